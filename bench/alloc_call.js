@@ -0,0 +1,9 @@
+// Allocations per call: ./run --count-allocs bench/alloc_call.js
+// Subtract the count with N = 0 and divide by N.
+var N = 10000;
+function f(a, b) {
+    return a;
+}
+for (var i = 0; i < N; i++) {
+    f(i, 1);
+}
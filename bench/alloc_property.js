@@ -0,0 +1,8 @@
+// Allocations per property read: ./run --count-allocs bench/alloc_property.js
+// Subtract the count with N = 0 and divide by N.
+var N = 10000;
+var o = { x: 1, y: 2 };
+var s = 0;
+for (var i = 0; i < N; i++) {
+    s = o.x;
+}
@@ -0,0 +1,9 @@
+// Array.prototype.concat microbenchmark: time ./run bench/array_concat.js
+var a = [], b = [], len = 0;
+for (var i = 0; i < 1000; i++) {
+    a[i] = i;
+    b[i] = -i;
+}
+for (var i = 0; i < 5000; i++)
+    len += a.concat(b, i).length;
+console.log(len);
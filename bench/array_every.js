@@ -0,0 +1,10 @@
+// Array.prototype.every microbenchmark: time ./run bench/array_every.js
+var a = [], count = 0;
+for (var i = 0; i < 1000; i++)
+    a[i] = i;
+function positive(x) { return x >= 0; }
+for (var i = 0; i < 100; i++) {
+    if (a.every(positive))
+        count++;
+}
+console.log(count);
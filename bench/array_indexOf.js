@@ -0,0 +1,7 @@
+// Array.prototype.indexOf microbenchmark: time ./run bench/array_indexOf.js
+var a = [], sum = 0;
+for (var i = 0; i < 10000; i++)
+    a[i] = i;
+for (var i = 0; i < 500; i++)
+    sum += a.indexOf(9999 - i);
+console.log(sum);
@@ -0,0 +1,7 @@
+// Array.prototype.join microbenchmark: time ./run bench/array_join.js
+var a = [], len = 0;
+for (var i = 0; i < 1000; i++)
+    a[i] = "item";
+for (var i = 0; i < 2000; i++)
+    len += a.join(", ").length;
+console.log(len);
@@ -0,0 +1,7 @@
+// Array.prototype.lastIndexOf microbenchmark: time ./run bench/array_lastIndexOf.js
+var a = [], sum = 0;
+for (var i = 0; i < 10000; i++)
+    a[i] = i;
+for (var i = 0; i < 500; i++)
+    sum += a.lastIndexOf(i);
+console.log(sum);
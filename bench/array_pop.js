@@ -0,0 +1,10 @@
+// Array.prototype.pop microbenchmark: time ./run bench/array_pop.js
+var a = [], sum = 0;
+for (var i = 0; i < 1000; i++)
+    a[i] = i;
+for (var i = 0; i < 200; i++) {
+    var b = a.slice(0);
+    while (b.length > 0)
+        sum += b.pop();
+}
+console.log(sum);
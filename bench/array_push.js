@@ -0,0 +1,8 @@
+// Array.prototype.push microbenchmark: time ./run bench/array_push.js
+var a;
+for (var i = 0; i < 200; i++) {
+    a = [];
+    for (var j = 0; j < 500; j++)
+        a.push(j, j);
+}
+console.log(a.length);
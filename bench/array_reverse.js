@@ -0,0 +1,7 @@
+// Array.prototype.reverse microbenchmark: time ./run bench/array_reverse.js
+var a = [];
+for (var i = 0; i < 10000; i++)
+    a[i] = i;
+for (var i = 0; i < 5001; i++)
+    a.reverse();
+console.log(a[0]);
@@ -0,0 +1,10 @@
+// Array.prototype.shift microbenchmark: time ./run bench/array_shift.js
+var a = [], sum = 0;
+for (var i = 0; i < 5000; i++)
+    a[i] = i;
+for (var i = 0; i < 20; i++) {
+    var b = a.slice(0);
+    while (b.length > 0)
+        sum += b.shift();
+}
+console.log(sum);
@@ -0,0 +1,7 @@
+// Array.prototype.slice microbenchmark: time ./run bench/array_slice.js
+var a = [], len = 0;
+for (var i = 0; i < 10000; i++)
+    a[i] = i;
+for (var i = 0; i < 5000; i++)
+    len += a.slice(i, i + 1000).length;
+console.log(len);
@@ -0,0 +1,10 @@
+// Array.prototype.some microbenchmark: time ./run bench/array_some.js
+var a = [], count = 0;
+for (var i = 0; i < 1000; i++)
+    a[i] = i;
+function negative(x) { return x < 0; }
+for (var i = 0; i < 100; i++) {
+    if (!a.some(negative))
+        count++;
+}
+console.log(count);
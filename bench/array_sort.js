@@ -0,0 +1,26 @@
+// Array.prototype.sort microbenchmark: time ./run bench/array_sort.js
+// Covers the default string order, numeric a - b comparators over int32s and
+// doubles, and an arbitrary comparator.
+var seed = 1;
+function random() {
+    seed = (seed * 16807) % 2147483647;
+    return seed;
+}
+var ints = [], doubles = [], strs = [], objs = [], b;
+for (var i = 0; i < 2000; i++) {
+    ints[i] = random() % 100000 - 50000;
+    doubles[i] = random() / 1024;
+    strs[i] = "key" + random();
+    objs[i] = { key: random() % 100 };
+}
+for (var i = 0; i < 20; i++) {
+    b = strs.slice(0);
+    b.sort();
+    b = ints.slice(0);
+    b.sort(function(x, y) { return x - y; });
+    b = doubles.slice(0);
+    b.sort(function(x, y) { return y - x; });
+}
+b = objs.slice(0);
+b.sort(function(x, y) { return x.key - y.key; });
+console.log(b[0].key <= b[1].key);
@@ -0,0 +1,9 @@
+// Array.prototype.splice microbenchmark: time ./run bench/array_splice.js
+var a = [];
+for (var i = 0; i < 10000; i++)
+    a[i] = i;
+for (var i = 0; i < 20000; i++) {
+    a.splice(i % 5000, 2, i);
+    a.splice(i % 7000, 0, i);
+}
+console.log(a.length);
@@ -0,0 +1,8 @@
+// Array.prototype.unshift microbenchmark: time ./run bench/array_unshift.js
+var a;
+for (var i = 0; i < 20; i++) {
+    a = [];
+    for (var j = 0; j < 5000; j++)
+        a.unshift(j);
+}
+console.log(a[0]);
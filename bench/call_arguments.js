@@ -0,0 +1,14 @@
+// Call overhead microbenchmark for functions with parameters, with and
+// without an arguments object: time ./run bench/call_arguments.js
+function add3(a, b, c) {
+    return a + b + c;
+}
+function sum_args(a, b, c) {
+    return arguments[0] + arguments[1] + arguments.length;
+}
+var s = 0;
+for (var i = 0; i < 20000; i++) {
+    s += add3(i, 1, 2);
+    s += sum_args(i, 1, 2);
+}
+console.log(s);
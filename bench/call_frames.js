@@ -0,0 +1,14 @@
+// Call frame microbenchmark: a leaf call in a loop and a recursive call
+// tree, neither of which creates closures: time ./run bench/call_frames.js
+function add(a, b) {
+    var t = a + b;
+    return t;
+}
+function fib(n) {
+    return n < 2 ? n : fib(n - 1) + fib(n - 2);
+}
+var s = 0;
+for (var i = 0; i < 30000; i++) {
+    s = add(s, i);
+}
+console.log(s, fib(18));
@@ -0,0 +1,20 @@
+// Function entry microbenchmark for a body with several var declarations:
+// time ./run bench/call_vars.js
+function f(a, b) {
+    var x = a + b;
+    var y = x * 2;
+    if (a > b) {
+        var z = y - a;
+    } else {
+        for (var i = 0; i < 1; i++) {
+            var w = i;
+        }
+    }
+    function g() {}
+    return x + y;
+}
+var s = 0;
+for (var n = 0; n < 40000; n++) {
+    s += f(n, 1);
+}
+console.log(s);
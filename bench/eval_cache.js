@@ -0,0 +1,16 @@
+// eval and new Function microbenchmark: time ./run bench/eval_cache.js
+// Templating style code with a few distinct sources, run with -c0 to
+// disable the code cache.
+var templates = [
+    "item.name + ': ' + item.price",
+    "item.name.length + item.price * 2",
+    "'<li>' + item.name + '</li>'"
+];
+var out = 0;
+for (var i = 0; i < 3000; i++) {
+    var item = { name: "n" + i, price: i };
+    out += eval(templates[i % 3]).length || 1;
+    var f = new Function("item", "return item.price + 1;");
+    out += f(item);
+}
+console.log(out);
@@ -0,0 +1,21 @@
+// for-in enumeration microbenchmark: time ./run bench/for_in.js
+// Enumerates many objects that have the same keys.
+function Point(i) {
+    this.x = i;
+    this.y = i + 1;
+    this.z = i + 2;
+    this.w = i + 3;
+}
+var points = [];
+for (var i = 0; i < 100; i++) {
+    points.push(new Point(i));
+}
+var n = 0;
+for (var round = 0; round < 100; round++) {
+    for (var j = 0; j < points.length; j++) {
+        for (var k in points[j]) {
+            n++;
+        }
+    }
+}
+console.log(n);
@@ -0,0 +1,16 @@
+// Optimizing tier microbenchmark: time ./run bench/hot_function.js
+// Small numeric functions called often enough to be optimized, whose
+// bodies read locals and literals.
+function lerp(a, b, t) {
+    var d = b - a;
+    return a + d * t;
+}
+function step(x, y) {
+    var nx = x * 0.5 + y * (1 / 4);
+    var ny = (y - x) * (2 + 1);
+    return nx * nx + ny * ny < 4 * 100 ? nx + ny : 0;
+}
+var s = 0;
+for (var i = 0; i < 100000; i++)
+    s = s + lerp(i, i + 8, 0.25) + step(i % 7, i % 11);
+console.log(s);
@@ -0,0 +1,25 @@
+// Integer key microbenchmark: time ./run bench/index_keys.js
+// Element reads and writes through a[i], plus index names built by
+// the array builtins and the arguments object.
+var a = [];
+for (var i = 0; i < 2000; i++)
+    a[i] = i;
+var s = 0;
+for (var k = 0; k < 20; k++) {
+    for (var i = 0; i < 2000; i++)
+        a[i] = a[i] + 1;
+    for (var i = 0; i < 2000; i++)
+        s += a[i];
+}
+var o = {};
+for (var i = 0; i < 1000; i++)
+    o[i] = i;
+for (var k = 0; k < 20; k++)
+    for (var i = 0; i < 1000; i++)
+        s += o[i];
+function f() {
+    return arguments[0] + arguments[1];
+}
+for (var i = 0; i < 5000; i++)
+    s += f(i, 1);
+console.log(s, a.join(",").length);
@@ -0,0 +1,17 @@
+// Int32 arithmetic microbenchmark: time ./run bench/int32.js
+// Hashing and fixed-point loops where every operand is an int32.
+function hash(n) {
+    var h = 0;
+    for (var i = 0; i < n; i++)
+        h = (h * 31 + (i ^ (i >>> 3))) | 0;
+    return h;
+}
+function fixed(n) {
+    var x = 1 << 12, s = 0;
+    for (var i = 0; i < n; i++) {
+        x = ((x * 3) >> 1) & 0xffff;
+        s = (s + (x % 7) - 3) | 0;
+    }
+    return s;
+}
+console.log(hash(100000), fixed(100000));
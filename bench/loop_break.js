@@ -0,0 +1,18 @@
+// Labelled break/continue microbenchmark: time ./run bench/loop_break.js
+var s = 0;
+outer: for (var i = 0; i < 300; i++) {
+    inner: for (var j = 0; j < 300; j++) {
+        if (j % 7 == 0)
+            continue;
+        if (j > i)
+            continue outer;
+        switch (j % 3) {
+            case 0:
+                s += 1;
+                break;
+            default:
+                s += 2;
+        }
+    }
+}
+console.log(s);
@@ -0,0 +1,12 @@
+// Number to string throughput: time ./run bench/number_to_string.js
+// Converts integers (as array keys and in join) and fractions.
+var arr = [];
+for (var i = 0; i < 20000; i++) {
+    arr.push(i);
+}
+var joined = arr.join(",");
+var len = 0;
+for (var j = 0; j < 20000; j++) {
+    len += ("" + j / 7).length;
+}
+console.log(joined.length, len);
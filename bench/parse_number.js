@@ -0,0 +1,13 @@
+// Number parsing microbenchmark: time ./run bench/parse_number.js
+// Splits CSV rows and converts the fields with ToNumber, parseFloat and parseInt.
+var rows = [];
+for (var i = 0; i < 200; i++)
+    rows.push(i + "," + (i * 1.25 + 0.001) + ",12345678.9" + i + "," + (i * 7919) + "px");
+var s = 0;
+for (var k = 0; k < 100; k++) {
+    for (var i = 0; i < rows.length; i++) {
+        var f = rows[i].split(",");
+        s += Number(f[0]) + +f[1] + parseFloat(f[2]) + parseInt(f[3]);
+    }
+}
+console.log(s);
@@ -0,0 +1,16 @@
+// Objects with a few data properties that are created, written and read.
+// Compare the peak memory as well as the time and ./run -a allocations.
+var points = [];
+for (var i = 0; i < 50000; i++) {
+    points.push({ x: i, y: i + 1, z: i + 2, w: 0 });
+}
+var s = 0;
+for (var k = 0; k < 4; k++) {
+    for (var i = 0; i < points.length; i++) {
+        var p = points[i];
+        p.w = p.x + p.y;
+        p.x = p.z;
+        s = (s + p.w) | 0;
+    }
+}
+console.log(s);
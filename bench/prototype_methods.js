@@ -0,0 +1,20 @@
+// Method loads that miss the receiver and find the method on a prototype.
+function Shape(w) {
+    this.w = w;
+}
+Shape.prototype.area = function() { return this.w * this.w; };
+function Square(w) {
+    this.w = w;
+}
+Square.prototype = Object.create(Shape.prototype);
+
+var s = new Square(3);
+var str = "abcdefgh";
+var a = [];
+var sum = 0;
+for (var i = 0; i < 100000; i++) {
+    a.push(i);
+    sum = (sum + a.pop() + s.area() + str.charCodeAt(i & 7)) | 0;
+    sum = (sum + str.length) | 0;
+}
+console.log(sum);
@@ -0,0 +1,20 @@
+// Scalar replacement microbenchmark: time ./run bench/scalar_objects.js
+// Small temporary objects that never leave the function making them.
+function length2(x0, y0, x1, y1) {
+    var d = { x: x1 - x0, y: y1 - y0 };
+    return d.x * d.x + d.y * d.y;
+}
+function mix(n) {
+    var s = 0;
+    for (var i = 0; i < n; i++) {
+        var c = { r: i & 255, g: (i >> 8) & 255, b: 7 };
+        s = (s + c.r * 3 + c.g * 5 + c.b) | 0;
+    }
+    return s;
+}
+var total = 0, mixed = 0;
+for (var i = 0; i < 50000; i++)
+    total = total + length2(i, 1, 2, i);
+for (var i = 0; i < 200; i++)
+    mixed = (mixed + mix(500)) | 0;
+console.log(total, mixed);
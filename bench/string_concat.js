@@ -0,0 +1,7 @@
+// String += and String.prototype.concat microbenchmark: time ./run bench/string_concat.js
+var s = "", t = "";
+for (var i = 0; i < 100000; i++)
+    s += "line " + i + "\n";
+for (var i = 0; i < 2000; i++)
+    t = t.concat("a", i, "b");
+console.log(s.length + t.length);
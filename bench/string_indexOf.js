@@ -0,0 +1,12 @@
+// String.prototype.indexOf/lastIndexOf microbenchmark: time ./run bench/string_indexOf.js
+var parts = [];
+for (var i = 0; i < 20000; i++)
+    parts[i] = "lorem ipsum dolor " + i;
+var s = parts.join(" "), sum = 0;
+var long_needle = "lorem ipsum dolor 19999 lorem ipsum dolor sit amet";
+for (var i = 0; i < 200; i++) {
+    sum += s.indexOf("dolor 1999" + (i % 10));
+    sum += s.lastIndexOf("lorem ipsum dolor 1" + i);
+    sum += s.indexOf(long_needle);
+}
+console.log(sum);
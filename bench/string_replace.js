@@ -0,0 +1,8 @@
+// String.prototype.replace microbenchmark: time ./run bench/string_replace.js
+var parts = [];
+for (var i = 0; i < 20000; i++)
+    parts[i] = "token" + i;
+var s = parts.join(" "), n = 0;
+for (var i = 0; i < 500; i++)
+    n += s.replace("token1999" + (i % 10), "[$&]").length;
+console.log(n);
@@ -0,0 +1,8 @@
+// String.prototype.split microbenchmark: time ./run bench/string_split.js
+var parts = [];
+for (var i = 0; i < 20000; i++)
+    parts[i] = "field" + i;
+var s = parts.join(", "), n = 0;
+for (var i = 0; i < 20; i++)
+    n += s.split(", ").length;
+console.log(n);
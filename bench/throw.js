@@ -0,0 +1,21 @@
+// Exception propagation microbenchmark: time ./run bench/throw.js
+// Set THROW to false for the same loop without exceptions.
+var THROW = true;
+function inner(i) {
+    if (THROW) {
+        throw i;
+    }
+    return i;
+}
+function outer(i) {
+    return inner(i) + 1;
+}
+var s = 0;
+for (var i = 0; i < 30000; i++) {
+    try {
+        s += outer(i);
+    } catch (e) {
+        s += e;
+    }
+}
+console.log(s);
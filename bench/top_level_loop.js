@@ -0,0 +1,12 @@
+// On-stack replacement microbenchmark: time ./run bench/top_level_loop.js
+// All the work is in top level loops that run once, over globals.
+var w = 0, h = 0, acc = 0;
+while (h < 300) {
+    w = 0;
+    while (w < 300) {
+        acc = (acc + w * h + (w ^ h)) % 1000003;
+        w++;
+    }
+    h++;
+}
+console.log(acc);
@@ -0,0 +1,37 @@
+// Typed array microbenchmark: time ./run bench/typed_array.js
+// Renders a mandelbrot into a Uint8Array and multiplies two Float64Array
+// matrices; set GENERIC to true to run the same kernels on plain arrays.
+var GENERIC = false;
+var w = 64, h = 64, n = 24;
+var image = GENERIC ? [] : new Uint8Array(w * h);
+for (var y = 0; y < h; y++) {
+    for (var x = 0; x < w; x++) {
+        var cr = -2 + 4 * x / w, ci = -2 + 4 * y / h, xr = 0, xi = 0, it = 0;
+        while (it < 32 && xr * xr + xi * xi < 4) {
+            var t = xr * xr - xi * xi + cr;
+            xi = 2 * xr * xi + ci;
+            xr = t;
+            it++;
+        }
+        image[y * w + x] = it;
+    }
+}
+var a = GENERIC ? [] : new Float64Array(n * n);
+var b = GENERIC ? [] : new Float64Array(n * n);
+var c = GENERIC ? [] : new Float64Array(n * n);
+for (var i = 0; i < n * n; i++) {
+    a[i] = i % 7;
+    b[i] = i % 5;
+}
+for (var i = 0; i < n; i++) {
+    for (var j = 0; j < n; j++) {
+        var sum = 0;
+        for (var k = 0; k < n; k++)
+            sum += a[i * n + k] * b[k * n + j];
+        c[i * n + j] = sum;
+    }
+}
+var checksum = 0;
+for (var i = 0; i < w * h; i++)
+    checksum += image[i];
+console.log(checksum, c[n * n - 1]);
@@ -10,17 +10,24 @@
 #include <string>
 #include <string_view>
 #include <array>
+#include <charconv>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <map>
 #include <bitset>
 #include <set>
 #include <stack>
+#include <deque>
+#include <list>
 #include <codecvt>
 #include <locale>
 #include <math.h>
 #include <string.h>
 #include <assert.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 /*
  * The code in this file is extracted directly from iv.
@@ -30,6 +37,8 @@
 namespace es
 {
     class /**/JSValue;
+    class PropertySlot;
+    struct ValidityCell;
 
     namespace character
     {
@@ -185,12 +194,53 @@ namespace es
         offset = 0;
         for(auto val : vals)
         {
-            memcpy((void*)(res.c_str() + offset), (void*)(val.data()), val.size() * 2);
+            memcpy((void*)(res.c_str() + offset), (void*)(val.data()), val.size());
             offset += val.size();
         }
         return res;
     }
 
+    // Collects the pieces of a string and joins them with a single allocation
+    // once the total length is known. Views must outlive the builder; strings
+    // passed by value are kept alive by the builder itself.
+    class StringBuilder
+    {
+    public:
+        void Append(std::string_view piece)
+        {
+            pieces_.push_back(piece);
+            size_ += piece.size();
+        }
+
+        void Append(std::string&& piece)
+        {
+            owned_.push_back(std::move(piece));
+            Append(std::string_view(owned_.back()));
+        }
+
+        size_t size() const
+        {
+            return size_;
+        }
+
+        std::string Build() const
+        {
+            std::string res(size_, '\0');
+            char* out = res.data();
+            for(const auto& piece : pieces_)
+            {
+                memcpy(out, piece.data(), piece.size());
+                out += piece.size();
+            }
+            return res;
+        }
+
+    private:
+        std::vector<std::string_view> pieces_;
+        std::deque<std::string> owned_;
+        size_t size_ = 0;
+    };
+
     inline bool HaveDuplicate(const std::vector<std::string>& vals)
     {
         size_t i;
@@ -208,6 +258,260 @@ namespace es
         return false;
     }
 
+    // Substring search kernels for the String.prototype methods. Short needles
+    // are located by testing 16 candidate positions at a time for matching first
+    // and last bytes and confirming the survivors with memcmp; long needles use
+    // the Two-Way algorithm, which never backtracks and so stays linear.
+    namespace search
+    {
+        static constexpr size_t npos = std::string_view::npos;
+        static constexpr size_t kTwoWayThreshold = 32;
+
+        // Two-Way string matching (Crochemore and Perrin), with a bad character
+        // shift on the last byte of the window.
+        inline size_t TwoWayFind(std::string_view haystack, std::string_view needle, size_t from)
+        {
+            const unsigned char* h = reinterpret_cast<const unsigned char*>(haystack.data());
+            const unsigned char* n = reinterpret_cast<const unsigned char*>(needle.data());
+            size_t l = needle.size();
+            size_t hlen = haystack.size();
+            size_t ip;
+            size_t jp;
+            size_t k;
+            size_t p;
+            size_t ms;
+            size_t p0;
+            size_t mem;
+            size_t mem0;
+            size_t shift[256] = { 0 };
+            for(size_t i = 0; i < l; i++)
+            {
+                shift[n[i]] = i + 1;
+            }
+            // Compute the maximal suffix for both orderings; the critical
+            // factorization is the later of the two.
+            ip = size_t(-1);
+            jp = 0;
+            k = p = 1;
+            while(jp + k < l)
+            {
+                if(n[ip + k] == n[jp + k])
+                {
+                    if(k == p)
+                    {
+                        jp += p;
+                        k = 1;
+                    }
+                    else
+                    {
+                        k++;
+                    }
+                }
+                else if(n[ip + k] > n[jp + k])
+                {
+                    jp += k;
+                    k = 1;
+                    p = jp - ip;
+                }
+                else
+                {
+                    ip = jp++;
+                    k = p = 1;
+                }
+            }
+            ms = ip;
+            p0 = p;
+            ip = size_t(-1);
+            jp = 0;
+            k = p = 1;
+            while(jp + k < l)
+            {
+                if(n[ip + k] == n[jp + k])
+                {
+                    if(k == p)
+                    {
+                        jp += p;
+                        k = 1;
+                    }
+                    else
+                    {
+                        k++;
+                    }
+                }
+                else if(n[ip + k] < n[jp + k])
+                {
+                    jp += k;
+                    k = 1;
+                    p = jp - ip;
+                }
+                else
+                {
+                    ip = jp++;
+                    k = p = 1;
+                }
+            }
+            if(ip + 1 > ms + 1)
+            {
+                ms = ip;
+            }
+            else
+            {
+                p = p0;
+            }
+            // Periodic needles remember how much of the window already matched.
+            if(memcmp(n, n + p, ms + 1) != 0)
+            {
+                mem0 = 0;
+                p = std::max(ms, l - ms - 1) + 1;
+            }
+            else
+            {
+                mem0 = l - p;
+            }
+            mem = 0;
+            size_t pos = from;
+            while(pos + l <= hlen)
+            {
+                const unsigned char* w = h + pos;
+                k = l - shift[w[l - 1]];
+                if(k != 0)
+                {
+                    pos += std::max(k, mem);
+                    mem = 0;
+                    continue;
+                }
+                // Compare the right half.
+                for(k = std::max(ms + 1, mem); k < l && n[k] == w[k]; k++)
+                {
+                }
+                if(k < l)
+                {
+                    pos += k - ms;
+                    mem = 0;
+                    continue;
+                }
+                // Compare the left half.
+                for(k = ms + 1; k > mem && n[k - 1] == w[k - 1]; k--)
+                {
+                }
+                if(k <= mem)
+                {
+                    return pos;
+                }
+                pos += p;
+                mem = mem0;
+            }
+            return npos;
+        }
+
+        // Returns the first position >= from where needle occurs in haystack.
+        inline size_t Find(std::string_view haystack, std::string_view needle, size_t from = 0)
+        {
+            size_t n = haystack.size();
+            size_t m = needle.size();
+            if(from > n || m > n - from)
+            {
+                return npos;
+            }
+            if(m == 0)
+            {
+                return from;
+            }
+            const char* h = haystack.data();
+            const char* s = needle.data();
+            if(m == 1)
+            {
+                const void* found = memchr(h + from, s[0], n - from);
+                return found == nullptr ? npos : static_cast<const char*>(found) - h;
+            }
+            if(m > kTwoWayThreshold)
+            {
+                return TwoWayFind(haystack, needle, from);
+            }
+            size_t i = from;
+#if defined(__SSE2__)
+            const __m128i first = _mm_set1_epi8(s[0]);
+            const __m128i last = _mm_set1_epi8(s[m - 1]);
+            for(; i + 16 + m - 1 <= n; i += 16)
+            {
+                __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i));
+                __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i + m - 1));
+                unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last)));
+                while(mask != 0)
+                {
+                    unsigned bit = __builtin_ctz(mask);
+                    if(memcmp(h + i + bit + 1, s + 1, m - 2) == 0)
+                    {
+                        return i + bit;
+                    }
+                    mask &= mask - 1;
+                }
+            }
+#endif
+            for(; i + m <= n; i++)
+            {
+                if(h[i] == s[0] && h[i + m - 1] == s[m - 1] && memcmp(h + i + 1, s + 1, m - 2) == 0)
+                {
+                    return i;
+                }
+            }
+            return npos;
+        }
+
+        // Returns the last position <= from where needle occurs in haystack.
+        inline size_t FindLast(std::string_view haystack, std::string_view needle, size_t from = npos)
+        {
+            size_t n = haystack.size();
+            size_t m = needle.size();
+            if(m > n)
+            {
+                return npos;
+            }
+            size_t pos = std::min(from, n - m);
+            if(m == 0)
+            {
+                return pos;
+            }
+            const char* h = haystack.data();
+            const char* s = needle.data();
+#if defined(__SSE2__)
+            const __m128i first = _mm_set1_epi8(s[0]);
+            const __m128i last = _mm_set1_epi8(s[m - 1]);
+            // Test the candidates pos - 15 ... pos, highest first.
+            while(pos >= 15 && pos != npos)
+            {
+                size_t start = pos - 15;
+                __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + start));
+                __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + start + m - 1));
+                unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last)));
+                while(mask != 0)
+                {
+                    unsigned bit = 31 - __builtin_clz(mask);
+                    if(memcmp(h + start + bit, s, m) == 0)
+                    {
+                        return start + bit;
+                    }
+                    mask &= ~(1u << bit);
+                }
+                if(start == 0)
+                {
+                    return npos;
+                }
+                pos = start - 1;
+            }
+#endif
+            for(size_t i = pos + 1; i-- > 0;)
+            {
+                if(h[i] == s[0] && h[i + m - 1] == s[m - 1] && memcmp(h + i, s, m) == 0)
+                {
+                    return i;
+                }
+            }
+            return npos;
+        }
+
+    }// namespace search
+
     namespace character
     {
         // uninames
@@ -673,11 +977,11 @@ namespace es
                     }
                 }
 
-                Type type()
+                Type type() const
                 {
                     return m_type;
                 }
-                std::string source()
+                const std::string& source() const
                 {
                     return m_source;
                 }
@@ -1675,13 +1979,26 @@ namespace es
                     AST_ILLEGAL,
                 };
 
+                // Binding slots of an identifier the optimizing tier does not
+                // speculate on, and of one it has yet to look up.
+                static constexpr uint32_t kNoSlot = static_cast<uint32_t>(-1);
+                static constexpr uint32_t kUnresolvedSlot = static_cast<uint32_t>(-2);
+
             private:
                 Type m_type;
                 std::string m_source;
-                std::string label_;
+                size_t target_;
+                // Filled in by the optimizing tier, see OptimizingTier.
+                bool optimized_;
+                JSValue* constant_;
+                uint32_t slot_;
+                uint32_t deopts_;
+                uint32_t back_edges_;
 
             public:
-                AST(Type type, const std::string& source = "") : m_type(type), m_source(source)
+                AST(Type type, const std::string& source = "")
+                : m_type(type), m_source(source), target_(0), optimized_(false), constant_(nullptr), slot_(kNoSlot), deopts_(0),
+                  back_edges_(0)
                 {
                 }
                 virtual ~AST(){};
@@ -1690,7 +2007,7 @@ namespace es
                 {
                     return m_type;
                 }
-                std::string source()
+                const std::string& source()
                 {
                     return m_source;
                 }
@@ -1705,13 +2022,61 @@ namespace es
                     return m_type == AST_ILLEGAL;
                 }
 
-                std::string label()
+                // Jump target id given by the parser to iteration, switch and
+                // labelled statements, and for break and continue the id of
+                // the statement they jump to. 0 if none.
+                size_t target()
+                {
+                    return target_;
+                }
+                void SetTarget(size_t target)
+                {
+                    target_ = target;
+                }
+
+                // Whether the optimizing tier has been over the node.
+                bool optimized()
+                {
+                    return optimized_;
+                }
+                void SetOptimized()
+                {
+                    optimized_ = true;
+                }
+
+                // The value of an expression the optimizing tier has found to
+                // be constant, nullptr otherwise.
+                JSValue* constant()
+                {
+                    return constant_;
+                }
+                void SetConstant(JSValue* constant)
+                {
+                    constant_ = constant;
+                }
+
+                // For an identifier in optimized code, the slot of its binding
+                // in the innermost declarative environment, speculating that
+                // the environment has the same layout on each evaluation.
+                uint32_t slot()
+                {
+                    return slot_;
+                }
+                void SetSlot(uint32_t slot)
+                {
+                    slot_ = slot;
+                }
+                // Returns the number of times the speculation on the node has
+                // failed, including this one.
+                uint32_t CountDeopt()
                 {
-                    return label_;
+                    return ++deopts_;
                 }
-                void SetLabel(const std::string& label)
+
+                // Returns the number of iterations of a loop before this one.
+                uint32_t CountBackEdge()
                 {
-                    label_ = label;
+                    return back_edges_++;
                 }
         };
 
@@ -1738,7 +2103,7 @@ namespace es
                 {
                     return len_;
                 }
-                std::vector<std::pair<size_t, AST*>> elements()
+                const std::vector<std::pair<size_t, AST*>>& elements()
                 {
                     return elements_;
                 }
@@ -1795,7 +2160,7 @@ namespace es
                     properties_.emplace_back(p);
                 }
 
-                std::vector<Property> properties()
+                const std::vector<Property>& properties()
                 {
                     return properties_;
                 }
@@ -1826,23 +2191,65 @@ namespace es
 
         class Binary : public AST
         {
+            public:
+                // Kinds of operand values, a site records the union of those it has seen.
+                enum OperandKind : uint8_t
+                {
+                    KIND_INT32 = 1 << 0,
+                    KIND_DOUBLE = 1 << 1,
+                    KIND_STRING = 1 << 2,
+                    KIND_OBJECT = 1 << 3,
+                    KIND_OTHER = 1 << 4,// undefined, null and booleans
+                };
+
+                // The specialized code the interpreter runs for the site.
+                enum Handler : uint8_t
+                {
+                    HANDLER_NONE,// not run yet
+                    HANDLER_INT32,
+                    HANDLER_NUMBER,
+                    HANDLER_STRING,
+                    HANDLER_GENERIC,
+                };
+
+                struct TypeFeedback
+                {
+                    uint8_t lhs_kinds = 0;
+                    uint8_t rhs_kinds = 0;
+                    Handler handler = HANDLER_NONE;
+                    uint64_t count = 0;
+                };
+
             private:
                 AST* lhs_;
                 AST* rhs_;
                 Token op_;
+                Token::Type calc_op_;
+                TypeFeedback feedback_;
 
             public:
                 Binary(AST* lhs, AST* rhs, Token op, const std::string& source = "")
-                : AST(AST_EXPR_BINARY, source), lhs_(lhs), rhs_(rhs), op_(std::move(op))
+                : AST(AST_EXPR_BINARY, source), lhs_(lhs), rhs_(rhs), op_(std::move(op)), calc_op_(CalcOp(op_.type()))
                 {
                 }
 
                 ~Binary() override
                 {
+                    if(feedback_.count != 0)
+                    {
+                        Sites().erase(this);
+                    }
                     delete lhs_;
                     delete rhs_;
                 }
 
+                // The sites that have run, for inspecting their feedback.
+                static std::unordered_set<Binary*>& Sites()
+                {
+                    static std::unordered_set<Binary*> sites;
+                    return sites;
+                }
+
                 AST* lhs()
                 {
                     return lhs_;
@@ -1851,10 +2258,52 @@ namespace es
                 {
                     return rhs_;
                 }
-                std::string op()
+                const std::string& op()
                 {
                     return op_.source();
                 }
+                // The operator without the assignment, e.g. TK_ADD for + and +=.
+                Token::Type calc_op()
+                {
+                    return calc_op_;
+                }
+
+                TypeFeedback& feedback()
+                {
+                    return feedback_;
+                }
+
+            private:
+                static Token::Type CalcOp(Token::Type op)
+                {
+                    switch(op)
+                    {
+                        case Token::TK_ADD_ASSIGN:
+                            return Token::TK_ADD;
+                        case Token::TK_SUB_ASSIGN:
+                            return Token::TK_SUB;
+                        case Token::TK_MUL_ASSIGN:
+                            return Token::TK_MUL;
+                        case Token::TK_MOD_ASSIGN:
+                            return Token::TK_MOD;
+                        case Token::TK_DIV_ASSIGN:
+                            return Token::TK_DIV;
+                        case Token::TK_BIT_LSH_ASSIGN:
+                            return Token::TK_BIT_LSH;
+                        case Token::TK_BIT_RSH_ASSIGN:
+                            return Token::TK_BIT_RSH;
+                        case Token::TK_BIT_URSH_ASSIGN:
+                            return Token::TK_BIT_URSH;
+                        case Token::TK_BIT_AND_ASSIGN:
+                            return Token::TK_BIT_AND;
+                        case Token::TK_BIT_OR_ASSIGN:
+                            return Token::TK_BIT_OR;
+                        case Token::TK_BIT_XOR_ASSIGN:
+                            return Token::TK_BIT_XOR;
+                        default:
+                            return op;
+                    }
+                }
         };
 
         class Unary : public AST
@@ -1878,7 +2327,7 @@ namespace es
                 {
                     return node_;
                 }
-                Token op()
+                const Token& op()
                 {
                     return op_;
                 }
@@ -1945,7 +2394,7 @@ namespace es
                     elements_.push_back(element);
                 }
 
-                std::vector<AST*> elements()
+                const std::vector<AST*>& elements()
                 {
                     return elements_;
                 }
@@ -1969,7 +2418,7 @@ namespace es
                     }
                 }
 
-                std::vector<AST*> args()
+                const std::vector<AST*>& args()
                 {
                     return args_;
                 }
@@ -1985,6 +2434,19 @@ namespace es
                     PROP,
                 };
 
+                // Where a property access base.name found name
+                // on the prototype chain of the last receiver that did not own
+                // it, see LookupPrototypeChain.
+                struct PropertyCache
+                {
+                    // The prototype of the receiver, nullptr if nothing is cached.
+                    JSValue* prototype = nullptr;
+                    // Valid as long as the chain from prototype is unchanged.
+                    ValidityCell* cell = nullptr;
+                    // The slot of name in its holder, nullptr if there is none.
+                    PropertySlot* slot = nullptr;
+                };
+
             private:
                 AST* base_;
                 size_t new_count_;
@@ -1993,6 +2455,7 @@ namespace es
                 std::vector<Arguments*> args_list_;
                 std::vector<AST*> index_list_;
                 std::vector<std::string> prop_name_list_;
+                std::vector<PropertyCache> prop_caches_;
 
             public:
                 LHS(AST* base, size_t new_count) : AST(AST_EXPR_LHS), base_(base), new_count_(new_count)
@@ -2027,6 +2490,7 @@ namespace es
                 {
                     order_.emplace_back(std::make_pair(prop_name_list_.size(), PROP));
                     prop_name_list_.emplace_back(prop_name.source());
+                    prop_caches_.emplace_back();
                 }
 
                 AST* base()
@@ -2037,22 +2501,46 @@ namespace es
                 {
                     return new_count_;
                 }
-                std::vector<std::pair<size_t, PostfixType>> order()
+                const std::vector<std::pair<size_t, PostfixType>>& order()
                 {
                     return order_;
                 }
-                std::vector<Arguments*> args_list()
+                const std::vector<Arguments*>& args_list()
                 {
                     return args_list_;
                 }
-                std::vector<AST*> index_list()
+                const std::vector<AST*>& index_list()
                 {
                     return index_list_;
                 }
-                std::vector<std::string> prop_name_list()
+                const std::vector<std::string>& prop_name_list()
                 {
                     return prop_name_list_;
                 }
+                // The cache of the i-th property access, nullptr if it can not
+                // have one.
+                PropertyCache* prop_cache(size_t i)
+                {
+                    // Function and arguments objects have their
+                    // own [[Get]] for caller, 15.3.5.4 and 10.6.
+                    if(prop_name_list_[i] == "caller")
+                    {
+                        return nullptr;
+                    }
+                    return &prop_caches_[i];
+                }
+
+                // Turns the property access base.name into the variable
+                // variable, for the scalar replacement of base.
+                void ReplaceWithVariable(const std::string& variable)
+                {
+                    assert(base_->type() == AST_EXPR_IDENT && new_count_ == 0);
+                    assert(order_.size() == 1 && order_[0].second == PROP);
+                    base_->SetSource(variable);
+                    order_.clear();
+                    prop_name_list_.clear();
+                    prop_caches_.clear();
+                }
 
         };
 
@@ -2069,12 +2557,7 @@ namespace es
                 {
                 }
 
-                Function(Token name, const std::vector<std::string>& params, AST* body, const std::string& source)
-                : AST(AST_FUNC, source), name_(std::move(name)), params_(params)
-                {
-                    assert(body->type() == AST::AST_FUNC_BODY);
-                    body_ = body;
-                }
+                Function(Token name, const std::vector<std::string>& params, AST* body, const std::string& source);
 
                 ~Function() override
                 {
@@ -2085,11 +2568,11 @@ namespace es
                 {
                     return name_.type() != Token::TK_NOT_FOUND;
                 }
-                std::string name()
+                const std::string& name()
                 {
                     return name_.source();
                 }
-                std::vector<std::string> params()
+                const std::vector<std::string>& params()
                 {
                     return params_;
                 }
@@ -2103,11 +2586,19 @@ namespace es
         {
             private:
                 bool strict_;
+                bool uses_arguments_;
+                bool has_inner_functions_;
+                uint32_t entries_;
+                uint32_t active_calls_;
                 std::vector<Function*> func_decls_;
                 std::vector<AST*> stmts_;
+                // The declarations bound on entry, see 10.5.
+                std::vector<std::string> var_decls_;
+                std::vector<std::string> fresh_var_decls_;
 
             public:
-                ProgramOrFunctionBody(Type type, bool strict) : AST(type), strict_(strict)
+                ProgramOrFunctionBody(Type type, bool strict)
+                : AST(type), strict_(strict), uses_arguments_(false), has_inner_functions_(false), entries_(0), active_calls_(0)
                 {
                 }
                 ~ProgramOrFunctionBody() override
@@ -2136,16 +2627,108 @@ namespace es
                 {
                     return strict_;
                 }
-                std::vector<Function*> func_decls()
+                // Set by the parser when the body (not counting nested functions)
+                // refers to arguments or eval, so that calls need an arguments object.
+                void SetUsesArguments()
+                {
+                    uses_arguments_ = true;
+                }
+                bool uses_arguments()
+                {
+                    return uses_arguments_;
+                }
+                // Set by the parser when a function is declared or expressed
+                // directly in the body, which may capture its environment.
+                void SetHasInnerFunctions()
+                {
+                    has_inner_functions_ = true;
+                }
+                bool has_inner_functions()
+                {
+                    return has_inner_functions_;
+                }
+                // Returns the number of times the code was entered before,
+                // for the optimizing tier to spot hot functions.
+                uint32_t CountEntry()
+                {
+                    return entries_++;
+                }
+                // The number of runs of the code that have not returned yet,
+                // recursive or reentered ones included.
+                void EnterCall()
+                {
+                    active_calls_++;
+                }
+                void ExitCall()
+                {
+                    active_calls_--;
+                }
+                uint32_t active_calls()
+                {
+                    return active_calls_;
+                }
+                void SetVarDecls(std::vector<std::string> var_decls)
+                {
+                    var_decls_ = std::move(var_decls);
+                    fresh_var_decls_ = var_decls_;
+                }
+                // Drops the variables that share a name with a parameter or a
+                // function declaration, which are bound before the variables.
+                void SetParameters(const std::vector<std::string>& params)
+                {
+                    fresh_var_decls_.clear();
+                    for(const auto& name : var_decls_)
+                    {
+                        if(std::find(params.begin(), params.end(), name) != params.end())
+                        {
+                            continue;
+                        }
+                        auto same_name = [&name](Function* func)
+                        {
+                            return func->name() == name;
+                        };
+                        if(std::find_if(func_decls_.begin(), func_decls_.end(), same_name) != func_decls_.end())
+                        {
+                            continue;
+                        }
+                        fresh_var_decls_.emplace_back(name);
+                    }
+                }
+                // All the variables declared in the code, without duplicates.
+                const std::vector<std::string>& var_decls()
+                {
+                    return var_decls_;
+                }
+                // The variables of a function body that need a new binding.
+                const std::vector<std::string>& fresh_var_decls()
+                {
+                    return fresh_var_decls_;
+                }
+                // Declares a variable no parameter or function shares the
+                // name of.
+                void AddVarDecl(const std::string& name)
+                {
+                    var_decls_.emplace_back(name);
+                    fresh_var_decls_.emplace_back(name);
+                }
+                const std::vector<Function*>& func_decls()
                 {
                     return func_decls_;
                 }
-                std::vector<AST*> statements()
+                const std::vector<AST*>& statements()
                 {
                     return stmts_;
                 }
         };
 
+        inline Function::Function(Token name, const std::vector<std::string>& params, AST* body, const std::string& source)
+        : AST(AST_FUNC, source), name_(std::move(name)), params_(params)
+        {
+            assert(body->type() == AST::AST_FUNC_BODY);
+            body_ = body;
+            static_cast<ProgramOrFunctionBody*>(body)->SetParameters(params_);
+        }
+
         class LabelledStmt : public AST
         {
             private:
@@ -2162,7 +2745,7 @@ namespace es
                     delete stmt_;
                 }
 
-                std::string label()
+                const std::string& label()
                 {
                     return label_.source();
                 }
@@ -2188,7 +2771,7 @@ namespace es
                 {
                 }
 
-                std::string ident()
+                const std::string& ident()
                 {
                     return ident_.source();
                 }
@@ -2243,6 +2826,7 @@ namespace es
             private:
                 Token ident_;
                 AST* init_;
+                std::vector<std::string> scalars_;
 
             public:
                 VarDecl(Token ident, const std::string& source) : VarDecl(std::move(ident), nullptr, source)
@@ -2258,7 +2842,7 @@ namespace es
                     delete init_;
                 }
 
-                std::string ident()
+                const std::string& ident()
                 {
                     return ident_.source();
                 }
@@ -2266,6 +2850,17 @@ namespace es
                 {
                     return init_;
                 }
+
+                // When the object literal init is replaced by scalars, the
+                // variable each of its properties is stored in.
+                const std::vector<std::string>& scalars()
+                {
+                    return scalars_;
+                }
+                void SetScalars(std::vector<std::string> scalars)
+                {
+                    scalars_ = std::move(scalars);
+                }
         };
 
         class VarStmt : public AST
@@ -2291,7 +2886,7 @@ namespace es
                     decls_.emplace_back(static_cast<VarDecl*>(decl));
                 }
 
-                std::vector<VarDecl*> decls()
+                const std::vector<VarDecl*>& decls()
                 {
                     return decls_;
                 }
@@ -2319,7 +2914,7 @@ namespace es
                     stmts_.emplace_back(stmt);
                 }
 
-                std::vector<AST*> statements()
+                const std::vector<AST*>& statements()
                 {
                     return stmts_;
                 }
@@ -2332,6 +2927,7 @@ namespace es
                 Token catch_ident_;
                 AST* catch_block_;
                 AST* finally_block_;
+                bool catch_env_captured_;
 
             public:
                 Try(AST* try_block, Token catch_ident, AST* catch_block, const std::string& source)
@@ -2346,7 +2942,7 @@ namespace es
 
                 Try(AST* try_block, Token catch_ident, AST* catch_block, AST* finally_block, const std::string& source)
                 : AST(AST_STMT_TRY, source), try_block_(try_block), catch_ident_(std::move(catch_ident)),
-                  catch_block_(catch_block), finally_block_(finally_block)
+                  catch_block_(catch_block), finally_block_(finally_block), catch_env_captured_(false)
                 {
                 }
 
@@ -2365,7 +2961,7 @@ namespace es
                 {
                     return try_block_;
                 }
-                std::string catch_ident()
+                const std::string& catch_ident()
                 {
                     return catch_ident_.source();
                 };
@@ -2373,6 +2969,16 @@ namespace es
                 {
                     return catch_block_;
                 }
+                // Set by the parser when the catch block contains a function
+                // or eval, which may keep the catch environment alive.
+                void SetCatchEnvCaptured()
+                {
+                    catch_env_captured_ = true;
+                }
+                bool catch_env_captured()
+                {
+                    return catch_env_captured_;
+                }
                 AST* finally_block()
                 {
                     return finally_block_;
@@ -2490,12 +3096,41 @@ namespace es
                     std::vector<AST*> stmts;
                 };
 
+                // When every case label is a number or a string
+                // literal, matching them has no side effect and the switch
+                // jumps through a table built on its first execution instead
+                // of comparing the clauses one by one. Clauses are numbered in
+                // source order, with the default clause counted in its place.
+                enum Dispatch
+                {
+                    DISPATCH_SEQUENTIAL,
+                    DISPATCH_INT32,
+                    DISPATCH_STRING,
+                };
+
+                static constexpr size_t kNoClause = static_cast<size_t>(-1);
+
+                struct JumpTable
+                {
+                    bool built = false;
+                    // DISPATCH_INT32 with dense labels: clause of label min + i.
+                    int32_t min = 0;
+                    std::vector<size_t> dense;
+                    // DISPATCH_INT32 with sparse labels: (label, clause) sorted
+                    // by label.
+                    std::vector<std::pair<int32_t, size_t>> sparse;
+                    // DISPATCH_STRING
+                    std::unordered_map<std::string, size_t> strings;
+                };
+
             private:
                 AST* expr_;
                 bool has_default_clause_ = false;
                 DefaultClause default_clause_;
                 std::vector<CaseClause> before_default_case_clauses_;
                 std::vector<CaseClause> after_default_case_clauses_;
+                Dispatch dispatch_ = DISPATCH_SEQUENTIAL;
+                JumpTable jump_table_;
 
             public:
                 Switch() : AST(AST_STMT_SWITCH)
@@ -2552,7 +3187,7 @@ namespace es
                 {
                     return expr_;
                 }
-                std::vector<CaseClause> before_default_case_clauses()
+                const std::vector<CaseClause>& before_default_case_clauses()
                 {
                     return before_default_case_clauses_;
                 }
@@ -2560,63 +3195,165 @@ namespace es
                 {
                     return has_default_clause_;
                 }
-                DefaultClause default_clause()
+                const DefaultClause& default_clause()
                 {
                     assert(has_default_clause());
                     return default_clause_;
                 }
-                std::vector<CaseClause> after_default_case_clauses()
+                const std::vector<CaseClause>& after_default_case_clauses()
                 {
                     return after_default_case_clauses_;
                 }
-        };
-
-        class For : public AST
-        {
-            private:
-                std::vector<AST*> expr0s_;
-                AST* expr1_;
-                AST* expr2_;
 
-                AST* stmt_;
-
-            public:
-                For(const std::vector<AST*>& expr0s, AST* expr1, AST* expr2, AST* stmt, const std::string& source)
-                : AST(AST_STMT_FOR, source), expr0s_(expr0s), expr1_(expr1), expr2_(expr2), stmt_(stmt)
+                size_t clause_count()
                 {
+                    return before_default_case_clauses_.size() + (has_default_clause_ ? 1 : 0) +
+                           after_default_case_clauses_.size();
                 }
-
-                std::vector<AST*> expr0s()
+                // Statements of the i-th clause in source order.
+                const std::vector<AST*>& clause_stmts(size_t i)
                 {
-                    return expr0s_;
+                    size_t before = before_default_case_clauses_.size();
+                    if(i < before)
+                    {
+                        return before_default_case_clauses_[i].stmts;
+                    }
+                    if(has_default_clause_)
+                    {
+                        if(i == before)
+                        {
+                            return default_clause_.stmts;
+                        }
+                        i--;
+                    }
+                    return after_default_case_clauses_[i - before].stmts;
                 }
-                AST* expr1()
+                size_t default_clause_index()
                 {
-                    return expr1_;
+                    return has_default_clause_ ? before_default_case_clauses_.size() : clause_count();
                 }
-                AST* expr2()
+
+                Dispatch dispatch()
                 {
-                    return expr2_;
+                    return dispatch_;
                 }
-                AST* statement()
+                void SetDispatch(Dispatch dispatch)
                 {
-                    return stmt_;
+                    dispatch_ = dispatch;
                 }
-        };
-
-        class ForIn : public AST
-        {
+                // Called by the parser once all clauses are added.
+                void ChooseDispatch()
+                {
+                    size_t numbers = 0;
+                    size_t strings = 0;
+                    for(const auto* clauses : { &before_default_case_clauses_, &after_default_case_clauses_ })
+                    {
+                        for(const CaseClause& clause : *clauses)
+                        {
+                            if(clause.expr->type() == AST_EXPR_NUMBER)
+                            {
+                                numbers++;
+                            }
+                            else if(clause.expr->type() == AST_EXPR_STRING)
+                            {
+                                strings++;
+                            }
+                        }
+                    }
+                    size_t cases = before_default_case_clauses_.size() + after_default_case_clauses_.size();
+                    if(cases == 0)
+                    {
+                        dispatch_ = DISPATCH_SEQUENTIAL;
+                    }
+                    else if(numbers == cases)
+                    {
+                        dispatch_ = DISPATCH_INT32;
+                    }
+                    else if(strings == cases)
+                    {
+                        dispatch_ = DISPATCH_STRING;
+                    }
+                }
+                JumpTable* jump_table()
+                {
+                    return &jump_table_;
+                }
+        };
+
+        class For : public AST
+        {
+            private:
+                std::vector<AST*> expr0s_;
+                AST* expr1_;
+                AST* expr2_;
+
+                AST* stmt_;
+
+            public:
+                For(const std::vector<AST*>& expr0s, AST* expr1, AST* expr2, AST* stmt, const std::string& source)
+                : AST(AST_STMT_FOR, source), expr0s_(expr0s), expr1_(expr1), expr2_(expr2), stmt_(stmt)
+                {
+                }
+
+                const std::vector<AST*>& expr0s()
+                {
+                    return expr0s_;
+                }
+                AST* expr1()
+                {
+                    return expr1_;
+                }
+                AST* expr2()
+                {
+                    return expr2_;
+                }
+                AST* statement()
+                {
+                    return stmt_;
+                }
+        };
+
+        class ForIn : public AST
+        {
             private:
                 AST* expr0_;
                 AST* expr1_;
                 AST* stmt_;
 
+            public:
+                // The property names of the last object the
+                // statement enumerated, as String values. They are reused for
+                // the next object if it has the same enumerable own keys and
+                // the same prototype chain, with no layout change since.
+                struct EnumerationCache
+                {
+                    std::vector<JSValue*> keys;
+                    // Number of own keys at the front of keys.
+                    size_t own_count = 0;
+                    // nullptr if keys can not be reused.
+                    JSValue* object = nullptr;
+                    uint64_t object_epoch = 0;
+                    // (prototype, layout epoch) along the prototype chain.
+                    std::vector<std::pair<JSValue*, uint64_t>> prototypes;
+                    // Whether an iteration is walking keys, in which case a
+                    // recursive evaluation of the statement does not use it.
+                    bool busy = false;
+                };
+
+            private:
+                EnumerationCache enumeration_cache_;
+
             public:
                 ForIn(AST* expr0, AST* expr1, AST* stmt, const std::string& source)
                 : AST(AST_STMT_FOR_IN, source), expr0_(expr0), expr1_(expr1), stmt_(stmt)
                 {
                 }
 
+                EnumerationCache* enumeration_cache()
+                {
+                    return &enumeration_cache_;
+                }
+
                 AST* expr0()
                 {
                     return expr0_;
@@ -2636,6 +3373,29 @@ namespace es
             private:
                 std::string m_source;
                 Lexer lexer_;
+                // The innermost function body or program being parsed.
+                ProgramOrFunctionBody* current_body_;
+                // Number of functions and references to eval parsed so far,
+                // i.e. the places where an environment may be captured.
+                size_t capture_sites_;
+                // 12.12 Labels and the statements break and continue can jump
+                // to, for the function body or program being parsed.
+                struct JumpTargets
+                {
+                    std::vector<std::pair<std::string, size_t>> labels;
+                    // (id, is an iteration statement) for the enclosing
+                    // iteration and switch statements.
+                    std::vector<std::pair<size_t, bool>> statements;
+                    // Id given by the labels directly in front of the
+                    // statement being parsed, 0 if none.
+                    size_t pending_label = 0;
+                };
+                JumpTargets jump_targets_;
+                size_t jump_target_count_;
+
+                size_t BeginJumpTarget(bool iteration);
+                void EndJumpTarget();
+                size_t ResolveJumpTarget(AST::Type type, const std::string& label);
 
             public:
                 Parser(const std::string& source);
@@ -2677,6 +3437,8 @@ namespace es
         };
     }
 
+    class JSValue;
+
     class Error
     {
         public:
@@ -2695,52 +3457,63 @@ namespace es
         private:
             Type m_type;
             std::string m_message;
+            // The value of a throw statement that is propagating through
+            // native frames, see Throw.
+            JSValue* m_value;
 
         public:
+            // Errors are plain values. Evaluation functions keep
+            // one on the native stack and hand out a pointer to it, so the
+            // success path never allocates and the message is only built
+            // when an error is actually raised.
+            Error() : m_type(E_OK), m_value(nullptr)
+            {
+            }
 
-            // TODO(zhuzilin) Fix memory leakage here.
-            static Error* Ok()
+            static Error Ok()
             {
-                return new Error(E_OK);
+                return Error(E_OK);
             }
 
-            static Error* EvalError()
+            static Error EvalError()
             {
-                return new Error(E_EVAL);
+                return Error(E_EVAL);
             }
 
-            static Error* RangeError(const std::string& message = "")
+            static Error RangeError(const std::string& message = "")
             {
-                return new Error(E_RANGE, message);
+                return Error(E_RANGE, message);
             }
 
-            static Error* ReferenceError(const std::string& message = "")
+            static Error ReferenceError(const std::string& message = "")
             {
-                return new Error(E_REFERENCE, message);
+                return Error(E_REFERENCE, message);
             }
 
-            static Error* SyntaxError(const std::string& message = "")
+            static Error SyntaxError(const std::string& message = "")
             {
-                return new Error(E_SYNTAX, message);
+                return Error(E_SYNTAX, message);
             }
 
-            static Error* TypeError(const std::string& message = "")
+            static Error TypeError(const std::string& message = "")
             {
-                return new Error(E_TYPE, message);
+                return Error(E_TYPE, message);
             }
 
-            static Error* UriError()
+            static Error UriError()
             {
-                return new Error(E_URI);
+                return Error(E_URI);
             }
 
-            static Error* NativeError(const std::string& message)
+            static Error NativeError(const std::string& message)
             {
-                return new Error(E_NATIVE, message);
+                return Error(E_NATIVE, message);
             }
 
-        private:        
-            Error(Type t, const std::string& message = "") : m_type(t), m_message(message)
+            static Error Throw(JSValue* value);
+
+        private:
+            Error(Type t, const std::string& message = "") : m_type(t), m_message(message), m_value(nullptr)
             {
             }
 
@@ -2755,14 +3528,19 @@ namespace es
                 return m_type == E_OK;
             }
 
-            std::string message()
+            const std::string& message()
             {
                 return m_message;
             }
 
+            JSValue* value()
+            {
+                return m_value;
+            }
+
             std::string ToString()
             {
-                return Ok() != nullptr ? "ok" : "error";
+                return IsOk() ? "ok" : "error";
             }
 
 
@@ -2865,7 +3643,7 @@ namespace es
             {
                 if(IsUndefined() || IsNull())
                 {
-                    *e = *Error::TypeError("undefined or null is not coercible");
+                    *e = Error::TypeError("undefined or null is not coercible");
                 }
             }
             virtual bool IsCallable()
@@ -2962,14 +3740,72 @@ namespace es
     class String : public JSValue
     {
     public:
-        String(const std::string& data) : JSValue(JS_STRING), data_(data)
+        // Concatenations shorter than this are copied eagerly. Longer ones are
+        // kept as a pair of strings and laid out on first access, so that
+        // appending to a long string in a loop stays linear.
+        static constexpr size_t kMinRopeLength = 256;
+
+        String(const std::string& data) : JSValue(JS_STRING), data_(data), size_(data.size()), left_(nullptr), right_(nullptr)
+        {
+        }
+        String(std::string&& data) : JSValue(JS_STRING), data_(std::move(data)), size_(data_.size()), left_(nullptr), right_(nullptr)
+        {
+        }
+        String(const char* data, size_t size) : JSValue(JS_STRING), data_(data, size), size_(size), left_(nullptr), right_(nullptr)
+        {
+        }
+        const std::string& data()
         {
+            Flatten();
+            return data_;
         }
-        std::string data()
+
+        std::string_view view()
         {
+            Flatten();
             return data_;
         }
 
+        size_t size()
+        {
+            return size_;
+        }
+
+        // Strings of different lengths are told apart without laying them out.
+        bool Equals(String* other)
+        {
+            if(this == other)
+            {
+                return true;
+            }
+            if(size_ != other->size_)
+            {
+                return false;
+            }
+            return view() == other->view();
+        }
+
+        static String* Concat(String* left, String* right)
+        {
+            if(left->size() == 0)
+            {
+                return right;
+            }
+            if(right->size() == 0)
+            {
+                return left;
+            }
+            if(left->size() + right->size() < kMinRopeLength)
+            {
+                std::string res;
+                res.reserve(left->size() + right->size());
+                res += left->view();
+                res += right->view();
+                return new String(std::move(res));
+            }
+            return new String(left, right);
+        }
+
         static String* Empty()
         {
             static String singleton("");
@@ -3020,18 +3856,158 @@ namespace es
 
         inline std::string ToString() override
         {
+            Flatten();
             return log::ToString(data_);
         }
 
     private:
+        String(String* left, String* right) : JSValue(JS_STRING), size_(left->size() + right->size()), left_(left), right_(right)
+        {
+        }
+
+        // Copies the leaves into data_ in a single pass from the back. The walk
+        // uses an explicit stack since += loops build very deep trees.
+        void Flatten()
+        {
+            if(left_ == nullptr)
+            {
+                return;
+            }
+            std::string res(size_, '\0');
+            size_t pos = size_;
+            std::vector<String*> stack = { left_, right_ };
+            while(!stack.empty())
+            {
+                String* node = stack.back();
+                stack.pop_back();
+                if(node->left_ != nullptr)
+                {
+                    stack.push_back(node->left_);
+                    stack.push_back(node->right_);
+                    continue;
+                }
+                pos -= node->size_;
+                memcpy(&res[pos], node->data_.data(), node->size_);
+            }
+            assert(pos == 0);
+            data_ = std::move(res);
+            left_ = nullptr;
+            right_ = nullptr;
+        }
+
         std::string data_;
+        size_t size_;
+        String* left_;
+        String* right_;
+    };
+
+    // Interned strings of the integers 0 to size() - 1. Array indices, loop
+    // counters and arguments positions are turned into property names all
+    // the time, so keep those strings around instead of formatting them anew.
+    class IndexStrings
+    {
+        public:
+            static constexpr uint32_t kDefaultSize = 1024;
+
+            static IndexStrings* Global()
+            {
+                static IndexStrings singleton(kDefaultSize);
+                return &singleton;
+            }
+
+            // Returns the interned string of m, or nullptr if m is not an
+            // integer below size().
+            String* Find(double m)
+            {
+                if(!(m >= 0 && m < strings_.size()))
+                {
+                    return nullptr;
+                }
+                size_t index = size_t(m);
+                if(index != m)
+                {
+                    return nullptr;
+                }
+                return strings_[index];
+            }
+
+            // 0 disables the table.
+            void SetSize(uint32_t size)
+            {
+                size_t old_size = strings_.size();
+                strings_.resize(size);
+                for(size_t i = old_size; i < size; i++)
+                {
+                    strings_[i] = new String(std::to_string(i));
+                }
+            }
+
+            uint32_t size()
+            {
+                return strings_.size();
+            }
+
+        private:
+            IndexStrings(uint32_t size)
+            {
+                SetSize(size);
+            }
+
+            std::vector<String*> strings_;
     };
 
+    std::string NumberToString(double m);
+
+    // 9.5 ToInt32: (Signed 32 Bit Integer) for a double. Values that are
+    // already in range only need a truncation, the others have their low 32
+    // bits picked out of the mantissa, so there is no fmod or pow.
+    inline int32_t DoubleToInt32(double d)
+    {
+        if(d >= -2147483648.0 && d <= 2147483647.0)
+        {
+            return int32_t(d);
+        }
+        uint64_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+        // |d| is mantissa * 2^exponent. NaN and the infinities have an
+        // exponent above 31 as well, and all of them map to 0.
+        int exponent = int((bits >> 52) & 0x7FF) - 1075;
+        if(exponent > 31)
+        {
+            return 0;
+        }
+        uint64_t mantissa = (bits & ((1ull << 52) - 1)) | (1ull << 52);
+        uint32_t low = exponent < 0 ? uint32_t(mantissa >> -exponent) : uint32_t(mantissa << exponent);
+        if(bits >> 63)
+        {
+            low = 0u - low;
+        }
+        return int32_t(low);
+    }
+
+    // 9.6 ToUint32: (Unsigned 32 Bit Integer) for a double.
+    inline uint32_t DoubleToUint32(double d)
+    {
+        return uint32_t(DoubleToInt32(d));
+    }
+
+    // Whether d is an int32 value, so that int32_t(d) is exact. -0 is not, as
+    // it would read back as +0.
+    inline bool IsInt32(double d)
+    {
+        return d >= -2147483648.0 && d <= 2147483647.0 && double(int32_t(d)) == d && (d != 0 || !signbit(d));
+    }
+
     class Number : public JSValue
     {
     public:
-        Number(double data) : JSValue(JS_NUMBER), data_(data)
+        Number(double data) : JSValue(JS_NUMBER), data_(data), int32_(es::IsInt32(data))
+        {
+        }
+
+        static Number* FromInt32(int32_t value)
         {
+            return new Number(value, true);
         }
 
         static Number* NaN()
@@ -3092,13 +4068,29 @@ namespace es
             return data_;
         }
 
+        // Whether es::IsInt32(data()), so that Int32Value() is exact.
+        inline bool IsInt32()
+        {
+            return int32_;
+        }
+        inline int32_t Int32Value()
+        {
+            assert(int32_);
+            return int32_t(data_);
+        }
+
         inline std::string ToString() override
         {
-            return std::to_string(data_);
+            return NumberToString(data_);
         }
 
     private:
+        Number(int32_t value, bool) : JSValue(JS_NUMBER), data_(value), int32_(true)
+        {
+        }
+
         double data_;
+        bool int32_;
     };
 
     class PropertyDescriptor : public JSValue
@@ -3136,14 +4128,16 @@ namespace es
             {
             }
 
+            // 8.10.1 IsAccessorDescriptor ( Desc )
             inline bool IsAccessorDescriptor()
             {
-                return ((bitmask_ & GET) != 0) && ((bitmask_ & SET) != 0);
+                return ((bitmask_ & GET) != 0) || ((bitmask_ & SET) != 0);
             }
 
+            // 8.10.2 IsDataDescriptor ( Desc )
             inline bool IsDataDescriptor()
             {
-                return ((bitmask_ & VALUE) != 0) && ((bitmask_ & WRITABLE) != 0);
+                return ((bitmask_ & VALUE) != 0) || ((bitmask_ & WRITABLE) != 0);
             }
 
             inline bool IsGenericDescriptor()
@@ -3317,6 +4311,157 @@ namespace es
 
     };
 
+    // Getter and setter of an accessor property.
+    struct AccessorPair
+    {
+        JSValue* getter;
+        JSValue* setter;
+    };
+
+    // An own property as an object stores it: the value of a
+    // data property, or the AccessorPair of an accessor property, next to the
+    // attributes packed in a byte. Only accessor properties allocate anything
+    // besides the slot. PropertyDescriptors are created for the algorithms of
+    // the spec that take one and for the reflective builtins.
+    class PropertySlot
+    {
+        public:
+            enum Attribute : uint8_t
+            {
+                WRITABLE = 1 << 0,
+                ENUMERABLE = 1 << 1,
+                CONFIGURABLE = 1 << 2,
+                ACCESSOR = 1 << 3,
+            };
+
+            PropertySlot() : value_(Undefined::Instance()), attributes_(0)
+            {
+            }
+
+            PropertySlot(JSValue* value, bool writable, bool enumerable, bool configurable)
+            : value_(value), attributes_((writable ? WRITABLE : 0) | (enumerable ? ENUMERABLE : 0) | (configurable ? CONFIGURABLE : 0))
+            {
+            }
+
+            // 8.12.9 step 4, the fields absent from desc take their default values.
+            explicit PropertySlot(PropertyDescriptor* desc) : PropertySlot()
+            {
+                if(desc->IsAccessorDescriptor())
+                {
+                    MakeAccessor();
+                }
+                Set(desc);
+            }
+
+            inline bool IsAccessor()
+            {
+                return (attributes_ & ACCESSOR) != 0;
+            }
+
+            inline JSValue* Value()
+            {
+                assert(!IsAccessor());
+                return value_;
+            }
+            inline void SetValue(JSValue* value)
+            {
+                assert(!IsAccessor());
+                value_ = value;
+            }
+
+            inline JSValue* Getter()
+            {
+                assert(IsAccessor());
+                return accessors_->getter;
+            }
+            inline JSValue* Setter()
+            {
+                assert(IsAccessor());
+                return accessors_->setter;
+            }
+
+            inline bool Writable()
+            {
+                return (attributes_ & WRITABLE) != 0;
+            }
+            inline bool Enumerable()
+            {
+                return (attributes_ & ENUMERABLE) != 0;
+            }
+            inline bool Configurable()
+            {
+                return (attributes_ & CONFIGURABLE) != 0;
+            }
+
+            // 8.12.9 step 9.b, keeps [[Configurable]] and [[Enumerable]].
+            void MakeAccessor()
+            {
+                accessors_ = new AccessorPair{ Undefined::Instance(), Undefined::Instance() };
+                attributes_ = (attributes_ & ~WRITABLE) | ACCESSOR;
+            }
+            // 8.12.9 step 9.c, keeps [[Configurable]] and [[Enumerable]].
+            void MakeData()
+            {
+                value_ = Undefined::Instance();
+                attributes_ &= ~(ACCESSOR | WRITABLE);
+            }
+
+            // 8.12.9 step 12, the property is already of the kind of desc.
+            void Set(PropertyDescriptor* desc)
+            {
+                if(desc->HasValue())
+                {
+                    SetValue(desc->Value());
+                }
+                if(desc->HasWritable())
+                {
+                    SetAttribute(WRITABLE, desc->Writable());
+                }
+                if(desc->HasGet())
+                {
+                    accessors_->getter = desc->Get();
+                }
+                if(desc->HasSet())
+                {
+                    accessors_->setter = desc->Set();
+                }
+                if(desc->HasEnumerable())
+                {
+                    SetAttribute(ENUMERABLE, desc->Enumerable());
+                }
+                if(desc->HasConfigurable())
+                {
+                    SetAttribute(CONFIGURABLE, desc->Configurable());
+                }
+            }
+
+            // 8.12.1 [[GetOwnProperty]] steps 3 to 6, fills the fields of desc.
+            void Describe(PropertyDescriptor* desc)
+            {
+                if(IsAccessor())
+                {
+                    desc->SetAccessorDescriptor(accessors_->getter, accessors_->setter, Enumerable(), Configurable());
+                }
+                else
+                {
+                    desc->SetDataDescriptor(value_, Writable(), Enumerable(), Configurable());
+                }
+            }
+
+        private:
+            void SetAttribute(Attribute attribute, bool value)
+            {
+                attributes_ = value ? (attributes_ | attribute) : (attributes_ & ~attribute);
+            }
+
+            union
+            {
+                JSValue* value_;
+                AccessorPair* accessors_;
+            };
+            uint8_t attributes_;
+    };
+
     class PropertyIdentifier : public JSValue
     {
         private:
@@ -3363,7 +4508,7 @@ namespace es
             {
                 String* str_x = static_cast<String*>(x);
                 String* str_y = static_cast<String*>(y);
-                return str_x->data() == str_y->data();
+                return str_x->Equals(str_y);
             }
             case JSValue::JS_BOOL:
             {
@@ -3378,6 +4523,15 @@ namespace es
 
     typedef std::function<JSValue*(Error*, JSValue*, const std::vector<JSValue*>&)> inner_func;
 
+    // Stands for the prototype chain that starts at an object
+    // which is the prototype of others. It turns invalid once an object on the
+    // chain adds, removes or reconfigures a property or changes its prototype,
+    // and the object then hands out a new cell.
+    struct ValidityCell
+    {
+        bool valid = true;
+    };
+
     class JSObject : public JSValue
     {
         public:
@@ -3395,15 +4549,40 @@ namespace es
                 OBJ_REGEX,
                 OBJ_JSON,
                 OBJ_ERROR,
+                OBJ_ARRAY_BUFFER,
+                OBJ_TYPED_ARRAY,
 
                 OBJ_INNER_FUNC,
                 OBJ_OTHER,
             };
 
 
+        protected:
+            std::map<std::string, PropertySlot> named_properties_;
+
+            // Called whenever an own property is added or
+            // removed, or changes its attributes, see ForIn::EnumerationCache.
+            void LayoutChanged()
+            {
+                layout_epoch_ = ++LayoutCounter();
+                if(prototype_info_ != nullptr)
+                {
+                    InvalidatePrototypeChains();
+                }
+            }
+
         private:
+            // Only objects that are the prototype of another object have one.
+            struct PrototypeInfo
+            {
+                ValidityCell* cell = nullptr;
+                // The prototypes whose [[Prototype]] is this object.
+                std::vector<JSObject*> users;
+            };
+
             ObjType obj_type_;
-            std::map<std::string, PropertyDescriptor*> named_properties_;
+            uint64_t layout_epoch_ = 0;
+            PrototypeInfo* prototype_info_ = nullptr;
 
             JSValue* prototype_;
             std::string class_;
@@ -3448,10 +4627,42 @@ namespace es
             void SetPrototype(JSValue* proto)
             {
                 assert(proto->type() == JS_NULL || proto->type() == JS_OBJECT);
+                if(prototype_info_ != nullptr)
+                {
+                    UnregisterPrototypeUser();
+                    InvalidatePrototypeChains();
+                }
                 prototype_ = proto;
+                if(proto->IsObject())
+                {
+                    JSObject* proto_obj = static_cast<JSObject*>(proto);
+                    proto_obj->MakePrototype();
+                    if(prototype_info_ != nullptr)
+                    {
+                        proto_obj->prototype_info_->users.emplace_back(this);
+                    }
+                }
+            }
+
+            // The validity cell of the prototype chain from this object, which
+            // is then treated as the prototype of another object.
+            ValidityCell* PrototypeValidityCell()
+            {
+                MakePrototype();
+                if(prototype_info_->cell == nullptr)
+                {
+                    // The prototype gets its cell first, so that
+                    // an object without a cell never has a user with one.
+                    if(prototype_->IsObject())
+                    {
+                        static_cast<JSObject*>(prototype_)->PrototypeValidityCell();
+                    }
+                    prototype_info_->cell = new ValidityCell();
+                }
+                return prototype_info_->cell;
             }
 
-            std::string Class()
+            const std::string& Class()
             {
                 return class_;
             }
@@ -3466,15 +4677,115 @@ namespace es
                 extensible_ = extensible;
             }
 
+        private:
+            void MakePrototype()
+            {
+                if(prototype_info_ != nullptr)
+                {
+                    return;
+                }
+                prototype_info_ = new PrototypeInfo();
+                if(prototype_->IsObject())
+                {
+                    JSObject* proto_obj = static_cast<JSObject*>(prototype_);
+                    proto_obj->MakePrototype();
+                    proto_obj->prototype_info_->users.emplace_back(this);
+                }
+            }
+
+            void UnregisterPrototypeUser()
+            {
+                if(prototype_->IsObject())
+                {
+                    std::vector<JSObject*>& users = static_cast<JSObject*>(prototype_)->prototype_info_->users;
+                    users.erase(std::find(users.begin(), users.end(), this));
+                }
+            }
+
+            // Invalidates the cells of the chains through this object.
+            void InvalidatePrototypeChains()
+            {
+                if(prototype_info_->cell == nullptr)
+                {
+                    return;
+                }
+                prototype_info_->cell->valid = false;
+                prototype_info_->cell = nullptr;
+                for(JSObject* user : prototype_info_->users)
+                {
+                    user->InvalidatePrototypeChains();
+                }
+            }
+
+        public:
+
+            // Counts the layout changes of all objects.
+            static uint64_t& LayoutCounter()
+            {
+                static uint64_t counter = 0;
+                return counter;
+            }
+            // Value of LayoutCounter() at the last layout change of this object.
+            uint64_t layout_epoch()
+            {
+                return layout_epoch_;
+            }
+            size_t OwnPropertyCount()
+            {
+                return named_properties_.size();
+            }
+            // Whether the own properties are exactly the first count of keys,
+            // in order, and all enumerable.
+            bool HasEnumerableOwnKeys(const std::vector<JSValue*>& keys, size_t count);
+            // Whether AllEnumerableProperties only lists named_properties_ and
+            // those of the prototypes.
+            virtual bool EnumeratesNamedPropertiesOnly()
+            {
+                return true;
+            }
+
             virtual JSValue* Get(Error* e, const std::string& P);
-            virtual JSValue* GetOwnProperty(const std::string& P);
+            // [[GetOwnProperty]] and [[GetProperty]] without a descriptor. Copy
+            // the property to slot and return true if there is one.
+            virtual bool GetOwnPropertySlot(const std::string& P, PropertySlot* slot);
+            bool GetPropertySlot(const std::string& P, PropertySlot* slot);
+            // Return a new PropertyDescriptor, or undefined.
+            JSValue* GetOwnProperty(const std::string& P);
             JSValue* GetProperty(const std::string& P);
-            void Put(Error* e, const std::string& P, JSValue* V, bool throw_flag);
+            // The slot of P in named_properties_, or nullptr.
+            PropertySlot* FindNamedProperty(const std::string& P)
+            {
+                auto iter = named_properties_.find(P);
+                return iter == named_properties_.end() ? nullptr : &iter->second;
+            }
+            virtual void Put(Error* e, const std::string& P, JSValue* V, bool throw_flag);
             bool CanPut(const std::string& P);
             bool HasProperty(const std::string& P);
             virtual bool Delete(Error* e, const std::string& P, bool throw_flag);
             JSValue* DefaultValue(Error* e, const std::string& hint);
             virtual bool DefineOwnProperty(Error* e, const std::string& P, PropertyDescriptor* desc, bool throw_flag);
+            // [[Get]] and [[Put]] of the array index property index. Objects
+            // with indexed storage override these to skip the property name.
+            // Others use the interned name of index if there is one.
+            virtual JSValue* GetByIndex(Error* e, uint32_t index)
+            {
+                String* name = IndexStrings::Global()->Find(index);
+                if(name != nullptr)
+                {
+                    return Get(e, name->data());
+                }
+                return Get(e, NumberToString(index));
+            }
+            virtual void PutByIndex(Error* e, uint32_t index, JSValue* V, bool throw_flag)
+            {
+                String* name = IndexStrings::Global()->Find(index);
+                if(name != nullptr)
+                {
+                    Put(e, name->data(), V, throw_flag);
+                    return;
+                }
+                Put(e, NumberToString(index), V, throw_flag);
+            }
 
             // Internal Properties Only Defined for Some Objects
             // [[PrimitiveValue]]
@@ -3531,7 +4842,7 @@ namespace es
                 }
                 if(!O->IsObject())
                 {
-                    *e = *Error::TypeError();
+                    *e = Error::TypeError();
                     return false;
                 }
                 while(!V->IsNull())
@@ -3552,38 +4863,34 @@ namespace es
 
             void AddValueProperty(const std::string& name, JSValue* value, bool writable, bool enumerable, bool configurable)
             {
-                PropertyDescriptor* desc = new PropertyDescriptor();
-                desc->SetDataDescriptor(value, writable, enumerable, configurable);
+                PropertyDescriptor desc;
+                desc.SetDataDescriptor(value, writable, enumerable, configurable);
                 // This should just like named_properties_[name] = desc
-                DefineOwnProperty(nullptr, name, desc, false);
+                DefineOwnProperty(nullptr, name, &desc, false);
             }
 
             void AddFuncProperty(const std::string& name, inner_func callable, bool writable, bool enumerable, bool configurable);
 
-            // This for for-in statement.
-            virtual std::vector<std::pair<std::string, PropertyDescriptor*>> AllEnumerableProperties()
+            // This for for-in statement. Returns the names of the properties.
+            virtual std::vector<std::string> AllEnumerableProperties()
             {
-                std::vector<std::pair<std::string, PropertyDescriptor*>> result;
-                for(auto pair : named_properties_)
+                std::vector<std::string> result;
+                for(auto& pair : named_properties_)
                 {
-                    if(!pair.second->HasEnumerable() || !pair.second->Enumerable())
+                    if(!pair.second.Enumerable())
                     {
                         continue;
                     }
-                    result.emplace_back(pair);
+                    result.emplace_back(pair.first);
                 }
                 if(!prototype_->IsNull())
                 {
                     JSObject* proto = static_cast<JSObject*>(prototype_);
-                    for(auto pair : proto->AllEnumerableProperties())
+                    for(const auto& name : proto->AllEnumerableProperties())
                     {
-                        if(!pair.second->HasEnumerable() || !pair.second->Enumerable())
+                        if(named_properties_.find(name) == named_properties_.end())
                         {
-                            continue;
-                        }
-                        if(named_properties_.find(pair.first) == named_properties_.end())
-                        {
-                            result.emplace_back(pair);
+                            result.emplace_back(name);
                         }
                     }
                 }
@@ -3596,55 +4903,94 @@ namespace es
             }
     };
 
+    inline bool JSObject::HasEnumerableOwnKeys(const std::vector<JSValue*>& keys, size_t count)
+    {
+        if(named_properties_.size() != count)
+        {
+            return false;
+        }
+        size_t i = 0;
+        for(auto& pair : named_properties_)
+        {
+            if(!pair.second.Enumerable() || static_cast<String*>(keys[i])->data() != pair.first)
+            {
+                return false;
+            }
+            i++;
+        }
+        return true;
+    }
+
     // 8.12.1 [[GetOwnProperty]] (P)
-    inline JSValue* JSObject::GetOwnProperty(const std::string& P)
+    inline bool JSObject::GetOwnPropertySlot(const std::string& P, PropertySlot* slot)
     {
         // TODO(zhuzilin) String Object has a more elaborate impl 15.5.5.2.
-        auto iter = named_properties_.find(P);
-        if(iter == named_properties_.end())
+        PropertySlot* own = FindNamedProperty(P);
+        if(own == nullptr)
         {
-            return Undefined::Instance();
+            return false;
         }
-        // NOTE(zhuzilin) In the spec, we need to create a new property descriptor D,
-        // And assign the property to it. However, if we init D->value = a, and
-        // set D->value = b in DefineOwnProperty, the value saved in the named_properties_ will
-        // remain b and that is not what we want.
-        return iter->second;
+        *slot = *own;
+        return true;
     }
 
-    inline JSValue* JSObject::GetProperty(const std::string& P)
+    // 8.12.2 [[GetProperty]] (P)
+    inline bool JSObject::GetPropertySlot(const std::string& P, PropertySlot* slot)
     {
-        JSValue* own_property = GetOwnProperty(P);
-        if(!own_property->IsUndefined())
+        if(GetOwnPropertySlot(P, slot))
         {
-            return own_property;
+            return true;
         }
         JSValue* proto = Prototype();
         if(proto->IsNull())
         {
-            return Undefined::Instance();
+            return false;
         }
         assert(proto->IsObject());
         JSObject* proto_obj = static_cast<JSObject*>(proto);
-        return proto_obj->GetProperty(P);
+        return proto_obj->GetPropertySlot(P, slot);
+    }
+
+    // As in the spec, the descriptor is a new one, so setting
+    // its fields does not change the property.
+    inline JSValue* JSObject::GetOwnProperty(const std::string& P)
+    {
+        PropertySlot slot;
+        if(!GetOwnPropertySlot(P, &slot))
+        {
+            return Undefined::Instance();
+        }
+        PropertyDescriptor* desc = new PropertyDescriptor();
+        slot.Describe(desc);
+        return desc;
+    }
+
+    inline JSValue* JSObject::GetProperty(const std::string& P)
+    {
+        PropertySlot slot;
+        if(!GetPropertySlot(P, &slot))
+        {
+            return Undefined::Instance();
+        }
+        PropertyDescriptor* desc = new PropertyDescriptor();
+        slot.Describe(desc);
+        return desc;
     }
 
     inline JSValue* JSObject::Get(Error* e, const std::string& P)
     {
-        JSValue* value = GetProperty(P);
-        if(value->IsUndefined())
+        PropertySlot slot;
+        if(!GetPropertySlot(P, &slot))
         {
             return Undefined::Instance();
         }
-        PropertyDescriptor* desc = static_cast<PropertyDescriptor*>(value);
-        if(desc->IsDataDescriptor())
+        if(!slot.IsAccessor())
         {
-            return desc->Value();
+            return slot.Value();
         }
         else
         {
-            assert(desc->IsAccessorDescriptor());
-            JSValue* getter = desc->Get();
+            JSValue* getter = slot.Getter();
             if(getter->IsUndefined())
             {
                 return Undefined::Instance();
@@ -3656,17 +5002,16 @@ namespace es
 
     inline bool JSObject::CanPut(const std::string& P)
     {
-        JSValue* value = GetOwnProperty(P);
-        if(!value->IsUndefined())
+        PropertySlot slot;
+        if(GetOwnPropertySlot(P, &slot))
         {
-            PropertyDescriptor* desc = static_cast<PropertyDescriptor*>(value);
-            if(desc->IsAccessorDescriptor())
+            if(slot.IsAccessor())
             {
-                return !desc->Set()->IsUndefined();
+                return !slot.Setter()->IsUndefined();
             }
             else
             {
-                return desc->Writable();
+                return slot.Writable();
             }
         }
 
@@ -3676,19 +5021,17 @@ namespace es
             return Extensible();
         }
         JSObject* proto_obj = static_cast<JSObject*>(proto);
-        JSValue* inherit = proto_obj->GetProperty(P);
-        if(inherit->IsUndefined())
+        if(!proto_obj->GetPropertySlot(P, &slot))
         {
             return Extensible();
         }
-        PropertyDescriptor* desc = static_cast<PropertyDescriptor*>(inherit);
-        if(desc->IsAccessorDescriptor())
+        if(slot.IsAccessor())
         {
-            return !desc->Set()->IsUndefined();
+            return !slot.Setter()->IsUndefined();
         }
         else
         {
-            return Extensible() ? desc->Writable() : false;
+            return Extensible() ? slot.Writable() : false;
         }
     }
 
@@ -3696,70 +5039,79 @@ namespace es
     inline void JSObject::Put(Error* e, const std::string& P, JSValue* V, bool throw_flag)
     {
         //log::PrintSource("Put ", P, " " + V->ToString());
-        if(!CanPut(P))
-        {// 1
-            if(throw_flag)
-            {// 1.a
-                *e = *Error::TypeError();
+        // [[CanPut]] (step 1) is answered by the lookups of
+        // step 2 and 4, so that the property is only looked up once.
+        PropertySlot slot;
+        bool found = GetOwnPropertySlot(P, &slot);// 2
+        if(found && !slot.IsAccessor())
+        {// 3
+            if(!slot.Writable())
+            {
+                goto reject;
             }
-            return;// 1.b
+            PropertyDescriptor value_desc;
+            value_desc.SetValue(V);
+            //log::PrintSource("Overwrite the old desc with " + value_desc.ToString());
+            DefineOwnProperty(e, P, &value_desc, throw_flag);
+            return;
         }
-        JSValue* value = GetOwnProperty(P);
-        if(!value->IsUndefined())
-        {
-            PropertyDescriptor* own_desc = static_cast<PropertyDescriptor*>(value);// 2
-            if(own_desc->IsDataDescriptor())
-            {// 3
-                PropertyDescriptor* value_desc = new PropertyDescriptor();
-                value_desc->SetValue(V);
-                //log::PrintSource("Overwrite the old desc with " + value_desc->ToString());
-                DefineOwnProperty(e, P, value_desc, throw_flag);
-                return;
-            }
+        if(!found && !Prototype()->IsNull())
+        {// 4
+            found = static_cast<JSObject*>(Prototype())->GetPropertySlot(P, &slot);
         }
-        value = GetProperty(P);
-        if(!value->IsUndefined())
-        {
-            PropertyDescriptor* desc = static_cast<PropertyDescriptor*>(value);
-            if(desc->IsAccessorDescriptor())
+        if(found && slot.IsAccessor())
+        {// 5
+            //log::PrintSource("Use parent prototype's setter");
+            JSValue* setter = slot.Setter();
+            if(setter->IsUndefined())
             {
-                //log::PrintSource("Use parent prototype's setter");
-                JSValue* setter = desc->Set();
-                assert(!setter->IsUndefined());
-                JSObject* setter_obj = static_cast<JSObject*>(setter);
-                setter_obj->Call(e, this, { V });
-                return;
+                goto reject;
             }
+            JSObject* setter_obj = static_cast<JSObject*>(setter);
+            setter_obj->Call(e, this, { V });
+            return;
+        }
+        if(!Extensible() || (found && !slot.Writable()))
+        {
+            goto reject;
+        }
+        {
+            PropertyDescriptor new_desc;
+            new_desc.SetDataDescriptor(V, true, true, true);// 6.a
+            DefineOwnProperty(e, P, &new_desc, throw_flag);
+            return;
+        }
+    reject:
+        if(throw_flag)
+        {// 1.a
+            *e = Error::TypeError();
         }
-        PropertyDescriptor* new_desc = new PropertyDescriptor();
-        new_desc->SetDataDescriptor(V, true, true, true);// 6.a
-        DefineOwnProperty(e, P, new_desc, throw_flag);
     }
 
     inline bool JSObject::HasProperty(const std::string& P)
     {
-        JSValue* desc = GetOwnProperty(P);
-        return !desc->IsUndefined();
+        PropertySlot slot;
+        return GetOwnPropertySlot(P, &slot);
     }
 
     inline bool JSObject::Delete(Error* e, const std::string& P, bool throw_flag)
     {
-        JSValue* value = GetOwnProperty(P);
-        if(value->IsUndefined())
+        PropertySlot slot;
+        if(!GetOwnPropertySlot(P, &slot))
         {
             return true;
         }
-        PropertyDescriptor* desc = static_cast<PropertyDescriptor*>(value);
-        if(desc->Configurable())
+        if(slot.Configurable())
         {
             named_properties_.erase(P);
+            LayoutChanged();
             return true;
         }
         else
         {
             if(throw_flag)
             {
-                *e = *Error::TypeError();
+                *e = Error::TypeError();
             }
             return false;
         }
@@ -3768,64 +5120,75 @@ namespace es
     // 8.12.9 [[DefineOwnProperty]] (P, Desc, Throw)
     inline bool JSObject::DefineOwnProperty(Error* e, const std::string& P, PropertyDescriptor* desc, bool throw_flag)
     {
-        JSValue* current = GetOwnProperty(P);
-        PropertyDescriptor* current_desc;
-        if(current->IsUndefined())
+        PropertySlot current;
+        PropertyDescriptor current_desc;
+        PropertySlot* stored;
+        if(!GetOwnPropertySlot(P, &current))
         {
             if(!extensible_)
             {// 3
                 goto reject;
             }
             // 4.
-            named_properties_[P] = desc;
+            named_properties_.emplace(P, PropertySlot(desc));
+            LayoutChanged();
             return true;
         }
         if(desc->bitmask() == 0)
         {// 5
             return true;
         }
-        current_desc = static_cast<PropertyDescriptor*>(current);
-        if((desc->bitmask() & current_desc->bitmask()) == desc->bitmask())
+        if(desc->bitmask() == PropertyDescriptor::VALUE && !current.IsAccessor() && current.Writable())
+        {// Only the value of a writable data property changes, as in [[Put]].
+            stored = FindNamedProperty(P);
+            if(stored != nullptr)
+            {
+                stored->SetValue(desc->Value());
+            }
+            return true;
+        }
+        current.Describe(&current_desc);
+        if((desc->bitmask() & current_desc.bitmask()) == desc->bitmask())
         {
             bool same = true;
             if(desc->HasValue())
             {
-                same = same && SameValue(desc->Value(), current_desc->Value());
+                same = same && SameValue(desc->Value(), current_desc.Value());
             }
             if(desc->HasWritable())
             {
-                same = same && (desc->Writable() == current_desc->Writable());
+                same = same && (desc->Writable() == current_desc.Writable());
             }
             if(desc->HasGet())
             {
-                same = same && SameValue(desc->Get(), current_desc->Get());
+                same = same && SameValue(desc->Get(), current_desc.Get());
             }
             if(desc->HasSet())
             {
-                same = same && SameValue(desc->Set(), current_desc->Set());
+                same = same && SameValue(desc->Set(), current_desc.Set());
             }
             if(desc->HasConfigurable())
             {
-                same = same && (desc->Configurable() == current_desc->Configurable());
+                same = same && (desc->Configurable() == current_desc.Configurable());
             }
             if(desc->HasEnumerable())
             {
-                same = same && (desc->Enumerable() == current_desc->Enumerable());
+                same = same && (desc->Enumerable() == current_desc.Enumerable());
             }
             if(same)
             {
                 return true;// 6
             }
         }
-        //log::PrintSource("desc: " + desc->ToString() + ", current: " + current_desc->ToString());
-        if(!current_desc->Configurable())
+        //log::PrintSource("desc: " + desc->ToString() + ", current: " + current_desc.ToString());
+        if(!current_desc.Configurable())
         {// 7
             if(desc->Configurable())
             {// 7.a
                 //log::PrintSource("DefineOwnProperty: ", P, " not configurable, while new value configurable");
                 goto reject;
             }
-            if(desc->HasEnumerable() && (desc->Enumerable() != current_desc->Enumerable()))
+            if(desc->HasEnumerable() && (desc->Enumerable() != current_desc.Enumerable()))
             {// 7.b
                 //log::PrintSource("DefineOwnProperty: ", P, " enumerable value differ");
                 goto reject;
@@ -3834,33 +5197,40 @@ namespace es
         // 8.
         if(!desc->IsGenericDescriptor())
         {
-            if(current_desc->IsDataDescriptor() != desc->IsDataDescriptor())
+            if(current_desc.IsDataDescriptor() != desc->IsDataDescriptor())
             {// 9.
                 // 9.a
-                if(!current_desc->Configurable())
+                if(!current_desc.Configurable())
                 {
                     goto reject;
                 }
                 // 9.b.i & 9.c.i
-                PropertyDescriptor* old_property = named_properties_[P];
-                PropertyDescriptor* new_property = new PropertyDescriptor();
-                new_property->SetConfigurable(old_property->Configurable());
-                new_property->SetEnumerable(old_property->Enumerable());
-                new_property->SetBitMask(old_property->bitmask());
-                named_properties_[P] = new_property;
-            }
-            else if(current_desc->IsDataDescriptor() && desc->IsDataDescriptor())
+                stored = FindNamedProperty(P);
+                if(stored != nullptr)
+                {
+                    if(stored->IsAccessor())
+                    {
+                        stored->MakeData();
+                    }
+                    else
+                    {
+                        stored->MakeAccessor();
+                    }
+                    LayoutChanged();
+                }
+            }
+            else if(current_desc.IsDataDescriptor() && desc->IsDataDescriptor())
             {// 10.
-                if(!current_desc->Configurable())
+                if(!current_desc.Configurable())
                 {// 10.a
-                    if(!current_desc->Writable())
+                    if(!current_desc.Writable())
                     {
                         if(desc->Writable())
                         {
                             goto reject;// 10.a.i
                         }
                         // 10.a.ii.1
-                        if(desc->HasValue() && !SameValue(desc->Value(), current_desc->Value()))
+                        if(desc->HasValue() && !SameValue(desc->Value(), current_desc.Value()))
                         {
                             goto reject;
                         }
@@ -3868,16 +5238,16 @@ namespace es
                 }
                 else
                 {// 10.b
-                    assert(current_desc->Configurable());
+                    assert(current_desc.Configurable());
                 }
             }
             else
             {// 11.
-                assert(current_desc->IsAccessorDescriptor() && desc->IsAccessorDescriptor());
-                if(!current_desc->Configurable())
+                assert(current_desc.IsAccessorDescriptor() && desc->IsAccessorDescriptor());
+                if(!current_desc.Configurable())
                 {// 11.a
-                    if(!SameValue(desc->Set(), current_desc->Set()) ||// 11.a.i
-                       !SameValue(desc->Get(), current_desc->Get()))
+                    if(!SameValue(desc->Set(), current_desc.Set()) ||// 11.a.i
+                       !SameValue(desc->Get(), current_desc.Get()))
                     {// 11.a.ii
                         goto reject;
                     }
@@ -3886,14 +5256,22 @@ namespace es
         }
         //log::PrintSource("DefineOwnProperty: ", P, " is set" + (desc->HasValue() ? " to " + desc->Value()->ToString() : ""));
         // 12.
-        current_desc->Set(desc);
+        stored = FindNamedProperty(P);
+        if(stored != nullptr)
+        {
+            stored->Set(desc);
+        }
+        if(desc->HasEnumerable())
+        {
+            LayoutChanged();
+        }
         // 13.
         return true;
     reject:
         //log::PrintSource("DefineOwnProperty reject");
         if(throw_flag)
         {
-            *e = *Error::TypeError();
+            *e = Error::TypeError();
         }
         return false;
     }
@@ -3912,6 +5290,11 @@ namespace es
             virtual JSValue* GetBindingValue(Error* e, const std::string& N, bool S) = 0;
             virtual bool DeleteBinding(Error* e, const std::string& N) = 0;
             virtual JSValue* ImplicitThisValue() = 0;
+
+            virtual bool IsDeclarative()
+            {
+                return false;
+            }
     };
 
     class DeclarativeEnvironmentRecord : public EnvironmentRecord
@@ -3919,57 +5302,111 @@ namespace es
         public:
             struct Binding
             {
+                std::string name;
                 JSValue* value;
                 bool can_delete;
                 bool is_mutable;
             };
 
+            // Records up to this size are searched linearly, larger ones keep
+            // a hash index next to the bindings.
+            static constexpr size_t kMaxLinearBindings = 16;
+
         private:
-            std::unordered_map<std::string, Binding> bindings_;
+            // The bindings are stored flat because most records
+            // belong to a function call and only hold a handful of names, and
+            // a pooled record can then be refilled without allocating.
+            std::vector<Binding> bindings_;
+            std::unordered_map<std::string, size_t> index_;
+
+            Binding* Find(const std::string& N)
+            {
+                if(!index_.empty())
+                {
+                    auto iter = index_.find(N);
+                    return iter == index_.end() ? nullptr : &bindings_[iter->second];
+                }
+                for(Binding& b : bindings_)
+                {
+                    if(b.name == N)
+                    {
+                        return &b;
+                    }
+                }
+                return nullptr;
+            }
+
+            void Append(const std::string& N, JSValue* V, bool D, bool is_mutable)
+            {
+                bindings_.push_back({N, V, D, is_mutable});
+                if(!index_.empty())
+                {
+                    index_.emplace(N, bindings_.size() - 1);
+                }
+                else if(bindings_.size() > kMaxLinearBindings)
+                {
+                    RebuildIndex();
+                }
+            }
+
+            void RebuildIndex()
+            {
+                index_.clear();
+                if(bindings_.size() <= kMaxLinearBindings)
+                {
+                    return;
+                }
+                index_.reserve(bindings_.size());
+                for(size_t i = 0; i < bindings_.size(); i++)
+                {
+                    index_.emplace(bindings_[i].name, i);
+                }
+            }
 
         public:
             bool HasBinding(const std::string& N) override
             {
-                return bindings_.find(N) != bindings_.end();
+                return Find(N) != nullptr;
             }
 
             void CreateMutableBinding(Error* e, const std::string& N, bool D) override
             {
                 (void)e;
                 assert(!HasBinding(N));
-                Binding b;
-                b.value = Undefined::Instance();
-                b.can_delete = D;
-                b.is_mutable = true;
-                bindings_[N] = b;
+                Append(N, Undefined::Instance(), D, true);
             }
 
             void SetMutableBinding(Error* e, const std::string& N, JSValue* V, bool S) override
             {
                 //log::PrintSource("enter SetMutableBinding ", N, " to " + V->ToString());
                 assert(V->IsLanguageType());
-                assert(HasBinding(N));
-                // NOTE(zhuzilin) If we do note b = bindings_[N] and change b.value,
-                // the value stored in bindings_ won't change.
-                if(bindings_[N].is_mutable)
+                Binding* b = Find(N);
+                assert(b != nullptr);
+                if(b->is_mutable)
                 {
-                    bindings_[N].value = V;
+                    b->value = V;
                 }
                 else if(S)
                 {
-                    *e = *Error::TypeError();
+                    *e = Error::TypeError();
                 }
             }
 
             JSValue* GetBindingValue(Error* e, const std::string& N, bool S) override
             {
-                assert(HasBinding(N));
-                Binding b = bindings_[N];
-                if(b.value->IsUndefined())
+                Binding* b = Find(N);
+                assert(b != nullptr);
+                return GetBindingValue(e, b, S);
+            }
+
+            JSValue* GetBindingValue(Error* e, Binding* b, bool S)
+            {
+                const std::string& N = b->name;
+                if(b->value->IsUndefined())
                 {
                     if(S)
                     {
-                        *e = *Error::ReferenceError(N + " is not defined");
+                        *e = Error::ReferenceError(N + " is not defined");
                         return nullptr;
                     }
                     else
@@ -3978,22 +5415,27 @@ namespace es
                         return Undefined::Instance();
                     }
                 }
-                //log::PrintSource("GetBindingValue ", N, " " + b.value->ToString());
-                return b.value;
+                //log::PrintSource("GetBindingValue ", N, " " + b->value->ToString());
+                return b->value;
             }
 
             bool DeleteBinding(Error* e, const std::string& N) override
             {
                 (void)e;
-                if(!HasBinding(N))
+                Binding* b = Find(N);
+                if(b == nullptr)
                 {
                     return true;
                 }
-                if(!bindings_[N].can_delete)
+                if(!b->can_delete)
                 {
                     return false;
                 }
-                bindings_.erase(N);
+                bindings_.erase(bindings_.begin() + (b - bindings_.data()));
+                if(!index_.empty())
+                {
+                    RebuildIndex();
+                }
                 return true;
             }
 
@@ -4002,21 +5444,68 @@ namespace es
                 return Undefined::Instance();
             }
 
+            bool IsDeclarative() override
+            {
+                return true;
+            }
+
+            // The slot of the binding N, which stays valid until a binding
+            // before it is deleted, or AST::kNoSlot.
+            uint32_t SlotOf(const std::string& N)
+            {
+                Binding* b = Find(N);
+                return b == nullptr ? Parsing::AST::kNoSlot : static_cast<uint32_t>(b - bindings_.data());
+            }
+
+            // The binding in slot if it is named N, nullptr otherwise.
+            Binding* BindingAt(uint32_t slot, const std::string& N)
+            {
+                if(slot < bindings_.size() && bindings_[slot].name == N)
+                {
+                    return &bindings_[slot];
+                }
+                return nullptr;
+            }
+
             void CreateImmutableBinding(const std::string& N)
             {
                 assert(!HasBinding(N));
-                Binding b;
-                b.value = Undefined::Instance();
-                b.can_delete = false;
-                b.is_mutable = false;
-                bindings_[N] = b;
+                Append(N, Undefined::Instance(), false, false);
             }
 
             void InitializeImmutableBinding(const std::string& N, JSValue* V)
             {
-                assert(HasBinding(N));
-                assert(!bindings_[N].is_mutable && bindings_[N].value->IsUndefined());
-                bindings_[N].value = V;
+                Binding* b = Find(N);
+                assert(b != nullptr);
+                assert(!b->is_mutable && b->value->IsUndefined());
+                b->value = V;
+            }
+
+            // Creates the mutable binding N, or overwrites its value if it
+            // exists. Used on function entry, where the record starts empty and
+            // the declarations are known to be consistent.
+            void InitializeMutableBinding(const std::string& N, JSValue* V)
+            {
+                Binding* b = Find(N);
+                if(b == nullptr)
+                {
+                    Append(N, V, false, true);
+                    return;
+                }
+                b->value = V;
+                b->can_delete = false;
+                b->is_mutable = true;
+            }
+
+            void Reserve(size_t n)
+            {
+                bindings_.reserve(n);
+            }
+
+            void Clear()
+            {
+                bindings_.clear();
+                index_.clear();
             }
 
             virtual std::string ToString() override
@@ -4045,9 +5534,9 @@ namespace es
             void CreateMutableBinding(Error* e, const std::string& N, bool D) override
             {
                 assert(!HasBinding(N));
-                PropertyDescriptor* desc = new PropertyDescriptor();
-                desc->SetDataDescriptor(Undefined::Instance(), true, true, D);
-                bindings_->DefineOwnProperty(e, N, desc, true);
+                PropertyDescriptor desc;
+                desc.SetDataDescriptor(Undefined::Instance(), true, true, D);
+                bindings_->DefineOwnProperty(e, N, &desc, true);
             }
 
             void SetMutableBinding(Error* e, const std::string& N, JSValue* V, bool S) override
@@ -4064,7 +5553,7 @@ namespace es
                 {
                     if(S)
                     {
-                        *e = *Error::ReferenceError(N + " is not defined");
+                        *e = Error::ReferenceError(N + " is not defined");
                         return nullptr;
                     }
                     else
@@ -4142,22 +5631,10 @@ namespace es
             static JSValue* eval(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
 
             // 15.1.2.2 parseInt (string , radix)
-            static JSValue* parseInt(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
-            {
-                (void)e;
-                (void)this_arg;
-                (void)vals;
-                assert(false);
-            }
+            static JSValue* parseInt(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
 
             // 15.1.2.3 parseFloat (string)
-            static JSValue* parseFloat(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
-            {
-                (void)e;
-                (void)this_arg;
-                (void)vals;
-                assert(false);
-            }
+            static JSValue* parseFloat(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
 
             // 15.1.2.4 isNaN (number)
             static JSValue* isNaN(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
@@ -4198,6 +5675,8 @@ namespace es
     };
 
     JSObject* ToObject(Error* e, JSValue* input);
+    // The [[Prototype]] of ToObject(input) for a primitive input.
+    JSObject* PrimitivePrototype(JSValue* input);
 
     class Reference : public JSValue
     {
@@ -4205,10 +5684,20 @@ namespace es
             JSValue* base_;
             std::string reference_name_;
             bool strict_reference_;
+            bool has_index_;
+            uint32_t index_;
+            Parsing::LHS::PropertyCache* cache_ = nullptr;
 
         public:
             Reference(JSValue* base, const std::string& reference_name, bool strict_reference)
-            : JSValue(JS_REF), base_(base), reference_name_(reference_name), strict_reference_(strict_reference)
+            : JSValue(JS_REF), base_(base), reference_name_(reference_name), strict_reference_(strict_reference), has_index_(false), index_(0)
+            {
+            }
+
+            // A reference to the array index property of base. The name is
+            // only built if something asks for it.
+            Reference(JSValue* base, uint32_t index, bool strict_reference)
+            : JSValue(JS_REF), base_(base), strict_reference_(strict_reference), has_index_(true), index_(index)
             {
             }
 
@@ -4216,14 +5705,35 @@ namespace es
             {
                 return base_;
             }
-            std::string GetReferencedName()
+            const std::string& GetReferencedName()
             {
+                if(has_index_ && reference_name_.empty())
+                {
+                    reference_name_ = NumberToString(index_);
+                }
                 return reference_name_;
             }
+            bool HasIndex()
+            {
+                return has_index_;
+            }
+            uint32_t Index()
+            {
+                return index_;
+            }
             bool IsStrictReference()
             {
                 return strict_reference_;
             }
+            // The cache of the property access the reference comes from, if any.
+            Parsing::LHS::PropertyCache* cache()
+            {
+                return cache_;
+            }
+            void SetCache(Parsing::LHS::PropertyCache* cache)
+            {
+                cache_ = cache;
+            }
             bool HasPrimitiveBase()
             {
                 return base_->IsBool() || base_->IsString() || base_->IsNumber();
@@ -4244,56 +5754,123 @@ namespace es
 
     };
 
-    inline JSValue* GetValue(Error* e, JSValue* V)
+    // The value of the property in slot, read from the receiver this_value.
+    // slot is nullptr if there is no such property.
+    inline JSValue* GetSlotValue(Error* e, PropertySlot* slot, JSValue* this_value)
     {
-        if(!V->IsReference())
+        if(slot == nullptr)
         {
-            return V;
+            return Undefined::Instance();
         }
-        Reference* ref = static_cast<Reference*>(V);
-        if(ref->IsUnresolvableReference())
+        if(!slot->IsAccessor())
         {
-            *e = *Error::ReferenceError(ref->GetReferencedName() + " is not defined");
-            return nullptr;
+            return slot->Value();
         }
-        JSValue* base = ref->GetBase();
-        if(ref->IsPropertyReference())
-        {// 4
-            // 4.a & 4.b
+        JSValue* getter = slot->Getter();
+        if(getter->IsUndefined())
+        {
+            return Undefined::Instance();
+        }
+        JSObject* getter_obj = static_cast<JSObject*>(getter);
+        return getter_obj->Call(e, this_value, {});
+    }
+
+    // Finds the slot of P on the prototype chain from proto, for a receiver
+    // which has no own property P. While the validity cell of the chain holds,
+    // the cache of the property access answers without walking the chain.
+    // Returns false if the chain can not be cached.
+    inline bool LookupPrototypeChain(Parsing::LHS::PropertyCache* cache, JSValue* proto, const std::string& P,
+                                     PropertySlot** holder)
+    {
+        if(cache->prototype == proto && cache->cell->valid)
+        {
+            *holder = cache->slot;
+            return true;
+        }
+        if(proto->IsNull())
+        {
+            return false;
+        }
+        PropertySlot* slot = nullptr;
+        for(JSValue* obj = proto; slot == nullptr && !obj->IsNull(); obj = static_cast<JSObject*>(obj)->Prototype())
+        {
+            // Property access names are never array indices,
+            // so only objects that store other names elsewhere are in the way.
+            if(!static_cast<JSObject*>(obj)->EnumeratesNamedPropertiesOnly())
+            {
+                return false;
+            }
+            slot = static_cast<JSObject*>(obj)->FindNamedProperty(P);
+        }
+        cache->prototype = proto;
+        cache->cell = static_cast<JSObject*>(proto)->PrototypeValidityCell();
+        cache->slot = slot;
+        *holder = slot;
+        return true;
+    }
+
+    inline JSValue* GetValue(Error* e, JSValue* V)
+    {
+        if(!V->IsReference())
+        {
+            return V;
+        }
+        Reference* ref = static_cast<Reference*>(V);
+        if(ref->IsUnresolvableReference())
+        {
+            *e = Error::ReferenceError(ref->GetReferencedName() + " is not defined");
+            return nullptr;
+        }
+        JSValue* base = ref->GetBase();
+        if(ref->IsPropertyReference())
+        {// 4
+            // 4.a & 4.b
             if(!ref->HasPrimitiveBase())
             {
                 assert(base->IsObject());
                 JSObject* obj = static_cast<JSObject*>(base);
+                if(ref->HasIndex())
+                {
+                    return obj->GetByIndex(e, ref->Index());
+                }
+                if(ref->cache() != nullptr)
+                {
+                    const std::string& P = ref->GetReferencedName();
+                    PropertySlot own;
+                    PropertySlot* holder;
+                    if(obj->GetOwnPropertySlot(P, &own))
+                    {
+                        return GetSlotValue(e, &own, base);
+                    }
+                    if(LookupPrototypeChain(ref->cache(), obj->Prototype(), P, &holder))
+                    {
+                        return GetSlotValue(e, holder, base);
+                    }
+                }
                 return obj->Get(e, ref->GetReferencedName());
             }
             else
             {// special [[Get]]
+                const std::string& P = ref->GetReferencedName();
+                PropertySlot* holder;
+                // The object ToObject would create only owns the length and
+                // the characters of a string.
+                if(ref->cache() != nullptr && !(base->IsString() && P == "length") &&
+                   LookupPrototypeChain(ref->cache(), PrimitivePrototype(base), P, &holder))
+                {
+                    return GetSlotValue(e, holder, base);
+                }
                 JSObject* O = ToObject(e, base);
                 if(!e->IsOk())
                 {
                     return nullptr;
                 }
-                JSValue* tmp = O->GetProperty(ref->GetReferencedName());
-                if(tmp->IsUndefined())
+                PropertySlot slot;
+                if(!O->GetPropertySlot(P, &slot))
                 {
                     return Undefined::Instance();
                 }
-                PropertyDescriptor* desc = static_cast<PropertyDescriptor*>(tmp);
-                if(desc->IsDataDescriptor())
-                {
-                    return desc->Value();
-                }
-                else
-                {
-                    assert(desc->IsAccessorDescriptor());
-                    JSValue* getter = desc->Get();
-                    if(getter->IsUndefined())
-                    {
-                        return Undefined::Instance();
-                    }
-                    JSObject* getter_obj = static_cast<JSObject*>(getter);
-                    return getter_obj->Call(e, base, {});
-                }
+                return GetSlotValue(e, &slot, base);
             }
         }
         else
@@ -4309,7 +5886,7 @@ namespace es
         //log::PrintSource("PutValue V: " + V->ToString() + ", W: " + W->ToString());
         if(!V->IsReference())
         {
-            *e = *Error::ReferenceError();
+            *e = Error::ReferenceError();
             return;
         }
         Reference* ref = static_cast<Reference*>(V);
@@ -4318,7 +5895,7 @@ namespace es
         {// 3
             if(ref->IsStrictReference())
             {// 3.a
-                *e = *Error::ReferenceError();
+                *e = Error::ReferenceError();
                 return;
             }
             GlobalObject::Instance()->Put(e, ref->GetReferencedName(), W, false);// 3.b
@@ -4326,44 +5903,46 @@ namespace es
         else if(ref->IsPropertyReference())
         {
             bool throw_flag = ref->IsStrictReference();
-            std::string P = ref->GetReferencedName();
             if(!ref->HasPrimitiveBase())
             {
                 assert(base->IsObject());
                 JSObject* base_obj = static_cast<JSObject*>(base);
-                base_obj->Put(e, P, W, throw_flag);
+                if(ref->HasIndex())
+                {
+                    base_obj->PutByIndex(e, ref->Index(), W, throw_flag);
+                    return;
+                }
+                base_obj->Put(e, ref->GetReferencedName(), W, throw_flag);
             }
             else
             {// special [[Put]]
+                const std::string& P = ref->GetReferencedName();
                 JSObject* O = ToObject(e, base);
                 if(!O->CanPut(P))
                 {// 2
                     if(throw_flag)
                     {
-                        *e = *Error::TypeError();
+                        *e = Error::TypeError();
                     }
                     return;
                 }
-                JSValue* tmp = O->GetOwnProperty(P);// 3
-                if(!tmp->IsUndefined())
+                PropertySlot slot;
+                if(O->GetOwnPropertySlot(P, &slot))// 3
                 {
-                    PropertyDescriptor* own_desc = static_cast<PropertyDescriptor*>(tmp);
-                    if(own_desc->IsDataDescriptor())
+                    if(!slot.IsAccessor())
                     {// 4
                         if(throw_flag)
                         {
-                            *e = *Error::TypeError();
+                            *e = Error::TypeError();
                         }
                         return;
                     }
                 }
-                tmp = O->GetProperty(P);
-                if(!tmp->IsUndefined())
+                if(O->GetPropertySlot(P, &slot))
                 {
-                    PropertyDescriptor* desc = static_cast<PropertyDescriptor*>(tmp);
-                    if(desc->IsAccessorDescriptor())
+                    if(slot.IsAccessor())
                     {// 4
-                        JSValue* setter = desc->Set();
+                        JSValue* setter = slot.Setter();
                         assert(!setter->IsUndefined());
                         JSObject* setter_obj = static_cast<JSObject*>(setter);
                         setter_obj->Call(e, base, { W });
@@ -4372,7 +5951,7 @@ namespace es
                     {// 7
                         if(throw_flag)
                         {
-                            *e = *Error::TypeError();
+                            *e = Error::TypeError();
                         }
                         return;
                     }
@@ -4442,6 +6021,15 @@ namespace es
                 return env_rec_;
             }
 
+            // Empties a declarative environment so that it can serve another
+            // call, see RuntimeContext::AcquireEnvironment.
+            void Reuse(JSValue* outer)
+            {
+                assert(outer->IsNull() || outer->IsLexicalEnvironment());
+                static_cast<DeclarativeEnvironmentRecord*>(env_rec_)->Clear();
+                outer_ = outer;
+            }
+
             std::string ToString() override
             {
                 return "LexicalEnvironment";
@@ -4455,13 +6043,14 @@ namespace es
             LexicalEnvironment* lexical_env_;
             JSValue* this_binding_;
             bool strict_;
-            std::stack<std::string> label_stack_;
-            size_t iteration_layers_;
+            // Whether variable_env_ goes back to the environment pool when the
+            // context is popped.
+            bool pooled_env_;
 
         public:
             ExecutionContext(LexicalEnvironment* variable_env, LexicalEnvironment* lexical_env, JSValue* this_binding, bool strict)
             : variable_env_(variable_env), lexical_env_(lexical_env), this_binding_(this_binding), strict_(strict),
-              iteration_layers_(0)
+              pooled_env_(false)
             {
             }
 
@@ -4487,45 +6076,13 @@ namespace es
                 lexical_env_ = lexical_env;
             }
 
-            bool HasLabel(const std::string& label)
-            {
-                if(label.empty())
-                {
-                    return true;
-                }
-                return (static_cast<unsigned int>(!label_stack_.empty()) != 0u) && label_stack_.top() == label;
-            }
-
-            void AddLabel(const std::string& label)
-            {
-                assert(!HasLabel(label));
-                label_stack_.push(label);
-            }
-
-            void RemoveLabel(const std::string& label)
-            {
-                if(label.empty())
-                {
-                    return;
-                }
-                assert(HasLabel(label));
-                label_stack_.pop();
-            }
-
-            void EnterIteration()
-            {
-                iteration_layers_++;
-            }
-            void ExitIteration()
+            bool pooled_env()
             {
-                if(iteration_layers_ != 0)
-                {
-                    iteration_layers_--;
-                }
+                return pooled_env_;
             }
-            bool InIteration()
+            void SetPooledEnv()
             {
-                return iteration_layers_ != 0;
+                pooled_env_ = true;
             }
 
 
@@ -4533,16 +6090,31 @@ namespace es
 
     class RuntimeContext
     {
+        public:
+            static constexpr size_t kDefaultMaxStackDepth = 3000;
+
         private:
-            std::stack<ExecutionContext*> context_stack_;
+            // The VM stack. Frames are stored contiguously and the storage is
+            // reserved up front, so pushing and popping a frame never
+            // allocates and the pointers returned by AddContext stay valid.
+            std::vector<ExecutionContext> context_stack_;
+            size_t max_stack_depth_;
             ExecutionContext* global_env_;
+            // Environments of finished calls that could not have been
+            // captured, ready to be handed to the next call.
+            std::vector<LexicalEnvironment*> env_pool_;
+            // Argument lists of the calls being evaluated, innermost last. The
+            // vectors keep their capacity, see ArgumentsGuard.
+            std::deque<std::vector<JSValue*>> arg_stack_;
+            size_t arg_depth_;
             // This is to make sure builtin function like `array.push()`
             // can visit `array`.
             std::stack<JSValue*> value_stack_;
 
         private:
-            RuntimeContext()
+            RuntimeContext() : max_stack_depth_(kDefaultMaxStackDepth), global_env_(nullptr), arg_depth_(0)
             {
+                context_stack_.reserve(max_stack_depth_);
                 value_stack_.push(Null::Instance());
             }
 
@@ -4553,18 +6125,42 @@ namespace es
                 return &singleton;
             }
 
-            void AddContext(ExecutionContext* context)
+            // Must be called before any code runs.
+            void SetMaxStackDepth(size_t depth)
+            {
+                assert(context_stack_.empty());
+                assert(depth > 0);
+                max_stack_depth_ = depth;
+                context_stack_ = std::vector<ExecutionContext>();
+                context_stack_.reserve(max_stack_depth_);
+            }
+
+            size_t max_stack_depth()
+            {
+                return max_stack_depth_;
+            }
+
+            // Pushes a new frame, or throws a RangeError once the stack holds
+            // max_stack_depth() frames, before the native stack overflows.
+            ExecutionContext* AddContext(Error* e, LexicalEnvironment* variable_env, LexicalEnvironment* lexical_env, JSValue* this_binding, bool strict)
             {
-                context_stack_.push(context);
+                if(context_stack_.size() == max_stack_depth_)
+                {
+                    *e = Error::RangeError("Maximum call stack size exceeded");
+                    return nullptr;
+                }
+                context_stack_.emplace_back(variable_env, lexical_env, this_binding, strict);
+                ExecutionContext* context = &context_stack_.back();
                 if(context_stack_.size() == 1)
                 {
                     global_env_ = context;
                 }
+                return context;
             }
 
             static ExecutionContext* TopContext()
             {
-                return RuntimeContext::Global()->context_stack_.top();
+                return &RuntimeContext::Global()->context_stack_.back();
             }
 
             static LexicalEnvironment* TopLexicalEnv()
@@ -4574,9 +6170,50 @@ namespace es
 
             void PopContext()
             {
-                ExecutionContext* top = context_stack_.top();
-                context_stack_.pop();
-                delete top;
+                ExecutionContext& top = context_stack_.back();
+                if(top.pooled_env())
+                {
+                    ReleaseEnvironment(top.variable_env());
+                }
+                context_stack_.pop_back();
+            }
+
+            void ReleaseEnvironment(LexicalEnvironment* env)
+            {
+                env_pool_.emplace_back(env);
+            }
+
+            // Returns an empty declarative environment for a call whose
+            // bindings cannot outlive it, i.e. a body without inner functions,
+            // arguments or eval. The environment is reclaimed by PopContext
+            // once the context is marked with SetPooledEnv.
+            LexicalEnvironment* AcquireEnvironment(JSValue* outer)
+            {
+                if(env_pool_.empty())
+                {
+                    return LexicalEnvironment::NewDeclarativeEnvironment(outer);
+                }
+                LexicalEnvironment* env = env_pool_.back();
+                env_pool_.pop_back();
+                env->Reuse(outer);
+                return env;
+            }
+
+            std::vector<JSValue*>& AddArguments()
+            {
+                if(arg_depth_ == arg_stack_.size())
+                {
+                    arg_stack_.emplace_back();
+                }
+                std::vector<JSValue*>& args = arg_stack_[arg_depth_++];
+                args.clear();
+                return args;
+            }
+
+            void PopArguments()
+            {
+                assert(arg_depth_ > 0);
+                arg_depth_--;
             }
 
             static JSValue* TopValue()
@@ -4625,6 +6262,29 @@ namespace es
             }
     };
 
+    // Holds the argument list of a call for the duration of the call. The
+    // list lives on the argument stack of the RuntimeContext, so evaluating a
+    // call does not allocate once the stack is warm.
+    class ArgumentsGuard
+    {
+        private:
+            std::vector<JSValue*>& values_;
+
+        public:
+            ArgumentsGuard() : values_(RuntimeContext::Global()->AddArguments())
+            {
+            }
+            ~ArgumentsGuard()
+            {
+                RuntimeContext::Global()->PopArguments();
+            }
+
+            std::vector<JSValue*>& values()
+            {
+                return values_;
+            }
+    };
+
     // TODO(zhuzilin) move this method to a better place
     inline JSValue* JSObject::DefaultValue(Error* e, const std::string& hint)
     {
@@ -4684,12 +6344,13 @@ namespace es
                 return val;
             }
         }
-        *e = *Error::TypeError("failed to get [[DefaultValue]]");
+        *e = Error::TypeError("failed to get [[DefaultValue]]");
         return nullptr;
     }
 
     std::string ToString(Error* e, JSValue* input);
     PropertyDescriptor* ToPropertyDescriptor(Error* e, JSValue* val);
+    JSValue* FromPropertyDescriptor(Error* e, JSValue* value);
 
     class ObjectProto : public JSObject
     {
@@ -4835,7 +6496,7 @@ namespace es
                 (void)this_arg;
                 if(vals.empty() || !vals[0]->IsObject())
                 {
-                    *e = *Error::TypeError();
+                    *e = Error::TypeError();
                     return nullptr;
                 }
                 return static_cast<JSObject*>(vals[0])->Prototype();
@@ -4844,10 +6505,20 @@ namespace es
             // 15.2.3.3 Object.getOwnPropertyDescriptor ( O, P )
             static JSValue* getOwnPropertyDescriptor(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
             {
-                (void)e;
                 (void)this_arg;
-                (void)vals;
-                assert(false);
+                if(vals.empty() || !vals[0]->IsObject())
+                {// 1
+                    *e = Error::TypeError("Object.getOwnPropertyDescriptor called on non-object");
+                    return nullptr;
+                }
+                JSObject* O = static_cast<JSObject*>(vals[0]);
+                std::string name = ::es::ToString(e, vals.size() < 2 ? Undefined::Instance() : vals[1]);// 2
+                if(!e->IsOk())
+                {
+                    return nullptr;
+                }
+                JSValue* desc = O->GetOwnProperty(name);// 3
+                return FromPropertyDescriptor(e, desc);// 4
             }
 
             static JSValue* getOwnPropertyNames(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
@@ -4863,7 +6534,7 @@ namespace es
                 Object* obj;
                 if(vals.empty() || (!vals[0]->IsObject() && !vals[0]->IsNull()))
                 {
-                    *e = *Error::TypeError("Object.create called on non-object");
+                    *e = Error::TypeError("Object.create called on non-object");
                     return nullptr;
                 }
                 obj = new Object();
@@ -4887,13 +6558,13 @@ namespace es
                 (void)this_arg;
                 if(vals.empty() || !vals[0]->IsObject())
                 {
-                    *e = *Error::TypeError("Object.defineProperty called on non-object");
+                    *e = Error::TypeError("Object.defineProperty called on non-object");
                     return nullptr;
                 }
                 O = static_cast<JSObject*>(vals[0]);
                 if(vals.size() < 2)
                 {
-                    *e = *Error::TypeError("Object.defineProperty need 3 arguments");
+                    *e = Error::TypeError("Object.defineProperty need 3 arguments");
                     return nullptr;
                 }
                 name = ::es::ToString(e, vals[1]);
@@ -4940,7 +6611,7 @@ namespace es
                 (void)this_arg;
                 if(vals.empty() || !vals[0]->IsObject())
                 {
-                    *e = *Error::TypeError("Object.preventExtensions called on non-object");
+                    *e = Error::TypeError("Object.preventExtensions called on non-object");
                     return nullptr;
                 }
                 obj = static_cast<JSObject*>(vals[0]);
@@ -4970,7 +6641,7 @@ namespace es
                 (void)this_arg;
                 if(vals.empty() || !vals[0]->IsObject())
                 {
-                    *e = *Error::TypeError("Object.isExtensible called on non-object");
+                    *e = Error::TypeError("Object.isExtensible called on non-object");
                     return nullptr;
                 }
                 obj = static_cast<JSObject*>(vals[0]);
@@ -4985,7 +6656,7 @@ namespace es
                 (void)this_arg;
                 if(vals.size() < 2)
                 {
-                    *e = *Error::TypeError("Object.preventExtensions need 2 arguments");
+                    *e = Error::TypeError("Object.preventExtensions need 2 arguments");
                     return nullptr;
                 }
                 vals[0]->CheckObjectCoercible(e);
@@ -4995,7 +6666,7 @@ namespace es
                 }
                 if(!(vals[1]->IsNull() || vals[1]->IsObject()))
                 {
-                    *e = *Error::TypeError("");
+                    *e = Error::TypeError("");
                     return nullptr;
                 }
                 if(!vals[0]->IsObject())
@@ -5070,7 +6741,7 @@ namespace es
 
         PropertyDescriptor* enumerable_desc = new PropertyDescriptor();
         enumerable_desc->SetDataDescriptor(Bool::Wrap(desc->Enumerable()), true, true, true);
-        obj->DefineOwnProperty(e, "get", enumerable_desc, false);
+        obj->DefineOwnProperty(e, "enumerable", enumerable_desc, false);
         if(!e->IsOk())
         {
             return nullptr;
@@ -5078,7 +6749,7 @@ namespace es
 
         PropertyDescriptor* configurable_desc = new PropertyDescriptor();
         configurable_desc->SetDataDescriptor(Bool::Wrap(desc->Configurable()), true, true, true);
-        obj->DefineOwnProperty(e, "set", configurable_desc, false);
+        obj->DefineOwnProperty(e, "configurable", configurable_desc, false);
         if(!e->IsOk())
         {
             return nullptr;
@@ -5091,7 +6762,7 @@ namespace es
     {
         if(!val->IsObject())
         {
-            *e = *Error::TypeError();
+            *e = Error::TypeError();
             return nullptr;
         }
         JSObject* obj = static_cast<JSObject*>(val);
@@ -5121,7 +6792,7 @@ namespace es
             JSValue* value = obj->Get(e, "get");
             if(!value->IsCallable() && !value->IsUndefined())
             {
-                *e = *Error::TypeError("getter not callable.");
+                *e = Error::TypeError("getter not callable.");
             }
             desc->SetGet(value);
         }
@@ -5130,7 +6801,7 @@ namespace es
             JSValue* value = obj->Get(e, "set");
             if(!value->IsCallable() && !value->IsUndefined())
             {
-                *e = *Error::TypeError("setter not callable.");
+                *e = Error::TypeError("setter not callable.");
             }
             desc->SetSet(value);
         }
@@ -5138,7 +6809,7 @@ namespace es
         {
             if(desc->HasValue() || desc->HasWritable())
             {
-                *e = *Error::TypeError("cannot have both get/set and value/writable");
+                *e = Error::TypeError("cannot have both get/set and value/writable");
                 return nullptr;
             }
         }
@@ -5179,34 +6850,61 @@ namespace es
     class ErrorObject : public JSObject
     {
         private:
-            Error* e_;
+            Error e_;
 
         public:
-            ErrorObject(Error* e) : JSObject(OBJ_ERROR, "Error", true, nullptr, false, false), e_(e)
+            ErrorObject(const Error& e) : JSObject(OBJ_ERROR, "Error", true, nullptr, false, false), e_(e)
             {
                 SetPrototype(ErrorProto::Instance());
-                AddValueProperty("message", new String(e->message()), true, false, false);
+                AddValueProperty("message", new String(e_.message()), true, false, false);
+            }
+            ErrorObject(Error* e) : ErrorObject(*e)
+            {
             }
 
             Error* e()
             {
-                return e_;
+                return &e_;
             }
             Error::Type ErrorType()
             {
-                return e_->type();
+                return e_.type();
             }
-            std::string ErrorMessage()
+            const std::string& ErrorMessage()
             {
-                return e_->message();
+                return e_.message();
             }
 
             std::string ToString()
             {
-                return log::ToString(e_->message());
+                return log::ToString(e_.message());
             }
     };
 
+    // An error that carries a thrown value across native frames, such as
+    // FunctionObject::Call, without converting it. The catch clause then
+    // receives the very value that was thrown, and no message is built.
+    inline Error Error::Throw(JSValue* value)
+    {
+        Error e(E_NATIVE);
+        if(value->IsObject() && static_cast<JSObject*>(value)->obj_type() == JSObject::OBJ_ERROR)
+        {
+            e.m_type = static_cast<ErrorObject*>(value)->ErrorType();
+        }
+        e.m_value = value;
+        return e;
+    }
+
+    // The value a throw completion carries for the error e.
+    inline JSValue* ThrownValue(Error* e)
+    {
+        if(e->value() != nullptr)
+        {
+            return e->value();
+        }
+        return new ErrorObject(e);
+    }
+
     class ErrorConstructor : public JSObject
     {
         public:
@@ -5267,13 +6965,15 @@ namespace es
 
         Type type;
         JSValue* value;
-        std::string target;
+        // Id of the statement a break or continue jumps to, as
+        // resolved by the parser. 0 for any other completion.
+        size_t target;
 
-        Completion() : Completion(NORMAL, nullptr, "")
+        Completion() : Completion(NORMAL, nullptr)
         {
         }
 
-        Completion(Type type, JSValue* value, const std::string& target) : type(type), value(value), target(target)
+        Completion(Type type, JSValue* value, size_t target = 0) : type(type), value(value), target(target)
         {
         }
 
@@ -5288,7 +6988,6 @@ namespace es
     };
 
     double ToNumber(Error* e, JSValue* input);
-    std::string NumberToString(double m);
     Completion EvalProgram(Parsing::AST* ast);
 
     class FunctionProto : public JSObject
@@ -5323,13 +7022,13 @@ namespace es
                 val = RuntimeContext::TopValue();
                 if(!val->IsObject())
                 {
-                    *e = *Error::TypeError("Function.prototype.apply called on non-object");
+                    *e = Error::TypeError("Function.prototype.apply called on non-object");
                     return nullptr;
                 }
                 JSObject* func = static_cast<JSObject*>(val);
                 if(!func->IsCallable())
                 {
-                    *e = *Error::TypeError("Function.prototype.apply called on non-callable");
+                    *e = Error::TypeError("Function.prototype.apply called on non-callable");
                     return nullptr;
                 }
                 if(vals.empty())
@@ -5342,7 +7041,7 @@ namespace es
                 }
                 if(!vals[1]->IsObject())
                 {// 3
-                    *e = *Error::TypeError("Function.prototype.apply's argument is non-object");
+                    *e = Error::TypeError("Function.prototype.apply's argument is non-object");
                     return nullptr;
                 }
                 JSObject* arg_array = static_cast<JSObject*>(vals[1]);
@@ -5378,13 +7077,13 @@ namespace es
                 JSValue* val = RuntimeContext::TopValue();
                 if(!val->IsObject())
                 {
-                    *e = *Error::TypeError("Function.prototype.call called on non-object");
+                    *e = Error::TypeError("Function.prototype.call called on non-object");
                     return nullptr;
                 }
                 JSObject* func = static_cast<JSObject*>(val);
                 if(!func->IsCallable())
                 {
-                    *e = *Error::TypeError("Function.prototype.call called on non-callable");
+                    *e = Error::TypeError("Function.prototype.call called on non-callable");
                     return nullptr;
                 }
                 if(static_cast<unsigned int>(!vals.empty()) != 0u)
@@ -5446,7 +7145,7 @@ namespace es
             {
                 return scope_;
             };
-            virtual std::vector<std::string> FormalParameters()
+            virtual const std::vector<std::string>& FormalParameters()
             {
                 return formal_params_;
             };
@@ -5485,20 +7184,8 @@ namespace es
                     case Completion::RETURNING:
                         return result.value;
                     case Completion::THROWING:
-                    {
-                        std::string message = ::es::ToString(e, result.value);
-                        if(result.value->IsObject())
-                        {
-                            JSObject* obj = static_cast<JSObject*>(result.value);
-                            if(obj->obj_type() == JSObject::OBJ_ERROR)
-                            {
-                                *e = *(static_cast<ErrorObject*>(obj)->e());
-                                return nullptr;
-                            }
-                        }
-                        *e = *Error::NativeError(message);
+                        *e = Error::Throw(result.value);
                         return nullptr;
-                    }
                     default:
                         assert(result.type == Completion::NORMAL);
                         return Undefined::Instance();
@@ -5549,7 +7236,7 @@ namespace es
                 }
                 if(!O->IsObject())
                 {
-                    *e = *Error::TypeError();
+                    *e = Error::TypeError();
                     return false;
                 }
                 while(!V->IsNull())
@@ -5585,7 +7272,7 @@ namespace es
                             FunctionObject* v_func = static_cast<FunctionObject*>(v);
                             if(v_func->strict())
                             {
-                                *e = *Error::TypeError();
+                                *e = Error::TypeError();
                                 return nullptr;
                             }
                         }
@@ -5631,7 +7318,7 @@ namespace es
                 assert(false);
             };
 
-            std::vector<std::string> FormalParameters() override
+            const std::vector<std::string>& FormalParameters() override
             {
                 assert(false);
             };
@@ -5672,7 +7359,7 @@ namespace es
             {
                 if(!target_function_->IsConstructor())
                 {
-                    *e = *Error::TypeError("target function has no [[Construct]] internal method");
+                    *e = Error::TypeError("target function has no [[Construct]] internal method");
                     return nullptr;
                 }
                 std::vector<JSValue*> args;
@@ -5688,6 +7375,130 @@ namespace es
             }
     };
 
+    // Templating code calls eval and new Function in loops with
+    // a handful of distinct source strings. CodeCache keeps the parsed code of
+    // the most recently used ones so that each is parsed once. Parsing does not
+    // depend on the strictness or the scope of the caller, which are applied
+    // when the code is entered, so the key is the kind of code and its source.
+    // Code that fails to parse is not kept, and is parsed again on every call.
+    class CodeCache
+    {
+        public:
+            enum Kind
+            {
+                EVAL_CODE,
+                FUNCTION_CODE,
+            };
+
+            struct Entry
+            {
+                Parsing::AST* ast;
+                // The formal parameters of FUNCTION_CODE.
+                std::vector<std::string> params;
+            };
+
+            static constexpr size_t kDefaultCapacity = 64;
+            // Longer sources are not kept, which bounds the cache to capacity
+            // entries of at most this many bytes of source.
+            static constexpr size_t kMaxSourceSize = 64 * 1024;
+
+            static CodeCache* Global()
+            {
+                static CodeCache singleton;
+                return &singleton;
+            }
+
+            // Returns the entry of (kind, source) and marks it as the most
+            // recently used, or nullptr.
+            const Entry* Find(Kind kind, const std::string& source)
+            {
+                auto& index = index_[kind];
+                auto it = index.find(source);
+                if(it == index.end())
+                {
+                    misses_++;
+                    return nullptr;
+                }
+                hits_++;
+                lru_.splice(lru_.begin(), lru_, it->second.lru);
+                return &it->second.entry;
+            }
+
+            void Insert(Kind kind, const std::string& source, const Entry& entry)
+            {
+                if(capacity_ == 0 || source.size() > kMaxSourceSize)
+                {
+                    return;
+                }
+                auto result = index_[kind].emplace(source, Slot{ entry, {} });
+                if(!result.second)
+                {
+                    return;
+                }
+                lru_.emplace_front(kind, &result.first->first);
+                result.first->second.lru = lru_.begin();
+                Shrink();
+            }
+
+            // 0 disables the cache.
+            void SetCapacity(size_t capacity)
+            {
+                capacity_ = capacity;
+                Shrink();
+            }
+
+            size_t size()
+            {
+                return lru_.size();
+            }
+            size_t hits()
+            {
+                return hits_;
+            }
+            size_t misses()
+            {
+                return misses_;
+            }
+            size_t evictions()
+            {
+                return evictions_;
+            }
+
+        private:
+            using LRUList = std::list<std::pair<Kind, const std::string*>>;
+
+            struct Slot
+            {
+                Entry entry;
+                LRUList::iterator lru;
+            };
+
+            CodeCache() : capacity_(kDefaultCapacity), hits_(0), misses_(0), evictions_(0)
+            {
+            }
+
+            // The evicted code is not deleted, as functions
+            // created by it may still refer to it.
+            void Shrink()
+            {
+                while(lru_.size() > capacity_)
+                {
+                    auto& index = index_[lru_.back().first];
+                    index.erase(index.find(*lru_.back().second));
+                    lru_.pop_back();
+                    evictions_++;
+                }
+            }
+
+            size_t capacity_;
+            // Most recently used first. The keys point into index_.
+            LRUList lru_;
+            std::unordered_map<std::string, Slot> index_[2];
+            size_t hits_;
+            size_t misses_;
+            size_t evictions_;
+    };
+
     class FunctionConstructor : public JSObject
     {
         public:
@@ -5742,24 +7553,37 @@ namespace es
                 }
                 std::vector<std::string> names;
                 Parsing::AST* body_ast;
-                if(!P.empty())
+                // The length of P tells where the parameters end.
+                std::string key = std::to_string(P.size()) + ":" + P + body;
+                const CodeCache::Entry* cached = CodeCache::Global()->Find(CodeCache::FUNCTION_CODE, key);
+                if(cached != nullptr)
                 {
-                    Parsing::Parser parser(P);
-                    names = parser.ParseFormalParameterList();
-                    if(names.empty())
-                    {
-                        *e = *Error::SyntaxError("invalid parameter name");
-                        return nullptr;
-                    }
+                    names = cached->params;
+                    body_ast = cached->ast;
                 }
+                else
                 {
-                    Parsing::Parser parser(body);
-                    body_ast = parser.ParseFunctionBody(Parsing::Token::TK_EOS);
-                    if(body_ast->IsIllegal())
+                    if(!P.empty())
                     {
-                        *e = *Error::SyntaxError("failed to parse function body: " + body_ast->source());
-                        return nullptr;
+                        Parsing::Parser parser(P);
+                        names = parser.ParseFormalParameterList();
+                        if(names.empty())
+                        {
+                            *e = Error::SyntaxError("invalid parameter name");
+                            return nullptr;
+                        }
+                    }
+                    {
+                        Parsing::Parser parser(body);
+                        body_ast = parser.ParseFunctionBody(Parsing::Token::TK_EOS);
+                        if(body_ast->IsIllegal())
+                        {
+                            *e = Error::SyntaxError("failed to parse function body: " + body_ast->source());
+                            return nullptr;
+                        }
                     }
+                    static_cast<Parsing::ProgramOrFunctionBody*>(body_ast)->SetParameters(names);
+                    CodeCache::Global()->Insert(CodeCache::FUNCTION_CODE, key, { body_ast, names });
                 }
                 LexicalEnvironment* scope = LexicalEnvironment::Global();
                 bool strict = static_cast<Parsing::ProgramOrFunctionBody*>(body_ast)->strict();
@@ -5768,14 +7592,14 @@ namespace es
                     // 13.1
                     if(HaveDuplicate(names))
                     {
-                        *e = *Error::SyntaxError();
+                        *e = Error::SyntaxError();
                         return nullptr;
                     }
                     for(const auto& name : names)
                     {
                         if(name == "eval" || name == "arguments")
                         {
-                            *e = *Error::SyntaxError();
+                            *e = Error::SyntaxError();
                             return nullptr;
                         }
                     }
@@ -5807,18 +7631,18 @@ namespace es
         val = RuntimeContext::TopValue();
         if(!val->IsObject())
         {
-            *e = *Error::TypeError("Function.prototype.toString called on non-object");
+            *e = Error::TypeError("Function.prototype.toString called on non-object");
             return nullptr;
         }
         obj = static_cast<JSObject*>(val);
         if(obj->obj_type() != JSObject::OBJ_FUNC)
         {
-            *e = *Error::TypeError("Function.prototype.toString called on non-function");
+            *e = Error::TypeError("Function.prototype.toString called on non-function");
             return nullptr;
         }
         func = static_cast<FunctionObject*>(obj);
         std::string str = "function (";
-        auto params = func->FormalParameters();
+        const auto& params = func->FormalParameters();
         if(!params.empty())
         {
             str += params[0];
@@ -5845,7 +7669,7 @@ namespace es
         val = RuntimeContext::TopValue();
         if(!val->IsCallable())
         {
-            *e = *Error::TypeError("Function.prototype.call called on non-callable");
+            *e = Error::TypeError("Function.prototype.call called on non-callable");
             return nullptr;
         }
         target = static_cast<JSObject*>(val);
@@ -5889,20 +7713,20 @@ namespace es
             // 13.1
             if(HaveDuplicate(func_ast->params()))
             {
-                *e = *Error::SyntaxError();
+                *e = Error::SyntaxError();
                 return nullptr;
             }
             for(const auto& name : func_ast->params())
             {
                 if(name == "eval" || name == "arguments")
                 {
-                    *e = *Error::SyntaxError();
+                    *e = Error::SyntaxError();
                     return nullptr;
                 }
             }
             if(func_ast->name() == "eval" || func_ast->name() == "arguments")
             {
-                *e = *Error::SyntaxError();
+                *e = Error::SyntaxError();
                 return nullptr;
             }
         }
@@ -5929,14 +7753,14 @@ namespace es
                 // 13.1
                 if(HaveDuplicate(func_ast->params()))
                 {
-                    *e = *Error::SyntaxError();
+                    *e = Error::SyntaxError();
                     return nullptr;
                 }
                 for(const auto& name : func_ast->params())
                 {
                     if(name == "eval" || name == "arguments")
                     {
-                        *e = *Error::SyntaxError();
+                        *e = Error::SyntaxError();
                         return nullptr;
                     }
                 }
@@ -5997,7 +7821,7 @@ namespace es
                 {
                     return val;
                 }
-                *e = *Error::TypeError("Number.prototype.valueOf called with non-number");
+                *e = Error::TypeError("Number.prototype.valueOf called with non-number");
                 return nullptr;
             }
 
@@ -6229,13 +8053,13 @@ namespace es
             JSValue* val = RuntimeContext::TopValue();
             if(!val->IsObject())
             {
-                *e = *Error::TypeError("String.prototype.toString called with non-object");
+                *e = Error::TypeError("String.prototype.toString called with non-object");
                 return nullptr;
             }
             JSObject* obj = static_cast<JSObject*>(val);
             if(obj->obj_type() != JSObject::OBJ_STRING)
             {
-                *e = *Error::TypeError("String.prototype.toString called with non-string");
+                *e = Error::TypeError("String.prototype.toString called with non-string");
                 return nullptr;
             }
             return obj->PrimitiveValue();
@@ -6248,13 +8072,13 @@ namespace es
             JSValue* val = RuntimeContext::TopValue();
             if(!val->IsObject())
             {
-                *e = *Error::TypeError("String.prototype.valueOf called with non-object");
+                *e = Error::TypeError("String.prototype.valueOf called with non-object");
                 return nullptr;
             }
             JSObject* obj = static_cast<JSObject*>(val);
             if(obj->obj_type() != JSObject::OBJ_STRING)
             {
-                *e = *Error::TypeError("String.prototype.valueOf called with non-string");
+                *e = Error::TypeError("String.prototype.valueOf called with non-string");
                 return nullptr;
             }
             return obj->PrimitiveValue();
@@ -6335,18 +8159,22 @@ namespace es
             {
                 return nullptr;
             }
-            std::string R = S;
-            std::vector<JSValue*> args = vals;
-            for(auto arg : args)
+            StringBuilder R;
+            R.Append(std::move(S));
+            for(auto arg : vals)
             {
-                std::string next = ::es::ToString(e, arg);
+                if(arg->IsString())
+                {
+                    R.Append(static_cast<String*>(arg)->view());
+                    continue;
+                }
+                R.Append(::es::ToString(e, arg));
                 if(!e->IsOk())
                 {
                     return nullptr;
                 }
-                R += next;
             }
-            return new String(R);
+            return new String(R.Build());
         }
 
         static JSValue* indexOf(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
@@ -6390,9 +8218,9 @@ namespace es
                     return nullptr;
                 }
             }
-            int start = fmin(fmax(pos, 0), S.size());
-            size_t find_pos = S.find(search_str, start);
-            if(find_pos != std::string::npos)
+            size_t start = fmin(fmax(pos, 0), S.size());
+            size_t find_pos = search::Find(S, search_str, start);
+            if(find_pos != search::npos)
             {
                 return new Number(find_pos);
             }
@@ -6440,7 +8268,7 @@ namespace es
                     return nullptr;
                 }
             }
-            int start;
+            size_t start;
             if(isnan(pos))
             {
                 start = S.size();
@@ -6449,8 +8277,8 @@ namespace es
             {
                 start = fmin(fmax(pos, 0), S.size());
             }
-            size_t find_pos = S.rfind(search_str, start);
-            if(find_pos != std::string::npos)
+            size_t find_pos = search::FindLast(S, search_str, start);
+            if(find_pos != search::npos)
             {
                 return new Number(find_pos);
             }
@@ -6473,13 +8301,8 @@ namespace es
             assert(false);
         }
 
-        static JSValue* replace(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
-        {
-            (void)e;
-            (void)this_arg;
-            (void)vals;
-            assert(false);
-        }
+        // 15.5.4.11 String.prototype.replace (searchValue, replaceValue)
+        static JSValue* replace(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
 
         static JSValue* search(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
         {
@@ -6497,13 +8320,8 @@ namespace es
             assert(false);
         }
 
-        static JSValue* split(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
-        {
-            (void)e;
-            (void)this_arg;
-            (void)vals;
-            assert(false);
-        }
+        // 15.5.4.14 String.prototype.split (separator, limit)
+        static JSValue* split(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
 
         static JSValue* substring(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
         {
@@ -6612,28 +8430,27 @@ namespace es
             AddValueProperty("length", new Number(length), false, false, false);
         }
 
-        JSValue* GetOwnProperty(const std::string& P) override
+        bool GetOwnPropertySlot(const std::string& P, PropertySlot* slot) override
         {
-            JSValue* val = JSObject::GetOwnProperty(P);
-            if(!val->IsUndefined())
+            if(JSObject::GetOwnPropertySlot(P, slot))
             {
-                return val;
+                return true;
             }
-            Error* e = Error::Ok();
+            Error error;
+            Error* e = &error;
             int index = ToInteger(e, new String(P));// this will never has error.
             if(NumberToString(fabs(index)) != P)
             {
-                return Undefined::Instance();
+                return false;
             }
-            std::string str = static_cast<String*>(PrimitiveValue())->data();
+            const std::string& str = static_cast<String*>(PrimitiveValue())->data();
             int len = str.size();
             if(len <= index)
             {
-                return Undefined::Instance();
+                return false;
             }
-            PropertyDescriptor* desc = new PropertyDescriptor();
-            desc->SetDataDescriptor(new String(str.substr(index, 1)), true, false, false);
-            return desc;
+            *slot = PropertySlot(new String(str.substr(index, 1)), true, false, false);
+            return true;
         }
     };
 
@@ -6706,24 +8523,54 @@ namespace es
 
     double StringToNumber(const std::string& source);
 
-    inline bool IsArrayIndex(const std::string& P)
-    {
-        return P == NumberToString(uint32_t(StringToNumber(P)));
-    }
+    bool StrictEqual(Error* e, JSValue* x, JSValue* y);
 
-    class ArrayProto : public JSObject
+    // 15.4 A property name P is an array index if and only if
+    // ToString(ToUint32(P)) is equal to P and ToUint32(P) is not equal to 2^32-1.
+    // This is on the path of every element access, so parse the
+    // digits directly instead of round tripping through StringToNumber and NumberToString.
+    inline bool ToArrayIndex(const std::string& P, uint32_t* index)
     {
-    public:
-        static ArrayProto* Instance()
+        size_t n = P.size();
+        uint64_t value = 0;
+        if(n == 0 || n > 10)
         {
-            static ArrayProto singleton;
-            return &singleton;
+            return false;
         }
-
-        // 15.4.4.2 Array.prototype.toString ( )
-        static JSValue* toString(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+        if(P[0] == u'0')
         {
-            (void)this_arg;
+            *index = 0;
+            return n == 1;
+        }
+        for(char c : P)
+        {
+            if(c < u'0' || c > u'9')
+            {
+                return false;
+            }
+            value = value * 10 + (c - u'0');
+        }
+        if(value >= 4294967295ull)
+        {
+            return false;
+        }
+        *index = uint32_t(value);
+        return true;
+    }
+
+    class ArrayProto : public JSObject
+    {
+    public:
+        static ArrayProto* Instance()
+        {
+            static ArrayProto singleton;
+            return &singleton;
+        }
+
+        // 15.4.4.2 Array.prototype.toString ( )
+        static JSValue* toString(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+        {
+            (void)this_arg;
             JSObject* array = ToObject(e, RuntimeContext::TopValue());
             JSValue* func = array->Get(e, "join");
             if(!e->IsOk())
@@ -6749,141 +8596,51 @@ namespace es
             assert(false);
         }
 
-        static JSValue* concat(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
-        {
-            (void)e;
-            (void)this_arg;
-            (void)vals;
-            assert(false);
-        }
-
-        static JSValue* join(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
-        {
-            (void)this_arg;
-            JSObject* O = ToObject(e, RuntimeContext::TopValue());
-            Number* len_val = static_cast<Number*>(O->Get(e, "length"));
-            size_t len = len_val->data();
+        // 15.4.4.4 Array.prototype.concat ( [ item1 [ , item2 [ , … ] ] ] )
+        static JSValue* concat(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
 
-            std::string sep = ",";
-            if(!vals.empty() && !vals[0]->IsUndefined())
-            {
-                sep = ::es::ToString(e, vals[0]);
-                if(!e->IsOk())
-                {
-                    return nullptr;
-                }
-            }
-            if(len == 0)
-            {
-                return String::Empty();
-            }
-            JSValue* element0 = O->Get(e, "0");
-            if(!e->IsOk())
-            {
-                return nullptr;
-            }
-            std::string R;
-            if(!element0->IsUndefined() && !element0->IsNull())
-            {
-                R = ::es::ToString(e, element0);
-            }
-            for(double k = 1; k < len; k++)
-            {
-                JSValue* element = O->Get(e, NumberToString(k));
-                if(!e->IsOk())
-                {
-                    return nullptr;
-                }
-                std::string next;
-                if(!element->IsUndefined() && !element->IsNull())
-                {
-                    next = ::es::ToString(e, element);
-                }
-                R += sep + next;
-            }
-            return new String(R);
-        }
+        // 15.4.4.5 Array.prototype.join (separator)
+        static JSValue* join(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
 
         // 15.4.4.6 Array.prototype.pop ( )
-        static JSValue* pop(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
-        {
-            (void)this_arg;
-            (void)vals;
-            JSObject* O = ToObject(e, RuntimeContext::TopValue());
-            if(!e->IsOk())
-            {
-                return nullptr;
-            }
-            size_t len = ToNumber(e, O->Get(e, "length"));
-            if(!e->IsOk())
-            {
-                return nullptr;
-            }
-            if(len == 0)
-            {
-                O->Put(e, "length", Number::Zero(), true);
-                if(!e->IsOk())
-                {
-                    return nullptr;
-                }
-                return Undefined::Instance();
-            }
-            else
-            {
-                assert(len > 0);
-                std::string indx = NumberToString(len - 1);
-                JSValue* element = O->Get(e, indx);
-                if(!e->IsOk())
-                {
-                    return nullptr;
-                }
-                O->Delete(e, indx, true);
-                if(!e->IsOk())
-                {
-                    return nullptr;
-                }
-                O->Put(e, "length", new Number(len - 1), true);
-                if(!e->IsOk())
-                {
-                    return nullptr;
-                }
-                return element;
-            }
-        }
+        static JSValue* pop(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
 
         // 15.4.4.7 Array.prototype.push ( [ item1 [ , item2 [ , … ] ] ] )
-        static JSValue* push(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
-        {
-            (void)this_arg;
-            JSObject* O = ToObject(e, RuntimeContext::TopValue());
-            if(!e->IsOk())
-            {
-                return nullptr;
-            }
-            double n = ToNumber(e, O->Get(e, "length"));
-            if(!e->IsOk())
-            {
-                return nullptr;
-            }
-            for(JSValue* E : vals)
-            {
-                O->Put(e, NumberToString(n), E, true);
-                if(!e->IsOk())
-                {
-                    return nullptr;
-                }
-                n++;
-            }
-            Number* num = new Number(n);
-            O->Put(e, "length", num, true);
-            if(!e->IsOk())
-            {
-                return nullptr;
-            }
-            return num;
-        }
+        static JSValue* push(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
+
+        // 15.4.4.8 Array.prototype.reverse ( )
+        static JSValue* reverse(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
+
+        // 15.4.4.9 Array.prototype.shift ( )
+        static JSValue* shift(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
+
+        // 15.4.4.10 Array.prototype.slice (start, end)
+        static JSValue* slice(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
+
+        // 15.4.4.11 Array.prototype.sort (comparefn)
+        static JSValue* sort(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
+
+        // 15.4.4.12 Array.prototype.splice (start, deleteCount [ , item1 [ , item2 [ , … ] ] ] )
+        static JSValue* splice(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
+
+        // 15.4.4.13 Array.prototype.unshift ( [ item1 [ , item2 [ , … ] ] ] )
+        static JSValue* unshift(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
+
+        // 15.4.4.14 Array.prototype.indexOf ( searchElement [ , fromIndex ] )
+        static JSValue* indexOf(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
+
+        // 15.4.4.15 Array.prototype.lastIndexOf ( searchElement [ , fromIndex ] )
+        static JSValue* lastIndexOf(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
+
+        // 15.4.4.16 Array.prototype.every ( callbackfn [ , thisArg ] )
+        static JSValue* every(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
+
+        // 15.4.4.17 Array.prototype.some ( callbackfn [ , thisArg ] )
+        static JSValue* some(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
+
+        static JSValue* forEach(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
 
-        static JSValue* reverse(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+        static JSValue* toLocaleUpperCase(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
         {
             (void)e;
             (void)this_arg;
@@ -6891,7 +8648,11 @@ namespace es
             assert(false);
         }
 
-        static JSValue* shift(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+        static JSValue* map(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
+
+        static JSValue* filter(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
+
+        static JSValue* reduce(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
         {
             (void)e;
             (void)this_arg;
@@ -6899,7 +8660,7 @@ namespace es
             assert(false);
         }
 
-        static JSValue* slice(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+        static JSValue* reduceRight(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
         {
             (void)e;
             (void)this_arg;
@@ -6907,115 +8668,185 @@ namespace es
             assert(false);
         }
 
-        static JSValue* sort(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+    private:
+        ArrayProto() : JSObject(OBJ_ARRAY, "Array", true, nullptr, false, false)
         {
-            (void)e;
-            (void)this_arg;
-            (void)vals;
-            assert(false);
         }
+    };
+
+    class ArrayObject : public JSObject
+    {
+    public:
+        // An array stays dense as long as every array index property
+        // is a plain data property (writable, enumerable and configurable). While dense,
+        // the elements live in elements_ (nullptr marks a hole) instead of
+        // named_properties_, so that the builtins can work on contiguous storage.
+        // Defining anything else on an index moves the elements back into
+        // named_properties_ for good.
+        static constexpr uint32_t kMaxHoleGrowth = 1024;
+        static constexpr uint32_t kMaxPreallocate = 1 << 20;
 
-        static JSValue* splice(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+        ArrayObject(double len) : JSObject(OBJ_ARRAY, "Array", true, nullptr, false, false), holes_(0), dense_(true)
         {
-            (void)e;
-            (void)this_arg;
-            (void)vals;
-            assert(false);
+            SetPrototype(ArrayProto::Instance());
+            // Not using AddValueProperty here to by pass the override DefineOwnProperty
+            PropertyDescriptor length_desc;
+            length_desc.SetDataDescriptor(new Number(len), true, false, false);
+            JSObject::DefineOwnProperty(nullptr, "length", &length_desc, false);
+            // length is not configurable, so its slot is never erased.
+            length_slot_ = FindNamedProperty("length");
         }
 
-        static JSValue* unshift(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+        // Returns O as an ArrayObject if it is one (Array.prototype is not).
+        static ArrayObject* Cast(JSObject* O)
         {
-            (void)e;
-            (void)this_arg;
-            (void)vals;
-            assert(false);
+            if(O->obj_type() != OBJ_ARRAY || O == ArrayProto::Instance())
+            {
+                return nullptr;
+            }
+            return static_cast<ArrayObject*>(O);
         }
 
-        static JSValue* indexOf(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+        // Returns O as an ArrayObject whose length equals the number of elements
+        // stored densely without holes, and which can grow and shrink freely.
+        // Builtins may then operate on elements() directly, provided that no user
+        // code runs in between.
+        static ArrayObject* AsPacked(JSObject* O)
         {
-            (void)e;
-            (void)this_arg;
-            (void)vals;
-            assert(false);
+            ArrayObject* A = Cast(O);
+            if(A == nullptr || !A->dense_ || !A->Extensible() || !A->length_slot_->Writable())
+            {
+                return nullptr;
+            }
+            if(A->holes_ != 0 || A->elements_.size() != A->Length())
+            {
+                return nullptr;
+            }
+            return A;
         }
 
-        static JSValue* lastIndexOf(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+        bool IsDense()
         {
-            (void)e;
-            (void)this_arg;
-            (void)vals;
-            assert(false);
+            return dense_;
         }
 
-        static JSValue* every(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+        // The builtins may replace, insert and remove elements through this,
+        // but must not leave holes, which are counted in holes_.
+        std::vector<JSValue*>& elements()
         {
-            (void)e;
-            (void)this_arg;
-            (void)vals;
-            assert(false);
+            return elements_;
         }
 
-        static JSValue* some(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+        double Length()
         {
-            (void)e;
-            (void)this_arg;
-            (void)vals;
-            assert(false);
+            return static_cast<Number*>(length_slot_->Value())->data();
         }
 
-        static JSValue* forEach(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
+        // Used by the builtins after changing elements() in place.
+        void SetLength(double len)
+        {
+            assert(length_slot_->Writable());
+            length_slot_->SetValue(new Number(len));
+        }
 
-        static JSValue* toLocaleUpperCase(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+        // Returns the element at index if it is stored densely, nullptr otherwise.
+        JSValue* DenseElement(double index)
         {
-            (void)e;
-            (void)this_arg;
-            (void)vals;
-            assert(false);
+            if(!dense_ || index >= elements_.size())
+            {
+                return nullptr;
+            }
+            return elements_[size_t(index)];
         }
 
-        static JSValue* map(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
+        bool GetOwnPropertySlot(const std::string& P, PropertySlot* slot) override
+        {
+            uint32_t index;
+            if(dense_ && ToArrayIndex(P, &index))
+            {
+                if(index >= elements_.size() || elements_[index] == nullptr)
+                {
+                    return false;
+                }
+                *slot = PropertySlot(elements_[index], true, true, true);
+                return true;
+            }
+            return JSObject::GetOwnPropertySlot(P, slot);
+        }
 
-        static JSValue* filter(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
+        JSValue* Get(Error* e, const std::string& P) override
+        {
+            uint32_t index;
+            if(dense_ && ToArrayIndex(P, &index) && index < elements_.size() && elements_[index] != nullptr)
+            {
+                return elements_[index];
+            }
+            return JSObject::Get(e, P);
+        }
 
-        static JSValue* reduce(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+        void Put(Error* e, const std::string& P, JSValue* V, bool throw_flag) override
         {
-            (void)e;
-            (void)this_arg;
-            (void)vals;
-            assert(false);
+            uint32_t index;
+            if(dense_ && ToArrayIndex(P, &index))
+            {
+                if(index < elements_.size() && elements_[index] != nullptr)
+                {
+                    elements_[index] = V;
+                    return;
+                }
+                // A new element, unless the prototype chain has something to say about it.
+                JSValue* proto = Prototype();
+                PropertySlot slot;
+                if(proto->IsNull() || !static_cast<JSObject*>(proto)->GetPropertySlot(P, &slot))
+                {
+                    if(PutNewElement(index, V))
+                    {
+                        return;
+                    }
+                }
+            }
+            JSObject::Put(e, P, V, throw_flag);
         }
 
-        static JSValue* reduceRight(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+        JSValue* GetByIndex(Error* e, uint32_t index) override
         {
-            (void)e;
-            (void)this_arg;
-            (void)vals;
-            assert(false);
+            if(dense_ && index < elements_.size() && elements_[index] != nullptr)
+            {
+                return elements_[index];
+            }
+            return JSObject::GetByIndex(e, index);
         }
 
-    private:
-        ArrayProto() : JSObject(OBJ_ARRAY, "Array", true, nullptr, false, false)
+        void PutByIndex(Error* e, uint32_t index, JSValue* V, bool throw_flag) override
         {
+            if(dense_ && index < elements_.size() && elements_[index] != nullptr)
+            {
+                elements_[index] = V;
+                return;
+            }
+            JSObject::PutByIndex(e, index, V, throw_flag);
         }
-    };
 
-    class ArrayObject : public JSObject
-    {
-    public:
-        ArrayObject(double len) : JSObject(OBJ_ARRAY, "Array", true, nullptr, false, false)
+        bool Delete(Error* e, const std::string& P, bool throw_flag) override
         {
-            SetPrototype(ArrayProto::Instance());
-            // Not using AddValueProperty here to by pass the override DefineOwnProperty
-            PropertyDescriptor* desc = new PropertyDescriptor();
-            desc->SetDataDescriptor(new Number(len), true, false, false);
-            JSObject::DefineOwnProperty(nullptr, "length", desc, false);
+            uint32_t index;
+            if(dense_ && ToArrayIndex(P, &index))
+            {
+                if(index < elements_.size() && elements_[index] != nullptr)
+                {
+                    elements_[index] = nullptr;
+                    holes_++;
+                }
+                return true;
+            }
+            return JSObject::Delete(e, P, throw_flag);
         }
 
         bool DefineOwnProperty(Error* e, const std::string& P, PropertyDescriptor* desc, bool throw_flag) override
         {
-            auto old_len_desc = static_cast<PropertyDescriptor*>(GetOwnProperty("length"));
-            assert(!old_len_desc->IsUndefined());
-            double old_len = ToNumber(e, old_len_desc->Value());
+            uint32_t index;
+            PropertySlot* old_len_slot = length_slot_;
+            double old_len = Length();
             if(P == "length")
             {// 3
                 if(!desc->HasValue())
@@ -7036,7 +8867,7 @@ namespace es
                 }
                 if(new_len != new_num)
                 {
-                    *e = *Error::RangeError("length of array need to be uint32.");
+                    *e = Error::RangeError("length of array need to be uint32.");
                     return false;
                 }
                 new_len_desc->SetValue(new Number(new_len));
@@ -7044,7 +8875,7 @@ namespace es
                 {// 3.f
                     return JSObject::DefineOwnProperty(e, "length", new_len_desc, throw_flag);
                 }
-                if(!old_len_desc->Writable())
+                if(!old_len_slot->Writable())
                 {// 3.g
                     goto reject;
                 }
@@ -7063,6 +8894,16 @@ namespace es
                 {
                     return false;// 3.k
                 }
+                if(dense_)
+                {
+                    // All the elements are configurable, so 3.l cannot fail.
+                    if(elements_.size() > new_len)
+                    {
+                        holes_ -= std::count(elements_.begin() + size_t(new_len), elements_.end(), nullptr);
+                        elements_.resize(new_len);
+                    }
+                    old_len = new_len;
+                }
                 while(new_len < old_len)
                 {// 3.l
                     old_len--;
@@ -7089,22 +8930,25 @@ namespace es
             }
             else
             {
-                if(IsArrayIndex(P))
+                if(ToArrayIndex(P, &index))
                 {// 4
-                    double index = StringToNumber(P);
-                    if(index >= old_len && !old_len_desc->Writable())
+                    if(index >= old_len && !old_len_slot->Writable())
                     {// 4.b
                         goto reject;
                     }
-                    bool succeeded = JSObject::DefineOwnProperty(e, P, desc, false);
+                    bool succeeded = dense_ && DefineOwnElement(index, desc);
+                    if(!succeeded)
+                    {
+                        succeeded = JSObject::DefineOwnProperty(e, P, desc, false);
+                    }
                     if(!succeeded)
                     {
                         goto reject;
                     }
                     if(index >= old_len)
                     {// 4.e
-                        old_len_desc->SetValue(new Number(index + 1));
-                        return JSObject::DefineOwnProperty(e, "length", old_len_desc, false);
+                        old_len_slot->SetValue(new Number(double(index) + 1));
+                        return true;
                     }
                     return true;
                 }
@@ -7114,16 +8958,181 @@ namespace es
             //log::PrintSource("Array::DefineOwnProperty reject ", P, " " + desc->ToString());
             if(throw_flag)
             {
-                *e = *Error::TypeError();
+                *e = Error::TypeError();
             }
             return false;
         }
 
+        bool EnumeratesNamedPropertiesOnly() override
+        {
+            return !dense_;
+        }
+
+        std::vector<std::string> AllEnumerableProperties() override
+        {
+            if(!dense_)
+            {
+                return JSObject::AllEnumerableProperties();
+            }
+            std::vector<std::string> result;
+            for(size_t i = 0; i < elements_.size(); i++)
+            {
+                if(elements_[i] == nullptr)
+                {
+                    continue;
+                }
+                result.emplace_back(NumberToString(i));
+            }
+            for(const auto& name : JSObject::AllEnumerableProperties())
+            {
+                uint32_t index;
+                if(ToArrayIndex(name, &index) && index < elements_.size() && elements_[index] != nullptr)
+                {// shadowed by an element
+                    continue;
+                }
+                result.emplace_back(name);
+            }
+            return result;
+        }
+
+        // Appends vals in place if the array is dense up to its length.
+        bool FastPush(const std::vector<JSValue*>& vals)
+        {
+            if(!dense_ || !Extensible() || !length_slot_->Writable() || elements_.size() != Length())
+            {
+                return false;
+            }
+            if(Length() + vals.size() > 4294967295.0)
+            {
+                return false;
+            }
+            elements_.insert(elements_.end(), vals.begin(), vals.end());
+            SetLength(elements_.size());
+            return true;
+        }
+
+        // Removes and returns the last element, or nullptr if the generic path has to do it.
+        JSValue* FastPop()
+        {
+            if(!dense_ || !length_slot_->Writable() || elements_.empty() || elements_.size() != Length())
+            {
+                return nullptr;
+            }
+            JSValue* element = elements_.back();
+            if(element == nullptr)
+            {
+                return nullptr;
+            }
+            elements_.pop_back();
+            SetLength(elements_.size());
+            return element;
+        }
+
         std::string ToString() override
         {
-            size_t num = ToNumber(nullptr, Get(nullptr, "length"));
+            size_t num = Length();
             return "Array(" + std::to_string(num) + ")";
         }
+
+    private:
+        // Fast [[Put]] for an index that is not an own element yet.
+        // Returns false if the generic path has to handle it.
+        bool PutNewElement(uint32_t index, JSValue* V)
+        {
+            if(!Extensible() || (index >= Length() && !length_slot_->Writable()))
+            {
+                return false;
+            }
+            if(!StoreElement(index, V))
+            {
+                return false;
+            }
+            if(index >= Length())
+            {
+                SetLength(double(index) + 1);
+            }
+            return true;
+        }
+
+        // Handles [[DefineOwnProperty]] of an index while dense. Returns false if
+        // desc cannot be represented in elements_, in which case the elements
+        // have been moved to named_properties_ where needed.
+        bool DefineOwnElement(uint32_t index, PropertyDescriptor* desc)
+        {
+            bool exists = index < elements_.size() && elements_[index] != nullptr;
+            bool plain = !desc->HasGet() && !desc->HasSet() &&
+                         (!desc->HasWritable() || desc->Writable()) &&
+                         (!desc->HasEnumerable() || desc->Enumerable()) &&
+                         (!desc->HasConfigurable() || desc->Configurable());
+            if(exists && plain)
+            {
+                if(desc->HasValue())
+                {
+                    elements_[index] = desc->Value();
+                }
+                return true;
+            }
+            if(!exists && !Extensible())
+            {
+                return false;
+            }
+            if(!exists && plain && desc->HasWritable() && desc->HasEnumerable() && desc->HasConfigurable())
+            {
+                if(StoreElement(index, desc->HasValue() ? desc->Value() : Undefined::Instance()))
+                {
+                    return true;
+                }
+            }
+            MakeSparse();
+            return false;
+        }
+
+        // Stores V at index, growing elements_ unless that would leave it
+        // mostly holes.
+        bool StoreElement(uint32_t index, JSValue* V)
+        {
+            size_t size = elements_.size();
+            if(index >= size)
+            {
+                bool near = index - size < kMaxHoleGrowth || index < 2 * size;
+                bool preallocated = index < Length() && Length() <= kMaxPreallocate;
+                if(!near && !preallocated)
+                {
+                    return false;
+                }
+                elements_.resize(size_t(index) + 1, nullptr);
+                holes_ += index - size + 1;
+            }
+            if(elements_[index] == nullptr)
+            {
+                holes_--;
+            }
+            elements_[index] = V;
+            return true;
+        }
+
+        void MakeSparse()
+        {
+            for(size_t i = 0; i < elements_.size(); i++)
+            {
+                if(elements_[i] == nullptr)
+                {
+                    continue;
+                }
+                named_properties_[NumberToString(i)] = PropertySlot(elements_[i], true, true, true);
+            }
+            LayoutChanged();
+            elements_.clear();
+            elements_.shrink_to_fit();
+            holes_ = 0;
+            dense_ = false;
+        }
+
+        std::vector<JSValue*> elements_;
+        // The number of nullptr entries in elements_.
+        size_t holes_;
+        PropertySlot* length_slot_;
+        bool dense_;
     };
 
     class ArrayConstructor : public JSObject
@@ -7154,7 +9163,7 @@ namespace es
                 }
                 else
                 {
-                    *e = *Error::RangeError("Invalid array length");
+                    *e = Error::RangeError("Invalid array length");
                     return nullptr;
                 }
             }
@@ -7193,61 +9202,65 @@ namespace es
         }
     };
 
-    // 15.4.4.18 Array.prototype.forEach ( callbackfn [ , thisArg ] )
-    inline JSValue* ArrayProto::forEach(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+    // Element access used by the algorithms of 15.4.4. The elements of a dense
+    // ArrayObject are accessed directly instead of through their string keys.
+    inline double GetArrayLength(Error* e, JSObject* O)
     {
-        (void)this_arg;
-        JSObject* O = ToObject(e, RuntimeContext::TopValue());
-        if(!e->IsOk())
+        ArrayObject* A = ArrayObject::Cast(O);
+        if(A != nullptr)
         {
-            return nullptr;
-        }
-        size_t len = ToNumber(e, O->Get(e, "length"));
-        if(vals.empty() || !vals[0]->IsCallable())
-        {// 4
-            *e = *Error::TypeError("Array.prototype.forEach called on non-callable");
-            return nullptr;
+            return A->Length();
         }
-        JSObject* callbackfn = static_cast<JSObject*>(vals[0]);
-        JSValue* T;
-        if(vals.size() < 2)
+        JSValue* len = O->Get(e, "length");
+        if(!e->IsOk())
         {
-            T = Undefined::Instance();
+            return 0;
         }
-        else
+        return ToUint32(e, len);
+    }
+
+    inline bool HasElement(JSObject* O, double k)
+    {
+        ArrayObject* A = ArrayObject::Cast(O);
+        if(A != nullptr && A->IsDense())
         {
-            T = vals[1];
+            return A->DenseElement(k) != nullptr;
         }
-        ArrayObject* A = new ArrayObject(len);
-        (void)A;
-        for(size_t k = 0; k < len; k++)
+        return O->HasProperty(NumberToString(k));
+    }
+
+    inline JSValue* GetElement(Error* e, JSObject* O, double k)
+    {
+        ArrayObject* A = ArrayObject::Cast(O);
+        if(A != nullptr)
         {
-            std::string p_k = NumberToString(k);
-            bool k_present = O->HasProperty(p_k);
-            if(!e->IsOk())
-            {
-                return nullptr;
-            }
-            if(k_present)
+            JSValue* element = A->DenseElement(k);
+            if(element != nullptr)
             {
-                JSValue* k_value = O->Get(e, p_k);
-                if(!e->IsOk())
-                {
-                    return nullptr;
-                }
-                JSValue* mapped_value = callbackfn->Call(e, T, { k_value, new Number(k), O });
-                (void)mapped_value;
-                if(!e->IsOk())
-                {
-                    return nullptr;
-                }
+                return element;
             }
         }
-        return Undefined::Instance();
+        return O->Get(e, NumberToString(k));
     }
 
-    // 15.4.4.19 Array.prototype.map ( callbackfn [ , thisArg ] )
-    inline JSValue* ArrayProto::map(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+    inline void PutElement(Error* e, JSObject* O, double k, JSValue* V)
+    {
+        ArrayObject* A = ArrayObject::Cast(O);
+        if(A != nullptr && A->DenseElement(k) != nullptr)
+        {
+            A->elements()[size_t(k)] = V;
+            return;
+        }
+        O->Put(e, NumberToString(k), V, true);
+    }
+
+    inline void DeleteElement(Error* e, JSObject* O, double k)
+    {
+        O->Delete(e, NumberToString(k), true);
+    }
+
+    // 15.4.4.4 Array.prototype.concat ( [ item1 [ , item2 [ , … ] ] ] )
+    inline JSValue* ArrayProto::concat(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
     {
         (void)this_arg;
         JSObject* O = ToObject(e, RuntimeContext::TopValue());
@@ -7255,52 +9268,57 @@ namespace es
         {
             return nullptr;
         }
-        size_t len = ToNumber(e, O->Get(e, "length"));
-        if(vals.empty() || !vals[0]->IsCallable())
-        {// 4
-            *e = *Error::TypeError("Array.prototype.map called on non-callable");
-            return nullptr;
-        }
-        JSObject* callbackfn = static_cast<JSObject*>(vals[0]);
-        JSValue* T;
-        if(vals.size() < 2)
-        {
-            T = Undefined::Instance();
-        }
-        else
-        {
-            T = vals[1];
-        }
-        ArrayObject* A = new ArrayObject(len);
-        (void)A;
-        for(size_t k = 0; k < len; k++)
-        {
-            std::string p_k = NumberToString(k);
-            bool k_present = O->HasProperty(p_k);
-            if(!e->IsOk())
-            {
-                return nullptr;
-            }
-            if(k_present)
-            {
-                JSValue* k_value = O->Get(e, p_k);
-                if(!e->IsOk())
+        ArrayObject* A = new ArrayObject(0);
+        double n = 0;
+        std::vector<JSValue*> items = { O };
+        items.insert(items.end(), vals.begin(), vals.end());
+        for(JSValue* E : items)
+        {// 5
+            if(E->IsObject() && static_cast<JSObject*>(E)->Class() == "Array")
+            {// 5.b
+                JSObject* obj = static_cast<JSObject*>(E);
+                ArrayObject* src = ArrayObject::AsPacked(obj);
+                if(src != nullptr && A->IsDense() && n == A->elements().size())
                 {
-                    return nullptr;
+                    A->elements().insert(A->elements().end(), src->elements().begin(), src->elements().end());
+                    n = A->elements().size();
+                    A->SetLength(n);
+                    continue;
                 }
-                JSValue* mapped_value = callbackfn->Call(e, T, { k_value, new Number(k), O });
+                double len = GetArrayLength(e, obj);
                 if(!e->IsOk())
                 {
                     return nullptr;
                 }
-                A->AddValueProperty(p_k, mapped_value, true, true, true);
+                for(double k = 0; k < len; k++, n++)
+                {// 5.b.iv
+                    if(HasElement(obj, k))
+                    {
+                        JSValue* sub_element = GetElement(e, obj, k);
+                        if(!e->IsOk())
+                        {
+                            return nullptr;
+                        }
+                        A->AddValueProperty(NumberToString(n), sub_element, true, true, true);
+                    }
+                }
             }
+            else
+            {// 5.c
+                A->AddValueProperty(NumberToString(n), E, true, true, true);
+                n++;
+            }
+        }
+        A->Put(e, "length", new Number(n), true);
+        if(!e->IsOk())
+        {
+            return nullptr;
         }
         return A;
     }
 
-    // 15.4.4.20 Array.prototype.filter ( callbackfn [ , thisArg ] )
-    inline JSValue* ArrayProto::filter(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+    // 15.4.4.5 Array.prototype.join (separator)
+    inline JSValue* ArrayProto::join(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
     {
         (void)this_arg;
         JSObject* O = ToObject(e, RuntimeContext::TopValue());
@@ -7308,944 +9326,4062 @@ namespace es
         {
             return nullptr;
         }
-        size_t len = ToNumber(e, O->Get(e, "length"));
-        if(vals.empty() || !vals[0]->IsCallable())
-        {// 4
-            *e = *Error::TypeError("Array.prototype.filter called on non-callable");
+        double len = GetArrayLength(e, O);
+        if(!e->IsOk())
+        {
             return nullptr;
         }
-        JSObject* callbackfn = static_cast<JSObject*>(vals[0]);
-        JSValue* T;
-        if(vals.size() < 2)
+        std::string sep = ",";
+        if(!vals.empty() && !vals[0]->IsUndefined())
         {
-            T = Undefined::Instance();
+            sep = ::es::ToString(e, vals[0]);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
         }
-        else
+        if(len == 0)
         {
-            T = vals[1];
+            return String::Empty();
         }
-        size_t to = 0;
-        ArrayObject* A = new ArrayObject(len);
-        for(size_t k = 0; k < len; k++)
+        // The first pass only collects the pieces; the result is written once.
+        StringBuilder R;
+        for(double k = 0; k < len; k++)
         {
-            std::string p_k = NumberToString(k);
-            bool k_present = O->HasProperty(p_k);
+            if(k > 0)
+            {
+                R.Append(std::string_view(sep));
+            }
+            JSValue* element = GetElement(e, O, k);
             if(!e->IsOk())
             {
                 return nullptr;
             }
-            if(k_present)
+            if(element->IsUndefined() || element->IsNull())
             {
-                JSValue* k_value = O->Get(e, p_k);
-                if(!e->IsOk())
-                {
-                    return nullptr;
-                }
-                JSValue* selected = callbackfn->Call(e, T, { k_value, new Number(k), O });
-                if(!e->IsOk())
-                {
-                    return nullptr;
-                }
-                if(ToBoolean(selected))
-                {
-                    A->AddValueProperty(NumberToString(to), k_value, true, true, true);
-                    to++;
-                }
+                continue;
+            }
+            if(element->IsString())
+            {
+                R.Append(static_cast<String*>(element)->view());
+                continue;
+            }
+            R.Append(::es::ToString(e, element));
+            if(!e->IsOk())
+            {
+                return nullptr;
             }
         }
-        return A;
+        return new String(R.Build());
     }
 
-    inline JSValue* ObjectConstructor::keys(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+    // 15.4.4.6 Array.prototype.pop ( )
+    inline JSValue* ArrayProto::pop(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
     {
         (void)this_arg;
-        if(vals.empty() || !vals[0]->IsObject())
+        (void)vals;
+        JSObject* O = ToObject(e, RuntimeContext::TopValue());
+        if(!e->IsOk())
         {
-            *e = *Error::TypeError("Object.keys called on non-object");
             return nullptr;
         }
-        JSObject* O = static_cast<JSObject*>(vals[0]);
-        auto properties = O->AllEnumerableProperties();
-        size_t n = properties.size();
-        ArrayObject* arr_obj = new ArrayObject(n);
-        for(size_t index = 0; index < n; index++)
+        ArrayObject* A = ArrayObject::Cast(O);
+        if(A != nullptr)
         {
-            arr_obj->AddValueProperty(NumberToString(index), new String(properties[index].first), true, true, true);
+            JSValue* element = A->FastPop();
+            if(element != nullptr)
+            {
+                return element;
+            }
         }
-        return arr_obj;
-    }
+        double len = GetArrayLength(e, O);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        if(len == 0)
+        {// 4
+            O->Put(e, "length", Number::Zero(), true);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+            return Undefined::Instance();
+        }
+        // 5
+        JSValue* element = GetElement(e, O, len - 1);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        DeleteElement(e, O, len - 1);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        O->Put(e, "length", new Number(len - 1), true);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        return element;
+    }
 
-    // 10.6 Arguments Object
-    class ArgumentsObject : public JSObject
+    // 15.4.4.7 Array.prototype.push ( [ item1 [ , item2 [ , … ] ] ] )
+    inline JSValue* ArrayProto::push(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
     {
-    public:
-        ArgumentsObject(JSObject* parameter_map, size_t len)
-        : JSObject(OBJ_OBJECT, "Arguments", true, nullptr, false, false), parameter_map_(parameter_map)
+        (void)this_arg;
+        JSObject* O = ToObject(e, RuntimeContext::TopValue());
+        if(!e->IsOk())
         {
-            SetPrototype(ObjectProto::Instance());
-            AddValueProperty("length", new Number(len), true, false, true);
+            return nullptr;
         }
-
-        JSObject* ParameterMap()
+        ArrayObject* A = ArrayObject::Cast(O);
+        if(A != nullptr && A->FastPush(vals))
         {
-            return parameter_map_;
+            return new Number(A->Length());
         }
-
-        JSValue* Get(Error* e, const std::string& P) override
+        double n = GetArrayLength(e, O);
+        if(!e->IsOk())
         {
-            JSObject* map = ParameterMap();
-            JSValue* is_mapped = map->GetOwnProperty(P);
-            if(is_mapped->IsUndefined())
-            {// 3
-                JSValue* v = JSObject::Get(e, P);
-                if(!e->IsOk())
-                {
-                    return nullptr;
-                }
-                if(P == "caller")
-                {
-                    if(v->IsObject())
-                    {
-                        JSObject* obj = static_cast<JSObject*>(v);
-                        if(obj->IsFunction())
-                        {
-                            FunctionObject* func = static_cast<FunctionObject*>(obj);
-                            if(func->strict())
-                            {
-                                *e = *Error::TypeError("caller could not be function object");
-                            }
-                        }
-                    }
-                }
-                return v;
-            }
-            // 4
-            return map->Get(e, P);
+            return nullptr;
         }
-
-        JSValue* GetOwnProperty(const std::string& P) override
+        for(JSValue* E : vals)
         {
-            JSValue* val = JSObject::GetOwnProperty(P);
-            if(val->IsUndefined())
+            O->Put(e, NumberToString(n), E, true);
+            if(!e->IsOk())
             {
-                return val;
-            }
-            PropertyDescriptor* desc = static_cast<PropertyDescriptor*>(val);
-            JSObject* map = ParameterMap();
-            JSValue* is_mapped = map->GetOwnProperty(P);
-            if(!is_mapped->IsUndefined())
-            {// 5
-                desc->SetValue(map->Get(nullptr, P));
+                return nullptr;
             }
-            return desc;
+            n++;
+        }
+        Number* num = new Number(n);
+        O->Put(e, "length", num, true);
+        if(!e->IsOk())
+        {
+            return nullptr;
         }
+        return num;
+    }
 
-        bool DefineOwnProperty(Error* e, const std::string& P, PropertyDescriptor* desc, bool throw_flag) override
+    // 15.4.4.8 Array.prototype.reverse ( )
+    inline JSValue* ArrayProto::reverse(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+    {
+        (void)this_arg;
+        (void)vals;
+        JSObject* O = ToObject(e, RuntimeContext::TopValue());
+        if(!e->IsOk())
         {
-            JSObject* map = ParameterMap();
-            JSValue* is_mapped = map->GetOwnProperty(P);
-            bool allowed = JSObject::DefineOwnProperty(e, P, desc, false);
-            if(!allowed)
+            return nullptr;
+        }
+        ArrayObject* A = ArrayObject::AsPacked(O);
+        if(A != nullptr)
+        {
+            std::reverse(A->elements().begin(), A->elements().end());
+            return O;
+        }
+        double len = GetArrayLength(e, O);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        double middle = floor(len / 2);
+        for(double lower = 0; lower != middle; lower++)
+        {// 6
+            double upper = len - lower - 1;
+            bool lower_exists = HasElement(O, lower);
+            bool upper_exists = HasElement(O, upper);
+            JSValue* lower_value = GetElement(e, O, lower);
+            if(!e->IsOk())
             {
-                if(throw_flag)
+                return nullptr;
+            }
+            JSValue* upper_value = GetElement(e, O, upper);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+            if(lower_exists && upper_exists)
+            {// 6.h
+                PutElement(e, O, lower, upper_value);
+                if(!e->IsOk())
                 {
-                    *e = *Error::TypeError("DefineOwnProperty " + P + " failed");
+                    return nullptr;
                 }
-                return false;
+                PutElement(e, O, upper, lower_value);
             }
-            if(!is_mapped->IsUndefined())
-            {// 5
-                if(desc->IsAccessorDescriptor())
+            else if(!lower_exists && upper_exists)
+            {// 6.i
+                PutElement(e, O, lower, upper_value);
+                if(!e->IsOk())
                 {
-                    map->Delete(e, P, false);
+                    return nullptr;
                 }
-                else
+                DeleteElement(e, O, upper);
+            }
+            else if(lower_exists && !upper_exists)
+            {// 6.j
+                DeleteElement(e, O, lower);
+                if(!e->IsOk())
                 {
-                    if(desc->HasValue())
-                    {
-                        map->Put(e, P, desc->Value(), false);
-                    }
-                    if(desc->HasWritable() && !desc->Writable())
-                    {
-                        map->Delete(e, P, false);
-                    }
+                    return nullptr;
                 }
+                PutElement(e, O, upper, lower_value);
+            }
+            if(!e->IsOk())
+            {
+                return nullptr;
             }
-            return true;
         }
+        return O;
+    }
 
-        bool Delete(Error* e, const std::string& P, bool throw_flag) override
+    // 15.4.4.9 Array.prototype.shift ( )
+    inline JSValue* ArrayProto::shift(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+    {
+        (void)this_arg;
+        (void)vals;
+        JSObject* O = ToObject(e, RuntimeContext::TopValue());
+        if(!e->IsOk())
         {
-            JSObject* map = ParameterMap();
-            JSValue* is_mapped = map->GetOwnProperty(P);
-            bool result = JSObject::Delete(e, P, throw_flag);
+            return nullptr;
+        }
+        ArrayObject* A = ArrayObject::AsPacked(O);
+        if(A != nullptr && !A->elements().empty())
+        {
+            JSValue* first = A->elements().front();
+            A->elements().erase(A->elements().begin());
+            A->SetLength(A->elements().size());
+            return first;
+        }
+        double len = GetArrayLength(e, O);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        if(len == 0)
+        {// 4
+            O->Put(e, "length", Number::Zero(), true);
             if(!e->IsOk())
             {
-                return false;
+                return nullptr;
+            }
+            return Undefined::Instance();
+        }
+        JSValue* first = GetElement(e, O, 0);// 5
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        for(double k = 1; k < len; k++)
+        {// 7
+            if(HasElement(O, k))
+            {
+                JSValue* from_val = GetElement(e, O, k);
+                if(!e->IsOk())
+                {
+                    return nullptr;
+                }
+                PutElement(e, O, k - 1, from_val);
+            }
+            else
+            {
+                DeleteElement(e, O, k - 1);
             }
-            if(result && !is_mapped->IsUndefined())
+            if(!e->IsOk())
             {
-                map->Delete(e, P, false);
+                return nullptr;
             }
-            return result;
         }
-
-        inline std::string ToString() override
+        DeleteElement(e, O, len - 1);// 8
+        if(!e->IsOk())
         {
-            return "ArgumentsObject";
+            return nullptr;
         }
+        O->Put(e, "length", new Number(len - 1), true);// 9
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        return first;
+    }
 
-    private:
-        JSObject* parameter_map_;
-    };
-
-    class Console : public JSObject
+    // Converts a relative index argument of slice and splice to an absolute one in [0, len].
+    inline double ToRelativeIndex(Error* e, JSValue* relative, double len)
     {
-    public:
-        static Console* Instance()
+        double relative_index = ToInteger(e, relative);
+        if(!e->IsOk())
         {
-            static Console singleton;
-            return &singleton;
+            return 0;
         }
+        if(relative_index < 0)
+        {
+            return fmax(len + relative_index, 0);
+        }
+        return fmin(relative_index, len);
+    }
 
-        static JSValue* log(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+    // 15.4.4.10 Array.prototype.slice (start, end)
+    inline JSValue* ArrayProto::slice(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+    {
+        (void)this_arg;
+        JSObject* O = ToObject(e, RuntimeContext::TopValue());
+        if(!e->IsOk())
         {
-            (void)e;
-            (void)this_arg;
-            for(auto val : vals)
+            return nullptr;
+        }
+        ArrayObject* A = new ArrayObject(0);
+        double len = GetArrayLength(e, O);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        double k = ToRelativeIndex(e, vals.empty() ? Undefined::Instance() : vals[0], len);// 5-6
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        double final_index = len;
+        if(vals.size() > 1 && !vals[1]->IsUndefined())
+        {// 7-8
+            final_index = ToRelativeIndex(e, vals[1], len);
+            if(!e->IsOk())
             {
-                std::cout << val->ToString() << " ";
+                return nullptr;
             }
-            std::cout << std::endl;
-            return Number::Zero();
         }
-
-    private:
-        Console() : JSObject(OBJ_BOOL, "Console", true, Bool::False(), false, false)
+        ArrayObject* src = ArrayObject::AsPacked(O);
+        if(src != nullptr && src->Length() == len)
         {
-            AddFuncProperty("log", log, false, false, false);
+            if(k < final_index)
+            {
+                A->elements().assign(src->elements().begin() + size_t(k), src->elements().begin() + size_t(final_index));
+                A->SetLength(A->elements().size());
+            }
+            return A;
         }
-    };
-
-    enum CodeType
-    {
-        CODE_GLOBAL = 0,
-        CODE_FUNC,
-        CODE_EVAL,
-    };
-
-    inline JSValue* MakeArgGetter(const std::string& name, LexicalEnvironment* env)
-    {
-        Parsing::Parser parser("return " + name + ";");
-        auto body = static_cast<Parsing::ProgramOrFunctionBody*>(parser.ParseFunctionBody(Parsing::Token::TK_EOS));
-        return new FunctionObject({}, body, env);
-    }
-
-    inline JSValue* MakeArgSetter(const std::string& name, LexicalEnvironment* env)
-    {
-        std::string param = name + "_arg";
-        Parsing::Parser parser(name + " = " + param);
-        auto body = static_cast<Parsing::ProgramOrFunctionBody*>(parser.ParseFunctionBody(Parsing::Token::TK_EOS));
-        return new FunctionObject({ param }, body, env);
-    }
-
-    // 10.6 Arguments Object
-    inline JSObject* CreateArgumentsObject(FunctionObject* func, std::vector<JSValue*>& args, LexicalEnvironment* env, bool strict)
-    {
-        std::vector<std::string> names = func->FormalParameters();
-        int len = args.size();
-        Object* map = new Object();// 8
-        JSObject* obj = new ArgumentsObject(map, len);
-        int indx = len - 1;// 10
-        std::set<std::string> mapped_names;
-        while(indx >= 0)
-        {// 11
-            JSValue* val = args[indx];// 11.a
-            obj->AddValueProperty(NumberToString(indx), val, true, true, true);// 11.b
-            if(indx < int(names.size()))
-            {// 11.c
-                std::string name = names[indx];// 11.c.i
-                if(!strict && mapped_names.find(name) == mapped_names.end())
-                {// 11.c.ii
-                    mapped_names.insert(name);
-                    JSValue* g = MakeArgGetter(name, env);
-                    JSValue* p = MakeArgSetter(name, env);
-                    PropertyDescriptor* desc = new PropertyDescriptor();
-                    desc->SetSet(p);
-                    desc->SetGet(g);
-                    desc->SetConfigurable(true);
-                    map->DefineOwnProperty(nullptr, NumberToString(indx), desc, false);
+        double n = 0;
+        for(; k < final_index; k++, n++)
+        {// 10
+            if(HasElement(O, k))
+            {
+                JSValue* k_value = GetElement(e, O, k);
+                if(!e->IsOk())
+                {
+                    return nullptr;
                 }
+                A->AddValueProperty(NumberToString(n), k_value, true, true, true);
             }
-            indx--;// 11.d
-        }
-        if(!strict)
-        {// 13
-            obj->AddValueProperty("callee", func, true, false, true);
         }
-        else
-        {// 14
-            // TODO(zhuzilin) thrower
+        A->Put(e, "length", new Number(n), true);
+        if(!e->IsOk())
+        {
+            return nullptr;
         }
-        return obj;// 15
+        return A;
     }
 
-    inline void FindAllVarDecl(const std::vector<Parsing::AST*>& stmts, const std::vector<Parsing::VarDecl*>& idecls)
+    // Binary insertion sort of v[lo, hi), where v[lo, start) is already sorted.
+    template<typename T, typename Less>
+    void BinaryInsertionSort(std::vector<T>& v, size_t lo, size_t hi, size_t start, Less& less)
     {
-        auto decls = idecls;
-        for(auto stmt : stmts)
+        for(size_t i = start; i < hi; i++)
         {
-            switch(stmt->type())
+            T pivot = std::move(v[i]);
+            // upper bound, so that equal elements keep their order.
+            size_t left = lo;
+            size_t right = i;
+            while(left < right)
             {
-                case Parsing::AST::AST_STMT_VAR:
+                size_t mid = left + (right - left) / 2;
+                if(less(pivot, v[mid]))
                 {
-                    Parsing::VarStmt* var_stmt = static_cast<Parsing::VarStmt*>(stmt);
-                    for(auto d : var_stmt->decls())
-                    {
-                        decls.emplace_back(d);
-                    }
-                    break;
+                    right = mid;
                 }
-                case Parsing::AST::AST_STMT_FOR:
+                else
                 {
-                    Parsing::For* for_stmt = static_cast<Parsing::For*>(stmt);
-                    if(!for_stmt->expr0s().empty() && for_stmt->expr0s()[0]->type() == Parsing::AST::AST_STMT_VAR_DECL)
-                    {
-                        for(Parsing::AST* ast : for_stmt->expr0s())
-                        {
-                            Parsing::VarDecl* d = static_cast<Parsing::VarDecl*>(ast);
-                            decls.emplace_back(d);
-                        }
-                    }
-                    FindAllVarDecl({ for_stmt->statement() }, decls);
-                    break;
+                    left = mid + 1;
+                }
+            }
+            std::move_backward(v.begin() + left, v.begin() + i, v.begin() + i + 1);
+            v[left] = std::move(pivot);
+        }
+    }
+
+    // Merges the adjacent sorted runs v[base1, base1 + len1) and v[base1 + len1, base1 + len1 + len2).
+    template<typename T, typename Less>
+    void MergeRuns(std::vector<T>& v, size_t base1, size_t len1, size_t len2, std::vector<T>& tmp, Less& less)
+    {
+        size_t base2 = base1 + len1;
+        // Elements of run1 not greater than the first of run2 are already in place.
+        size_t left = base1;
+        size_t right = base2;
+        while(left < right)
+        {
+            size_t mid = left + (right - left) / 2;
+            if(less(v[base2], v[mid]))
+            {
+                right = mid;
+            }
+            else
+            {
+                left = mid + 1;
+            }
+        }
+        len1 -= left - base1;
+        base1 = left;
+        if(len1 == 0)
+        {
+            return;
+        }
+        // So are the elements of run2 not less than the last of run1.
+        left = base2;
+        right = base2 + len2;
+        while(left < right)
+        {
+            size_t mid = left + (right - left) / 2;
+            if(less(v[mid], v[base2 - 1]))
+            {
+                left = mid + 1;
+            }
+            else
+            {
+                right = mid;
+            }
+        }
+        len2 = left - base2;
+        if(len2 == 0)
+        {
+            return;
+        }
+        tmp.clear();
+        if(len1 <= len2)
+        {// merge from the left, buffering run1
+            std::move(v.begin() + base1, v.begin() + base2, std::back_inserter(tmp));
+            size_t i = 0;
+            size_t j = base2;
+            size_t dest = base1;
+            while(i < len1 && j < base2 + len2)
+            {
+                if(less(v[j], tmp[i]))
+                {
+                    v[dest++] = std::move(v[j++]);
                 }
-                case Parsing::AST::AST_STMT_FOR_IN:
+                else
                 {
-                    Parsing::ForIn* for_in_stmt = static_cast<Parsing::ForIn*>(stmt);
-                    if(for_in_stmt->expr0()->type() == Parsing::AST::AST_STMT_VAR_DECL)
-                    {
-                        Parsing::VarDecl* d = static_cast<Parsing::VarDecl*>(for_in_stmt->expr0());
-                        decls.emplace_back(d);
-                    }
-                    FindAllVarDecl({ for_in_stmt->statement() }, decls);
-                    break;
+                    v[dest++] = std::move(tmp[i++]);
                 }
-                case Parsing::AST::AST_STMT_BLOCK:
+            }
+            std::move(tmp.begin() + i, tmp.begin() + len1, v.begin() + dest);
+        }
+        else
+        {// merge from the right, buffering run2
+            std::move(v.begin() + base2, v.begin() + base2 + len2, std::back_inserter(tmp));
+            ptrdiff_t i = ptrdiff_t(base2) - 1;
+            ptrdiff_t j = ptrdiff_t(len2) - 1;
+            ptrdiff_t dest = ptrdiff_t(base2 + len2) - 1;
+            while(i >= ptrdiff_t(base1) && j >= 0)
+            {
+                if(less(tmp[j], v[i]))
                 {
-                    Parsing::Block* block = static_cast<Parsing::Block*>(stmt);
-                    FindAllVarDecl(block->statements(), decls);
-                    break;
+                    v[dest--] = std::move(v[i--]);
                 }
-                case Parsing::AST::AST_STMT_TRY:
+                else
                 {
-                    Parsing::Try* try_stmt = static_cast<Parsing::Try*>(stmt);
-                    FindAllVarDecl({ try_stmt->try_block() }, decls);
-                    if(try_stmt->catch_block() != nullptr)
-                    {
-                        FindAllVarDecl({ try_stmt->catch_block() }, decls);
-                    }
-                    if(try_stmt->finally_block() != nullptr)
-                    {
-                        FindAllVarDecl({ try_stmt->finally_block() }, decls);
-                    }
-                    break;
+                    v[dest--] = std::move(tmp[j--]);
                 }
-                // TODO(zhuzilin) fill the other statements.
-                default:
-                    break;
             }
+            std::move(tmp.begin(), tmp.begin() + j + 1, v.begin() + (dest - j));
         }
     }
 
-    // 10.5 Declaration Binding Instantiation
-    inline void DeclarationBindingInstantiation(
-    Error* e, ExecutionContext* context, Parsing::AST* code, CodeType code_type, FunctionObject* f = nullptr, std::vector<JSValue*> args = {})
+    // A stable merge sort in the manner of TimSort: natural runs (strictly
+    // descending ones are reversed) are extended to a minimum length with binary
+    // insertion sort and kept on a stack whose lengths are merged to stay balanced.
+    // less is a user comparator in general, so nothing here may
+    // rely on it being consistent. It just has to leave a permutation of v.
+    template<typename T, typename Less>
+    void TimSort(std::vector<T>& v, Less less)
     {
-        auto env = context->variable_env()->env_rec();// 1
-        bool configurable_bindings = false;
-        Parsing::ProgramOrFunctionBody* body = static_cast<Parsing::ProgramOrFunctionBody*>(code);
-        if(code_type == CODE_EVAL)
+        size_t n = v.size();
+        if(n < 2)
         {
-            configurable_bindings = true;// 2
+            return;
         }
-        bool strict = body->strict();// 3
-        if(code_type == CODE_FUNC)
-        {// 4
-            assert(f != nullptr);
-            auto names = f->FormalParameters();// 4.a
-            Parsing::Function* func_ast = static_cast<Parsing::Function*>(code);
-            (void)func_ast;
-            size_t arg_count = args.size();// 4.b
-            size_t n = 0;// 4.c
-            for(const auto& arg_name : names)
-            {// 4.d
-                JSValue* v = Undefined::Instance();
-                if(n < arg_count)
-                {// 4.d.i & 4.d.ii
-                    v = args[n++];
-                }
-                bool arg_already_declared = env->HasBinding(arg_name);// 4.d.iii
-                if(!arg_already_declared)
-                {// 4.d.iv
-                    // NOTE(zhuzlin) I'm not sure if this should be false.
-                    env->CreateMutableBinding(e, arg_name, false);
-                    if(!e->IsOk())
+        size_t min_run = n;
+        bool has_low_bits = false;
+        while(min_run >= 32)
+        {
+            has_low_bits |= (min_run & 1) != 0;
+            min_run >>= 1;
+        }
+        min_run += has_low_bits;
+
+        std::vector<T> tmp;
+        std::vector<std::pair<size_t, size_t>> runs;// base, len
+        size_t lo = 0;
+        while(lo < n)
+        {
+            size_t run_end = lo + 1;
+            if(run_end < n)
+            {
+                if(less(v[run_end], v[lo]))
+                {
+                    run_end++;
+                    while(run_end < n && less(v[run_end], v[run_end - 1]))
                     {
-                        return;
+                        run_end++;
                     }
+                    std::reverse(v.begin() + lo, v.begin() + run_end);
                 }
-                env->SetMutableBinding(e, arg_name, v, strict);// 4.d.v
-                if(!e->IsOk())
+                else
                 {
-                    return;
+                    run_end++;
+                    while(run_end < n && !less(v[run_end], v[run_end - 1]))
+                    {
+                        run_end++;
+                    }
                 }
             }
-        }
-        // 5
-        for(Parsing::Function* func_decl : body->func_decls())
-        {
-            assert(func_decl->is_named());
-            std::string fn = func_decl->name();
-            FunctionObject* fo = InstantiateFunctionDeclaration(e, func_decl);
-            if(!e->IsOk())
+            size_t force = std::min(n - lo, min_run);
+            if(run_end - lo < force)
             {
-                return;
+                BinaryInsertionSort(v, lo, lo + force, run_end, less);
+                run_end = lo + force;
             }
-            bool func_already_declared = env->HasBinding(fn);
-            if(!func_already_declared)
-            {// 5.d
-                env->CreateMutableBinding(e, fn, configurable_bindings);
-                if(!e->IsOk())
+            runs.emplace_back(lo, run_end - lo);
+            lo = run_end;
+
+            while(runs.size() > 1)
+            {
+                size_t i = runs.size() - 2;
+                if((i >= 1 && runs[i - 1].second <= runs[i].second + runs[i + 1].second) ||
+                   (i >= 2 && runs[i - 2].second <= runs[i - 1].second + runs[i].second))
                 {
-                    return;
-                }
-            }
-            else
-            {// 5.e
-                auto go = GlobalObject::Instance();
-                auto existing_prop = go->GetProperty(fn);
-                assert(!existing_prop->IsUndefined());
-                auto existing_prop_desc = static_cast<PropertyDescriptor*>(existing_prop);
-                if(existing_prop_desc->Configurable())
-                {// 5.e.iii
-                    auto new_desc = new PropertyDescriptor();
-                    new_desc->SetDataDescriptor(Undefined::Instance(), true, true, configurable_bindings);
-                    go->DefineOwnProperty(e, fn, new_desc, true);
-                    if(!e->IsOk())
+                    if(runs[i - 1].second < runs[i + 1].second)
                     {
-                        return;
+                        i--;
                     }
                 }
-                else
-                {// 5.e.iv
-                    if(existing_prop_desc->IsAccessorDescriptor()
-                       || !(existing_prop_desc->HasConfigurable() && existing_prop_desc->Configurable()
-                            && existing_prop_desc->HasEnumerable() && existing_prop_desc->Enumerable()))
-                    {
-                        *e = *Error::TypeError();
-                        return;
-                    }
+                else if(runs[i].second > runs[i + 1].second)
+                {
+                    break;
                 }
+                MergeRuns(v, runs[i].first, runs[i].second, runs[i + 1].second, tmp, less);
+                runs[i].second += runs[i + 1].second;
+                runs.erase(runs.begin() + i + 1);
             }
-            env->SetMutableBinding(e, fn, fo, strict);// 5.f
         }
-        // 6
-        bool arguments_already_declared = env->HasBinding("arguments");
-        // 7
-        if(code_type == CODE_FUNC && !arguments_already_declared)
+        while(runs.size() > 1)
         {
-            auto args_obj = CreateArgumentsObject(f, args, context->variable_env(), strict);
-            if(strict)
-            {// 7.b
-                DeclarativeEnvironmentRecord* decl_env = static_cast<DeclarativeEnvironmentRecord*>(env);
-                decl_env->CreateImmutableBinding("arguments");
-                decl_env->InitializeImmutableBinding("arguments", args_obj);
-            }
-            else
-            {// 7.c
-                // NOTE(zhuzlin) I'm not sure if this should be false.
-                env->CreateMutableBinding(e, "arguments", false);
-                env->SetMutableBinding(e, "arguments", args_obj, false);
+            size_t i = runs.size() - 2;
+            if(i >= 1 && runs[i - 1].second < runs[i + 1].second)
+            {
+                i--;
             }
+            MergeRuns(v, runs[i].first, runs[i].second, runs[i + 1].second, tmp, less);
+            runs[i].second += runs[i + 1].second;
+            runs.erase(runs.begin() + i + 1);
         }
-        // 8
-        std::vector<Parsing::VarDecl*> decls;
-        FindAllVarDecl(body->statements(), decls);
-        for(Parsing::VarDecl* d : decls)
+    }
+
+    // LSD radix sort of int32 keys, one byte at a time. Stable.
+    inline void RadixSortInt32(std::vector<std::pair<uint32_t, JSValue*>>& v)
+    {
+        std::vector<std::pair<uint32_t, JSValue*>> tmp(v.size());
+        for(uint32_t shift = 0; shift < 32; shift += 8)
         {
-            std::string dn = d->ident();
-            bool var_already_declared = env->HasBinding(dn);
-            if(!var_already_declared)
+            size_t count[257] = { 0 };
+            for(auto& item : v)
             {
-                env->CreateMutableBinding(e, dn, configurable_bindings);
-                if(!e->IsOk())
-                {
-                    return;
-                }
-                env->SetMutableBinding(e, dn, Undefined::Instance(), strict);
-                if(!e->IsOk())
-                {
-                    return;
-                }
+                count[((item.first >> shift) & 0xff) + 1]++;
+            }
+            if(count[((v[0].first >> shift) & 0xff) + 1] == v.size())
+            {// every key has the same byte here
+                continue;
             }
+            for(size_t i = 1; i < 257; i++)
+            {
+                count[i] += count[i - 1];
+            }
+            for(auto& item : v)
+            {
+                tmp[count[(item.first >> shift) & 0xff]++] = item;
+            }
+            v.swap(tmp);
         }
     }
 
-    // 10.4.1
-    inline void EnterGlobalCode(Error* e, Parsing::AST* ast)
+    // Returns the name if ast is a bare identifier, the empty string otherwise.
+    inline std::string PlainIdentifier(Parsing::AST* ast)
     {
-        Parsing::ProgramOrFunctionBody* program;
-        if(ast->type() == Parsing::AST::AST_PROGRAM)
+        if(ast->type() == Parsing::AST::AST_EXPR_LHS)
         {
-            program = static_cast<Parsing::ProgramOrFunctionBody*>(ast);
+            Parsing::LHS* lhs = static_cast<Parsing::LHS*>(ast);
+            if(lhs->new_count() != 0 || !lhs->order().empty())
+            {
+                return "";
+            }
+            ast = lhs->base();
         }
-        else
+        if(ast->type() != Parsing::AST::AST_EXPR_IDENT)
         {
-            // TODO(zhuzilin) This is for test. Add test label like #ifdefine TEST
-            program = new Parsing::ProgramOrFunctionBody(Parsing::AST::AST_PROGRAM, false);
-            program->AddStatement(ast);
+            return "";
         }
-        // 1 10.4.1.1
-        LexicalEnvironment* global_env = LexicalEnvironment::Global();
-        ExecutionContext* context = new ExecutionContext(global_env, global_env, GlobalObject::Instance(), program->strict());
-        RuntimeContext::Global()->AddContext(context);
-        // 2
-        DeclarationBindingInstantiation(e, context, program, CODE_GLOBAL);
+        return ast->source();
     }
 
-    // 10.4.2
-    inline void EnterEvalCode(Error* e, Parsing::AST* ast)
+    // Recognizes comparators of the form function (a, b) { return a - b; }, returning
+    // 1 for a - b, -1 for b - a and 0 otherwise, so that sort can compare numbers natively.
+    inline int NumericComparatorDirection(JSObject* comparefn)
     {
-        assert(ast->type() == Parsing::AST::AST_PROGRAM);
-        Parsing::ProgramOrFunctionBody* program = static_cast<Parsing::ProgramOrFunctionBody*>(ast);
-        ExecutionContext* context;
-        LexicalEnvironment* variable_env;
-        LexicalEnvironment* lexical_env;
-        JSValue* this_binding;
-        if(!GlobalObject::Instance()->direct_eval())
-        {// 1
-            LexicalEnvironment* global_env = LexicalEnvironment::Global();
-            variable_env = global_env;
-            lexical_env = global_env;
-            this_binding = GlobalObject::Instance();
+        if(!comparefn->IsFunction())
+        {
+            return 0;
         }
-        else
-        {// 2
-            ExecutionContext* calling_context = RuntimeContext::TopContext();
-            variable_env = calling_context->variable_env();
-            lexical_env = calling_context->lexical_env();
-            this_binding = calling_context->this_binding();
+        FunctionObject* func = static_cast<FunctionObject*>(comparefn);
+        if(func->from_bind() || func->Code() == nullptr)
+        {
+            return 0;
         }
-        bool strict = RuntimeContext::TopContext()->strict() || (program->strict() && GlobalObject::Instance()->direct_eval());
-        if(strict)
-        {// 3
-            LexicalEnvironment* strict_var_env = LexicalEnvironment::NewDeclarativeEnvironment(lexical_env);
-            lexical_env = strict_var_env;
-            variable_env = strict_var_env;
+        const std::vector<std::string>& params = func->FormalParameters();
+        if(params.size() != 2 || params[0] == params[1])
+        {
+            return 0;
         }
-        context = new ExecutionContext(variable_env, lexical_env, this_binding, strict);
-        RuntimeContext::Global()->AddContext(context);
-        // 4
-        DeclarationBindingInstantiation(e, context, program, CODE_EVAL);
+        Parsing::ProgramOrFunctionBody* body = static_cast<Parsing::ProgramOrFunctionBody*>(func->Code());
+        if(!body->func_decls().empty() || body->statements().size() != 1)
+        {
+            return 0;
+        }
+        Parsing::AST* stmt = body->statements()[0];
+        if(stmt->type() != Parsing::AST::AST_STMT_RETURN)
+        {
+            return 0;
+        }
+        Parsing::AST* expr = static_cast<Parsing::Return*>(stmt)->expr();
+        while(expr != nullptr && expr->type() == Parsing::AST::AST_EXPR_PAREN)
+        {
+            expr = static_cast<Parsing::Paren*>(expr)->expr();
+        }
+        if(expr == nullptr || expr->type() != Parsing::AST::AST_EXPR_BINARY)
+        {
+            return 0;
+        }
+        Parsing::Binary* binary = static_cast<Parsing::Binary*>(expr);
+        if(binary->op() != "-")
+        {
+            return 0;
+        }
+        std::string lhs = PlainIdentifier(binary->lhs());
+        std::string rhs = PlainIdentifier(binary->rhs());
+        if(lhs == params[0] && rhs == params[1])
+        {
+            return 1;
+        }
+        if(lhs == params[1] && rhs == params[0])
+        {
+            return -1;
+        }
+        return 0;
     }
 
-    // 15.1.2.1 eval(X)
-    inline JSValue* GlobalObject::eval(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+    // 15.4.4.11 Array.prototype.sort (comparefn)
+    inline JSValue* ArrayProto::sort(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
     {
         (void)this_arg;
-        //log::PrintSource("enter GlobalObject::eval");
-        if(vals.empty())
+        JSObject* obj = ToObject(e, RuntimeContext::TopValue());
+        if(!e->IsOk())
         {
-            return Undefined::Instance();
+            return nullptr;
         }
-        if(!vals[0]->IsString())
+        double len = GetArrayLength(e, obj);
+        if(!e->IsOk())
         {
-            return vals[0];
+            return nullptr;
         }
-        std::string x = static_cast<String*>(vals[0])->data();
-        Parsing::Parser parser(x);
-        Parsing::AST* program = parser.ParseProgram();
-        if(program->IsIllegal())
+        JSValue* comparefn = vals.empty() ? Undefined::Instance() : vals[0];
+        if(!comparefn->IsUndefined() && !comparefn->IsCallable())
         {
-            *e = *Error::SyntaxError("failed to parse eval");
+            *e = Error::TypeError("The comparison function must be either a function or undefined");
             return nullptr;
         }
-        EnterEvalCode(e, program);
-        if(!e->IsOk())
+        // Holes sort after undefined, which sorts after everything
+        // else (SortCompare steps 1-7), so only the rest needs to be compared.
+        std::vector<JSValue*> items;
+        double undefined_count = 0;
+        bool all_numbers = true;
+        for(double k = 0; k < len; k++)
         {
-            return nullptr;
+            if(!HasElement(obj, k))
+            {
+                continue;
+            }
+            JSValue* element = GetElement(e, obj, k);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+            if(element->IsUndefined())
+            {
+                undefined_count++;
+            }
+            else
+            {
+                all_numbers = all_numbers && element->IsNumber();
+                items.emplace_back(element);
+            }
         }
-        Completion result = EvalProgram(program);
-        RuntimeContext::Global()->PopContext();
 
-        switch(result.type)
-        {
-            case Completion::NORMAL:
-                if(result.value != nullptr)
+        if(comparefn->IsUndefined())
+        {// 15.4.4.11 SortCompare 12-17, converting every element to a string only once
+            std::vector<std::pair<std::string, JSValue*>> keyed;
+            keyed.reserve(items.size());
+            for(JSValue* item : items)
+            {
+                if(item->IsString())
                 {
-                    return result.value;
+                    keyed.emplace_back(static_cast<String*>(item)->data(), item);
+                    continue;
                 }
-                else
+                keyed.emplace_back(::es::ToString(e, item), item);
+                if(!e->IsOk())
                 {
-                    return Undefined::Instance();
+                    return nullptr;
                 }
-            default:
+            }
+            TimSort(keyed, [](const std::pair<std::string, JSValue*>& x, const std::pair<std::string, JSValue*>& y) {
+                return x.first < y.first;
+            });
+            for(size_t i = 0; i < keyed.size(); i++)
             {
-                assert(result.type == Completion::THROWING);
-                std::string message = ::es::ToString(e, result.value);
-                if(result.value->IsObject())
+                items[i] = keyed[i].second;
+            }
+        }
+        else if(int direction = all_numbers ? NumericComparatorDirection(static_cast<JSObject*>(comparefn)) : 0)
+        {// comparefn is a - b or b - a, which needs no call for numbers
+            bool all_int32 = true;
+            for(JSValue* item : items)
+            {
+                all_int32 = all_int32 && IsInt32(static_cast<Number*>(item)->data());
+            }
+            if(all_int32 && items.size() > 64)
+            {
+                std::vector<std::pair<uint32_t, JSValue*>> keyed;
+                keyed.reserve(items.size());
+                for(JSValue* item : items)
                 {
-                    JSObject* obj = static_cast<JSObject*>(result.value);
-                    if(obj->obj_type() == JSObject::OBJ_ERROR)
-                    {
-                        message = static_cast<ErrorObject*>(obj)->ErrorMessage();
-                    }
+                    keyed.emplace_back(uint32_t(int32_t(static_cast<Number*>(item)->data())) ^ 0x80000000u, item);
+                }
+                RadixSortInt32(keyed);
+                if(direction < 0)
+                {// equal int32 values are indistinguishable, so reversing keeps it stable
+                    std::reverse(keyed.begin(), keyed.end());
+                }
+                for(size_t i = 0; i < keyed.size(); i++)
+                {
+                    items[i] = keyed[i].second;
+                }
+            }
+            else
+            {
+                std::vector<std::pair<double, JSValue*>> keyed;
+                keyed.reserve(items.size());
+                for(JSValue* item : items)
+                {
+                    keyed.emplace_back(static_cast<Number*>(item)->data(), item);
+                }
+                TimSort(keyed, [direction](const std::pair<double, JSValue*>& x, const std::pair<double, JSValue*>& y) {
+                    return (direction > 0 ? x.first - y.first : y.first - x.first) < 0;
+                });
+                for(size_t i = 0; i < keyed.size(); i++)
+                {
+                    items[i] = keyed[i].second;
                 }
-                *e = *Error::NativeError(message);
-                return result.value;
             }
-        }
-    }
-
-    // 10.4.3
-    inline void
-    EnterFunctionCode(Error* e, JSObject* f, Parsing::ProgramOrFunctionBody* body, JSValue* this_arg, const std::vector<JSValue*>& args, bool strict)
-    {
-        assert(f->obj_type() == JSObject::OBJ_FUNC);
-        FunctionObject* func = static_cast<FunctionObject*>(f);
-        JSValue* this_binding;
-        if(strict)
-        {// 1
-            this_binding = this_arg;
         }
         else
-        {// 2 & 3
-            this_binding = (this_arg->IsUndefined() || this_arg->IsNull()) ? GlobalObject::Instance() : this_arg;
+        {
+            JSObject* func = static_cast<JSObject*>(comparefn);
+            std::vector<JSValue*> args(2);
+            TimSort(items, [&](JSValue* x, JSValue* y) {
+                if(!e->IsOk())
+                {
+                    return false;
+                }
+                args[0] = x;
+                args[1] = y;
+                JSValue* res = func->Call(e, Undefined::Instance(), args);
+                if(!e->IsOk())
+                {
+                    return false;
+                }
+                double num = ToNumber(e, res);
+                if(!e->IsOk())
+                {
+                    return false;
+                }
+                return num < 0;
+            });
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
         }
-        LexicalEnvironment* local_env = LexicalEnvironment::NewDeclarativeEnvironment(func->Scope());
-        ExecutionContext* context = new ExecutionContext(local_env, local_env, this_binding, strict);// 8
-        RuntimeContext::Global()->AddContext(context);
-        // 9
-        DeclarationBindingInstantiation(e, context, body, CODE_FUNC, func, args);
+
+        double k = 0;
+        for(JSValue* element : items)
+        {
+            PutElement(e, obj, k++, element);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+        }
+        for(double i = 0; i < undefined_count; i++)
+        {
+            PutElement(e, obj, k++, Undefined::Instance());
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+        }
+        for(; k < len; k++)
+        {
+            DeleteElement(e, obj, k);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+        }
+        return obj;
     }
 
-    inline void InitGlobalObject()
+    // 15.4.4.12 Array.prototype.splice (start, deleteCount [ , item1 [ , item2 [ , … ] ] ] )
+    inline JSValue* ArrayProto::splice(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
     {
-        auto global_obj = GlobalObject::Instance();
-        // 15.1.1 Value Properties of the Global Object
-        global_obj->AddValueProperty("NaN", Number::NaN(), false, false, false);
-        global_obj->AddValueProperty("Infinity", Number::PositiveInfinity(), false, false, false);
-        global_obj->AddValueProperty("undefined", Undefined::Instance(), false, false, false);
-        // 15.1.2 Function Properties of the Global Object
-        global_obj->AddFuncProperty("eval", GlobalObject::eval, true, false, true);
-        global_obj->AddFuncProperty("parseInt", GlobalObject::parseInt, true, false, true);
-        global_obj->AddFuncProperty("parseFloat", GlobalObject::parseFloat, true, false, true);
-        global_obj->AddFuncProperty("isNaN", GlobalObject::isNaN, true, false, true);
-        global_obj->AddFuncProperty("isFinite", GlobalObject::isFinite, true, false, true);
-        // 15.1.3 URI Handling Function Properties
-        // TODO(zhuzilin)
-        // 15.1.4 Constructor Properties of the Global Object
-        global_obj->AddValueProperty("Object", ObjectConstructor::Instance(), true, false, true);
-        global_obj->AddValueProperty("Function", FunctionConstructor::Instance(), true, false, true);
-        global_obj->AddValueProperty("Number", NumberConstructor::Instance(), true, false, true);
-        global_obj->AddValueProperty("Boolean", BoolConstructor::Instance(), true, false, true);
-        global_obj->AddValueProperty("String", StringConstructor::Instance(), true, false, true);
-        global_obj->AddValueProperty("Array", ArrayConstructor::Instance(), true, false, true);
-
-        global_obj->AddValueProperty("Error", ErrorConstructor::Instance(), true, false, true);
-        // TODO(zhuzilin) differentiate errors.
-        global_obj->AddValueProperty("EvalError", ErrorConstructor::Instance(), true, false, true);
-        global_obj->AddValueProperty("RangeError", ErrorConstructor::Instance(), true, false, true);
-        global_obj->AddValueProperty("ReferenceError", ErrorConstructor::Instance(), true, false, true);
-        global_obj->AddValueProperty("SyntaxError", ErrorConstructor::Instance(), true, false, true);
-        global_obj->AddValueProperty("TypeError", ErrorConstructor::Instance(), true, false, true);
-        global_obj->AddValueProperty("URIError", ErrorConstructor::Instance(), true, false, true);
-
-        global_obj->AddValueProperty("console", Console::Instance(), true, false, true);
+        (void)this_arg;
+        JSObject* O = ToObject(e, RuntimeContext::TopValue());
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        ArrayObject* A = new ArrayObject(0);
+        double len = GetArrayLength(e, O);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        double actual_start = ToRelativeIndex(e, vals.empty() ? Undefined::Instance() : vals[0], len);// 5-6
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        // Like every engine does, a missing deleteCount removes
+        // everything after start.
+        double actual_delete_count = len - actual_start;
+        if(vals.size() > 1)
+        {// 7
+            actual_delete_count = ToInteger(e, vals[1]);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+            actual_delete_count = fmin(fmax(actual_delete_count, 0), len - actual_start);
+        }
+        std::vector<JSValue*> items;
+        if(vals.size() > 2)
+        {
+            items.assign(vals.begin() + 2, vals.end());
+        }
+        double item_count = items.size();
+        ArrayObject* src = ArrayObject::AsPacked(O);
+        if(src != nullptr && src->Length() == len && len - actual_delete_count + item_count <= 4294967295.0)
+        {
+            std::vector<JSValue*>& elements = src->elements();
+            auto first = elements.begin() + size_t(actual_start);
+            A->elements().assign(first, first + size_t(actual_delete_count));
+            A->SetLength(actual_delete_count);
+            if(item_count < actual_delete_count)
+            {
+                std::copy(items.begin(), items.end(), first);
+                elements.erase(first + size_t(item_count), first + size_t(actual_delete_count));
+            }
+            else
+            {
+                elements.insert(first + size_t(actual_delete_count), size_t(item_count - actual_delete_count), nullptr);
+                std::copy(items.begin(), items.end(), elements.begin() + size_t(actual_start));
+            }
+            src->SetLength(elements.size());
+            return A;
+        }
+        for(double k = 0; k < actual_delete_count; k++)
+        {// 9
+            double from = actual_start + k;
+            if(HasElement(O, from))
+            {
+                JSValue* from_value = GetElement(e, O, from);
+                if(!e->IsOk())
+                {
+                    return nullptr;
+                }
+                A->AddValueProperty(NumberToString(k), from_value, true, true, true);
+            }
+        }
+        A->Put(e, "length", new Number(actual_delete_count), true);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        if(item_count < actual_delete_count)
+        {// 12
+            for(double k = actual_start; k < len - actual_delete_count; k++)
+            {
+                double from = k + actual_delete_count;
+                double to = k + item_count;
+                if(HasElement(O, from))
+                {
+                    JSValue* from_value = GetElement(e, O, from);
+                    if(!e->IsOk())
+                    {
+                        return nullptr;
+                    }
+                    PutElement(e, O, to, from_value);
+                }
+                else
+                {
+                    DeleteElement(e, O, to);
+                }
+                if(!e->IsOk())
+                {
+                    return nullptr;
+                }
+            }
+            for(double k = len; k > len - actual_delete_count + item_count; k--)
+            {// 12.d
+                DeleteElement(e, O, k - 1);
+                if(!e->IsOk())
+                {
+                    return nullptr;
+                }
+            }
+        }
+        else if(item_count > actual_delete_count)
+        {// 13
+            for(double k = len - actual_delete_count; k > actual_start; k--)
+            {
+                double from = k + actual_delete_count - 1;
+                double to = k + item_count - 1;
+                if(HasElement(O, from))
+                {
+                    JSValue* from_value = GetElement(e, O, from);
+                    if(!e->IsOk())
+                    {
+                        return nullptr;
+                    }
+                    PutElement(e, O, to, from_value);
+                }
+                else
+                {
+                    DeleteElement(e, O, to);
+                }
+                if(!e->IsOk())
+                {
+                    return nullptr;
+                }
+            }
+        }
+        double k = actual_start;
+        for(JSValue* E : items)
+        {// 15
+            PutElement(e, O, k++, E);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+        }
+        O->Put(e, "length", new Number(len - actual_delete_count + item_count), true);// 16
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        return A;
     }
 
-    inline void InitObject()
+    // 15.4.4.13 Array.prototype.unshift ( [ item1 [ , item2 [ , … ] ] ] )
+    inline JSValue* ArrayProto::unshift(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
     {
-        ObjectConstructor* constructor = ObjectConstructor::Instance();
-        constructor->SetPrototype(FunctionProto::Instance());
-        // 15.2.3 Properties of the Object Constructor
-        constructor->AddValueProperty("prototype", ObjectProto::Instance(), false, false, false);
-        constructor->AddFuncProperty("toString", ObjectConstructor::toString, false, false, false);
-        // TODO(zhuzilin) check if the config is correct.
-        constructor->AddFuncProperty("getPrototypeOf", ObjectConstructor::getPrototypeOf, false, false, false);
-        constructor->AddFuncProperty("getOwnPropertyDescriptor", ObjectConstructor::getOwnPropertyDescriptor, false, false, false);
-        constructor->AddFuncProperty("getOwnPropertyNames", ObjectConstructor::getOwnPropertyNames, false, false, false);
-        constructor->AddFuncProperty("create", ObjectConstructor::create, false, false, false);
-        constructor->AddFuncProperty("defineProperty", ObjectConstructor::defineProperty, false, false, false);
-        constructor->AddFuncProperty("defineProperties", ObjectConstructor::defineProperties, false, false, false);
-        constructor->AddFuncProperty("seal", ObjectConstructor::seal, false, false, false);
-        constructor->AddFuncProperty("freeze", ObjectConstructor::freeze, false, false, false);
-        constructor->AddFuncProperty("preventExtensions", ObjectConstructor::preventExtensions, false, false, false);
-        constructor->AddFuncProperty("isSealed", ObjectConstructor::isSealed, false, false, false);
-        constructor->AddFuncProperty("isFrozen", ObjectConstructor::isFrozen, false, false, false);
-        constructor->AddFuncProperty("isExtensible", ObjectConstructor::isExtensible, false, false, false);
-        constructor->AddFuncProperty("keys", ObjectConstructor::keys, false, false, false);
-        // ES6
-        constructor->AddFuncProperty("setPrototypeOf", ObjectConstructor::setPrototypeOf, false, false, false);
-
-        ObjectProto* proto = ObjectProto::Instance();
-        // 15.2.4 Properties of the Object Prototype Object
-        proto->AddValueProperty("constructor", ObjectConstructor::Instance(), false, false, false);
-        proto->AddFuncProperty("toString", ObjectProto::toString, false, false, false);
-        proto->AddFuncProperty("toLocaleString", ObjectProto::toLocaleString, false, false, false);
-        proto->AddFuncProperty("valueOf", ObjectProto::valueOf, false, false, false);
-        proto->AddFuncProperty("hasOwnProperty", ObjectProto::hasOwnProperty, false, false, false);
-        proto->AddFuncProperty("isPrototypeOf", ObjectProto::isPrototypeOf, false, false, false);
-        proto->AddFuncProperty("propertyIsEnumerable", ObjectProto::propertyIsEnumerable, false, false, false);
+        (void)this_arg;
+        JSObject* O = ToObject(e, RuntimeContext::TopValue());
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        double len = GetArrayLength(e, O);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        double arg_count = vals.size();
+        ArrayObject* A = ArrayObject::AsPacked(O);
+        if(A != nullptr && len + arg_count <= 4294967295.0)
+        {
+            A->elements().insert(A->elements().begin(), vals.begin(), vals.end());
+            A->SetLength(A->elements().size());
+            return new Number(A->Length());
+        }
+        for(double k = len; k > 0; k--)
+        {// 6
+            double from = k - 1;
+            double to = k + arg_count - 1;
+            if(HasElement(O, from))
+            {
+                JSValue* from_value = GetElement(e, O, from);
+                if(!e->IsOk())
+                {
+                    return nullptr;
+                }
+                PutElement(e, O, to, from_value);
+            }
+            else
+            {
+                DeleteElement(e, O, to);
+            }
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+        }
+        double j = 0;
+        for(JSValue* E : vals)
+        {// 9
+            PutElement(e, O, j++, E);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+        }
+        Number* num = new Number(len + arg_count);
+        O->Put(e, "length", num, true);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        return num;
     }
 
-    inline void InitFunction()
+    // 15.4.4.14 Array.prototype.indexOf ( searchElement [ , fromIndex ] )
+    inline JSValue* ArrayProto::indexOf(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
     {
-        FunctionConstructor* constructor = FunctionConstructor::Instance();
-        constructor->SetPrototype(FunctionProto::Instance());
-        // 15.3.3 Properties of the Function Constructor
-        constructor->AddValueProperty("prototype", FunctionProto::Instance(), false, false, false);
-        constructor->AddValueProperty("length", Number::One(), false, false, false);
-        constructor->AddFuncProperty("toString", FunctionConstructor::toString, false, false, false);
-
-        FunctionProto* proto = FunctionProto::Instance();
-        proto->SetPrototype(ObjectProto::Instance());
-        // 15.2.4 Properties of the Function Prototype Function
-        proto->AddValueProperty("constructor", FunctionConstructor::Instance(), false, false, false);
-        proto->AddFuncProperty("toString", FunctionProto::toString, false, false, false);
-        proto->AddFuncProperty("apply", FunctionProto::apply, false, false, false);
-        proto->AddFuncProperty("call", FunctionProto::call, false, false, false);
-        proto->AddFuncProperty("bind", FunctionProto::bind, false, false, false);
+        (void)this_arg;
+        JSObject* O = ToObject(e, RuntimeContext::TopValue());
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        double len = GetArrayLength(e, O);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        if(len == 0)
+        {// 4
+            return new Number(-1);
+        }
+        double n = 0;
+        if(vals.size() > 1)
+        {// 5
+            n = ToInteger(e, vals[1]);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+        }
+        if(n >= len)
+        {// 6
+            return new Number(-1);
+        }
+        double k = n >= 0 ? n : fmax(len + n, 0);// 7-8
+        JSValue* search_element = vals.empty() ? Undefined::Instance() : vals[0];
+        for(; k < len; k++)
+        {// 9
+            if(!HasElement(O, k))
+            {
+                continue;
+            }
+            JSValue* element_k = GetElement(e, O, k);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+            if(StrictEqual(e, search_element, element_k))
+            {
+                return new Number(k);
+            }
+        }
+        return new Number(-1);
     }
 
-    inline void InitNumber()
+    // 15.4.4.15 Array.prototype.lastIndexOf ( searchElement [ , fromIndex ] )
+    inline JSValue* ArrayProto::lastIndexOf(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
     {
-        NumberConstructor* constructor = NumberConstructor::Instance();
-        constructor->SetPrototype(FunctionProto::Instance());
-        // 15.3.3 Properties of the Number Constructor
-        constructor->AddValueProperty("prototype", NumberProto::Instance(), false, false, false);
-        constructor->AddValueProperty("length", Number::One(), false, false, false);
-        constructor->AddValueProperty("MAX_VALUE", new Number(1.7976931348623157e308), false, false, false);
-        constructor->AddValueProperty("MIN_VALUE", new Number(5e-324), false, false, false);
-        constructor->AddValueProperty("NaN", Number::NaN(), false, false, false);
-        constructor->AddValueProperty("NEGATIVE_INFINITY", Number::PositiveInfinity(), false, false, false);
-        constructor->AddValueProperty("POSITIVE_INFINITY", Number::NegativeInfinity(), false, false, false);
-
-        NumberProto* proto = NumberProto::Instance();
-        proto->SetPrototype(ObjectProto::Instance());
-        // 15.2.4 Properties of the Number Prototype Number
-        proto->AddValueProperty("constructor", NumberConstructor::Instance(), false, false, false);
-        proto->AddFuncProperty("toString", NumberProto::toString, false, false, false);
-        proto->AddFuncProperty("toLocaleString", NumberProto::toLocaleString, false, false, false);
-        proto->AddFuncProperty("valueOf", NumberProto::valueOf, false, false, false);
-        proto->AddFuncProperty("toFixed", NumberProto::toFixed, false, false, false);
-        proto->AddFuncProperty("toExponential", NumberProto::toExponential, false, false, false);
-        proto->AddFuncProperty("toPrecision", NumberProto::toPrecision, false, false, false);
+        (void)this_arg;
+        JSObject* O = ToObject(e, RuntimeContext::TopValue());
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        double len = GetArrayLength(e, O);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        if(len == 0)
+        {// 4
+            return new Number(-1);
+        }
+        double n = len - 1;
+        if(vals.size() > 1)
+        {// 5
+            n = ToInteger(e, vals[1]);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+        }
+        double k = n >= 0 ? fmin(n, len - 1) : len + n;// 6-7
+        JSValue* search_element = vals.empty() ? Undefined::Instance() : vals[0];
+        for(; k >= 0; k--)
+        {// 8
+            if(!HasElement(O, k))
+            {
+                continue;
+            }
+            JSValue* element_k = GetElement(e, O, k);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+            if(StrictEqual(e, search_element, element_k))
+            {
+                return new Number(k);
+            }
+        }
+        return new Number(-1);
     }
 
-    inline void InitError()
+    // 15.4.4.16 Array.prototype.every ( callbackfn [ , thisArg ] )
+    inline JSValue* ArrayProto::every(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
     {
-        ErrorConstructor* constructor = ErrorConstructor::Instance();
-        constructor->SetPrototype(FunctionProto::Instance());
-        // 15.11.3 Properties of the Error Constructor
-        constructor->AddValueProperty("prototype", ErrorProto::Instance(), false, false, false);
-        constructor->AddValueProperty("length", Number::One(), false, false, false);
-        constructor->AddFuncProperty("toString", NumberConstructor::toString, false, false, false);
-
-        ErrorProto* proto = ErrorProto::Instance();
-        proto->SetPrototype(ObjectProto::Instance());
-        // 15.11.4 Properties of the Error Prototype Object
-        proto->AddValueProperty("constructor", ErrorConstructor::Instance(), false, false, false);
-        proto->AddValueProperty("name", new String("Error"), false, false, false);
-        proto->AddValueProperty("message", String::Empty(), true, false, false);
-        proto->AddFuncProperty("call", ErrorProto::toString, false, false, false);
+        (void)this_arg;
+        JSObject* O = ToObject(e, RuntimeContext::TopValue());
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        double len = GetArrayLength(e, O);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        if(vals.empty() || !vals[0]->IsCallable())
+        {// 4
+            *e = Error::TypeError("Array.prototype.every called on non-callable");
+            return nullptr;
+        }
+        JSObject* callbackfn = static_cast<JSObject*>(vals[0]);
+        JSValue* T = vals.size() < 2 ? Undefined::Instance() : vals[1];
+        for(double k = 0; k < len; k++)
+        {// 7
+            if(!HasElement(O, k))
+            {
+                continue;
+            }
+            JSValue* k_value = GetElement(e, O, k);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+            JSValue* test_result = callbackfn->Call(e, T, { k_value, new Number(k), O });
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+            if(!ToBoolean(test_result))
+            {
+                return Bool::False();
+            }
+        }
+        return Bool::True();
     }
 
-    inline void InitBool()
+    // 15.4.4.17 Array.prototype.some ( callbackfn [ , thisArg ] )
+    inline JSValue* ArrayProto::some(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
     {
-        BoolConstructor* constructor = BoolConstructor::Instance();
-        constructor->SetPrototype(FunctionProto::Instance());
-        // 15.6.3 Properties of the Boolean Constructor
-        constructor->AddValueProperty("prototype", BoolProto::Instance(), false, false, false);
-        constructor->AddFuncProperty("toString", BoolConstructor::toString, false, false, false);
-
-        BoolProto* proto = BoolProto::Instance();
-        proto->SetPrototype(ObjectProto::Instance());
-        // 15.6.4 Properties of the Boolean Prototype Object
-        proto->AddValueProperty("constructor", BoolConstructor::Instance(), false, false, false);
-        proto->AddFuncProperty("toString", BoolProto::toString, false, false, false);
-        proto->AddFuncProperty("valueOf", BoolProto::valueOf, false, false, false);
+        (void)this_arg;
+        JSObject* O = ToObject(e, RuntimeContext::TopValue());
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        double len = GetArrayLength(e, O);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        if(vals.empty() || !vals[0]->IsCallable())
+        {// 4
+            *e = Error::TypeError("Array.prototype.some called on non-callable");
+            return nullptr;
+        }
+        JSObject* callbackfn = static_cast<JSObject*>(vals[0]);
+        JSValue* T = vals.size() < 2 ? Undefined::Instance() : vals[1];
+        for(double k = 0; k < len; k++)
+        {// 7
+            if(!HasElement(O, k))
+            {
+                continue;
+            }
+            JSValue* k_value = GetElement(e, O, k);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+            JSValue* test_result = callbackfn->Call(e, T, { k_value, new Number(k), O });
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+            if(ToBoolean(test_result))
+            {
+                return Bool::True();
+            }
+        }
+        return Bool::False();
     }
 
-    inline void InitString()
+    // 15.4.4.18 Array.prototype.forEach ( callbackfn [ , thisArg ] )
+    inline JSValue* ArrayProto::forEach(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
     {
-        StringConstructor* constructor = StringConstructor::Instance();
-        constructor->SetPrototype(FunctionProto::Instance());
-        // 15.3.3 Properties of the String Constructor
-        constructor->AddValueProperty("prototype", StringProto::Instance(), false, false, false);
-        constructor->AddValueProperty("length", Number::One(), true, false, false);
-        constructor->AddFuncProperty("fromCharCode", StringConstructor::fromCharCode, false, false, false);
-        constructor->AddFuncProperty("toString", StringConstructor::toString, false, false, false);
+        (void)this_arg;
+        JSObject* O = ToObject(e, RuntimeContext::TopValue());
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        size_t len = ToNumber(e, O->Get(e, "length"));
+        if(vals.empty() || !vals[0]->IsCallable())
+        {// 4
+            *e = Error::TypeError("Array.prototype.forEach called on non-callable");
+            return nullptr;
+        }
+        JSObject* callbackfn = static_cast<JSObject*>(vals[0]);
+        JSValue* T;
+        if(vals.size() < 2)
+        {
+            T = Undefined::Instance();
+        }
+        else
+        {
+            T = vals[1];
+        }
+        ArrayObject* A = new ArrayObject(len);
+        (void)A;
+        for(size_t k = 0; k < len; k++)
+        {
+            std::string p_k = NumberToString(k);
+            bool k_present = O->HasProperty(p_k);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+            if(k_present)
+            {
+                JSValue* k_value = O->Get(e, p_k);
+                if(!e->IsOk())
+                {
+                    return nullptr;
+                }
+                JSValue* mapped_value = callbackfn->Call(e, T, { k_value, new Number(k), O });
+                (void)mapped_value;
+                if(!e->IsOk())
+                {
+                    return nullptr;
+                }
+            }
+        }
+        return Undefined::Instance();
+    }
 
-        StringProto* proto = StringProto::Instance();
-        proto->SetPrototype(ObjectProto::Instance());
-        // 15.2.4 Properties of the String Prototype String
-        proto->AddValueProperty("constructor", StringConstructor::Instance(), false, false, false);
-        proto->AddFuncProperty("toString", StringProto::toString, false, false, false);
-        proto->AddFuncProperty("valueOf", StringProto::valueOf, false, false, false);
-        proto->AddFuncProperty("charAt", StringProto::charAt, false, false, false);
-        proto->AddFuncProperty("charCodeAt", StringProto::charCodeAt, false, false, false);
-        proto->AddFuncProperty("concat", StringProto::concat, false, false, false);
-        proto->AddFuncProperty("indexOf", StringProto::indexOf, false, false, false);
-        proto->AddFuncProperty("lastIndexOf", StringProto::lastIndexOf, false, false, false);
-        proto->AddFuncProperty("localeCompare", StringProto::localeCompare, false, false, false);
-        proto->AddFuncProperty("match", StringProto::match, false, false, false);
-        proto->AddFuncProperty("replace", StringProto::replace, false, false, false);
-        proto->AddFuncProperty("search", StringProto::search, false, false, false);
-        proto->AddFuncProperty("slice", StringProto::slice, false, false, false);
-        proto->AddFuncProperty("split", StringProto::split, false, false, false);
-        proto->AddFuncProperty("substring", StringProto::substring, false, false, false);
-        proto->AddFuncProperty("toLowerCase", StringProto::toLowerCase, false, false, false);
-        proto->AddFuncProperty("toLocaleLowerCase", StringProto::toLocaleLowerCase, false, false, false);
-        proto->AddFuncProperty("toUpperCase", StringProto::toUpperCase, false, false, false);
-        proto->AddFuncProperty("toLocaleUpperCase", StringProto::toLocaleUpperCase, false, false, false);
-        proto->AddFuncProperty("trim", StringProto::trim, false, false, false);
+    // 15.4.4.19 Array.prototype.map ( callbackfn [ , thisArg ] )
+    inline JSValue* ArrayProto::map(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+    {
+        (void)this_arg;
+        JSObject* O = ToObject(e, RuntimeContext::TopValue());
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        size_t len = ToNumber(e, O->Get(e, "length"));
+        if(vals.empty() || !vals[0]->IsCallable())
+        {// 4
+            *e = Error::TypeError("Array.prototype.map called on non-callable");
+            return nullptr;
+        }
+        JSObject* callbackfn = static_cast<JSObject*>(vals[0]);
+        JSValue* T;
+        if(vals.size() < 2)
+        {
+            T = Undefined::Instance();
+        }
+        else
+        {
+            T = vals[1];
+        }
+        ArrayObject* A = new ArrayObject(len);
+        (void)A;
+        for(size_t k = 0; k < len; k++)
+        {
+            std::string p_k = NumberToString(k);
+            bool k_present = O->HasProperty(p_k);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+            if(k_present)
+            {
+                JSValue* k_value = O->Get(e, p_k);
+                if(!e->IsOk())
+                {
+                    return nullptr;
+                }
+                JSValue* mapped_value = callbackfn->Call(e, T, { k_value, new Number(k), O });
+                if(!e->IsOk())
+                {
+                    return nullptr;
+                }
+                A->AddValueProperty(p_k, mapped_value, true, true, true);
+            }
+        }
+        return A;
     }
 
-    inline void InitArray()
+    // 15.4.4.20 Array.prototype.filter ( callbackfn [ , thisArg ] )
+    inline JSValue* ArrayProto::filter(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
     {
-        ArrayConstructor* constructor = ArrayConstructor::Instance();
-        constructor->SetPrototype(FunctionProto::Instance());
-        // 15.6.3 Properties of the Arrayean Constructor
-        constructor->AddValueProperty("length", Number::One(), false, false, false);
-        constructor->AddValueProperty("prototype", ArrayProto::Instance(), false, false, false);
-        constructor->AddFuncProperty("isArray", ArrayConstructor::isArray, false, false, false);
-        constructor->AddFuncProperty("toString", ArrayConstructor::toString, false, false, false);
+        (void)this_arg;
+        JSObject* O = ToObject(e, RuntimeContext::TopValue());
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        size_t len = ToNumber(e, O->Get(e, "length"));
+        if(vals.empty() || !vals[0]->IsCallable())
+        {// 4
+            *e = Error::TypeError("Array.prototype.filter called on non-callable");
+            return nullptr;
+        }
+        JSObject* callbackfn = static_cast<JSObject*>(vals[0]);
+        JSValue* T;
+        if(vals.size() < 2)
+        {
+            T = Undefined::Instance();
+        }
+        else
+        {
+            T = vals[1];
+        }
+        size_t to = 0;
+        ArrayObject* A = new ArrayObject(len);
+        for(size_t k = 0; k < len; k++)
+        {
+            std::string p_k = NumberToString(k);
+            bool k_present = O->HasProperty(p_k);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+            if(k_present)
+            {
+                JSValue* k_value = O->Get(e, p_k);
+                if(!e->IsOk())
+                {
+                    return nullptr;
+                }
+                JSValue* selected = callbackfn->Call(e, T, { k_value, new Number(k), O });
+                if(!e->IsOk())
+                {
+                    return nullptr;
+                }
+                if(ToBoolean(selected))
+                {
+                    A->AddValueProperty(NumberToString(to), k_value, true, true, true);
+                    to++;
+                }
+            }
+        }
+        return A;
+    }
 
-        ArrayProto* proto = ArrayProto::Instance();
-        proto->SetPrototype(ObjectProto::Instance());
-        // 15.6.4 Properties of the Arrayean Prototype Object
-        proto->AddValueProperty("length", Number::Zero(), false, false, false);
-        proto->AddValueProperty("constructor", ArrayConstructor::Instance(), false, false, false);
-        proto->AddFuncProperty("toString", ArrayProto::toString, false, false, false);
-        proto->AddFuncProperty("toLocaleString", ArrayProto::toLocaleString, false, false, false);
-        proto->AddFuncProperty("concat", ArrayProto::concat, false, false, false);
-        proto->AddFuncProperty("join", ArrayProto::join, false, false, false);
-        proto->AddFuncProperty("pop", ArrayProto::pop, false, false, false);
-        proto->AddFuncProperty("push", ArrayProto::push, false, false, false);
-        proto->AddFuncProperty("reverse", ArrayProto::reverse, false, false, false);
-        proto->AddFuncProperty("shift", ArrayProto::shift, false, false, false);
-        proto->AddFuncProperty("slice", ArrayProto::slice, false, false, false);
-        proto->AddFuncProperty("sort", ArrayProto::sort, false, false, false);
-        proto->AddFuncProperty("splice", ArrayProto::splice, false, false, false);
-        proto->AddFuncProperty("unshift", ArrayProto::unshift, false, false, false);
-        proto->AddFuncProperty("indexOf", ArrayProto::indexOf, false, false, false);
-        proto->AddFuncProperty("lastIndexOf", ArrayProto::lastIndexOf, false, false, false);
-        proto->AddFuncProperty("every", ArrayProto::every, false, false, false);
-        proto->AddFuncProperty("some", ArrayProto::some, false, false, false);
-        proto->AddFuncProperty("forEach", ArrayProto::forEach, false, false, false);
-        proto->AddFuncProperty("map", ArrayProto::map, false, false, false);
-        proto->AddFuncProperty("filter", ArrayProto::filter, false, false, false);
-        proto->AddFuncProperty("reduce", ArrayProto::reduce, false, false, false);
-        proto->AddFuncProperty("reduceRight", ArrayProto::reduceRight, false, false, false);
+    inline JSValue* StringProto::replace(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+    {
+        (void)this_arg;
+        JSValue* val = RuntimeContext::TopValue();
+        val->CheckObjectCoercible(e);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        std::string S = ::es::ToString(e, val);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        JSValue* search_value = vals.empty() ? Undefined::Instance() : vals[0];
+        JSValue* replace_value = vals.size() < 2 ? Undefined::Instance() : vals[1];
+        // There is no RegExp yet, so searchValue is always
+        // converted to a string and only its first occurrence is replaced.
+        std::string search_str = ::es::ToString(e, search_value);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        bool functional = replace_value->IsCallable();
+        std::string replace_str;
+        if(!functional)
+        {
+            replace_str = ::es::ToString(e, replace_value);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+        }
+        size_t pos = search::Find(S, search_str);
+        if(pos == search::npos)
+        {
+            return val->IsString() ? val : new String(S);
+        }
+        size_t tail = pos + search_str.size();
+        std::string replacement;
+        if(functional)
+        {
+            JSValue* res = static_cast<JSObject*>(replace_value)->Call(e, Undefined::Instance(), { new String(search_str), new Number(pos), new String(S) });
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+            replacement = ::es::ToString(e, res);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+        }
+        else if(replace_str.find('$') == std::string::npos)
+        {
+            replacement = std::move(replace_str);
+        }
+        else
+        {// Table 22
+            replacement.reserve(replace_str.size());
+            for(size_t i = 0; i < replace_str.size(); i++)
+            {
+                char c = replace_str[i];
+                if(c != '$' || i + 1 == replace_str.size())
+                {
+                    replacement += c;
+                    continue;
+                }
+                switch(replace_str[i + 1])
+                {
+                    case '$':
+                        replacement += '$';
+                        break;
+                    case '&':
+                        replacement += search_str;
+                        break;
+                    case '`':
+                        replacement.append(S, 0, pos);
+                        break;
+                    case '\'':
+                        replacement.append(S, tail, std::string::npos);
+                        break;
+                    default:
+                        replacement += c;
+                        continue;
+                }
+                i++;
+            }
+        }
+        std::string R;
+        R.reserve(S.size() - search_str.size() + replacement.size());
+        R.append(S, 0, pos);
+        R += replacement;
+        R.append(S, tail, std::string::npos);
+        return new String(R);
     }
 
-    inline void Init()
+    inline JSValue* StringProto::split(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
     {
-        InitGlobalObject();
-        InitObject();
-        InitFunction();
-        InitNumber();
-        InitError();
-        InitBool();
-        InitString();
-        InitArray();
+        (void)this_arg;
+        JSValue* val = RuntimeContext::TopValue();
+        val->CheckObjectCoercible(e);// 1
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        std::string S = ::es::ToString(e, val);// 2
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        ArrayObject* A = new ArrayObject(0);// 3
+        double lim = 4294967295.0;// 5
+        if(vals.size() >= 2 && !vals[1]->IsUndefined())
+        {
+            lim = ToUint32(e, vals[1]);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+        }
+        JSValue* separator = vals.empty() ? Undefined::Instance() : vals[0];
+        std::string R;
+        if(!separator->IsUndefined())
+        {// 8
+            R = ::es::ToString(e, separator);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+        }
+        if(lim == 0)
+        {// 9
+            return A;
+        }
+        std::vector<JSValue*>& elements = A->elements();
+        if(separator->IsUndefined())
+        {// 10
+            elements.push_back(val->IsString() ? val : new String(S));
+            A->SetLength(1);
+            return A;
+        }
+        size_t s = S.size();
+        if(s == 0)
+        {// 11
+            if(!R.empty())
+            {
+                elements.push_back(String::Empty());
+                A->SetLength(1);
+            }
+            return A;
+        }
+        const char* data = S.data();
+        size_t p = 0;
+        if(R.empty())
+        {
+            // Strings are stored as UTF-8, so an empty separator
+            // splits between code points rather than between code units.
+            while(p < s && elements.size() < lim)
+            {
+                size_t q = p + 1;
+                while(q < s && (static_cast<unsigned char>(data[q]) & 0xC0) == 0x80)
+                {
+                    q++;
+                }
+                elements.push_back(new String(data + p, q - p));
+                p = q;
+            }
+            A->SetLength(elements.size());
+            return A;
+        }
+        for(size_t q = search::Find(S, R, p); q != search::npos; q = search::Find(S, R, p))
+        {// 13
+            elements.push_back(new String(data + p, q - p));
+            if(elements.size() == lim)
+            {
+                A->SetLength(lim);
+                return A;
+            }
+            p = q + R.size();
+        }
+        elements.push_back(new String(data + p, s - p));// 14 - 16
+        A->SetLength(elements.size());
+        return A;
     }
 
-    JSValue* ToPrimitive(Error* e, JSValue* input, const std::string& preferred_type);
-    bool ToBoolean(JSValue* input);
-    double StringToNumber(const std::string& source);
-    double StringToNumber(String* str);
-    double ToNumber(Error* e, JSValue* input);
-    double ToInteger(Error* e, JSValue* input);
-    double ToInt32(Error* e, JSValue* input);
-    double ToUint(Error* e, JSValue* input, char bits);
-    double ToUint32(Error* e, JSValue* input);
-    double ToUint16(Error* e, JSValue* input);
-    std::string NumberToString(double m);
-    std::string NumberToString(Number* num);
-    std::string ToString(Error* e, JSValue* input);
+    // ES6 24.1 ArrayBuffer Objects and 22.2 TypedArray Objects
+    //
+    // Typed arrays keep their elements as raw bytes in the
+    // ArrayBuffer they view, so indexed access never goes through
+    // named_properties_. A view is only a (buffer, byte offset, length) triple,
+    // which makes subarray free. Like ArrayObject, length, byteLength,
+    // byteOffset and buffer are exposed as own read-only properties.
+    enum TypedArrayType
+    {
+        TYPED_INT8,
+        TYPED_UINT8,
+        TYPED_UINT8_CLAMPED,
+        TYPED_INT16,
+        TYPED_UINT16,
+        TYPED_INT32,
+        TYPED_UINT32,
+        TYPED_FLOAT32,
+        TYPED_FLOAT64,
+
+        TYPED_NUM,
+    };
 
-    JSObject* ToObject(Error* e, JSValue* input);
+    inline size_t TypedArrayElementSize(TypedArrayType type)
+    {
+        static const size_t sizes[TYPED_NUM] = { 1, 1, 1, 2, 2, 4, 4, 4, 8 };
+        return sizes[type];
+    }
 
-    // 11.8.5 The Abstract Relational Comparison Algorithm
-    // x < y
-    JSValue* LessThan(Error* e, JSValue* x, JSValue* y, bool left_first = true);
-    // 11.9.3 The Abstract Equality Comparison Algorithm
-    // x == y
-    bool Equal(Error* e, JSValue* x, JSValue* y);
-    // 11.9.6 The Strict Equality Comparison Algorithm
-    // x === y
-    bool StrictEqual(Error* e, JSValue* x, JSValue* y);
+    inline std::string TypedArrayName(TypedArrayType type)
+    {
+        static const char* names[TYPED_NUM] = {
+            "Int8Array", "Uint8Array", "Uint8ClampedArray", "Int16Array", "Uint16Array",
+            "Int32Array", "Uint32Array", "Float32Array", "Float64Array",
+        };
+        return names[type];
+    }
+
+    class ArrayBufferProto : public JSObject
+    {
+    public:
+        static ArrayBufferProto* Instance()
+        {
+            static ArrayBufferProto singleton;
+            return &singleton;
+        }
+
+        // ES6 24.1.4.3 ArrayBuffer.prototype.slice (start, end)
+        static JSValue* slice(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
+
+    private:
+        ArrayBufferProto() : JSObject(OBJ_OTHER, "ArrayBuffer", true, nullptr, false, false)
+        {
+        }
+    };
+
+    class ArrayBufferObject : public JSObject
+    {
+    public:
+        static constexpr double kMaxByteLength = 2147483647.0;
+
+        ArrayBufferObject(size_t byte_length) : JSObject(OBJ_ARRAY_BUFFER, "ArrayBuffer", true, nullptr, false, false), data_(byte_length, 0)
+        {
+            SetPrototype(ArrayBufferProto::Instance());
+            AddValueProperty("byteLength", new Number(byte_length), false, false, false);
+        }
+
+        static ArrayBufferObject* Cast(JSValue* V)
+        {
+            if(!V->IsObject() || static_cast<JSObject*>(V)->obj_type() != OBJ_ARRAY_BUFFER)
+            {
+                return nullptr;
+            }
+            return static_cast<ArrayBufferObject*>(V);
+        }
+
+        uint8_t* data()
+        {
+            return data_.data();
+        }
+
+        size_t ByteLength()
+        {
+            return data_.size();
+        }
+
+    private:
+        std::vector<uint8_t> data_;
+    };
+
+    class ArrayBufferConstructor : public JSObject
+    {
+    public:
+        static ArrayBufferConstructor* Instance()
+        {
+            static ArrayBufferConstructor singleton;
+            return &singleton;
+        }
+
+        JSValue* Call(Error* e, JSValue* this_arg, const std::vector<JSValue*>& arguments = {}) override
+        {
+            (void)this_arg;
+            (void)arguments;
+            *e = Error::TypeError("Constructor ArrayBuffer requires 'new'");
+            return nullptr;
+        }
+
+        // ES6 24.1.2.1 ArrayBuffer ( length )
+        JSObject* Construct(Error* e, const std::vector<JSValue*>& arguments) override
+        {
+            double len = 0;
+            if(!arguments.empty())
+            {
+                len = ToInteger(e, arguments[0]);
+                if(!e->IsOk())
+                {
+                    return nullptr;
+                }
+            }
+            if(len < 0 || len > ArrayBufferObject::kMaxByteLength)
+            {
+                *e = Error::RangeError("Invalid array buffer length");
+                return nullptr;
+            }
+            return new ArrayBufferObject(len);
+        }
+
+        // ES6 24.1.3.1 ArrayBuffer.isView ( arg )
+        static JSValue* isView(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+        {
+            (void)e;
+            (void)this_arg;
+            if(vals.empty() || !vals[0]->IsObject())
+            {
+                return Bool::False();
+            }
+            return Bool::Wrap(static_cast<JSObject*>(vals[0])->obj_type() == OBJ_TYPED_ARRAY);
+        }
+
+        static JSValue* toString(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+        {
+            (void)e;
+            (void)this_arg;
+            (void)vals;
+            return new String("function ArrayBuffer() { [native code] }");
+        }
+
+    private:
+        ArrayBufferConstructor() : JSObject(OBJ_OTHER, "ArrayBuffer", true, nullptr, true, true)
+        {
+        }
+    };
+
+    class TypedArrayProto : public JSObject
+    {
+    public:
+        static TypedArrayProto* Instance(TypedArrayType type)
+        {
+            static TypedArrayProto* singletons[TYPED_NUM] = { nullptr };
+            if(singletons[type] == nullptr)
+            {
+                singletons[type] = new TypedArrayProto(type);
+            }
+            return singletons[type];
+        }
+
+        // ES6 22.2.3.22 %TypedArray%.prototype.set ( array [ , offset ] )
+        static JSValue* set(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
+        // ES6 22.2.3.26 %TypedArray%.prototype.subarray( [ begin [ , end ] ] )
+        static JSValue* subarray(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
+        // ES6 22.2.3.8 %TypedArray%.prototype.fill (value [ , start [ , end ] ] )
+        static JSValue* fill(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals);
+
+    private:
+        TypedArrayProto(TypedArrayType type) : JSObject(OBJ_OTHER, TypedArrayName(type), true, nullptr, false, false)
+        {
+        }
+    };
+
+    class TypedArrayObject : public JSObject
+    {
+    public:
+        TypedArrayObject(TypedArrayType type, ArrayBufferObject* buffer, size_t byte_offset, size_t length)
+        : JSObject(OBJ_TYPED_ARRAY, TypedArrayName(type), true, nullptr, false, false), type_(type), buffer_(buffer),
+          byte_offset_(byte_offset), length_(length)
+        {
+            SetPrototype(TypedArrayProto::Instance(type));
+        }
+
+        static TypedArrayObject* Cast(JSValue* V)
+        {
+            if(!V->IsObject() || static_cast<JSObject*>(V)->obj_type() != OBJ_TYPED_ARRAY)
+            {
+                return nullptr;
+            }
+            return static_cast<TypedArrayObject*>(V);
+        }
+
+        TypedArrayType type()
+        {
+            return type_;
+        }
+
+        ArrayBufferObject* buffer()
+        {
+            return buffer_;
+        }
+
+        size_t ByteOffset()
+        {
+            return byte_offset_;
+        }
+
+        size_t Length()
+        {
+            return length_;
+        }
+
+        size_t ByteLength()
+        {
+            return length_ * TypedArrayElementSize(type_);
+        }
+
+        uint8_t* data()
+        {
+            return buffer_->data() + byte_offset_;
+        }
+
+        double GetIndex(size_t index)
+        {
+            uint8_t* p = data() + index * TypedArrayElementSize(type_);
+            switch(type_)
+            {
+                case TYPED_INT8:
+                    return *reinterpret_cast<int8_t*>(p);
+                case TYPED_UINT8:
+                case TYPED_UINT8_CLAMPED:
+                    return *p;
+                case TYPED_INT16:
+                    return *reinterpret_cast<int16_t*>(p);
+                case TYPED_UINT16:
+                    return *reinterpret_cast<uint16_t*>(p);
+                case TYPED_INT32:
+                    return *reinterpret_cast<int32_t*>(p);
+                case TYPED_UINT32:
+                    return *reinterpret_cast<uint32_t*>(p);
+                case TYPED_FLOAT32:
+                    return *reinterpret_cast<float*>(p);
+                case TYPED_FLOAT64:
+                    return *reinterpret_cast<double*>(p);
+                default:
+                    assert(false);
+            }
+        }
+
+        // ES6 24.1.1.6 SetValueInBuffer, with the conversions of 7.1.5 - 7.1.11.
+        void SetIndex(size_t index, double value)
+        {
+            uint8_t* p = data() + index * TypedArrayElementSize(type_);
+            switch(type_)
+            {
+                case TYPED_INT8:
+                case TYPED_UINT8:
+                    *p = ModuloUint32(value);
+                    break;
+                case TYPED_UINT8_CLAMPED:
+                    *p = isnan(value) ? 0 : nearbyint(fmin(fmax(value, 0), 255));
+                    break;
+                case TYPED_INT16:
+                case TYPED_UINT16:
+                    *reinterpret_cast<uint16_t*>(p) = ModuloUint32(value);
+                    break;
+                case TYPED_INT32:
+                case TYPED_UINT32:
+                    *reinterpret_cast<uint32_t*>(p) = ModuloUint32(value);
+                    break;
+                case TYPED_FLOAT32:
+                    *reinterpret_cast<float*>(p) = value;
+                    break;
+                case TYPED_FLOAT64:
+                    *reinterpret_cast<double*>(p) = value;
+                    break;
+                default:
+                    assert(false);
+            }
+        }
+
+        bool GetOwnPropertySlot(const std::string& P, PropertySlot* slot) override
+        {
+            uint32_t index;
+            if(ToArrayIndex(P, &index))
+            {
+                if(index >= length_)
+                {
+                    return false;
+                }
+                *slot = PropertySlot(new Number(GetIndex(index)), true, true, false);
+                return true;
+            }
+            JSValue* value = ViewProperty(P);
+            if(value != nullptr)
+            {
+                *slot = PropertySlot(value, false, false, false);
+                return true;
+            }
+            return JSObject::GetOwnPropertySlot(P, slot);
+        }
+
+        JSValue* Get(Error* e, const std::string& P) override
+        {
+            uint32_t index;
+            if(ToArrayIndex(P, &index))
+            {// ES6 9.4.5.4
+                if(index >= length_)
+                {
+                    return Undefined::Instance();
+                }
+                return new Number(GetIndex(index));
+            }
+            JSValue* value = ViewProperty(P);
+            if(value != nullptr)
+            {
+                return value;
+            }
+            return JSObject::Get(e, P);
+        }
+
+        void Put(Error* e, const std::string& P, JSValue* V, bool throw_flag) override
+        {
+            uint32_t index;
+            if(ToArrayIndex(P, &index))
+            {// ES6 9.4.5.5
+                double num = ToNumber(e, V);
+                if(!e->IsOk())
+                {
+                    return;
+                }
+                if(index < length_)
+                {
+                    SetIndex(index, num);
+                }
+                return;
+            }
+            JSObject::Put(e, P, V, throw_flag);
+        }
+
+        JSValue* GetByIndex(Error* e, uint32_t index) override
+        {
+            (void)e;
+            if(index >= length_)
+            {
+                return Undefined::Instance();
+            }
+            return new Number(GetIndex(index));
+        }
+
+        void PutByIndex(Error* e, uint32_t index, JSValue* V, bool throw_flag) override
+        {
+            (void)throw_flag;
+            double num = ToNumber(e, V);
+            if(!e->IsOk())
+            {
+                return;
+            }
+            if(index < length_)
+            {
+                SetIndex(index, num);
+            }
+        }
+
+        bool Delete(Error* e, const std::string& P, bool throw_flag) override
+        {
+            uint32_t index;
+            if(ToArrayIndex(P, &index))
+            {
+                if(index >= length_)
+                {
+                    return true;
+                }
+                goto reject;
+            }
+            if(ViewProperty(P) != nullptr)
+            {
+                goto reject;
+            }
+            return JSObject::Delete(e, P, throw_flag);
+        reject:
+            if(throw_flag)
+            {
+                *e = Error::TypeError();
+            }
+            return false;
+        }
+
+        // ES6 9.4.5.3 [[DefineOwnProperty]] ( P, Desc)
+        bool DefineOwnProperty(Error* e, const std::string& P, PropertyDescriptor* desc, bool throw_flag) override
+        {
+            uint32_t index;
+            if(ToArrayIndex(P, &index))
+            {
+                if(index >= length_ || desc->IsAccessorDescriptor())
+                {
+                    goto reject;
+                }
+                if((desc->HasConfigurable() && desc->Configurable()) || (desc->HasEnumerable() && !desc->Enumerable())
+                   || (desc->HasWritable() && !desc->Writable()))
+                {
+                    goto reject;
+                }
+                if(desc->HasValue())
+                {
+                    double num = ToNumber(e, desc->Value());
+                    if(!e->IsOk())
+                    {
+                        return false;
+                    }
+                    SetIndex(index, num);
+                }
+                return true;
+            }
+            if(ViewProperty(P) != nullptr)
+            {
+                goto reject;
+            }
+            return JSObject::DefineOwnProperty(e, P, desc, throw_flag);
+        reject:
+            if(throw_flag)
+            {
+                *e = Error::TypeError();
+            }
+            return false;
+        }
+
+        bool EnumeratesNamedPropertiesOnly() override
+        {
+            return false;
+        }
+
+        std::vector<std::string> AllEnumerableProperties() override
+        {
+            std::vector<std::string> result;
+            for(size_t i = 0; i < length_; i++)
+            {
+                result.emplace_back(NumberToString(i));
+            }
+            for(const auto& name : JSObject::AllEnumerableProperties())
+            {
+                result.emplace_back(name);
+            }
+            return result;
+        }
+
+    private:
+        // Integer types store the value modulo 2^n, so the low bits of the
+        // ToUint32 result are all that is needed.
+        static uint32_t ModuloUint32(double value)
+        {
+            if(!isfinite(value))
+            {
+                return 0;
+            }
+            double int_bit = fmod(trunc(value), 4294967296.0);
+            if(int_bit < 0)
+            {
+                int_bit += 4294967296.0;
+            }
+            return int_bit;
+        }
+
+        JSValue* ViewProperty(const std::string& P)
+        {
+            if(P == "length")
+            {
+                return new Number(length_);
+            }
+            if(P == "byteLength")
+            {
+                return new Number(ByteLength());
+            }
+            if(P == "byteOffset")
+            {
+                return new Number(byte_offset_);
+            }
+            if(P == "buffer")
+            {
+                return buffer_;
+            }
+            return nullptr;
+        }
+
+        TypedArrayType type_;
+        ArrayBufferObject* buffer_;
+        size_t byte_offset_;
+        size_t length_;
+    };
+
+    class TypedArrayConstructor : public JSObject
+    {
+    public:
+        static TypedArrayConstructor* Instance(TypedArrayType type)
+        {
+            static TypedArrayConstructor* singletons[TYPED_NUM] = { nullptr };
+            if(singletons[type] == nullptr)
+            {
+                singletons[type] = new TypedArrayConstructor(type);
+            }
+            return singletons[type];
+        }
+
+        JSValue* Call(Error* e, JSValue* this_arg, const std::vector<JSValue*>& arguments = {}) override
+        {
+            (void)this_arg;
+            (void)arguments;
+            *e = Error::TypeError("Constructor " + TypedArrayName(type_) + " requires 'new'");
+            return nullptr;
+        }
+
+        // ES6 22.2.4 The TypedArray Constructors
+        JSObject* Construct(Error* e, const std::vector<JSValue*>& arguments) override;
+
+        static JSValue* toString(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+        {
+            (void)this_arg;
+            (void)vals;
+            JSValue* val = RuntimeContext::TopValue();
+            for(int type = 0; type < TYPED_NUM; type++)
+            {
+                if(val == Instance(TypedArrayType(type)))
+                {
+                    return new String("function " + TypedArrayName(TypedArrayType(type)) + "() { [native code] }");
+                }
+            }
+            *e = Error::TypeError("toString called on incompatible receiver");
+            return nullptr;
+        }
+
+    private:
+        TypedArrayConstructor(TypedArrayType type) : JSObject(OBJ_OTHER, TypedArrayName(type), true, nullptr, true, true), type_(type)
+        {
+        }
+
+        TypedArrayType type_;
+    };
+
+    inline JSValue* ArrayBufferProto::slice(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+    {
+        (void)this_arg;
+        ArrayBufferObject* O = ArrayBufferObject::Cast(RuntimeContext::TopValue());
+        if(O == nullptr)
+        {
+            *e = Error::TypeError("ArrayBuffer.prototype.slice called on incompatible receiver");
+            return nullptr;
+        }
+        double len = O->ByteLength();
+        double first = ToRelativeIndex(e, vals.empty() ? Undefined::Instance() : vals[0], len);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        double final = len;
+        if(vals.size() >= 2 && !vals[1]->IsUndefined())
+        {
+            final = ToRelativeIndex(e, vals[1], len);
+        }
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        size_t new_len = fmax(final - first, 0);
+        ArrayBufferObject* A = new ArrayBufferObject(new_len);
+        memcpy(A->data(), O->data() + size_t(first), new_len);
+        return A;
+    }
+
+    inline JSObject* TypedArrayConstructor::Construct(Error* e, const std::vector<JSValue*>& arguments)
+    {
+        size_t element_size = TypedArrayElementSize(type_);
+        JSValue* first = arguments.empty() ? Undefined::Instance() : arguments[0];
+        if(!first->IsObject())
+        {// 22.2.4.2 TypedArray ( length )
+            double len = 0;
+            if(!first->IsUndefined())
+            {
+                len = ToInteger(e, first);
+                if(!e->IsOk())
+                {
+                    return nullptr;
+                }
+            }
+            if(len < 0 || len * element_size > ArrayBufferObject::kMaxByteLength)
+            {
+                *e = Error::RangeError("Invalid typed array length");
+                return nullptr;
+            }
+            return new TypedArrayObject(type_, new ArrayBufferObject(len * element_size), 0, len);
+        }
+        ArrayBufferObject* buffer = ArrayBufferObject::Cast(first);
+        if(buffer != nullptr)
+        {// 22.2.4.5 TypedArray ( buffer [ , byteOffset [ , length ] ] )
+            double offset = 0;
+            if(arguments.size() >= 2)
+            {
+                offset = ToInteger(e, arguments[1]);
+                if(!e->IsOk())
+                {
+                    return nullptr;
+                }
+            }
+            if(offset < 0 || fmod(offset, element_size) != 0)
+            {
+                *e = Error::RangeError("start offset of " + TypedArrayName(type_) + " should be a multiple of " + NumberToString(element_size));
+                return nullptr;
+            }
+            double buffer_len = buffer->ByteLength();
+            double new_byte_len;
+            if(arguments.size() < 3 || arguments[2]->IsUndefined())
+            {
+                if(fmod(buffer_len, element_size) != 0)
+                {
+                    *e = Error::RangeError("byte length of " + TypedArrayName(type_) + " should be a multiple of " + NumberToString(element_size));
+                    return nullptr;
+                }
+                new_byte_len = buffer_len - offset;
+            }
+            else
+            {
+                double new_len = ToInteger(e, arguments[2]);
+                if(!e->IsOk())
+                {
+                    return nullptr;
+                }
+                new_byte_len = new_len * element_size;
+            }
+            if(new_byte_len < 0 || offset + new_byte_len > buffer_len)
+            {
+                *e = Error::RangeError("Invalid typed array length");
+                return nullptr;
+            }
+            return new TypedArrayObject(type_, buffer, offset, new_byte_len / element_size);
+        }
+        TypedArrayObject* src = TypedArrayObject::Cast(first);
+        if(src != nullptr)
+        {// 22.2.4.3 TypedArray ( typedArray )
+            size_t len = src->Length();
+            TypedArrayObject* A = new TypedArrayObject(type_, new ArrayBufferObject(len * element_size), 0, len);
+            if(src->type() == type_)
+            {
+                memcpy(A->data(), src->data(), len * element_size);
+                return A;
+            }
+            for(size_t k = 0; k < len; k++)
+            {
+                A->SetIndex(k, src->GetIndex(k));
+            }
+            return A;
+        }
+        // 22.2.4.4 TypedArray ( object )
+        JSObject* obj = static_cast<JSObject*>(first);
+        double len = GetArrayLength(e, obj);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        if(len * element_size > ArrayBufferObject::kMaxByteLength)
+        {
+            *e = Error::RangeError("Invalid typed array length");
+            return nullptr;
+        }
+        TypedArrayObject* A = new TypedArrayObject(type_, new ArrayBufferObject(len * element_size), 0, len);
+        for(size_t k = 0; k < len; k++)
+        {
+            JSValue* k_value = GetElement(e, obj, k);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+            double num = ToNumber(e, k_value);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+            A->SetIndex(k, num);
+        }
+        return A;
+    }
+
+    inline JSValue* TypedArrayProto::set(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+    {
+        (void)this_arg;
+        TypedArrayObject* target = TypedArrayObject::Cast(RuntimeContext::TopValue());
+        if(target == nullptr)
+        {
+            *e = Error::TypeError("%TypedArray%.prototype.set called on incompatible receiver");
+            return nullptr;
+        }
+        if(vals.empty() || !vals[0]->IsObject())
+        {
+            *e = Error::TypeError("%TypedArray%.prototype.set requires an array-like source");
+            return nullptr;
+        }
+        double target_offset = 0;
+        if(vals.size() >= 2)
+        {
+            target_offset = ToInteger(e, vals[1]);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+        }
+        if(target_offset < 0)
+        {
+            *e = Error::RangeError("offset is out of bounds");
+            return nullptr;
+        }
+        size_t target_len = target->Length();
+        TypedArrayObject* src = TypedArrayObject::Cast(vals[0]);
+        if(src != nullptr)
+        {// 22.2.3.22.2
+            size_t src_len = src->Length();
+            if(src_len + target_offset > target_len)
+            {
+                *e = Error::RangeError("offset is out of bounds");
+                return nullptr;
+            }
+            size_t offset = target_offset;
+            if(src->type() == target->type())
+            {
+                // memmove, as both views may share a buffer.
+                size_t element_size = TypedArrayElementSize(target->type());
+                memmove(target->data() + offset * element_size, src->data(), src_len * element_size);
+                return Undefined::Instance();
+            }
+            std::vector<double> values(src_len);
+            for(size_t k = 0; k < src_len; k++)
+            {
+                values[k] = src->GetIndex(k);
+            }
+            for(size_t k = 0; k < src_len; k++)
+            {
+                target->SetIndex(offset + k, values[k]);
+            }
+            return Undefined::Instance();
+        }
+        // 22.2.3.22.1
+        JSObject* obj = static_cast<JSObject*>(vals[0]);
+        double src_len = GetArrayLength(e, obj);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        if(src_len + target_offset > target_len)
+        {
+            *e = Error::RangeError("offset is out of bounds");
+            return nullptr;
+        }
+        for(double k = 0; k < src_len; k++)
+        {
+            JSValue* k_value = GetElement(e, obj, k);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+            double num = ToNumber(e, k_value);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+            target->SetIndex(target_offset + k, num);
+        }
+        return Undefined::Instance();
+    }
+
+    inline JSValue* TypedArrayProto::subarray(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+    {
+        (void)this_arg;
+        TypedArrayObject* O = TypedArrayObject::Cast(RuntimeContext::TopValue());
+        if(O == nullptr)
+        {
+            *e = Error::TypeError("%TypedArray%.prototype.subarray called on incompatible receiver");
+            return nullptr;
+        }
+        double len = O->Length();
+        double begin = ToRelativeIndex(e, vals.empty() ? Undefined::Instance() : vals[0], len);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        double end = len;
+        if(vals.size() >= 2 && !vals[1]->IsUndefined())
+        {
+            end = ToRelativeIndex(e, vals[1], len);
+        }
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        size_t new_len = fmax(end - begin, 0);
+        size_t byte_offset = O->ByteOffset() + size_t(begin) * TypedArrayElementSize(O->type());
+        return new TypedArrayObject(O->type(), O->buffer(), byte_offset, new_len);
+    }
+
+    inline JSValue* TypedArrayProto::fill(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+    {
+        (void)this_arg;
+        TypedArrayObject* O = TypedArrayObject::Cast(RuntimeContext::TopValue());
+        if(O == nullptr)
+        {
+            *e = Error::TypeError("%TypedArray%.prototype.fill called on incompatible receiver");
+            return nullptr;
+        }
+        double value = ToNumber(e, vals.empty() ? Undefined::Instance() : vals[0]);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        double len = O->Length();
+        double k = ToRelativeIndex(e, vals.size() < 2 ? Undefined::Instance() : vals[1], len);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        double final = len;
+        if(vals.size() >= 3 && !vals[2]->IsUndefined())
+        {
+            final = ToRelativeIndex(e, vals[2], len);
+        }
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        for(; k < final; k++)
+        {
+            O->SetIndex(k, value);
+        }
+        return O;
+    }
+
+    inline JSValue* ObjectConstructor::keys(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+    {
+        (void)this_arg;
+        if(vals.empty() || !vals[0]->IsObject())
+        {
+            *e = Error::TypeError("Object.keys called on non-object");
+            return nullptr;
+        }
+        JSObject* O = static_cast<JSObject*>(vals[0]);
+        auto properties = O->AllEnumerableProperties();
+        size_t n = properties.size();
+        ArrayObject* arr_obj = new ArrayObject(n);
+        for(size_t index = 0; index < n; index++)
+        {
+            arr_obj->AddValueProperty(NumberToString(index), new String(properties[index]), true, true, true);
+        }
+        return arr_obj;
+    }
+
+    // 10.6 Arguments Object
+    //
+    // Instead of the accessor functions of the parameter map
+    // ([[ParameterMap]] in the spec), a mapped index just remembers the name of
+    // its formal parameter and reads or writes the binding in the function's
+    // environment record directly.
+    class ArgumentsObject : public JSObject
+    {
+    public:
+        ArgumentsObject(EnvironmentRecord* env, size_t len)
+        : JSObject(OBJ_OBJECT, "Arguments", true, nullptr, false, false), env_(env)
+        {
+            SetPrototype(ObjectProto::Instance());
+            AddValueProperty("length", new Number(len), true, false, true);
+        }
+
+        // Aliases the element at index to the formal parameter name.
+        void MapParameter(size_t index, const std::string& name)
+        {
+            if(mapped_names_.size() <= index)
+            {
+                mapped_names_.resize(index + 1);
+            }
+            mapped_names_[index] = name;
+        }
+
+        JSValue* Get(Error* e, const std::string& P) override
+        {
+            const std::string* name = MappedName(P);
+            if(name == nullptr)
+            {// 3
+                JSValue* v = JSObject::Get(e, P);
+                if(!e->IsOk())
+                {
+                    return nullptr;
+                }
+                if(P == "caller")
+                {
+                    if(v->IsObject())
+                    {
+                        JSObject* obj = static_cast<JSObject*>(v);
+                        if(obj->IsFunction())
+                        {
+                            FunctionObject* func = static_cast<FunctionObject*>(obj);
+                            if(func->strict())
+                            {
+                                *e = Error::TypeError("caller could not be function object");
+                            }
+                        }
+                    }
+                }
+                return v;
+            }
+            // 4
+            return env_->GetBindingValue(e, *name, false);
+        }
+
+        bool GetOwnPropertySlot(const std::string& P, PropertySlot* slot) override
+        {
+            if(!JSObject::GetOwnPropertySlot(P, slot))
+            {
+                return false;
+            }
+            const std::string* name = MappedName(P);
+            if(name != nullptr)
+            {// 5
+                Error error;
+                Error* e = &error;
+                slot->SetValue(env_->GetBindingValue(e, *name, false));
+            }
+            return true;
+        }
+
+        bool DefineOwnProperty(Error* e, const std::string& P, PropertyDescriptor* desc, bool throw_flag) override
+        {
+            const std::string* name = MappedName(P);
+            bool allowed = JSObject::DefineOwnProperty(e, P, desc, false);
+            if(!allowed)
+            {
+                if(throw_flag)
+                {
+                    *e = Error::TypeError("DefineOwnProperty " + P + " failed");
+                }
+                return false;
+            }
+            if(name != nullptr)
+            {// 5
+                if(desc->IsAccessorDescriptor())
+                {
+                    Unmap(P);
+                }
+                else
+                {
+                    if(desc->HasValue())
+                    {
+                        env_->SetMutableBinding(e, *name, desc->Value(), false);
+                    }
+                    if(desc->HasWritable() && !desc->Writable())
+                    {
+                        Unmap(P);
+                    }
+                }
+            }
+            return true;
+        }
+
+        bool Delete(Error* e, const std::string& P, bool throw_flag) override
+        {
+            const std::string* name = MappedName(P);
+            bool result = JSObject::Delete(e, P, throw_flag);
+            if(!e->IsOk())
+            {
+                return false;
+            }
+            if(result && name != nullptr)
+            {
+                Unmap(P);
+            }
+            return result;
+        }
+
+        inline std::string ToString() override
+        {
+            return "ArgumentsObject";
+        }
+
+    private:
+        // Returns the parameter aliased by P, or nullptr if P is not mapped.
+        const std::string* MappedName(const std::string& P)
+        {
+            uint32_t index;
+            if(mapped_names_.empty() || !ToArrayIndex(P, &index) || index >= mapped_names_.size() || mapped_names_[index].empty())
+            {
+                return nullptr;
+            }
+            return &mapped_names_[index];
+        }
+
+        void Unmap(const std::string& P)
+        {
+            uint32_t index;
+            if(ToArrayIndex(P, &index) && index < mapped_names_.size())
+            {
+                mapped_names_[index].clear();
+            }
+        }
+
+        EnvironmentRecord* env_;
+        std::vector<std::string> mapped_names_;
+    };
+
+    class Console : public JSObject
+    {
+    public:
+        static Console* Instance()
+        {
+            static Console singleton;
+            return &singleton;
+        }
+
+        static JSValue* log(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+        {
+            (void)e;
+            (void)this_arg;
+            for(auto val : vals)
+            {
+                std::cout << val->ToString() << " ";
+            }
+            std::cout << std::endl;
+            return Number::Zero();
+        }
+
+    private:
+        Console() : JSObject(OBJ_BOOL, "Console", true, Bool::False(), false, false)
+        {
+            AddFuncProperty("log", log, false, false, false);
+        }
+    };
+
+    enum CodeType
+    {
+        CODE_GLOBAL = 0,
+        CODE_FUNC,
+        CODE_EVAL,
+    };
+
+    // 10.6 Arguments Object
+    inline JSObject* CreateArgumentsObject(FunctionObject* func, const std::vector<JSValue*>& args, LexicalEnvironment* env, bool strict)
+    {
+        const std::vector<std::string>& names = func->FormalParameters();
+        int len = args.size();
+        ArgumentsObject* obj = new ArgumentsObject(env->env_rec(), len);
+        int indx = len - 1;// 10
+        std::set<std::string> mapped_names;
+        while(indx >= 0)
+        {// 11
+            JSValue* val = args[indx];// 11.a
+            obj->AddValueProperty(NumberToString(indx), val, true, true, true);// 11.b
+            if(indx < int(names.size()))
+            {// 11.c
+                std::string name = names[indx];// 11.c.i
+                if(!strict && mapped_names.find(name) == mapped_names.end())
+                {// 11.c.ii
+                    mapped_names.insert(name);
+                    obj->MapParameter(indx, name);
+                }
+            }
+            indx--;// 11.d
+        }
+        if(!strict)
+        {// 13
+            obj->AddValueProperty("callee", func, true, false, true);
+        }
+        else
+        {// 14
+            // TODO(zhuzilin) thrower
+        }
+        return obj;// 15
+    }
+
+    // 10.5 Declaration Binding Instantiation, for function code.
+    //
+    // The environment of a function call starts empty, and the parser has
+    // already deduplicated the declarations of the body (see
+    // ProgramOrFunctionBody::fresh_var_decls), so the bindings are created in
+    // one pass without checking for existing ones.
+    inline void FunctionDeclarationBindingInstantiation(
+    Error* e, ExecutionContext* context, Parsing::ProgramOrFunctionBody* body, FunctionObject* f, const std::vector<JSValue*>& args)
+    {
+        DeclarativeEnvironmentRecord* env = static_cast<DeclarativeEnvironmentRecord*>(context->variable_env()->env_rec());// 1
+        bool strict = body->strict();// 3
+        const std::vector<std::string>& names = f->FormalParameters();// 4.a
+        const std::vector<Parsing::Function*>& func_decls = body->func_decls();
+        const std::vector<std::string>& var_decls = body->fresh_var_decls();
+        env->Reserve(names.size() + func_decls.size() + var_decls.size() + 1);
+        for(size_t n = 0; n < names.size(); n++)
+        {// 4.d
+            env->InitializeMutableBinding(names[n], n < args.size() ? args[n] : Undefined::Instance());
+        }
+        for(Parsing::Function* func_decl : func_decls)
+        {// 5
+            FunctionObject* fo = InstantiateFunctionDeclaration(e, func_decl);
+            if(!e->IsOk())
+            {
+                return;
+            }
+            env->InitializeMutableBinding(func_decl->name(), fo);
+        }
+        // The arguments object can only be observed if the body
+        // mentions arguments or eval, which the parser records.
+        bool create_arguments = body->uses_arguments() && !env->HasBinding("arguments");// 6
+        if(create_arguments)
+        {// 7
+            auto args_obj = CreateArgumentsObject(f, args, context->variable_env(), strict);
+            if(strict)
+            {// 7.b
+                env->CreateImmutableBinding("arguments");
+                env->InitializeImmutableBinding("arguments", args_obj);
+            }
+            else
+            {// 7.c
+                env->InitializeMutableBinding("arguments", args_obj);
+            }
+        }
+        for(const std::string& dn : var_decls)
+        {// 8
+            if(create_arguments && dn == "arguments")
+            {
+                continue;
+            }
+            env->InitializeMutableBinding(dn, Undefined::Instance());
+        }
+    }
+
+    // 10.5 Declaration Binding Instantiation
+    inline void DeclarationBindingInstantiation(
+    Error* e, ExecutionContext* context, Parsing::AST* code, CodeType code_type, FunctionObject* f = nullptr, const std::vector<JSValue*>& args = {})
+    {
+        Parsing::ProgramOrFunctionBody* body = static_cast<Parsing::ProgramOrFunctionBody*>(code);
+        if(code_type == CODE_FUNC)
+        {// 4 & 7
+            assert(f != nullptr);
+            FunctionDeclarationBindingInstantiation(e, context, body, f, args);
+            return;
+        }
+        auto env = context->variable_env()->env_rec();// 1
+        bool configurable_bindings = false;
+        if(code_type == CODE_EVAL)
+        {
+            configurable_bindings = true;// 2
+        }
+        bool strict = body->strict();// 3
+        // 5
+        for(Parsing::Function* func_decl : body->func_decls())
+        {
+            assert(func_decl->is_named());
+            std::string fn = func_decl->name();
+            FunctionObject* fo = InstantiateFunctionDeclaration(e, func_decl);
+            if(!e->IsOk())
+            {
+                return;
+            }
+            bool func_already_declared = env->HasBinding(fn);
+            if(!func_already_declared)
+            {// 5.d
+                env->CreateMutableBinding(e, fn, configurable_bindings);
+                if(!e->IsOk())
+                {
+                    return;
+                }
+            }
+            else
+            {// 5.e
+                auto go = GlobalObject::Instance();
+                PropertySlot existing_prop;
+                bool found = go->GetPropertySlot(fn, &existing_prop);
+                assert(found);
+                (void)found;
+                if(existing_prop.Configurable())
+                {// 5.e.iii
+                    PropertyDescriptor new_desc;
+                    new_desc.SetDataDescriptor(Undefined::Instance(), true, true, configurable_bindings);
+                    go->DefineOwnProperty(e, fn, &new_desc, true);
+                    if(!e->IsOk())
+                    {
+                        return;
+                    }
+                }
+                else
+                {// 5.e.iv
+                    if(existing_prop.IsAccessor() || !(existing_prop.Writable() && existing_prop.Enumerable()))
+                    {
+                        *e = Error::TypeError();
+                        return;
+                    }
+                }
+            }
+            env->SetMutableBinding(e, fn, fo, strict);// 5.f
+        }
+        // 8
+        for(const std::string& dn : body->var_decls())
+        {
+            bool var_already_declared = env->HasBinding(dn);
+            if(!var_already_declared)
+            {
+                env->CreateMutableBinding(e, dn, configurable_bindings);
+                if(!e->IsOk())
+                {
+                    return;
+                }
+                env->SetMutableBinding(e, dn, Undefined::Instance(), strict);
+                if(!e->IsOk())
+                {
+                    return;
+                }
+            }
+        }
+    }
+
+    // 10.4.1
+    inline void EnterGlobalCode(Error* e, Parsing::AST* ast)
+    {
+        Parsing::ProgramOrFunctionBody* program;
+        if(ast->type() == Parsing::AST::AST_PROGRAM)
+        {
+            program = static_cast<Parsing::ProgramOrFunctionBody*>(ast);
+        }
+        else
+        {
+            // TODO(zhuzilin) This is for test. Add test label like #ifdefine TEST
+            program = new Parsing::ProgramOrFunctionBody(Parsing::AST::AST_PROGRAM, false);
+            program->AddStatement(ast);
+        }
+        // 1 10.4.1.1
+        LexicalEnvironment* global_env = LexicalEnvironment::Global();
+        ExecutionContext* context = RuntimeContext::Global()->AddContext(e, global_env, global_env, GlobalObject::Instance(), program->strict());
+        if(!e->IsOk())
+        {
+            return;
+        }
+        // 2
+        DeclarationBindingInstantiation(e, context, program, CODE_GLOBAL);
+    }
+
+    // 10.4.2
+    inline void EnterEvalCode(Error* e, Parsing::AST* ast)
+    {
+        assert(ast->type() == Parsing::AST::AST_PROGRAM);
+        Parsing::ProgramOrFunctionBody* program = static_cast<Parsing::ProgramOrFunctionBody*>(ast);
+        ExecutionContext* context;
+        LexicalEnvironment* variable_env;
+        LexicalEnvironment* lexical_env;
+        JSValue* this_binding;
+        if(!GlobalObject::Instance()->direct_eval())
+        {// 1
+            LexicalEnvironment* global_env = LexicalEnvironment::Global();
+            variable_env = global_env;
+            lexical_env = global_env;
+            this_binding = GlobalObject::Instance();
+        }
+        else
+        {// 2
+            ExecutionContext* calling_context = RuntimeContext::TopContext();
+            variable_env = calling_context->variable_env();
+            lexical_env = calling_context->lexical_env();
+            this_binding = calling_context->this_binding();
+        }
+        bool strict = RuntimeContext::TopContext()->strict() || (program->strict() && GlobalObject::Instance()->direct_eval());
+        if(strict)
+        {// 3
+            LexicalEnvironment* strict_var_env = LexicalEnvironment::NewDeclarativeEnvironment(lexical_env);
+            lexical_env = strict_var_env;
+            variable_env = strict_var_env;
+        }
+        context = RuntimeContext::Global()->AddContext(e, variable_env, lexical_env, this_binding, strict);
+        if(!e->IsOk())
+        {
+            return;
+        }
+        // 4
+        DeclarationBindingInstantiation(e, context, program, CODE_EVAL);
+        if(!e->IsOk())
+        {
+            RuntimeContext::Global()->PopContext();
+        }
+    }
+
+    // 15.1.2.1 eval(X)
+    inline JSValue* GlobalObject::eval(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+    {
+        (void)this_arg;
+        //log::PrintSource("enter GlobalObject::eval");
+        if(vals.empty())
+        {
+            return Undefined::Instance();
+        }
+        if(!vals[0]->IsString())
+        {
+            return vals[0];
+        }
+        const std::string& x = static_cast<String*>(vals[0])->data();
+        Parsing::AST* program;
+        const CodeCache::Entry* cached = CodeCache::Global()->Find(CodeCache::EVAL_CODE, x);
+        if(cached != nullptr)
+        {
+            program = cached->ast;
+        }
+        else
+        {
+            Parsing::Parser parser(x);
+            program = parser.ParseProgram();
+            if(program->IsIllegal())
+            {
+                *e = Error::SyntaxError("failed to parse eval");
+                return nullptr;
+            }
+            CodeCache::Global()->Insert(CodeCache::EVAL_CODE, x, { program, {} });
+        }
+        EnterEvalCode(e, program);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        Completion result = EvalProgram(program);
+        RuntimeContext::Global()->PopContext();
+
+        switch(result.type)
+        {
+            case Completion::NORMAL:
+                if(result.value != nullptr)
+                {
+                    return result.value;
+                }
+                else
+                {
+                    return Undefined::Instance();
+                }
+            default:
+            {
+                assert(result.type == Completion::THROWING);
+                *e = Error::Throw(result.value);
+                return result.value;
+            }
+        }
+    }
+
+    double ToInt32(Error* e, JSValue* input);
+    double ParseInt(const std::string& source, int radix);
+    double ParseFloat(const std::string& source);
+
+    // 15.1.2.2 parseInt (string , radix)
+    inline JSValue* GlobalObject::parseInt(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+    {
+        (void)this_arg;
+        std::string input_string = ::es::ToString(e, vals.size() > 0 ? vals[0] : Undefined::Instance());// 1
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        double radix = ToInt32(e, vals.size() > 1 ? vals[1] : Undefined::Instance());// 6
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        return new Number(ParseInt(input_string, int(radix)));
+    }
+
+    // 15.1.2.3 parseFloat (string)
+    inline JSValue* GlobalObject::parseFloat(Error* e, JSValue* this_arg, const std::vector<JSValue*>& vals)
+    {
+        (void)this_arg;
+        std::string input_string = ::es::ToString(e, vals.size() > 0 ? vals[0] : Undefined::Instance());// 1
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        return new Number(ParseFloat(input_string));
+    }
+
+    // 10.4.3
+    inline void
+    EnterFunctionCode(Error* e, JSObject* f, Parsing::ProgramOrFunctionBody* body, JSValue* this_arg, const std::vector<JSValue*>& args, bool strict)
+    {
+        assert(f->obj_type() == JSObject::OBJ_FUNC);
+        FunctionObject* func = static_cast<FunctionObject*>(f);
+        JSValue* this_binding;
+        if(strict)
+        {// 1
+            this_binding = this_arg;
+        }
+        else
+        {// 2 & 3
+            this_binding = (this_arg->IsUndefined() || this_arg->IsNull()) ? GlobalObject::Instance() : this_arg;
+        }
+        // Only inner functions and the arguments object can
+        // keep the local environment alive after the call returns.
+        bool pooled_env = !body->has_inner_functions() && !body->uses_arguments();
+        LexicalEnvironment* local_env;
+        if(pooled_env)
+        {
+            local_env = RuntimeContext::Global()->AcquireEnvironment(func->Scope());
+        }
+        else
+        {
+            local_env = LexicalEnvironment::NewDeclarativeEnvironment(func->Scope());
+        }
+        ExecutionContext* context = RuntimeContext::Global()->AddContext(e, local_env, local_env, this_binding, strict);// 8
+        if(!e->IsOk())
+        {
+            return;
+        }
+        if(pooled_env)
+        {
+            context->SetPooledEnv();
+        }
+        // 9
+        DeclarationBindingInstantiation(e, context, body, CODE_FUNC, func, args);
+        if(!e->IsOk())
+        {
+            RuntimeContext::Global()->PopContext();
+        }
+    }
+
+    inline void InitGlobalObject()
+    {
+        auto global_obj = GlobalObject::Instance();
+        // 15.1.1 Value Properties of the Global Object
+        global_obj->AddValueProperty("NaN", Number::NaN(), false, false, false);
+        global_obj->AddValueProperty("Infinity", Number::PositiveInfinity(), false, false, false);
+        global_obj->AddValueProperty("undefined", Undefined::Instance(), false, false, false);
+        // 15.1.2 Function Properties of the Global Object
+        global_obj->AddFuncProperty("eval", GlobalObject::eval, true, false, true);
+        global_obj->AddFuncProperty("parseInt", GlobalObject::parseInt, true, false, true);
+        global_obj->AddFuncProperty("parseFloat", GlobalObject::parseFloat, true, false, true);
+        global_obj->AddFuncProperty("isNaN", GlobalObject::isNaN, true, false, true);
+        global_obj->AddFuncProperty("isFinite", GlobalObject::isFinite, true, false, true);
+        // 15.1.3 URI Handling Function Properties
+        // TODO(zhuzilin)
+        // 15.1.4 Constructor Properties of the Global Object
+        global_obj->AddValueProperty("Object", ObjectConstructor::Instance(), true, false, true);
+        global_obj->AddValueProperty("Function", FunctionConstructor::Instance(), true, false, true);
+        global_obj->AddValueProperty("Number", NumberConstructor::Instance(), true, false, true);
+        global_obj->AddValueProperty("Boolean", BoolConstructor::Instance(), true, false, true);
+        global_obj->AddValueProperty("String", StringConstructor::Instance(), true, false, true);
+        global_obj->AddValueProperty("Array", ArrayConstructor::Instance(), true, false, true);
+        global_obj->AddValueProperty("ArrayBuffer", ArrayBufferConstructor::Instance(), true, false, true);
+        for(int type = 0; type < TYPED_NUM; type++)
+        {
+            TypedArrayConstructor* constructor = TypedArrayConstructor::Instance(TypedArrayType(type));
+            global_obj->AddValueProperty(constructor->Class(), constructor, true, false, true);
+        }
+
+        global_obj->AddValueProperty("Error", ErrorConstructor::Instance(), true, false, true);
+        // TODO(zhuzilin) differentiate errors.
+        global_obj->AddValueProperty("EvalError", ErrorConstructor::Instance(), true, false, true);
+        global_obj->AddValueProperty("RangeError", ErrorConstructor::Instance(), true, false, true);
+        global_obj->AddValueProperty("ReferenceError", ErrorConstructor::Instance(), true, false, true);
+        global_obj->AddValueProperty("SyntaxError", ErrorConstructor::Instance(), true, false, true);
+        global_obj->AddValueProperty("TypeError", ErrorConstructor::Instance(), true, false, true);
+        global_obj->AddValueProperty("URIError", ErrorConstructor::Instance(), true, false, true);
+
+        global_obj->AddValueProperty("console", Console::Instance(), true, false, true);
+    }
+
+    inline void InitObject()
+    {
+        ObjectConstructor* constructor = ObjectConstructor::Instance();
+        constructor->SetPrototype(FunctionProto::Instance());
+        // 15.2.3 Properties of the Object Constructor
+        constructor->AddValueProperty("prototype", ObjectProto::Instance(), false, false, false);
+        constructor->AddFuncProperty("toString", ObjectConstructor::toString, false, false, false);
+        // TODO(zhuzilin) check if the config is correct.
+        constructor->AddFuncProperty("getPrototypeOf", ObjectConstructor::getPrototypeOf, false, false, false);
+        constructor->AddFuncProperty("getOwnPropertyDescriptor", ObjectConstructor::getOwnPropertyDescriptor, false, false, false);
+        constructor->AddFuncProperty("getOwnPropertyNames", ObjectConstructor::getOwnPropertyNames, false, false, false);
+        constructor->AddFuncProperty("create", ObjectConstructor::create, false, false, false);
+        constructor->AddFuncProperty("defineProperty", ObjectConstructor::defineProperty, false, false, false);
+        constructor->AddFuncProperty("defineProperties", ObjectConstructor::defineProperties, false, false, false);
+        constructor->AddFuncProperty("seal", ObjectConstructor::seal, false, false, false);
+        constructor->AddFuncProperty("freeze", ObjectConstructor::freeze, false, false, false);
+        constructor->AddFuncProperty("preventExtensions", ObjectConstructor::preventExtensions, false, false, false);
+        constructor->AddFuncProperty("isSealed", ObjectConstructor::isSealed, false, false, false);
+        constructor->AddFuncProperty("isFrozen", ObjectConstructor::isFrozen, false, false, false);
+        constructor->AddFuncProperty("isExtensible", ObjectConstructor::isExtensible, false, false, false);
+        constructor->AddFuncProperty("keys", ObjectConstructor::keys, false, false, false);
+        // ES6
+        constructor->AddFuncProperty("setPrototypeOf", ObjectConstructor::setPrototypeOf, false, false, false);
+
+        ObjectProto* proto = ObjectProto::Instance();
+        // 15.2.4 Properties of the Object Prototype Object
+        proto->AddValueProperty("constructor", ObjectConstructor::Instance(), false, false, false);
+        proto->AddFuncProperty("toString", ObjectProto::toString, false, false, false);
+        proto->AddFuncProperty("toLocaleString", ObjectProto::toLocaleString, false, false, false);
+        proto->AddFuncProperty("valueOf", ObjectProto::valueOf, false, false, false);
+        proto->AddFuncProperty("hasOwnProperty", ObjectProto::hasOwnProperty, false, false, false);
+        proto->AddFuncProperty("isPrototypeOf", ObjectProto::isPrototypeOf, false, false, false);
+        proto->AddFuncProperty("propertyIsEnumerable", ObjectProto::propertyIsEnumerable, false, false, false);
+    }
+
+    inline void InitFunction()
+    {
+        FunctionConstructor* constructor = FunctionConstructor::Instance();
+        constructor->SetPrototype(FunctionProto::Instance());
+        // 15.3.3 Properties of the Function Constructor
+        constructor->AddValueProperty("prototype", FunctionProto::Instance(), false, false, false);
+        constructor->AddValueProperty("length", Number::One(), false, false, false);
+        constructor->AddFuncProperty("toString", FunctionConstructor::toString, false, false, false);
+
+        FunctionProto* proto = FunctionProto::Instance();
+        proto->SetPrototype(ObjectProto::Instance());
+        // 15.2.4 Properties of the Function Prototype Function
+        proto->AddValueProperty("constructor", FunctionConstructor::Instance(), false, false, false);
+        proto->AddFuncProperty("toString", FunctionProto::toString, false, false, false);
+        proto->AddFuncProperty("apply", FunctionProto::apply, false, false, false);
+        proto->AddFuncProperty("call", FunctionProto::call, false, false, false);
+        proto->AddFuncProperty("bind", FunctionProto::bind, false, false, false);
+    }
+
+    inline void InitNumber()
+    {
+        NumberConstructor* constructor = NumberConstructor::Instance();
+        constructor->SetPrototype(FunctionProto::Instance());
+        // 15.3.3 Properties of the Number Constructor
+        constructor->AddValueProperty("prototype", NumberProto::Instance(), false, false, false);
+        constructor->AddValueProperty("length", Number::One(), false, false, false);
+        constructor->AddValueProperty("MAX_VALUE", new Number(1.7976931348623157e308), false, false, false);
+        constructor->AddValueProperty("MIN_VALUE", new Number(5e-324), false, false, false);
+        constructor->AddValueProperty("NaN", Number::NaN(), false, false, false);
+        constructor->AddValueProperty("NEGATIVE_INFINITY", Number::PositiveInfinity(), false, false, false);
+        constructor->AddValueProperty("POSITIVE_INFINITY", Number::NegativeInfinity(), false, false, false);
+
+        NumberProto* proto = NumberProto::Instance();
+        proto->SetPrototype(ObjectProto::Instance());
+        // 15.2.4 Properties of the Number Prototype Number
+        proto->AddValueProperty("constructor", NumberConstructor::Instance(), false, false, false);
+        proto->AddFuncProperty("toString", NumberProto::toString, false, false, false);
+        proto->AddFuncProperty("toLocaleString", NumberProto::toLocaleString, false, false, false);
+        proto->AddFuncProperty("valueOf", NumberProto::valueOf, false, false, false);
+        proto->AddFuncProperty("toFixed", NumberProto::toFixed, false, false, false);
+        proto->AddFuncProperty("toExponential", NumberProto::toExponential, false, false, false);
+        proto->AddFuncProperty("toPrecision", NumberProto::toPrecision, false, false, false);
+    }
+
+    inline void InitError()
+    {
+        ErrorConstructor* constructor = ErrorConstructor::Instance();
+        constructor->SetPrototype(FunctionProto::Instance());
+        // 15.11.3 Properties of the Error Constructor
+        constructor->AddValueProperty("prototype", ErrorProto::Instance(), false, false, false);
+        constructor->AddValueProperty("length", Number::One(), false, false, false);
+        constructor->AddFuncProperty("toString", NumberConstructor::toString, false, false, false);
+
+        ErrorProto* proto = ErrorProto::Instance();
+        proto->SetPrototype(ObjectProto::Instance());
+        // 15.11.4 Properties of the Error Prototype Object
+        proto->AddValueProperty("constructor", ErrorConstructor::Instance(), false, false, false);
+        proto->AddValueProperty("name", new String("Error"), false, false, false);
+        proto->AddValueProperty("message", String::Empty(), true, false, false);
+        proto->AddFuncProperty("call", ErrorProto::toString, false, false, false);
+    }
+
+    inline void InitBool()
+    {
+        BoolConstructor* constructor = BoolConstructor::Instance();
+        constructor->SetPrototype(FunctionProto::Instance());
+        // 15.6.3 Properties of the Boolean Constructor
+        constructor->AddValueProperty("prototype", BoolProto::Instance(), false, false, false);
+        constructor->AddFuncProperty("toString", BoolConstructor::toString, false, false, false);
+
+        BoolProto* proto = BoolProto::Instance();
+        proto->SetPrototype(ObjectProto::Instance());
+        // 15.6.4 Properties of the Boolean Prototype Object
+        proto->AddValueProperty("constructor", BoolConstructor::Instance(), false, false, false);
+        proto->AddFuncProperty("toString", BoolProto::toString, false, false, false);
+        proto->AddFuncProperty("valueOf", BoolProto::valueOf, false, false, false);
+    }
+
+    inline void InitString()
+    {
+        StringConstructor* constructor = StringConstructor::Instance();
+        constructor->SetPrototype(FunctionProto::Instance());
+        // 15.3.3 Properties of the String Constructor
+        constructor->AddValueProperty("prototype", StringProto::Instance(), false, false, false);
+        constructor->AddValueProperty("length", Number::One(), true, false, false);
+        constructor->AddFuncProperty("fromCharCode", StringConstructor::fromCharCode, false, false, false);
+        constructor->AddFuncProperty("toString", StringConstructor::toString, false, false, false);
+
+        StringProto* proto = StringProto::Instance();
+        proto->SetPrototype(ObjectProto::Instance());
+        // 15.2.4 Properties of the String Prototype String
+        proto->AddValueProperty("constructor", StringConstructor::Instance(), false, false, false);
+        proto->AddFuncProperty("toString", StringProto::toString, false, false, false);
+        proto->AddFuncProperty("valueOf", StringProto::valueOf, false, false, false);
+        proto->AddFuncProperty("charAt", StringProto::charAt, false, false, false);
+        proto->AddFuncProperty("charCodeAt", StringProto::charCodeAt, false, false, false);
+        proto->AddFuncProperty("concat", StringProto::concat, false, false, false);
+        proto->AddFuncProperty("indexOf", StringProto::indexOf, false, false, false);
+        proto->AddFuncProperty("lastIndexOf", StringProto::lastIndexOf, false, false, false);
+        proto->AddFuncProperty("localeCompare", StringProto::localeCompare, false, false, false);
+        proto->AddFuncProperty("match", StringProto::match, false, false, false);
+        proto->AddFuncProperty("replace", StringProto::replace, false, false, false);
+        proto->AddFuncProperty("search", StringProto::search, false, false, false);
+        proto->AddFuncProperty("slice", StringProto::slice, false, false, false);
+        proto->AddFuncProperty("split", StringProto::split, false, false, false);
+        proto->AddFuncProperty("substring", StringProto::substring, false, false, false);
+        proto->AddFuncProperty("toLowerCase", StringProto::toLowerCase, false, false, false);
+        proto->AddFuncProperty("toLocaleLowerCase", StringProto::toLocaleLowerCase, false, false, false);
+        proto->AddFuncProperty("toUpperCase", StringProto::toUpperCase, false, false, false);
+        proto->AddFuncProperty("toLocaleUpperCase", StringProto::toLocaleUpperCase, false, false, false);
+        proto->AddFuncProperty("trim", StringProto::trim, false, false, false);
+    }
+
+    inline void InitArray()
+    {
+        ArrayConstructor* constructor = ArrayConstructor::Instance();
+        constructor->SetPrototype(FunctionProto::Instance());
+        // 15.6.3 Properties of the Arrayean Constructor
+        constructor->AddValueProperty("length", Number::One(), false, false, false);
+        constructor->AddValueProperty("prototype", ArrayProto::Instance(), false, false, false);
+        constructor->AddFuncProperty("isArray", ArrayConstructor::isArray, false, false, false);
+        constructor->AddFuncProperty("toString", ArrayConstructor::toString, false, false, false);
+
+        ArrayProto* proto = ArrayProto::Instance();
+        proto->SetPrototype(ObjectProto::Instance());
+        // 15.6.4 Properties of the Arrayean Prototype Object
+        proto->AddValueProperty("length", Number::Zero(), false, false, false);
+        proto->AddValueProperty("constructor", ArrayConstructor::Instance(), false, false, false);
+        proto->AddFuncProperty("toString", ArrayProto::toString, false, false, false);
+        proto->AddFuncProperty("toLocaleString", ArrayProto::toLocaleString, false, false, false);
+        proto->AddFuncProperty("concat", ArrayProto::concat, false, false, false);
+        proto->AddFuncProperty("join", ArrayProto::join, false, false, false);
+        proto->AddFuncProperty("pop", ArrayProto::pop, false, false, false);
+        proto->AddFuncProperty("push", ArrayProto::push, false, false, false);
+        proto->AddFuncProperty("reverse", ArrayProto::reverse, false, false, false);
+        proto->AddFuncProperty("shift", ArrayProto::shift, false, false, false);
+        proto->AddFuncProperty("slice", ArrayProto::slice, false, false, false);
+        proto->AddFuncProperty("sort", ArrayProto::sort, false, false, false);
+        proto->AddFuncProperty("splice", ArrayProto::splice, false, false, false);
+        proto->AddFuncProperty("unshift", ArrayProto::unshift, false, false, false);
+        proto->AddFuncProperty("indexOf", ArrayProto::indexOf, false, false, false);
+        proto->AddFuncProperty("lastIndexOf", ArrayProto::lastIndexOf, false, false, false);
+        proto->AddFuncProperty("every", ArrayProto::every, false, false, false);
+        proto->AddFuncProperty("some", ArrayProto::some, false, false, false);
+        proto->AddFuncProperty("forEach", ArrayProto::forEach, false, false, false);
+        proto->AddFuncProperty("map", ArrayProto::map, false, false, false);
+        proto->AddFuncProperty("filter", ArrayProto::filter, false, false, false);
+        proto->AddFuncProperty("reduce", ArrayProto::reduce, false, false, false);
+        proto->AddFuncProperty("reduceRight", ArrayProto::reduceRight, false, false, false);
+    }
+
+    inline void InitTypedArray()
+    {
+        ArrayBufferConstructor* buffer_constructor = ArrayBufferConstructor::Instance();
+        buffer_constructor->SetPrototype(FunctionProto::Instance());
+        // ES6 24.1.3 Properties of the ArrayBuffer Constructor
+        buffer_constructor->AddValueProperty("length", Number::One(), false, false, false);
+        buffer_constructor->AddValueProperty("prototype", ArrayBufferProto::Instance(), false, false, false);
+        buffer_constructor->AddFuncProperty("isView", ArrayBufferConstructor::isView, false, false, false);
+        buffer_constructor->AddFuncProperty("toString", ArrayBufferConstructor::toString, false, false, false);
+
+        ArrayBufferProto* buffer_proto = ArrayBufferProto::Instance();
+        buffer_proto->SetPrototype(ObjectProto::Instance());
+        // ES6 24.1.4 Properties of the ArrayBuffer Prototype Object
+        buffer_proto->AddValueProperty("constructor", ArrayBufferConstructor::Instance(), false, false, false);
+        buffer_proto->AddFuncProperty("slice", ArrayBufferProto::slice, false, false, false);
+
+        for(int i = 0; i < TYPED_NUM; i++)
+        {
+            TypedArrayType type = TypedArrayType(i);
+            Number* bytes_per_element = new Number(TypedArrayElementSize(type));
+            TypedArrayConstructor* constructor = TypedArrayConstructor::Instance(type);
+            constructor->SetPrototype(FunctionProto::Instance());
+            // ES6 22.2.5 Properties of the TypedArray Constructors
+            constructor->AddValueProperty("length", new Number(3), false, false, false);
+            constructor->AddValueProperty("prototype", TypedArrayProto::Instance(type), false, false, false);
+            constructor->AddValueProperty("BYTES_PER_ELEMENT", bytes_per_element, false, false, false);
+            constructor->AddFuncProperty("toString", TypedArrayConstructor::toString, false, false, false);
+
+            TypedArrayProto* proto = TypedArrayProto::Instance(type);
+            proto->SetPrototype(ObjectProto::Instance());
+            // ES6 22.2.3 and 22.2.6 Properties of the TypedArray Prototype Objects
+            proto->AddValueProperty("constructor", constructor, false, false, false);
+            proto->AddValueProperty("BYTES_PER_ELEMENT", bytes_per_element, false, false, false);
+            proto->AddFuncProperty("set", TypedArrayProto::set, false, false, false);
+            proto->AddFuncProperty("subarray", TypedArrayProto::subarray, false, false, false);
+            proto->AddFuncProperty("fill", TypedArrayProto::fill, false, false, false);
+        }
+    }
+
+    inline void Init()
+    {
+        InitGlobalObject();
+        InitObject();
+        InitFunction();
+        InitNumber();
+        InitError();
+        InitBool();
+        InitString();
+        InitArray();
+        InitTypedArray();
+    }
+
+    JSValue* ToPrimitive(Error* e, JSValue* input, const std::string& preferred_type);
+    bool ToBoolean(JSValue* input);
+    // Parses the longest prefix of [begin, end) that is a StrUnsignedDecimalLiteral
+    // other than Infinity (9.3.1) into a correctly rounded *result, and returns
+    // its end, or begin if there is none.
+    const char* ParseDecimal(const char* begin, const char* end, double* result);
+    // Same for the longest run of digits of radix 2 to 36.
+    const char* ParseDigits(const char* begin, const char* end, int radix, double* result);
+    double StringToNumber(const std::string& source);
+    double StringToNumber(String* str);
+    // The number that parseInt and parseFloat make of source. A radix of 0
+    // means that none was given.
+    double ParseInt(const std::string& source, int radix);
+    double ParseFloat(const std::string& source);
+    double ToNumber(Error* e, JSValue* input);
+    double ToInteger(Error* e, JSValue* input);
+    double ToInt32(Error* e, JSValue* input);
+    double ToUint(Error* e, JSValue* input, char bits);
+    double ToUint32(Error* e, JSValue* input);
+    double ToUint16(Error* e, JSValue* input);
+    // Large enough for the string of any number, e.g. "-1.2345678901234567e-308".
+    constexpr size_t kNumberToStringSize = 32;
+    // Writes the shortest string that reads back as m into buf, which holds
+    // kNumberToStringSize chars, and returns its length.
+    size_t NumberToString(double m, char* buf);
+    std::string NumberToString(double m);
+    std::string NumberToString(Number* num);
+    std::string ToString(Error* e, JSValue* input);
+
+    JSObject* ToObject(Error* e, JSValue* input);
+
+    // 11.8.5 The Abstract Relational Comparison Algorithm
+    // x < y
+    JSValue* LessThan(Error* e, JSValue* x, JSValue* y, bool left_first = true);
+    // 11.9.3 The Abstract Equality Comparison Algorithm
+    // x == y
+    bool Equal(Error* e, JSValue* x, JSValue* y);
+    // 11.9.6 The Strict Equality Comparison Algorithm
+    // x === y
+    bool StrictEqual(Error* e, JSValue* x, JSValue* y);
+
+    Completion EvalStatement(Parsing::AST* ast);
+    Completion EvalStatementList(const std::vector<Parsing::AST*>& statements);
+    Completion EvalBlockStatement(Parsing::AST* ast);
+    std::string EvalVarDecl(Error* e, Parsing::AST* ast);
+    Completion EvalVarStatement(Parsing::AST* ast);
+    Completion EvalIfStatement(Parsing::AST* ast);
+    Completion EvalForStatement(Parsing::AST* ast);
+    Completion EvalForInStatement(Parsing::AST* ast);
+    Completion EvalDoWhileStatement(Parsing::AST* ast);
+    Completion EvalWhileStatement(Parsing::AST* ast);
+    Completion EvalContinueStatement(Parsing::AST* ast);
+    Completion EvalBreakStatement(Parsing::AST* ast);
+    Completion EvalReturnStatement(Parsing::AST* ast);
+    Completion EvalLabelledStatement(Parsing::AST* ast);
+    Completion EvalWithStatement(Parsing::AST* ast);
+    Completion EvalSwitchStatement(Parsing::AST* ast);
+    Completion EvalThrowStatement(Parsing::AST* ast);
+    Completion EvalTryStatement(Parsing::AST* ast);
+    Completion EvalExpressionStatement(Parsing::AST* ast);
+
+    JSValue* EvalExpression(Error* e, Parsing::AST* ast);
+    JSValue* EvalExpressionValue(Error* e, Parsing::AST* ast);
+    std::string EvalPropertyName(Error* e, const Parsing::Token& token);
+    JSValue* EvalPrimaryExpression(Error* e, Parsing::AST* ast);
+    Reference* EvalIdentifier(Parsing::AST* ast);
+    Number* EvalNumber(Parsing::AST* ast);
+    String* EvalString(Parsing::AST* ast);
+    Object* EvalObject(Error* e, Parsing::AST* ast);
+    ArrayObject* EvalArray(Error* e, Parsing::AST* ast);
+    JSValue* EvalUnaryOperator(Error* e, Parsing::AST* ast);
+    JSValue* EvalBinaryExpression(Error* e, Parsing::AST* ast);
+    JSValue* EvalBinaryExpression(Error* e, const std::string& op, JSValue* lval, JSValue* rval);
+    Number* EvalInt32ArithmeticOperator(char op, int32_t lnum, int32_t rnum);
+    JSValue* EvalQuickenedBinary(Parsing::Binary* b, JSValue* lval, JSValue* rval);
+    JSValue* EvalArithmeticOperator(Error* e, const std::string& op, JSValue* lval, JSValue* rval);
+    JSValue* EvalAddOperator(Error* e, JSValue* lval, JSValue* rval);
+    JSValue* EvalBitwiseShiftOperator(Error* e, const std::string& op, JSValue* lval, JSValue* rval);
+    JSValue* EvalRelationalOperator(Error* e, const std::string& op, JSValue* lval, JSValue* rval);
+    JSValue* EvalEqualityOperator(Error* e, const std::string& op, JSValue* lval, JSValue* rval);
+    JSValue* EvalBitwiseOperator(Error* e, const std::string& op, JSValue* lval, JSValue* rval);
+    JSValue* EvalLogicalOperator(Error* e, const std::string& op, Parsing::AST* lhs, Parsing::AST* rhs);
+    JSValue* EvalSimpleAssignment(Error* e, JSValue* lref, JSValue* rval);
+    JSValue* EvalCompoundAssignment(Error* e, Parsing::Binary* b, JSValue* lref, JSValue* rval);
+    JSValue* EvalTripleConditionExpression(Error* e, Parsing::AST* ast);
+    JSValue* EvalAssignmentExpression(Error* e, Parsing::AST* ast);
+    JSValue* EvalLeftHandSideExpression(Error* e, Parsing::AST* ast);
+    void EvalArgumentsList(Error* e, Parsing::Arguments* ast, std::vector<JSValue*>& arg_list);
+    JSValue* EvalCallExpression(Error* e, JSValue* ref, const std::vector<JSValue*>& arg_list);
+    JSValue* EvalIndexExpression(Error* e, JSValue* base_ref, const std::string& identifier_name, ValueGuard& guard,
+                                 Parsing::LHS::PropertyCache* cache = nullptr);
+    JSValue* EvalIndexExpression(Error* e, JSValue* base_ref, uint32_t index, ValueGuard& guard);
+    JSValue* EvalIndexExpression(Error* e, JSValue* base_ref, Parsing::AST* expr, ValueGuard& guard);
+    JSValue* EvalExpressionList(Error* e, Parsing::AST* ast);
+
+    Reference* IdentifierResolution(const std::string& name);
+
+    // The optimizing tier. A function body, program or eval
+    // code entered more than threshold times is rewritten in place once:
+    // literals are evaluated ahead of time, operators over constants are
+    // folded, and identifiers speculate that their binding sits in the same
+    // slot of the innermost environment on every evaluation. That is a
+    // binding of a declarative environment, or a data property of the global
+    // object while its layout does not change. The speculation is checked on
+    // each use, and a failing check falls back to the generic lookup of
+    // 10.3.1 (a deopt). Nested functions tier up on their own.
+    //
+    // A loop that iterates more than threshold times is rewritten the same
+    // way while it runs, so code entered once, like the top level loops of a
+    // script, gets optimized too. As the nodes are rewritten in place and the
+    // environments stay as they are, the next iteration simply runs the
+    // optimized loop, which is on-stack replacement for a tree of nodes.
+    class OptimizingTier
+    {
+        public:
+            static constexpr uint32_t kDefaultThreshold = 100;
+            // Failed speculations after which an identifier stops speculating.
+            static constexpr uint32_t kMaxDeopts = 4;
+            // Slots from this one on are global cells.
+            static constexpr uint32_t kGlobalSlot = 1u << 30;
+
+            static OptimizingTier* Global()
+            {
+                static OptimizingTier singleton;
+                return &singleton;
+            }
 
-    Completion EvalStatement(Parsing::AST* ast);
-    Completion EvalStatementList(const std::vector<Parsing::AST*>& statements);
-    Completion EvalBlockStatement(Parsing::AST* ast);
-    std::string EvalVarDecl(Error* e, Parsing::AST* ast);
-    Completion EvalVarStatement(Parsing::AST* ast);
-    Completion EvalIfStatement(Parsing::AST* ast);
-    Completion EvalForStatement(Parsing::AST* ast);
-    Completion EvalForInStatement(Parsing::AST* ast);
-    Completion EvalDoWhileStatement(Parsing::AST* ast);
-    Completion EvalWhileStatement(Parsing::AST* ast);
-    Completion EvalContinueStatement(Parsing::AST* ast);
-    Completion EvalBreakStatement(Parsing::AST* ast);
-    Completion EvalReturnStatement(Parsing::AST* ast);
-    Completion EvalLabelledStatement(Parsing::AST* ast);
-    Completion EvalWithStatement(Parsing::AST* ast);
-    Completion EvalSwitchStatement(Parsing::AST* ast);
-    Completion EvalThrowStatement(Parsing::AST* ast);
-    Completion EvalTryStatement(Parsing::AST* ast);
-    Completion EvalExpressionStatement(Parsing::AST* ast);
+            // 0 optimizes all code before it first runs.
+            void SetThreshold(uint32_t threshold)
+            {
+                threshold_ = threshold;
+            }
+            uint32_t threshold()
+            {
+                return threshold_;
+            }
+
+            // Called each time body is entered.
+            void CountEntry(Parsing::ProgramOrFunctionBody* body)
+            {
+                if(body->CountEntry() >= threshold_)
+                {
+                    Optimize(body);
+                }
+            }
+
+            // Called on each iteration of loop.
+            void CountBackEdge(Parsing::AST* loop)
+            {
+                if(!loop->optimized() && loop->CountBackEdge() >= threshold_)
+                {
+                    replaced_++;
+                    Visit(loop);
+                }
+            }
+
+            void Optimize(Parsing::ProgramOrFunctionBody* body)
+            {
+                if(body->optimized())
+                {
+                    return;
+                }
+                body->SetOptimized();
+                optimized_++;
+                // The other runs of body that are still active
+                // hold the object and have no "p.x" bindings, so the rewrite
+                // is only safe while the run that got here is the only one.
+                if(body->active_calls() == 1)
+                {
+                    ReplaceScalars(body);
+                }
+                VisitAll(body->statements());
+            }
+
+            // Reads the binding name from the slot site speculates it is in.
+            // Returns nullptr if site does not speculate or the speculation
+            // fails, and then the caller looks name up.
+            JSValue* ReadSlot(Error* e, Parsing::AST* site, const std::string& name)
+            {
+                EnvironmentRecord* env = RuntimeContext::TopLexicalEnv()->env_rec();
+                uint32_t slot = site->slot();
+                if(slot == Parsing::AST::kUnresolvedSlot)
+                {
+                    slot = ResolveSlot(site, name, env);
+                }
+                if(slot == Parsing::AST::kNoSlot)
+                {
+                    return nullptr;
+                }
+                if(slot < kGlobalSlot)
+                {
+                    if(env->IsDeclarative())
+                    {
+                        DeclarativeEnvironmentRecord* decl_env = static_cast<DeclarativeEnvironmentRecord*>(env);
+                        DeclarativeEnvironmentRecord::Binding* b = decl_env->BindingAt(slot, name);
+                        if(b != nullptr)
+                        {
+                            return decl_env->GetBindingValue(e, b, RuntimeContext::TopContext()->strict());
+                        }
+                    }
+                }
+                else if(env == LexicalEnvironment::Global()->env_rec())
+                {// A layout change may have removed the property or made it an accessor.
+                    const GlobalCell& cell = global_cells_[slot - kGlobalSlot];
+                    if(cell.epoch == GlobalObject::Instance()->layout_epoch() && !cell.slot->IsAccessor())
+                    {
+                        return cell.slot->Value();
+                    }
+                }
+                Deopt(site);
+                return nullptr;
+            }
+
+            size_t optimized()
+            {
+                return optimized_;
+            }
+            size_t replaced()
+            {
+                return replaced_;
+            }
+            size_t scalars()
+            {
+                return scalars_;
+            }
+            size_t constants()
+            {
+                return constants_;
+            }
+            size_t speculations()
+            {
+                return speculations_;
+            }
+            size_t deopts()
+            {
+                return deopts_;
+            }
+
+        private:
+            struct GlobalCell
+            {
+                PropertySlot* slot;
+                uint64_t epoch;
+            };
+
+            OptimizingTier()
+            : threshold_(kDefaultThreshold), optimized_(0), replaced_(0), scalars_(0), constants_(0), speculations_(0), deopts_(0)
+            {
+            }
+
+            // Resolves the slot site speculates the binding name is in, or
+            // gives up on it if env does not hold name in a slot.
+            uint32_t ResolveSlot(Parsing::AST* site, const std::string& name, EnvironmentRecord* env)
+            {
+                uint32_t slot = Parsing::AST::kNoSlot;
+                if(env->IsDeclarative())
+                {
+                    slot = static_cast<DeclarativeEnvironmentRecord*>(env)->SlotOf(name);
+                }
+                else if(env == LexicalEnvironment::Global()->env_rec() && global_cells_.size() < kGlobalSlot - 2)
+                {
+                    GlobalObject* global = GlobalObject::Instance();
+                    PropertySlot* property = global->FindNamedProperty(name);
+                    if(property != nullptr && !property->IsAccessor())
+                    {
+                        slot = kGlobalSlot + static_cast<uint32_t>(global_cells_.size());
+                        global_cells_.push_back({ property, global->layout_epoch() });
+                    }
+                }
+                if(slot != Parsing::AST::kNoSlot)
+                {
+                    speculations_++;
+                }
+                site->SetSlot(slot);
+                return slot;
+            }
+
+            // Called when the binding of site is not in its speculated slot.
+            void Deopt(Parsing::AST* site)
+            {
+                deopts_++;
+                site->SetSlot(site->CountDeopt() < kMaxDeopts ? Parsing::AST::kUnresolvedSlot : Parsing::AST::kNoSlot);
+            }
+
+            static bool IsFoldable(const std::string& op, bool unary)
+            {
+                static const std::unordered_set<std::string> kBinary = {
+                    "*", "/", "%", "+", "-", "<<", ">>", ">>>", "<", ">", "<=", ">=", "==", "!=", "===", "!==", "&", "^", "|"
+                };
+                static const std::unordered_set<std::string> kUnary = { "-", "+", "!", "~", "typeof", "void" };
+                return unary ? kUnary.count(op) != 0 : kBinary.count(op) != 0;
+            }
+
+            void SetConstant(Parsing::AST* ast, JSValue* val)
+            {
+                ast->SetConstant(val);
+                constants_++;
+            }
+
+            // Calls f on each child of ast, except for the bodies of functions,
+            // which are optimized when they get hot themselves.
+            template<typename F>
+            static void ForEachChild(Parsing::AST* ast, F f)
+            {
+                using Parsing::AST;
+                auto all = [&f](const std::vector<AST*>& asts)
+                {
+                    for(AST* child : asts)
+                    {
+                        f(child);
+                    }
+                };
+                switch(ast->type())
+                {
+                    case AST::AST_EXPR_ARRAY:
+                        for(const auto& pair : static_cast<Parsing::ArrayLiteral*>(ast)->elements())
+                        {
+                            f(pair.second);
+                        }
+                        break;
+                    case AST::AST_EXPR_OBJ:
+                        for(const auto& property : static_cast<Parsing::ObjectLiteral*>(ast)->properties())
+                        {
+                            if(property.type == Parsing::ObjectLiteral::Property::NORMAL)
+                            {
+                                f(property.value);
+                            }
+                        }
+                        break;
+                    case AST::AST_EXPR_PAREN:
+                        f(static_cast<Parsing::Paren*>(ast)->expr());
+                        break;
+                    case AST::AST_EXPR_BINARY:
+                        f(static_cast<Parsing::Binary*>(ast)->lhs());
+                        f(static_cast<Parsing::Binary*>(ast)->rhs());
+                        break;
+                    case AST::AST_EXPR_UNARY:
+                        f(static_cast<Parsing::Unary*>(ast)->node());
+                        break;
+                    case AST::AST_EXPR_TRIPLE:
+                    {
+                        Parsing::TripleCondition* t = static_cast<Parsing::TripleCondition*>(ast);
+                        f(t->cond());
+                        f(t->true_expr());
+                        f(t->false_expr());
+                        break;
+                    }
+                    case AST::AST_EXPR_ARGS:
+                        all(static_cast<Parsing::Arguments*>(ast)->args());
+                        break;
+                    case AST::AST_EXPR_LHS:
+                    {
+                        Parsing::LHS* lhs = static_cast<Parsing::LHS*>(ast);
+                        f(lhs->base());
+                        for(Parsing::Arguments* args : lhs->args_list())
+                        {
+                            f(args);
+                        }
+                        all(lhs->index_list());
+                        break;
+                    }
+                    case AST::AST_EXPR:
+                        all(static_cast<Parsing::Expression*>(ast)->elements());
+                        break;
+                    case AST::AST_STMT_BLOCK:
+                        all(static_cast<Parsing::Block*>(ast)->statements());
+                        break;
+                    case AST::AST_STMT_IF:
+                    {
+                        Parsing::If* if_stmt = static_cast<Parsing::If*>(ast);
+                        f(if_stmt->cond());
+                        f(if_stmt->if_block());
+                        f(if_stmt->else_block());
+                        break;
+                    }
+                    case AST::AST_STMT_WHILE:
+                    case AST::AST_STMT_WITH:
+                        f(static_cast<Parsing::WhileOrWith*>(ast)->expr());
+                        f(static_cast<Parsing::WhileOrWith*>(ast)->stmt());
+                        break;
+                    case AST::AST_STMT_DO_WHILE:
+                        f(static_cast<Parsing::DoWhile*>(ast)->expr());
+                        f(static_cast<Parsing::DoWhile*>(ast)->stmt());
+                        break;
+                    case AST::AST_STMT_FOR:
+                    {
+                        Parsing::For* stmt = static_cast<Parsing::For*>(ast);
+                        all(stmt->expr0s());
+                        f(stmt->expr1());
+                        f(stmt->expr2());
+                        f(stmt->statement());
+                        break;
+                    }
+                    case AST::AST_STMT_FOR_IN:
+                    {
+                        Parsing::ForIn* stmt = static_cast<Parsing::ForIn*>(ast);
+                        f(stmt->expr0());
+                        f(stmt->expr1());
+                        f(stmt->statement());
+                        break;
+                    }
+                    case AST::AST_STMT_TRY:
+                    {
+                        Parsing::Try* stmt = static_cast<Parsing::Try*>(ast);
+                        f(stmt->try_block());
+                        f(stmt->catch_block());
+                        f(stmt->finally_block());
+                        break;
+                    }
+                    case AST::AST_STMT_VAR:
+                        for(Parsing::VarDecl* decl : static_cast<Parsing::VarStmt*>(ast)->decls())
+                        {
+                            f(decl);
+                        }
+                        break;
+                    case AST::AST_STMT_VAR_DECL:
+                        f(static_cast<Parsing::VarDecl*>(ast)->init());
+                        break;
+                    case AST::AST_STMT_RETURN:
+                        f(static_cast<Parsing::Return*>(ast)->expr());
+                        break;
+                    case AST::AST_STMT_THROW:
+                        f(static_cast<Parsing::Throw*>(ast)->expr());
+                        break;
+                    case AST::AST_STMT_SWITCH:
+                    {
+                        Parsing::Switch* stmt = static_cast<Parsing::Switch*>(ast);
+                        f(stmt->expr());
+                        for(size_t i = 0; i < stmt->clause_count(); i++)
+                        {
+                            all(stmt->clause_stmts(i));
+                        }
+                        break;
+                    }
+                    case AST::AST_STMT_LABEL:
+                        f(static_cast<Parsing::LabelledStmt*>(ast)->statement());
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            // Scalar replacement. In a function that captures
+            // nothing and uses neither eval, arguments nor with, a statement
+            //     var p = { x: ..., y: ... };
+            // makes an object that can not escape if every later mention of p
+            // is p.x or p.y in the statements that follow it in the same
+            // block, as they always run after it. The object is then never
+            // made: the properties become the variables "p.x" and "p.y",
+            // which no identifier can name.
+            void ReplaceScalars(Parsing::ProgramOrFunctionBody* body)
+            {
+                if(body->type() != Parsing::AST::AST_FUNC_BODY || body->uses_arguments() || body->has_inner_functions())
+                {
+                    return;
+                }
+                for(Parsing::AST* stmt : body->statements())
+                {
+                    if(Mentions(stmt, "", true) != 0)
+                    {
+                        return;
+                    }
+                }
+                std::vector<std::string> added;
+                FindScalars(body, body->statements(), &added);
+                // The body is about to run with the bindings made on entry.
+                LexicalEnvironment* env = RuntimeContext::TopContext()->variable_env();
+                for(const std::string& name : added)
+                {
+                    static_cast<DeclarativeEnvironmentRecord*>(env->env_rec())->InitializeMutableBinding(name, Undefined::Instance());
+                }
+            }
+
+            void FindScalars(Parsing::ProgramOrFunctionBody* body, const std::vector<Parsing::AST*>& stmts, std::vector<std::string>* added)
+            {
+                for(size_t i = 0; i < stmts.size(); i++)
+                {
+                    ReplaceScalars(body, stmts, i, added);
+                    FindBlocks(body, stmts[i], added);
+                }
+            }
+
+            void FindBlocks(Parsing::ProgramOrFunctionBody* body, Parsing::AST* ast, std::vector<std::string>* added)
+            {
+                if(ast == nullptr)
+                {
+                    return;
+                }
+                if(ast->type() == Parsing::AST::AST_STMT_BLOCK)
+                {
+                    FindScalars(body, static_cast<Parsing::Block*>(ast)->statements(), added);
+                    return;
+                }
+                ForEachChild(ast, [&](Parsing::AST* child)
+                {
+                    FindBlocks(body, child, added);
+                });
+            }
+
+            // Replaces the object literal declared by stmts[i] if it does not escape.
+            void ReplaceScalars(Parsing::ProgramOrFunctionBody* body, const std::vector<Parsing::AST*>& stmts, size_t i,
+                                std::vector<std::string>* added)
+            {
+                using Parsing::AST;
+                if(stmts[i]->type() != AST::AST_STMT_VAR || static_cast<Parsing::VarStmt*>(stmts[i])->decls().size() != 1)
+                {
+                    return;
+                }
+                Parsing::VarDecl* decl = static_cast<Parsing::VarStmt*>(stmts[i])->decls()[0];
+                const std::string& name = decl->ident();
+                const std::vector<std::string>& fresh = body->fresh_var_decls();
+                if(name == "arguments" || std::find(fresh.begin(), fresh.end(), name) == fresh.end())
+                {// Parameters and functions are bound on entry.
+                    return;
+                }
+                if(decl->init() == nullptr || decl->init()->type() != AST::AST_EXPR_LHS)
+                {
+                    return;
+                }
+                Parsing::LHS* init = static_cast<Parsing::LHS*>(decl->init());
+                if(!init->order().empty() || init->new_count() != 0 || init->base()->type() != AST::AST_EXPR_OBJ)
+                {
+                    return;
+                }
+                std::vector<std::string> keys;
+                for(const auto& property : static_cast<Parsing::ObjectLiteral*>(init->base())->properties())
+                {
+                    if(property.type != Parsing::ObjectLiteral::Property::NORMAL || property.key.type() == Parsing::Token::TK_NUMBER)
+                    {
+                        return;
+                    }
+                    Error error;
+                    std::string key = EvalPropertyName(&error, property.key);
+                    if(!error.IsOk() || std::find(keys.begin(), keys.end(), key) != keys.end())
+                    {
+                        return;
+                    }
+                    keys.emplace_back(key);
+                }
+                std::vector<Parsing::LHS*> uses;
+                for(size_t j = i + 1; j < stmts.size(); j++)
+                {
+                    if(!FindUses(stmts[j], name, keys, &uses))
+                    {
+                        return;
+                    }
+                }
+                size_t mentions = 0;
+                for(AST* stmt : body->statements())
+                {
+                    mentions += Mentions(stmt, name, false);
+                }
+                if(mentions != uses.size() + 1)
+                {// Mentioned somewhere else, or by the literal itself.
+                    return;
+                }
+                std::vector<std::string> scalars;
+                for(const std::string& key : keys)
+                {
+                    scalars.emplace_back(name + "." + key);
+                    body->AddVarDecl(scalars.back());
+                    added->emplace_back(scalars.back());
+                }
+                for(Parsing::LHS* use : uses)
+                {
+                    std::string scalar = name + "." + use->prop_name_list()[0];
+                    use->ReplaceWithVariable(scalar);
+                }
+                decl->SetScalars(std::move(scalars));
+                scalars_++;
+            }
+
+            // Whether ast is name.key for one of keys.
+            static bool IsScalarUse(Parsing::AST* ast, const std::string& name, const std::vector<std::string>& keys)
+            {
+                if(ast->type() != Parsing::AST::AST_EXPR_LHS)
+                {
+                    return false;
+                }
+                Parsing::LHS* lhs = static_cast<Parsing::LHS*>(ast);
+                return lhs->base()->type() == Parsing::AST::AST_EXPR_IDENT && lhs->base()->source() == name && lhs->new_count() == 0
+                       && lhs->order().size() == 1 && lhs->order()[0].second == Parsing::LHS::PROP
+                       && std::find(keys.begin(), keys.end(), lhs->prop_name_list()[0]) != keys.end();
+            }
+
+            // Collects the uses name.key in ast. Returns false if one of them
+            // is deleted, which the object would observe.
+            static bool FindUses(Parsing::AST* ast, const std::string& name, const std::vector<std::string>& keys, std::vector<Parsing::LHS*>* uses)
+            {
+                if(ast == nullptr)
+                {
+                    return true;
+                }
+                if(ast->type() == Parsing::AST::AST_EXPR_UNARY && static_cast<Parsing::Unary*>(ast)->op().source() == "delete"
+                   && IsScalarUse(static_cast<Parsing::Unary*>(ast)->node(), name, keys))
+                {
+                    return false;
+                }
+                if(IsScalarUse(ast, name, keys))
+                {
+                    uses->emplace_back(static_cast<Parsing::LHS*>(ast));
+                }
+                bool ok = true;
+                ForEachChild(ast, [&](Parsing::AST* child)
+                {
+                    ok = ok && FindUses(child, name, keys, uses);
+                });
+                return ok;
+            }
+
+            // Counts the identifiers, declarations and catch parameters
+            // named name in ast, or with the with statements if with is set.
+            static size_t Mentions(Parsing::AST* ast, const std::string& name, bool with)
+            {
+                using Parsing::AST;
+                if(ast == nullptr)
+                {
+                    return 0;
+                }
+                size_t count = 0;
+                switch(ast->type())
+                {
+                    case AST::AST_EXPR_IDENT:
+                        count = !with && ast->source() == name;
+                        break;
+                    case AST::AST_STMT_VAR_DECL:
+                        count = !with && static_cast<Parsing::VarDecl*>(ast)->ident() == name;
+                        break;
+                    case AST::AST_STMT_TRY:
+                        count = !with && static_cast<Parsing::Try*>(ast)->catch_ident() == name;
+                        break;
+                    case AST::AST_STMT_WITH:
+                        count = with;
+                        break;
+                    default:
+                        break;
+                }
+                ForEachChild(ast, [&](AST* child)
+                {
+                    count += Mentions(child, name, with);
+                });
+                return count;
+            }
+
+            // Folds the operators of ast whose operands are all constant.
+            // Evaluating them has no side effect and can not throw, as their
+            // values are primitive.
+            void Visit(Parsing::AST* ast)
+            {
+                using Parsing::AST;
+                if(ast == nullptr || ast->optimized())
+                {
+                    return;
+                }
+                ast->SetOptimized();
+                ForEachChild(ast, [this](AST* child)
+                {
+                    Visit(child);
+                });
+                Error error;
+                switch(ast->type())
+                {
+                    case AST::AST_EXPR_IDENT:
+                        if(ast->slot() == AST::kNoSlot)
+                        {
+                            ast->SetSlot(AST::kUnresolvedSlot);
+                        }
+                        break;
+                    case AST::AST_EXPR_NULL:
+                        SetConstant(ast, Null::Instance());
+                        break;
+                    case AST::AST_EXPR_BOOL:
+                        SetConstant(ast, ast->source() == "true" ? Bool::True() : Bool::False());
+                        break;
+                    case AST::AST_EXPR_NUMBER:
+                        SetConstant(ast, EvalNumber(ast));
+                        break;
+                    case AST::AST_EXPR_STRING:
+                        SetConstant(ast, EvalString(ast));
+                        break;
+                    case AST::AST_EXPR_PAREN:
+                        if(static_cast<Parsing::Paren*>(ast)->expr()->constant() != nullptr)
+                        {
+                            SetConstant(ast, static_cast<Parsing::Paren*>(ast)->expr()->constant());
+                        }
+                        break;
+                    case AST::AST_EXPR_BINARY:
+                    {
+                        Parsing::Binary* b = static_cast<Parsing::Binary*>(ast);
+                        JSValue* lval = b->lhs()->constant();
+                        JSValue* rval = b->rhs()->constant();
+                        if(lval != nullptr && rval != nullptr && IsFoldable(b->op(), false))
+                        {
+                            JSValue* val = EvalBinaryExpression(&error, b->op(), lval, rval);
+                            if(error.IsOk())
+                            {
+                                SetConstant(ast, val);
+                            }
+                        }
+                        break;
+                    }
+                    case AST::AST_EXPR_UNARY:
+                    {
+                        Parsing::Unary* u = static_cast<Parsing::Unary*>(ast);
+                        if(u->node()->constant() != nullptr && IsFoldable(u->op().source(), true))
+                        {
+                            JSValue* val = EvalUnaryOperator(&error, ast);
+                            if(error.IsOk())
+                            {
+                                SetConstant(ast, val);
+                            }
+                        }
+                        break;
+                    }
+                    case AST::AST_EXPR_LHS:
+                    {
+                        // The parser wraps every primary expression in an LHS.
+                        Parsing::LHS* lhs = static_cast<Parsing::LHS*>(ast);
+                        if(lhs->order().empty() && lhs->new_count() == 0)
+                        {
+                            ast->SetConstant(lhs->base()->constant());
+                            ast->SetSlot(lhs->base()->slot());
+                        }
+                        break;
+                    }
+                    default:
+                        break;
+                }
+            }
+
+            void VisitAll(const std::vector<Parsing::AST*>& asts)
+            {
+                for(Parsing::AST* ast : asts)
+                {
+                    Visit(ast);
+                }
+            }
+
+            uint32_t threshold_;
+            size_t optimized_;
+            size_t replaced_;
+            size_t scalars_;
+            size_t constants_;
+            size_t speculations_;
+            size_t deopts_;
+            std::vector<GlobalCell> global_cells_;
+    };
+
+    class ActiveCallGuard
+    {
+        private:
+            Parsing::ProgramOrFunctionBody* body_;
 
-    JSValue* EvalExpression(Error* e, Parsing::AST* ast);
-    JSValue* EvalPrimaryExpression(Error* e, Parsing::AST* ast);
-    Reference* EvalIdentifier(Parsing::AST* ast);
-    Number* EvalNumber(Parsing::AST* ast);
-    String* EvalString(Parsing::AST* ast);
-    Object* EvalObject(Error* e, Parsing::AST* ast);
-    ArrayObject* EvalArray(Error* e, Parsing::AST* ast);
-    JSValue* EvalUnaryOperator(Error* e, Parsing::AST* ast);
-    JSValue* EvalBinaryExpression(Error* e, Parsing::AST* ast);
-    JSValue* EvalBinaryExpression(Error* e, const std::string& op, Parsing::AST* lhs, Parsing::AST* rhs);
-    JSValue* EvalBinaryExpression(Error* e, const std::string& op, JSValue* lval, JSValue* rval);
-    JSValue* EvalArithmeticOperator(Error* e, const std::string& op, JSValue* lval, JSValue* rval);
-    JSValue* EvalAddOperator(Error* e, JSValue* lval, JSValue* rval);
-    JSValue* EvalBitwiseShiftOperator(Error* e, const std::string& op, JSValue* lval, JSValue* rval);
-    JSValue* EvalRelationalOperator(Error* e, const std::string& op, JSValue* lval, JSValue* rval);
-    JSValue* EvalEqualityOperator(Error* e, const std::string& op, JSValue* lval, JSValue* rval);
-    JSValue* EvalBitwiseOperator(Error* e, const std::string& op, JSValue* lval, JSValue* rval);
-    JSValue* EvalLogicalOperator(Error* e, const std::string& op, Parsing::AST* lhs, Parsing::AST* rhs);
-    JSValue* EvalSimpleAssignment(Error* e, JSValue* lref, JSValue* rval);
-    JSValue* EvalCompoundAssignment(Error* e, const std::string& op, JSValue* lref, JSValue* rval);
-    JSValue* EvalTripleConditionExpression(Error* e, Parsing::AST* ast);
-    JSValue* EvalAssignmentExpression(Error* e, Parsing::AST* ast);
-    JSValue* EvalLeftHandSideExpression(Error* e, Parsing::AST* ast);
-    std::vector<JSValue*> EvalArgumentsList(Error* e, Parsing::Arguments* ast);
-    JSValue* EvalCallExpression(Error* e, JSValue* ref, const std::vector<JSValue*>& arg_list);
-    JSValue* EvalIndexExpression(Error* e, JSValue* base_ref, const std::string& identifier_name, ValueGuard& guard);
-    JSValue* EvalIndexExpression(Error* e, JSValue* base_ref, Parsing::AST* expr, ValueGuard& guard);
-    JSValue* EvalExpressionList(Error* e, Parsing::AST* ast);
+        public:
+            explicit ActiveCallGuard(Parsing::ProgramOrFunctionBody* body) : body_(body)
+            {
+                body_->EnterCall();
+            }
 
-    Reference* IdentifierResolution(const std::string& name);
+            ~ActiveCallGuard()
+            {
+                body_->ExitCall();
+            }
+    };
 
     inline Completion EvalProgram(Parsing::AST* ast)
     {
         Completion head_result;
         assert(ast->type() == Parsing::AST::AST_PROGRAM || ast->type() == Parsing::AST::AST_FUNC_BODY);
         auto prog = static_cast<Parsing::ProgramOrFunctionBody*>(ast);
-        auto statements = prog->statements();
+        ActiveCallGuard active_call(prog);
+        if(!prog->optimized())
+        {
+            OptimizingTier::Global()->CountEntry(prog);
+        }
+        const auto& statements = prog->statements();
         // 12.9 considered syntactically incorrect if it contains
         //      a return statement that is not within a FunctionBody.
         if(ast->type() != Parsing::AST::AST_FUNC_BODY)
@@ -8254,13 +13390,13 @@ namespace es
             {
                 if(stmt->type() == Parsing::AST::AST_STMT_RETURN)
                 {
-                    return Completion(Completion::THROWING, new ErrorObject(Error::SyntaxError()), "");
+                    return Completion(Completion::THROWING, new ErrorObject(Error::SyntaxError()));
                 }
             }
         }
         if(statements.empty())
         {
-            return Completion(Completion::NORMAL, nullptr, "");
+            return Completion(Completion::NORMAL, nullptr);
         }
         for(auto stmt : prog->statements())
         {
@@ -8288,7 +13424,7 @@ namespace es
             case Parsing::AST::AST_STMT_VAR:
                 return EvalVarStatement(ast);
             case Parsing::AST::AST_STMT_EMPTY:
-                return Completion(Completion::NORMAL, nullptr, "");
+                return Completion(Completion::NORMAL, nullptr);
             case Parsing::AST::AST_STMT_IF:
                 return EvalIfStatement(ast);
             case Parsing::AST::AST_STMT_DO_WHILE:
@@ -8316,7 +13452,7 @@ namespace es
             case Parsing::AST::AST_STMT_TRY:
                 return EvalTryStatement(ast);
             case Parsing::AST::AST_STMT_DEBUG:
-                return Completion(Completion::NORMAL, nullptr, "");
+                return Completion(Completion::NORMAL, nullptr);
             default:
                 return EvalExpressionStatement(ast);
         }
@@ -8356,13 +13492,25 @@ namespace es
         {
             return decl->ident();
         }
-        JSValue* lhs = IdentifierResolution(decl->ident());
-        JSValue* rhs = EvalAssignmentExpression(e, decl->init());
-        if(!e->IsOk())
-        {
+        if(!decl->scalars().empty())
+        {// The object literal is replaced by its properties, see OptimizingTier.
+            Parsing::LHS* init = static_cast<Parsing::LHS*>(decl->init());
+            const auto& properties = static_cast<Parsing::ObjectLiteral*>(init->base())->properties();
+            EnvironmentRecord* env = RuntimeContext::TopContext()->variable_env()->env_rec();
+            bool strict = RuntimeContext::TopContext()->strict();
+            for(size_t i = 0; i < properties.size(); i++)
+            {
+                JSValue* value = EvalExpressionValue(e, properties[i].value);
+                if(!e->IsOk())
+                {
+                    return decl->ident();
+                }
+                env->SetMutableBinding(e, decl->scalars()[i], value, strict);
+            }
             return decl->ident();
         }
-        JSValue* value = GetValue(e, rhs);
+        JSValue* lhs = IdentifierResolution(decl->ident());
+        JSValue* value = EvalExpressionValue(e, decl->init());
         if(!e->IsOk())
         {
             return decl->ident();
@@ -8378,7 +13526,8 @@ namespace es
     inline Completion EvalVarStatement(Parsing::AST* ast)
     {
         assert(ast->type() == Parsing::AST::AST_STMT_VAR);
-        Error* e = Error::Ok();
+        Error error;
+        Error* e = &error;
         Parsing::VarStmt* var_stmt = static_cast<Parsing::VarStmt*>(ast);
         for(Parsing::VarDecl* decl : var_stmt->decls())
         {
@@ -8392,25 +13541,21 @@ namespace es
                 goto error;
             }
         }
-        return Completion(Completion::NORMAL, nullptr, "");
+        return Completion(Completion::NORMAL, nullptr);
     error:
-        return Completion(Completion::THROWING, new ErrorObject(e), "");
+        return Completion(Completion::THROWING, ThrownValue(e));
     }
 
     inline Completion EvalIfStatement(Parsing::AST* ast)
     {
         assert(ast->type() == Parsing::AST::AST_STMT_IF);
-        Error* e = Error::Ok();
+        Error error;
+        Error* e = &error;
         Parsing::If* if_stmt = static_cast<Parsing::If*>(ast);
-        JSValue* expr_ref = EvalExpression(e, if_stmt->cond());
-        if(!e->IsOk())
-        {
-            return Completion(Completion::THROWING, new ErrorObject(e), "");
-        }
-        JSValue* expr = GetValue(e, expr_ref);
+        JSValue* expr = EvalExpressionValue(e, if_stmt->cond());
         if(!e->IsOk())
         {
-            return Completion(Completion::THROWING, new ErrorObject(e), "");
+            return Completion(Completion::THROWING, ThrownValue(e));
         }
         if(ToBoolean(expr))
         {
@@ -8420,49 +13565,40 @@ namespace es
         {
             return EvalStatement(if_stmt->else_block());
         }
-        return Completion(Completion::NORMAL, nullptr, "");
+        return Completion(Completion::NORMAL, nullptr);
     }
 
     // 12.6.1 The do-while Statement
     inline Completion EvalDoWhileStatement(Parsing::AST* ast)
     {
         assert(ast->type() == Parsing::AST::AST_STMT_DO_WHILE);
-        Error* e = Error::Ok();
-        RuntimeContext::TopContext()->EnterIteration();
+        Error error;
+        Error* e = &error;
         Parsing::DoWhile* loop_stmt = static_cast<Parsing::DoWhile*>(ast);
         JSValue* V = nullptr;
-        JSValue* expr_ref;
         JSValue* val;
         Completion stmt;
-        bool has_label;
         while(true)
         {
+            OptimizingTier::Global()->CountBackEdge(ast);
             stmt = EvalStatement(loop_stmt->stmt());
             if(stmt.value != nullptr)
             {// 3.b
                 V = stmt.value;
             }
-            has_label = stmt.target == ast->label() || stmt.target.empty();
-            if(stmt.type != Completion::CONTINUING || !has_label)
+            if(stmt.type != Completion::CONTINUING || stmt.target != ast->target())
             {
-                if(stmt.type == Completion::BREAKING && has_label)
+                if(stmt.type == Completion::BREAKING && stmt.target == ast->target())
                 {
-                    RuntimeContext::TopContext()->ExitIteration();
-                    return Completion(Completion::NORMAL, V, "");
+                    return Completion(Completion::NORMAL, V);
                 }
                 if(stmt.IsAbruptCompletion())
                 {
-                    RuntimeContext::TopContext()->ExitIteration();
                     return stmt;
                 }
             }
 
-            expr_ref = EvalExpression(e, loop_stmt->expr());
-            if(!e->IsOk())
-            {
-                goto error;
-            }
-            val = GetValue(e, expr_ref);
+            val = EvalExpressionValue(e, loop_stmt->expr());
             if(!e->IsOk())
             {
                 goto error;
@@ -8472,33 +13608,25 @@ namespace es
                 break;
             }
         }
-        RuntimeContext::TopContext()->ExitIteration();
-        return Completion(Completion::NORMAL, V, "");
+        return Completion(Completion::NORMAL, V);
     error:
-        RuntimeContext::TopContext()->ExitIteration();
-        return Completion(Completion::THROWING, new ErrorObject(e), "");
+        return Completion(Completion::THROWING, ThrownValue(e));
     }
 
     // 12.6.2 The while Statement
     inline Completion EvalWhileStatement(Parsing::AST* ast)
     {
         assert(ast->type() == Parsing::AST::AST_STMT_WHILE);
-        Error* e = Error::Ok();
-        RuntimeContext::TopContext()->EnterIteration();
+        Error error;
+        Error* e = &error;
         Parsing::WhileOrWith* loop_stmt = static_cast<Parsing::WhileOrWith*>(ast);
         JSValue* V = nullptr;
-        JSValue* expr_ref;
         JSValue* val;
         Completion stmt;
-        bool has_label;
         while(true)
         {
-            expr_ref = EvalExpression(e, loop_stmt->expr());
-            if(!e->IsOk())
-            {
-                goto error;
-            }
-            val = GetValue(e, expr_ref);
+            OptimizingTier::Global()->CountBackEdge(ast);
+            val = EvalExpressionValue(e, loop_stmt->expr());
             if(!e->IsOk())
             {
                 goto error;
@@ -8513,38 +13641,32 @@ namespace es
             {// 3.b
                 V = stmt.value;
             }
-            has_label = stmt.target == ast->label() || stmt.target.empty();
-            if(stmt.type != Completion::CONTINUING || !has_label)
+            if(stmt.type != Completion::CONTINUING || stmt.target != ast->target())
             {
-                if(stmt.type == Completion::BREAKING && has_label)
+                if(stmt.type == Completion::BREAKING && stmt.target == ast->target())
                 {
-                    RuntimeContext::TopContext()->ExitIteration();
-                    return Completion(Completion::NORMAL, V, "");
+                    return Completion(Completion::NORMAL, V);
                 }
                 if(stmt.IsAbruptCompletion())
                 {
-                    RuntimeContext::TopContext()->ExitIteration();
                     return stmt;
                 }
             }
         }
-        RuntimeContext::TopContext()->ExitIteration();
-        return Completion(Completion::NORMAL, V, "");
+        return Completion(Completion::NORMAL, V);
     error:
-        RuntimeContext::TopContext()->ExitIteration();
-        return Completion(Completion::THROWING, new ErrorObject(e), "");
+        return Completion(Completion::THROWING, ThrownValue(e));
     }
 
     // 12.6.3 The for Statement
     inline Completion EvalForStatement(Parsing::AST* ast)
     {
         assert(ast->type() == Parsing::AST::AST_STMT_FOR);
-        Error* e = Error::Ok();
-        RuntimeContext::TopContext()->EnterIteration();
+        Error error;
+        Error* e = &error;
         Parsing::For* for_stmt = static_cast<Parsing::For*>(ast);
         JSValue* V = nullptr;
         Completion stmt;
-        bool has_label;
         for(auto expr : for_stmt->expr0s())
         {
             if(expr->type() == Parsing::AST::AST_STMT_VAR_DECL)
@@ -8571,14 +13693,10 @@ namespace es
         }
         while(true)
         {
+            OptimizingTier::Global()->CountBackEdge(ast);
             if(for_stmt->expr1() != nullptr)
             {
-                JSValue* test_expr_ref = EvalExpression(e, for_stmt->expr1());
-                if(!e->IsOk())
-                {
-                    goto error;
-                }
-                JSValue* test_value = GetValue(e, test_expr_ref);
+                JSValue* test_value = EvalExpressionValue(e, for_stmt->expr1());
                 if(!e->IsOk())
                 {
                     goto error;
@@ -8594,17 +13712,14 @@ namespace es
             {// 3.b
                 V = stmt.value;
             }
-            has_label = stmt.target == ast->label() || stmt.target.empty();
-            if(stmt.type != Completion::CONTINUING || !has_label)
+            if(stmt.type != Completion::CONTINUING || stmt.target != ast->target())
             {
-                if(stmt.type == Completion::BREAKING && has_label)
+                if(stmt.type == Completion::BREAKING && stmt.target == ast->target())
                 {
-                    RuntimeContext::TopContext()->ExitIteration();
-                    return Completion(Completion::NORMAL, V, "");
+                    return Completion(Completion::NORMAL, V);
                 }
                 if(stmt.IsAbruptCompletion())
                 {
-                    RuntimeContext::TopContext()->ExitIteration();
                     return stmt;
                 }
             }
@@ -8623,199 +13738,239 @@ namespace es
                 }
             }
         }
-        RuntimeContext::TopContext()->ExitIteration();
-        return Completion(Completion::NORMAL, V, "");
+        return Completion(Completion::NORMAL, V);
     error:
-        RuntimeContext::TopContext()->ExitIteration();
-        return Completion(Completion::THROWING, new ErrorObject(e), "");
+        return Completion(Completion::THROWING, ThrownValue(e));
+    }
+
+    // Whether the names in cache can be reused to enumerate obj.
+    inline bool EnumerationCacheHit(Parsing::ForIn::EnumerationCache* cache, JSObject* obj)
+    {
+        if(cache->object == nullptr)
+        {
+            return false;
+        }
+        if(obj != cache->object || obj->layout_epoch() != cache->object_epoch)
+        {
+            if(!obj->EnumeratesNamedPropertiesOnly() || !obj->HasEnumerableOwnKeys(cache->keys, cache->own_count))
+            {
+                return false;
+            }
+        }
+        JSValue* proto = obj->Prototype();
+        for(const auto& pair : cache->prototypes)
+        {
+            if(proto != pair.first || static_cast<JSObject*>(proto)->layout_epoch() != pair.second)
+            {
+                return false;
+            }
+            proto = static_cast<JSObject*>(proto)->Prototype();
+        }
+        return proto->IsNull();
+    }
+
+    // Fills cache with the names of the enumerable properties of obj, and
+    // records what they depend on if obj can be cached.
+    inline void FillEnumerationCache(Parsing::ForIn::EnumerationCache* cache, JSObject* obj)
+    {
+        cache->keys.clear();
+        cache->prototypes.clear();
+        cache->object = nullptr;
+        for(const auto& name : obj->AllEnumerableProperties())
+        {
+            cache->keys.emplace_back(new String(name));
+        }
+        cache->own_count = obj->OwnPropertyCount();
+        if(!obj->EnumeratesNamedPropertiesOnly() || cache->own_count > cache->keys.size() ||
+           !obj->HasEnumerableOwnKeys(cache->keys, cache->own_count))
+        {
+            return;
+        }
+        JSValue* proto = obj->Prototype();
+        while(!proto->IsNull())
+        {
+            JSObject* proto_obj = static_cast<JSObject*>(proto);
+            if(!proto_obj->EnumeratesNamedPropertiesOnly())
+            {
+                cache->prototypes.clear();
+                return;
+            }
+            cache->prototypes.emplace_back(proto, proto_obj->layout_epoch());
+            proto = proto_obj->Prototype();
+        }
+        cache->object = obj;
+        cache->object_epoch = obj->layout_epoch();
     }
 
     // 12.6.4 The for-in Statement
     inline Completion EvalForInStatement(Parsing::AST* ast)
     {
         assert(ast->type() == Parsing::AST::AST_STMT_FOR_IN);
-        Error* e = Error::Ok();
-        RuntimeContext::TopContext()->EnterIteration();
+        Error error;
+        Error* e = &error;
         Parsing::ForIn* for_in_stmt = static_cast<Parsing::ForIn*>(ast);
+        Parsing::ForIn::EnumerationCache* cache = for_in_stmt->enumeration_cache();
+        bool is_var_decl = for_in_stmt->expr0()->type() == Parsing::AST::AST_STMT_VAR_DECL;
+        std::string var_name;
         JSObject* obj;
         JSValue* expr_ref;
         JSValue* expr_val;
         Completion stmt;
-        bool has_label;
         JSValue* V = nullptr;
-        if(for_in_stmt->expr0()->type() == Parsing::AST::AST_STMT_VAR_DECL)
-        {
-            Parsing::VarDecl* decl = static_cast<Parsing::VarDecl*>(for_in_stmt->expr0());
-            std::string var_name = EvalVarDecl(e, decl);
+        std::vector<JSValue*> uncached_keys;
+        const std::vector<JSValue*>* keys;
+        bool check_deleted;
+        bool abrupt = false;
+        uint64_t layout;
+        if(is_var_decl)
+        {
+            var_name = EvalVarDecl(e, for_in_stmt->expr0());
             if(!e->IsOk())
             {
-                goto error;
+                return Completion(Completion::THROWING, ThrownValue(e));
             }
-            expr_ref = EvalExpression(e, for_in_stmt->expr1());
-            if(!e->IsOk())
+        }
+        expr_ref = EvalExpression(e, for_in_stmt->expr1());
+        if(!e->IsOk())
+        {
+            return Completion(Completion::THROWING, ThrownValue(e));
+        }
+        expr_val = GetValue(e, expr_ref);
+        if(!e->IsOk())
+        {
+            return Completion(Completion::THROWING, ThrownValue(e));
+        }
+        if(expr_val->IsUndefined() || expr_val->IsNull())
+        {
+            return Completion(Completion::NORMAL, nullptr);
+        }
+        obj = ToObject(e, expr_val);
+        if(!e->IsOk())
+        {
+            return Completion(Completion::THROWING, ThrownValue(e));
+        }
+
+        if(!cache->busy)
+        {
+            if(!EnumerationCacheHit(cache, obj))
             {
-                goto error;
+                FillEnumerationCache(cache, obj);
             }
-            expr_val = GetValue(e, expr_ref);
-            if(!e->IsOk())
+            cache->busy = true;
+            keys = &cache->keys;
+            check_deleted = cache->object == nullptr;
+        }
+        else
+        {
+            for(const auto& name : obj->AllEnumerableProperties())
             {
-                goto error;
+                uncached_keys.emplace_back(new String(name));
             }
-            if(expr_val->IsUndefined() || expr_val->IsNull())
+            keys = &uncached_keys;
+            check_deleted = true;
+        }
+        // A property deleted before it is visited is not
+        // visited. Unless the keys come from a reusable cache, whose objects
+        // report their layout changes, look each one up again.
+        layout = JSObject::LayoutCounter();
+        for(JSValue* P : *keys)
+        {
+            PropertySlot slot;
+            if((check_deleted || JSObject::LayoutCounter() != layout) &&
+               !obj->GetPropertySlot(static_cast<String*>(P)->data(), &slot))
             {
-                RuntimeContext::TopContext()->ExitIteration();
-                return Completion(Completion::NORMAL, nullptr, "");
+                continue;
             }
-            obj = ToObject(e, expr_val);
-            if(!e->IsOk())
+            OptimizingTier::Global()->CountBackEdge(ast);
+            if(is_var_decl)
             {
-                goto error;
+                expr_ref = IdentifierResolution(var_name);
             }
-
-            for(const auto& pair : obj->AllEnumerableProperties())
+            else
             {
-                String* P = new String(pair.first);
-                Reference* var_ref = IdentifierResolution(var_name);
-                PutValue(e, var_ref, P);
+                expr_ref = EvalExpression(e, for_in_stmt->expr0());
                 if(!e->IsOk())
                 {
-                    goto error;
-                }
-
-                stmt = EvalStatement(for_in_stmt->statement());
-                if(stmt.value != nullptr)
-                {
-                    V = stmt.value;
-                }
-                has_label = stmt.target == ast->label() || stmt.target.empty();
-                if(stmt.type != Completion::CONTINUING || !has_label)
-                {
-                    if(stmt.type == Completion::BREAKING && has_label)
-                    {
-                        RuntimeContext::TopContext()->ExitIteration();
-                        return Completion(Completion::NORMAL, V, "");
-                    }
-                    if(stmt.IsAbruptCompletion())
-                    {
-                        RuntimeContext::TopContext()->ExitIteration();
-                        return stmt;
-                    }
+                    break;
                 }
             }
-        }
-        else
-        {
-            expr_ref = EvalExpression(e, for_in_stmt->expr1());
-            if(!e->IsOk())
-            {
-                goto error;
-            }
-            expr_ref = EvalExpression(e, for_in_stmt->expr1());
+            PutValue(e, expr_ref, P);
             if(!e->IsOk())
             {
-                goto error;
-            }
-            expr_val = GetValue(e, expr_ref);
-            if(!e->IsOk())
-            {
-                goto error;
+                break;
             }
-            if(expr_val->IsUndefined() || expr_val->IsNull())
+
+            stmt = EvalStatement(for_in_stmt->statement());
+            if(stmt.value != nullptr)
             {
-                RuntimeContext::TopContext()->ExitIteration();
-                return Completion(Completion::NORMAL, nullptr, "");
+                V = stmt.value;
             }
-            obj = ToObject(e, expr_val);
-            for(const auto& pair : obj->AllEnumerableProperties())
+            if(stmt.type != Completion::CONTINUING || stmt.target != ast->target())
             {
-                String* P = new String(pair.first);
-                JSValue* lhs_ref = EvalExpression(e, for_in_stmt->expr0());
-                if(!e->IsOk())
-                {
-                    goto error;
-                }
-                PutValue(e, lhs_ref, P);
-                if(!e->IsOk())
-                {
-                    goto error;
-                }
-
-                stmt = EvalStatement(for_in_stmt->statement());
-                if(stmt.value != nullptr)
+                if(stmt.type == Completion::BREAKING && stmt.target == ast->target())
                 {
-                    V = stmt.value;
+                    break;
                 }
-                has_label = stmt.target == ast->label() || stmt.target.empty();
-                if(stmt.type != Completion::CONTINUING || !has_label)
+                if(stmt.IsAbruptCompletion())
                 {
-                    if(stmt.type == Completion::BREAKING && has_label)
-                    {
-                        RuntimeContext::TopContext()->ExitIteration();
-                        return Completion(Completion::NORMAL, V, "");
-                    }
-                    if(stmt.IsAbruptCompletion())
-                    {
-                        RuntimeContext::TopContext()->ExitIteration();
-                        return stmt;
-                    }
+                    abrupt = true;
+                    break;
                 }
             }
         }
-        RuntimeContext::TopContext()->ExitIteration();
-        return Completion(Completion::NORMAL, V, "");
-    error:
-        RuntimeContext::TopContext()->ExitIteration();
-        return Completion(Completion::THROWING, new ErrorObject(e), "");
+        if(keys == &cache->keys)
+        {
+            cache->busy = false;
+        }
+        if(!e->IsOk())
+        {
+            return Completion(Completion::THROWING, ThrownValue(e));
+        }
+        if(abrupt)
+        {
+            return stmt;
+        }
+        return Completion(Completion::NORMAL, V);
     }
 
     inline Completion EvalContinueStatement(Parsing::AST* ast)
     {
         assert(ast->type() == Parsing::AST::AST_STMT_CONTINUE);
-        Error* e = Error::Ok();
-        if(!RuntimeContext::TopContext()->InIteration())
-        {
-            *e = *Error::SyntaxError();
-            return Completion(Completion::THROWING, new ErrorObject(e), "");
-        }
-        Parsing::ContinueOrBreak* stmt = static_cast<Parsing::ContinueOrBreak*>(ast);
-        return Completion(Completion::CONTINUING, nullptr, stmt->ident());
+        return Completion(Completion::CONTINUING, nullptr, ast->target());
     }
 
     inline Completion EvalBreakStatement(Parsing::AST* ast)
     {
         assert(ast->type() == Parsing::AST::AST_STMT_BREAK);
-        Error* e = Error::Ok();
-        if(!RuntimeContext::TopContext()->InIteration())
-        {
-            *e = *Error::SyntaxError();
-            return Completion(Completion::THROWING, new ErrorObject(e), "");
-        }
-        Parsing::ContinueOrBreak* stmt = static_cast<Parsing::ContinueOrBreak*>(ast);
-        return Completion(Completion::BREAKING, nullptr, stmt->ident());
+        return Completion(Completion::BREAKING, nullptr, ast->target());
     }
 
     inline Completion EvalReturnStatement(Parsing::AST* ast)
     {
         assert(ast->type() == Parsing::AST::AST_STMT_RETURN);
-        Error* e = Error::Ok();
+        Error error;
+        Error* e = &error;
         Parsing::Return* return_stmt = static_cast<Parsing::Return*>(ast);
         if(return_stmt->expr() == nullptr)
         {
-            return Completion(Completion::RETURNING, Undefined::Instance(), "");
+            return Completion(Completion::RETURNING, Undefined::Instance());
+        }
+        JSValue* value = EvalExpressionValue(e, return_stmt->expr());
+        if(!e->IsOk())
+        {
+            return Completion(Completion::THROWING, ThrownValue(e));
         }
-        auto exp_ref = EvalExpression(e, return_stmt->expr());
-        return Completion(Completion::RETURNING, GetValue(e, exp_ref), "");
+        return Completion(Completion::RETURNING, value);
     }
 
     inline Completion EvalLabelledStatement(Parsing::AST* ast)
     {
         assert(ast->type() == Parsing::AST::AST_STMT_LABEL);
         Parsing::LabelledStmt* label_stmt = static_cast<Parsing::LabelledStmt*>(ast);
-        label_stmt->statement()->SetLabel(label_stmt->label());
         Completion R = EvalStatement(label_stmt->statement());
-        if(R.type == Completion::BREAKING && R.target == label_stmt->label())
+        if(R.type == Completion::BREAKING && R.target == ast->target())
         {
-            return Completion(Completion::NORMAL, R.value, "");
+            return Completion(Completion::NORMAL, R.value);
         }
         return R;
     }
@@ -8827,24 +13982,25 @@ namespace es
         if(RuntimeContext::TopContext()->strict())
         {
             return Completion(Completion::THROWING,
-                              new ErrorObject(Error::SyntaxError("cannot have with statement in strict mode")), "");
+                              new ErrorObject(Error::SyntaxError("cannot have with statement in strict mode")));
         }
-        Error* e = Error::Ok();
+        Error error;
+        Error* e = &error;
         Parsing::WhileOrWith* with_stmt = static_cast<Parsing::WhileOrWith*>(ast);
         JSValue* ref = EvalExpression(e, with_stmt->expr());
         if(!e->IsOk())
         {
-            return Completion(Completion::THROWING, new ErrorObject(e), "");
+            return Completion(Completion::THROWING, ThrownValue(e));
         }
         JSValue* val = GetValue(e, ref);
         if(!e->IsOk())
         {
-            return Completion(Completion::THROWING, new ErrorObject(e), "");
+            return Completion(Completion::THROWING, ThrownValue(e));
         }
         JSObject* obj = ToObject(e, val);
         if(!e->IsOk())
         {
-            return Completion(Completion::THROWING, new ErrorObject(e), "");
+            return Completion(Completion::THROWING, ThrownValue(e));
         }
         LexicalEnvironment* old_env = RuntimeContext::TopLexicalEnv();
         LexicalEnvironment* new_env = LexicalEnvironment::NewObjectEnvironment(obj, old_env, true);
@@ -8856,90 +14012,188 @@ namespace es
 
     inline JSValue* EvalCaseClause(Error* e, const Parsing::Switch::CaseClause& C)
     {
-        JSValue* exp_ref = EvalExpression(e, C.expr);
-        if(!e->IsOk())
+        return EvalExpressionValue(e, C.expr);
+    }
+
+    // Whether selector d can index a jump table. -0 is strictly equal to 0,
+    // and dispatches as 0.
+    inline bool IsInt32Selector(double d)
+    {
+        return IsInt32(d) || d == 0;
+    }
+
+    // Evaluates the literal case labels of switch_stmt once and fills its jump
+    // table, or falls back to sequential matching if a number label is not an
+    // int32.
+    inline void BuildJumpTable(Parsing::Switch* switch_stmt)
+    {
+        Parsing::Switch::JumpTable* table = switch_stmt->jump_table();
+        const auto& before = switch_stmt->before_default_case_clauses();
+        const auto& after = switch_stmt->after_default_case_clauses();
+        size_t after_start = before.size() + (switch_stmt->has_default_clause() ? 1 : 0);
+        table->built = true;
+        if(switch_stmt->dispatch() == Parsing::Switch::DISPATCH_STRING)
         {
-            return nullptr;
+            // emplace keeps the first of duplicated labels,
+            // which is the one sequential matching would pick.
+            for(size_t i = 0; i < before.size(); i++)
+            {
+                table->strings.emplace(EvalString(before[i].expr)->data(), i);
+            }
+            for(size_t i = 0; i < after.size(); i++)
+            {
+                table->strings.emplace(EvalString(after[i].expr)->data(), after_start + i);
+            }
+            return;
+        }
+        assert(switch_stmt->dispatch() == Parsing::Switch::DISPATCH_INT32);
+        std::vector<std::pair<int32_t, size_t>> labels;
+        labels.reserve(before.size() + after.size());
+        for(size_t i = 0; i < before.size() + after.size(); i++)
+        {
+            Parsing::AST* expr = i < before.size() ? before[i].expr : after[i - before.size()].expr;
+            double label = EvalNumber(expr)->data();
+            if(!IsInt32Selector(label))
+            {
+                switch_stmt->SetDispatch(Parsing::Switch::DISPATCH_SEQUENTIAL);
+                return;
+            }
+            labels.emplace_back(int32_t(label), i < before.size() ? i : after_start + i - before.size());
+        }
+        std::stable_sort(labels.begin(), labels.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        labels.erase(std::unique(labels.begin(), labels.end(), [](const auto& a, const auto& b) { return a.first == b.first; }),
+                     labels.end());
+        int64_t span = static_cast<int64_t>(labels.back().first) - labels.front().first + 1;
+        if(span <= static_cast<int64_t>(2 * labels.size() + 8))
+        {
+            table->min = labels.front().first;
+            table->dense.assign(span, Parsing::Switch::kNoClause);
+            for(const auto& pair : labels)
+            {
+                table->dense[pair.first - table->min] = pair.second;
+            }
+        }
+        else
+        {
+            table->sparse = std::move(labels);
         }
-        return GetValue(e, exp_ref);
     }
 
-    inline Completion EvalCaseBlock(Parsing::Switch* switch_stmt, JSValue* input)
+    // Index of the clause a jump table dispatch selects for input.
+    inline size_t LookupJumpTable(Parsing::Switch* switch_stmt, JSValue* input)
     {
-        Error* e = Error::Ok();
-        JSValue* V = nullptr;
-        bool found = false;
-        for(const auto& C : switch_stmt->before_default_case_clauses())
+        Parsing::Switch::JumpTable* table = switch_stmt->jump_table();
+        size_t index = Parsing::Switch::kNoClause;
+        if(switch_stmt->dispatch() == Parsing::Switch::DISPATCH_STRING)
         {
-            if(!found)
-            {// 5.a
-                JSValue* clause_selector = EvalCaseClause(e, C);
-                bool b = StrictEqual(e, input, clause_selector);
-                if(!e->IsOk())
-                {
-                    return Completion(Completion::THROWING, new ErrorObject(e), "");
-                }
-                if(b)
+            if(input->IsString())
+            {
+                auto it = table->strings.find(static_cast<String*>(input)->data());
+                if(it != table->strings.end())
                 {
-                    found = true;
+                    index = it->second;
                 }
             }
-            if(found)
-            {// 5.b
-                Completion R = EvalStatementList(C.stmts);
-                if(R.value != nullptr)
+        }
+        else
+        {
+            if(input->IsNumber() && IsInt32Selector(static_cast<Number*>(input)->data()))
+            {
+                int32_t value = int32_t(static_cast<Number*>(input)->data());
+                if(!table->dense.empty())
                 {
-                    V = R.value;
+                    uint64_t offset = static_cast<uint64_t>(static_cast<int64_t>(value) - table->min);
+                    if(offset < table->dense.size())
+                    {
+                        index = table->dense[offset];
+                    }
                 }
-                if(R.IsAbruptCompletion())
+                else
                 {
-                    return Completion(R.type, V, R.target);
+                    auto it = std::lower_bound(table->sparse.begin(), table->sparse.end(), value,
+                                               [](const auto& pair, int32_t v) { return pair.first < v; });
+                    if(it != table->sparse.end() && it->first == value)
+                    {
+                        index = it->second;
+                    }
                 }
             }
         }
-        bool found_in_b = false;
-        size_t i;
-        for(i = 0; !found_in_b && i < switch_stmt->after_default_case_clauses().size(); i++)
-        {
-            auto C = switch_stmt->after_default_case_clauses()[i];
-            JSValue* clause_selector = EvalCaseClause(e, C);
+        return index == Parsing::Switch::kNoClause ? switch_stmt->default_clause_index() : index;
+    }
+
+    // 12.11 Index of the first clause whose selector is strictly equal to
+    // input, trying the clauses before the default one first, or of the
+    // default clause.
+    inline size_t FindCaseClause(Error* e, Parsing::Switch* switch_stmt, JSValue* input)
+    {
+        const auto& before = switch_stmt->before_default_case_clauses();
+        const auto& after = switch_stmt->after_default_case_clauses();
+        for(size_t i = 0; i < before.size(); i++)
+        {// 5.a
+            JSValue* clause_selector = EvalCaseClause(e, before[i]);
+            if(!e->IsOk())
+            {
+                return 0;
+            }
             bool b = StrictEqual(e, input, clause_selector);
             if(!e->IsOk())
             {
-                return Completion(Completion::THROWING, new ErrorObject(e), "");
+                return 0;
             }
             if(b)
             {
-                found_in_b = true;
-                Completion R = EvalStatementList(C.stmts);
-                if(R.value != nullptr)
-                {
-                    V = R.value;
-                }
-                if(R.IsAbruptCompletion())
-                {
-                    return Completion(R.type, V, R.target);
-                }
+                return i;
             }
         }
-        if(!found_in_b && switch_stmt->has_default_clause())
-        {// 8
-            Completion R = EvalStatementList(switch_stmt->default_clause().stmts);
-            if(R.value != nullptr)
+        size_t after_start = before.size() + (switch_stmt->has_default_clause() ? 1 : 0);
+        for(size_t i = 0; i < after.size(); i++)
+        {// 7.b
+            JSValue* clause_selector = EvalCaseClause(e, after[i]);
+            if(!e->IsOk())
             {
-                V = R.value;
+                return 0;
             }
-            if(R.IsAbruptCompletion())
+            bool b = StrictEqual(e, input, clause_selector);
+            if(!e->IsOk())
             {
-                return Completion(R.type, V, R.target);
+                return 0;
+            }
+            if(b)
+            {
+                return after_start + i;
             }
         }
-        for(i = 0; i < switch_stmt->after_default_case_clauses().size(); i++)
+        return switch_stmt->default_clause_index();
+    }
+
+    inline Completion EvalCaseBlock(Parsing::Switch* switch_stmt, JSValue* input)
+    {
+        Error error;
+        Error* e = &error;
+        if(switch_stmt->dispatch() != Parsing::Switch::DISPATCH_SEQUENTIAL && !switch_stmt->jump_table()->built)
+        {
+            BuildJumpTable(switch_stmt);
+        }
+        size_t index;
+        if(switch_stmt->dispatch() != Parsing::Switch::DISPATCH_SEQUENTIAL)
+        {
+            index = LookupJumpTable(switch_stmt, input);
+        }
+        else
+        {
+            index = FindCaseClause(e, switch_stmt, input);
+            if(!e->IsOk())
+            {
+                return Completion(Completion::THROWING, ThrownValue(e));
+            }
+        }
+        // Statements run from the selected clause on, falling through the
+        // following clauses (and the default clause) in source order.
+        JSValue* V = nullptr;
+        for(size_t i = index; i < switch_stmt->clause_count(); i++)
         {
-            auto C = switch_stmt->after_default_case_clauses()[i];
-            JSValue* clause_selector = EvalCaseClause(e, C);
-            (void)clause_selector;
-            Completion R = EvalStatementList(C.stmts);
+            Completion R = EvalStatementList(switch_stmt->clause_stmts(i));
             if(R.value != nullptr)
             {
                 V = R.value;
@@ -8949,29 +14203,34 @@ namespace es
                 return Completion(R.type, V, R.target);
             }
         }
-        return Completion(Completion::NORMAL, V, "");
+        return Completion(Completion::NORMAL, V);
     }
 
     // 12.11 The switch Statement
     inline Completion EvalSwitchStatement(Parsing::AST* ast)
     {
         assert(ast->type() == Parsing::AST::AST_STMT_SWITCH);
-        Error* e = Error::Ok();
+        Error error;
+        Error* e = &error;
         Parsing::Switch* switch_stmt = static_cast<Parsing::Switch*>(ast);
         JSValue* expr_ref = EvalExpression(e, switch_stmt->expr());
         if(!e->IsOk())
         {
-            return Completion(Completion::THROWING, new ErrorObject(e), "");
+            return Completion(Completion::THROWING, ThrownValue(e));
+        }
+        JSValue* input = GetValue(e, expr_ref);
+        if(!e->IsOk())
+        {
+            return Completion(Completion::THROWING, ThrownValue(e));
         }
-        Completion R = EvalCaseBlock(switch_stmt, expr_ref);
+        Completion R = EvalCaseBlock(switch_stmt, input);
         if(R.IsThrow())
         {
             return R;
         }
-        bool has_label = ast->label() == R.target;
-        if(R.type == Completion::BREAKING && has_label)
+        if(R.type == Completion::BREAKING && R.target == ast->target())
         {
-            return Completion(Completion::NORMAL, R.value, "");
+            return Completion(Completion::NORMAL, R.value);
         }
         return R;
     }
@@ -8980,49 +14239,58 @@ namespace es
     inline Completion EvalThrowStatement(Parsing::AST* ast)
     {
         assert(ast->type() == Parsing::AST::AST_STMT_THROW);
-        Error* e = Error::Ok();
+        Error error;
+        Error* e = &error;
         Parsing::Throw* throw_stmt = static_cast<Parsing::Throw*>(ast);
         JSValue* exp_ref = EvalExpression(e, throw_stmt->expr());
-        if(es::Error::Ok() == nullptr)
+        if(!e->IsOk())
         {
-            return Completion(Completion::THROWING, new ErrorObject(e), "");
+            return Completion(Completion::THROWING, ThrownValue(e));
         }
         JSValue* val = GetValue(e, exp_ref);
-        if(es::Error::Ok() == nullptr)
+        if(!e->IsOk())
         {
-            return Completion(Completion::THROWING, new ErrorObject(e), "");
+            return Completion(Completion::THROWING, ThrownValue(e));
         }
-        return Completion(Completion::THROWING, val, "");
+        return Completion(Completion::THROWING, val);
     }
 
     inline Completion EvalCatch(Parsing::Try* try_stmt, const Completion& C)
     {
         // NOTE(zhuzilin) Don't gc these two env, during this function.
-        Error* e = Error::Ok();
         LexicalEnvironment* old_env = RuntimeContext::TopLexicalEnv();
-        LexicalEnvironment* catch_env = LexicalEnvironment::NewDeclarativeEnvironment(old_env);
-        catch_env->env_rec()->CreateMutableBinding(e, try_stmt->catch_ident(), false);// 4
-        if(!e->IsOk())
+        // Unless the catch block has a function or eval that
+        // may capture it, the catch environment is only reachable while the
+        // block runs and can come from the environment pool.
+        bool pooled_env = !try_stmt->catch_env_captured();
+        LexicalEnvironment* catch_env;
+        if(pooled_env)
         {
-            return Completion(Completion::THROWING, new ErrorObject(e), "");
+            catch_env = RuntimeContext::Global()->AcquireEnvironment(old_env);
         }
-        // NOTE(zhuzilin) The spec say to send C instead of C.value.
-        // However, I think it should be send C.value...
-        catch_env->env_rec()->SetMutableBinding(e, try_stmt->catch_ident(), C.value, false);// 5
-        if(!e->IsOk())
+        else
         {
-            return Completion(Completion::THROWING, new ErrorObject(e), "");
+            catch_env = LexicalEnvironment::NewDeclarativeEnvironment(old_env);
         }
+        // NOTE(zhuzilin) The spec say to send C instead of C.value.
+        // However, I think it should be send C.value...
+        auto catch_rec = static_cast<DeclarativeEnvironmentRecord*>(catch_env->env_rec());
+        catch_rec->InitializeMutableBinding(try_stmt->catch_ident(), C.value);// 4 & 5
         RuntimeContext::TopContext()->SetLexicalEnv(catch_env);
         Completion B = EvalBlockStatement(try_stmt->catch_block());
         RuntimeContext::TopContext()->SetLexicalEnv(old_env);
+        if(pooled_env)
+        {
+            RuntimeContext::Global()->ReleaseEnvironment(catch_env);
+        }
         return B;
     }
 
     inline Completion EvalTryStatement(Parsing::AST* ast)
     {
         assert(ast->type() == Parsing::AST::AST_STMT_TRY);
-        Error* e = Error::Ok();
+        Error error;
+        Error* e = &error;
         (void)e;
         Parsing::Try* try_stmt = static_cast<Parsing::Try*>(ast);
         Completion B = EvalBlockStatement(try_stmt->try_block());
@@ -9061,18 +14329,23 @@ namespace es
 
     inline Completion EvalExpressionStatement(Parsing::AST* ast)
     {
-        Error* e = Error::Ok();
+        Error error;
+        Error* e = &error;
         JSValue* val = EvalExpression(e, ast);
         if(!e->IsOk())
         {
-            return Completion(Completion::THROWING, new ErrorObject(e), "");
+            return Completion(Completion::THROWING, ThrownValue(e));
         }
-        return Completion(Completion::NORMAL, val, "");
+        return Completion(Completion::NORMAL, val);
     }
 
     inline JSValue* EvalExpression(Error* e, Parsing::AST* ast)
     {
         assert(ast->type() <= Parsing::AST::AST_EXPR || ast->type() == Parsing::AST::AST_FUNC);
+        if(ast->constant() != nullptr)
+        {
+            return ast->constant();
+        }
         JSValue* val;
         switch(ast->type())
         {
@@ -9114,8 +14387,34 @@ namespace es
         return val;
     }
 
+    // GetValue(EvalExpression(ast)), which reads an identifier of optimized
+    // code from its speculated slot without making a Reference.
+    inline JSValue* EvalExpressionValue(Error* e, Parsing::AST* ast)
+    {
+        using Parsing::AST;
+        if(ast->slot() != AST::kNoSlot)
+        {
+            AST* ident = ast->type() == AST::AST_EXPR_LHS ? static_cast<Parsing::LHS*>(ast)->base() : ast;
+            JSValue* val = OptimizingTier::Global()->ReadSlot(e, ast, ident->source());
+            if(val != nullptr || !e->IsOk())
+            {
+                return val;
+            }
+        }
+        JSValue* ref = EvalExpression(e, ast);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        return GetValue(e, ref);
+    }
+
     inline JSValue* EvalPrimaryExpression(Error* e, Parsing::AST* ast)
     {
+        if(ast->constant() != nullptr)
+        {
+            return ast->constant();
+        }
         JSValue* val;
         switch(ast->type())
         {
@@ -9169,72 +14468,16 @@ namespace es
 
     inline Number* EvalNumber(const std::string& source)
     {
+        const char* begin = source.data();
+        const char* end = begin + source.size();
         double val = 0;
-        double frac = 1;
-        size_t pos = 0;
-        bool dot = false;
-        while(pos < source.size())
+        if(source.size() > 2 && source[0] == u'0' && (source[1] == u'x' || source[1] == u'X'))
         {
-            char c = source[pos];
-            switch(c)
-            {
-                case u'.':
-                    dot = true;
-                    break;
-                case u'e':
-                case u'E':
-                {
-                    double exp = 0;
-                    bool sign = true;
-                    pos++;// skip e/E
-                    if(c == u'-')
-                    {
-                        sign = false;
-                        pos++;// skip -
-                    }
-                    else if(c == u'+')
-                    {
-                        sign = true;
-                        pos++;// skip +;
-                    }
-                    while(pos < source.size())
-                    {
-                        exp *= 10;
-                        exp += character::Digit(c);
-                    }
-                    if(!sign)
-                    {
-                        exp = -exp;
-                    }
-                    return new Number(val * pow(10.0, exp));
-                }
-                case u'x':
-                case u'X':
-                {
-                    assert(val == 0);
-                    pos++;
-                    while(pos < source.size())
-                    {
-                        c = source[pos];
-                        val *= 16;
-                        val += character::Digit(c);
-                        pos++;
-                    }
-                    return new Number(val);
-                }
-                default:
-                    if(dot)
-                    {
-                        frac /= 10;
-                        val += character::Digit(c) * frac;
-                    }
-                    else
-                    {
-                        val *= 10;
-                        val += character::Digit(c);
-                    }
-            }
-            pos++;
+            ParseDigits(begin + 2, end, 16, &val);
+        }
+        else
+        {
+            ParseDecimal(begin, end, &val);
         }
         return new Number(val);
     }
@@ -9242,7 +14485,7 @@ namespace es
     inline Number* EvalNumber(Parsing::AST* ast)
     {
         assert(ast->type() == Parsing::AST::AST_EXPR_NUMBER);
-        auto source = ast->source();
+        const std::string& source = ast->source();
         return EvalNumber(source);
     }
 
@@ -9355,11 +14598,11 @@ namespace es
     inline String* EvalString(Parsing::AST* ast)
     {
         assert(ast->type() == Parsing::AST::AST_EXPR_STRING);
-        auto source = ast->source();
+        const std::string& source = ast->source();
         return EvalString(source);
     }
 
-    inline std::string EvalPropertyName(Error* e, Parsing::Token token)
+    inline std::string EvalPropertyName(Error* e, const Parsing::Token& token)
     {
         switch(token.type())
         {
@@ -9383,17 +14626,21 @@ namespace es
         bool strict = RuntimeContext::TopContext()->strict();
         Object* obj = new Object();
         // PropertyName : AssignmentExpression
-        for(auto property : obj_ast->properties())
+        for(const auto& property : obj_ast->properties())
         {
             std::string prop_name = EvalPropertyName(e, property.key);
-            PropertyDescriptor* desc = new PropertyDescriptor();
+            PropertyDescriptor desc;
+            PropertySlot previous;
             switch(property.type)
             {
                 case Parsing::ObjectLiteral::Property::NORMAL:
                 {
-                    JSValue* expr_value = EvalAssignmentExpression(e, property.value);
-                    JSValue* prop_value = GetValue(e, expr_value);
-                    desc->SetDataDescriptor(prop_value, true, true, true);
+                    JSValue* prop_value = EvalExpressionValue(e, property.value);
+                    if(!e->IsOk())
+                    {
+                        return nullptr;
+                    }
+                    desc.SetDataDescriptor(prop_value, true, true, true);
                     break;
                 }
                 default:
@@ -9407,7 +14654,7 @@ namespace es
                         {
                             if(name == "eval" || name == "arguments")
                             {
-                                *e = *Error::SyntaxError();
+                                *e = Error::SyntaxError();
                                 return nullptr;
                             }
                         }
@@ -9416,39 +14663,39 @@ namespace es
                     = new FunctionObject(func_ast->params(), func_ast->body(), RuntimeContext::TopLexicalEnv());
                     if(property.type == Parsing::ObjectLiteral::Property::GET)
                     {
-                        desc->SetGet(closure);
+                        desc.SetGet(closure);
                     }
                     else
                     {
-                        desc->SetSet(closure);
+                        desc.SetSet(closure);
                     }
-                    desc->SetEnumerable(true);
-                    desc->SetConfigurable(true);
+                    desc.SetEnumerable(true);
+                    desc.SetConfigurable(true);
                     break;
                 }
             }
-            auto previous = obj->GetOwnProperty(prop_name);// 3
-            if(!previous->IsUndefined())
-            {// 4
-                PropertyDescriptor* previous_desc = static_cast<PropertyDescriptor*>(previous);
-                if(strict && previous_desc->IsDataDescriptor() && desc->IsDataDescriptor())
+            if(obj->GetOwnPropertySlot(prop_name, &previous))
+            {// 3 & 4
+                if(strict && !previous.IsAccessor() && desc.IsDataDescriptor())
                 {// 4.a
-                    *e = *Error::SyntaxError();
+                    *e = Error::SyntaxError();
                     return nullptr;
                 }
-                if((previous_desc->IsDataDescriptor() && desc->IsAccessorDescriptor()) || (previous_desc->IsAccessorDescriptor() && desc->IsDataDescriptor()))
+                if(previous.IsAccessor() != desc.IsAccessorDescriptor())
                 {// 4.c
-                    *e = *Error::SyntaxError();
+                    *e = Error::SyntaxError();
                     return nullptr;
                 }
-                if(((previous_desc->IsAccessorDescriptor() && desc->IsAccessorDescriptor() &&// 4.d
-                   (previous_desc->HasGet() && desc->HasGet())) || (previous_desc->HasSet() && desc->HasSet())))
+                // A stored accessor always has both functions,
+                // an absent one is undefined.
+                if(previous.IsAccessor() &&// 4.d
+                   ((!previous.Getter()->IsUndefined() && desc.HasGet()) || (!previous.Setter()->IsUndefined() && desc.HasSet())))
                 {
-                    *e = *Error::SyntaxError();
+                    *e = Error::SyntaxError();
                     return nullptr;
                 }
             }
-            obj->DefineOwnProperty(e, prop_name, desc, false);
+            obj->DefineOwnProperty(e, prop_name, &desc, false);
         }
         return obj;
     }
@@ -9466,7 +14713,12 @@ namespace es
             {
                 return nullptr;
             }
-            arr->AddValueProperty(NumberToString(pair.first), init_result, true, true, true);
+            JSValue* init_value = GetValue(e, init_result);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
+            arr->AddValueProperty(NumberToString(pair.first), init_value, true, true, true);
         }
         return arr;
     }
@@ -9486,7 +14738,7 @@ namespace es
         {
             return nullptr;
         }
-        std::string op = u->op().source();
+        const std::string& op = u->op().source();
 
         if(op == "++" || op == "--")
         {// a++, ++a, a--, --a
@@ -9496,7 +14748,7 @@ namespace es
                 if(ref->IsStrictReference() && ref->GetBase()->IsEnvironmentRecord()
                    && (ref->GetReferencedName() == "eval" || ref->GetReferencedName() == "arguments"))
                 {
-                    *e = *Error::SyntaxError();
+                    *e = Error::SyntaxError();
                     return nullptr;
                 }
             }
@@ -9505,19 +14757,26 @@ namespace es
             {
                 return nullptr;
             }
-            double num = ToNumber(e, old_val);
-            if(!e->IsOk())
-            {
-                return nullptr;
-            }
-            JSValue* new_value;
-            if(op == "++")
+            JSValue* new_value = nullptr;
+            if(old_val->IsNumber() && static_cast<Number*>(old_val)->IsInt32())
             {
-                new_value = new Number(num + 1);
+                new_value = EvalInt32ArithmeticOperator(op[0], static_cast<Number*>(old_val)->Int32Value(), 1);
             }
-            else
+            if(new_value == nullptr)
             {
-                new_value = new Number(num - 1);
+                double num = ToNumber(e, old_val);
+                if(!e->IsOk())
+                {
+                    return nullptr;
+                }
+                if(op == "++")
+                {
+                    new_value = new Number(num + 1);
+                }
+                else
+                {
+                    new_value = new Number(num - 1);
+                }
             }
             PutValue(e, expr, new_value);
             if(!e->IsOk())
@@ -9544,7 +14803,7 @@ namespace es
             {// 3
                 if(ref->IsStrictReference())
                 {
-                    *e = *Error::SyntaxError();
+                    *e = Error::SyntaxError();
                     return Bool::False();
                 }
                 return Bool::True();
@@ -9562,7 +14821,7 @@ namespace es
             {
                 if(ref->IsStrictReference())
                 {
-                    *e = *Error::SyntaxError();
+                    *e = Error::SyntaxError();
                     return Bool::False();
                 }
                 EnvironmentRecord* bindings = static_cast<EnvironmentRecord*>(ref->GetBase());
@@ -9639,7 +14898,7 @@ namespace es
                 {
                     return nullptr;
                 }
-                return new Number(~num);
+                return Number::FromInt32(~num);
             }
             else if(op == "!")
             {
@@ -9658,11 +14917,9 @@ namespace es
     {
         assert(ast->type() == Parsing::AST::AST_EXPR_BINARY);
         Parsing::Binary* b = static_cast<Parsing::Binary*>(ast);
-        return EvalBinaryExpression(e, b->op(), b->lhs(), b->rhs());
-    }
-
-    inline JSValue* EvalBinaryExpression(Error* e, const std::string& op, Parsing::AST* lhs, Parsing::AST* rhs)
-    {
+        const std::string& op = b->op();
+        Parsing::AST* lhs = b->lhs();
+        Parsing::AST* rhs = b->rhs();
         // && and || are different, as there are not &&= and ||=
         if((op == "&&") || (op == "||"))
         {
@@ -9678,12 +14935,7 @@ namespace es
             }
             // TODO(zhuzilin) The compound assignment should do lval = GetValue(lref)
             // here. Check if changing the order will have any influence.
-            JSValue* rref = EvalExpression(e, rhs);
-            if(!e->IsOk())
-            {
-                return nullptr;
-            }
-            JSValue* rval = GetValue(e, rref);
+            JSValue* rval = EvalExpressionValue(e, rhs);
             if(!e->IsOk())
             {
                 return nullptr;
@@ -9694,31 +14946,278 @@ namespace es
             }
             else
             {
-                return EvalCompoundAssignment(e, op, lref, rval);
+                return EvalCompoundAssignment(e, b, lref, rval);
             }
         }
 
-        JSValue* lref = EvalExpression(e, lhs);
+        JSValue* lval = EvalExpressionValue(e, lhs);
         if(!e->IsOk())
         {
             return nullptr;
         }
-        JSValue* lval = GetValue(e, lref);
+        JSValue* rval = EvalExpressionValue(e, rhs);
         if(!e->IsOk())
         {
             return nullptr;
         }
-        JSValue* rref = EvalExpression(e, rhs);
-        if(!e->IsOk())
+        JSValue* res = EvalQuickenedBinary(b, lval, rval);
+        if(res != nullptr)
         {
-            return nullptr;
+            return res;
         }
-        JSValue* rval = GetValue(e, rref);
-        if(!e->IsOk())
+        return EvalBinaryExpression(e, op, lval, rval);
+    }
+
+    inline uint8_t OperandKind(JSValue* val)
+    {
+        switch(val->type())
         {
-            return nullptr;
+            case JSValue::JS_NUMBER:
+                return static_cast<Number*>(val)->IsInt32() ? Parsing::Binary::KIND_INT32 : Parsing::Binary::KIND_DOUBLE;
+            case JSValue::JS_STRING:
+                return Parsing::Binary::KIND_STRING;
+            case JSValue::JS_OBJECT:
+                return Parsing::Binary::KIND_OBJECT;
+            default:
+                return Parsing::Binary::KIND_OTHER;
+        }
+    }
+
+    // Picks the handler for operand kinds lhs_kinds and rhs_kinds. Only
+    // primitives get a specialized one, anything else may run user code
+    // through valueOf and toString.
+    inline Parsing::Binary::Handler SelectBinaryHandler(Parsing::Token::Type op, uint8_t lhs_kinds, uint8_t rhs_kinds)
+    {
+        using Parsing::Binary;
+        using Parsing::Token;
+        switch(op)
+        {
+            case Token::TK_ADD:
+            case Token::TK_SUB:
+            case Token::TK_MUL:
+            case Token::TK_DIV:
+            case Token::TK_MOD:
+            case Token::TK_BIT_LSH:
+            case Token::TK_BIT_RSH:
+            case Token::TK_BIT_URSH:
+            case Token::TK_BIT_AND:
+            case Token::TK_BIT_OR:
+            case Token::TK_BIT_XOR:
+            case Token::TK_LT:
+            case Token::TK_GT:
+            case Token::TK_LE:
+            case Token::TK_GE:
+            case Token::TK_EQ:
+            case Token::TK_NE:
+            case Token::TK_EQ3:
+            case Token::TK_NE3:
+                break;
+            default:
+                return Binary::HANDLER_GENERIC;
+        }
+        uint8_t kinds = lhs_kinds | rhs_kinds;
+        if(kinds == Binary::KIND_INT32)
+        {
+            return Binary::HANDLER_INT32;
+        }
+        if((kinds & ~(Binary::KIND_INT32 | Binary::KIND_DOUBLE)) == 0)
+        {
+            return Binary::HANDLER_NUMBER;
+        }
+        if(kinds == Binary::KIND_STRING)
+        {
+            switch(op)
+            {
+                case Token::TK_ADD:
+                case Token::TK_LT:
+                case Token::TK_GT:
+                case Token::TK_LE:
+                case Token::TK_GE:
+                case Token::TK_EQ:
+                case Token::TK_NE:
+                case Token::TK_EQ3:
+                case Token::TK_NE3:
+                    return Binary::HANDLER_STRING;
+                default:
+                    break;
+            }
+        }
+        return Binary::HANDLER_GENERIC;
+    }
+
+    inline JSValue* EvalNumberBinary(Parsing::Token::Type op, double lnum, double rnum)
+    {
+        using Parsing::Token;
+        switch(op)
+        {
+            case Token::TK_ADD:
+                return new Number(lnum + rnum);
+            case Token::TK_SUB:
+                return new Number(lnum - rnum);
+            case Token::TK_MUL:
+                return new Number(lnum * rnum);
+            case Token::TK_DIV:
+                return new Number(lnum / rnum);
+            case Token::TK_MOD:
+                return new Number(fmod(lnum, rnum));
+            case Token::TK_BIT_LSH:
+                return Number::FromInt32(int32_t(DoubleToUint32(lnum) << (DoubleToUint32(rnum) & 0x1F)));
+            case Token::TK_BIT_RSH:
+                return Number::FromInt32(DoubleToInt32(lnum) >> (DoubleToUint32(rnum) & 0x1F));
+            case Token::TK_BIT_URSH:
+                return new Number(DoubleToUint32(lnum) >> (DoubleToUint32(rnum) & 0x1F));
+            case Token::TK_BIT_AND:
+                return Number::FromInt32(DoubleToInt32(lnum) & DoubleToInt32(rnum));
+            case Token::TK_BIT_OR:
+                return Number::FromInt32(DoubleToInt32(lnum) | DoubleToInt32(rnum));
+            case Token::TK_BIT_XOR:
+                return Number::FromInt32(DoubleToInt32(lnum) ^ DoubleToInt32(rnum));
+            // NaN compares false and 0 equals -0 in both languages.
+            case Token::TK_LT:
+                return Bool::Wrap(lnum < rnum);
+            case Token::TK_GT:
+                return Bool::Wrap(lnum > rnum);
+            case Token::TK_LE:
+                return Bool::Wrap(lnum <= rnum);
+            case Token::TK_GE:
+                return Bool::Wrap(lnum >= rnum);
+            case Token::TK_EQ:
+            case Token::TK_EQ3:
+                return Bool::Wrap(lnum == rnum);
+            case Token::TK_NE:
+            case Token::TK_NE3:
+                return Bool::Wrap(lnum != rnum);
+            default:
+                assert(false);
+        }
+    }
+
+    inline JSValue* EvalInt32Binary(Parsing::Token::Type op, int32_t lnum, int32_t rnum)
+    {
+        using Parsing::Token;
+        switch(op)
+        {
+            case Token::TK_ADD:
+            case Token::TK_SUB:
+            case Token::TK_MUL:
+            case Token::TK_DIV:
+            case Token::TK_MOD:
+            {
+                char calc_op = op == Token::TK_ADD ? u'+' : op == Token::TK_SUB ? u'-' : op == Token::TK_MUL ? u'*' : op == Token::TK_DIV ? u'/' : u'%';
+                Number* res = EvalInt32ArithmeticOperator(calc_op, lnum, rnum);
+                if(res != nullptr)
+                {
+                    return res;
+                }
+                return EvalNumberBinary(op, lnum, rnum);
+            }
+            case Token::TK_BIT_LSH:
+                return Number::FromInt32(int32_t(uint32_t(lnum) << (rnum & 0x1F)));
+            case Token::TK_BIT_RSH:
+                return Number::FromInt32(lnum >> (rnum & 0x1F));
+            case Token::TK_BIT_AND:
+                return Number::FromInt32(lnum & rnum);
+            case Token::TK_BIT_OR:
+                return Number::FromInt32(lnum | rnum);
+            case Token::TK_BIT_XOR:
+                return Number::FromInt32(lnum ^ rnum);
+            default:
+                return EvalNumberBinary(op, lnum, rnum);
+        }
+    }
+
+    inline JSValue* EvalStringBinary(Parsing::Token::Type op, String* lstr, String* rstr)
+    {
+        using Parsing::Token;
+        switch(op)
+        {
+            case Token::TK_ADD:
+                return String::Concat(lstr, rstr);
+            case Token::TK_LT:
+                return Bool::Wrap(lstr->view() < rstr->view());
+            case Token::TK_GT:
+                return Bool::Wrap(lstr->view() > rstr->view());
+            case Token::TK_LE:
+                return Bool::Wrap(lstr->view() <= rstr->view());
+            case Token::TK_GE:
+                return Bool::Wrap(lstr->view() >= rstr->view());
+            case Token::TK_EQ:
+            case Token::TK_EQ3:
+                return Bool::Wrap(lstr->Equals(rstr));
+            case Token::TK_NE:
+            case Token::TK_NE3:
+                return Bool::Wrap(!lstr->Equals(rstr));
+            default:
+                assert(false);
+        }
+    }
+
+    // Records the operand kinds at b and runs the handler its feedback
+    // selected. Returns nullptr if the site is generic, then the caller
+    // takes the full path of 11.5 to 11.10.
+    inline JSValue* EvalQuickenedBinary(Parsing::Binary* b, JSValue* lval, JSValue* rval)
+    {
+        using Parsing::Binary;
+        Binary::TypeFeedback& feedback = b->feedback();
+        uint8_t lhs_kind = OperandKind(lval);
+        uint8_t rhs_kind = OperandKind(rval);
+        if(feedback.count++ == 0)
+        {
+            Binary::Sites().insert(b);
+        }
+        if((feedback.lhs_kinds & lhs_kind) == 0 || (feedback.rhs_kinds & rhs_kind) == 0)
+        {// The handler only ever widens, so a site goes generic at most once.
+            feedback.lhs_kinds |= lhs_kind;
+            feedback.rhs_kinds |= rhs_kind;
+            feedback.handler = SelectBinaryHandler(b->calc_op(), feedback.lhs_kinds, feedback.rhs_kinds);
+        }
+        switch(feedback.handler)
+        {
+            case Binary::HANDLER_INT32:
+                return EvalInt32Binary(b->calc_op(), static_cast<Number*>(lval)->Int32Value(), static_cast<Number*>(rval)->Int32Value());
+            case Binary::HANDLER_NUMBER:
+                return EvalNumberBinary(b->calc_op(), static_cast<Number*>(lval)->data(), static_cast<Number*>(rval)->data());
+            case Binary::HANDLER_STRING:
+                return EvalStringBinary(b->calc_op(), static_cast<String*>(lval), static_cast<String*>(rval));
+            default:
+                return nullptr;
+        }
+    }
+
+    // Prints the type feedback of the sites that have run, the busiest first.
+    inline void DumpTypeFeedback(std::ostream& os)
+    {
+        using Parsing::Binary;
+        static const char* const kHandlerNames[] = { "none", "int32", "number", "string", "generic" };
+        static const char* const kKindNames[] = { "int32", "double", "string", "object", "other" };
+        auto kinds_name = [](uint8_t kinds)
+        {
+            std::string name;
+            for(size_t i = 0; i < 5; i++)
+            {
+                if(kinds & (1 << i))
+                {
+                    name += name.empty() ? "" : "|";
+                    name += kKindNames[i];
+                }
+            }
+            return name;
+        };
+        std::vector<Binary*> sites(Binary::Sites().begin(), Binary::Sites().end());
+        std::sort(sites.begin(), sites.end(), [](Binary* a, Binary* b)
+        {
+            return a->feedback().count > b->feedback().count;
+        });
+        for(Binary* site : sites)
+        {
+            const Binary::TypeFeedback& feedback = site->feedback();
+            const std::string& full = site->source();
+            size_t start = std::min(full.find_first_not_of(" \t\r\n"), full.size());
+            std::string source = full.substr(start, 60);
+            std::replace(source.begin(), source.end(), '\n', ' ');
+            os << feedback.count << "\t" << kHandlerNames[feedback.handler] << "\t" << kinds_name(feedback.lhs_kinds) << " "
+               << site->op() << " " << kinds_name(feedback.rhs_kinds) << "\t" << source << std::endl;
         }
-        return EvalBinaryExpression(e, op, lval, rval);
     }
 
     inline JSValue* EvalBinaryExpression(Error* e, const std::string& op, JSValue* lval, JSValue* rval)
@@ -9750,9 +15249,71 @@ namespace es
         assert(false);
     }
 
+    // Returns lnum op rnum for *, /, %, - and + if the result is an int32 too,
+    // or nullptr if it needs the double arithmetic (overflow, -0, a fraction).
+    inline Number* EvalInt32ArithmeticOperator(char op, int32_t lnum, int32_t rnum)
+    {
+        int32_t res;
+        switch(op)
+        {
+            case u'+':
+                if(__builtin_add_overflow(lnum, rnum, &res))
+                {
+                    return nullptr;
+                }
+                break;
+            case u'-':
+                if(__builtin_sub_overflow(lnum, rnum, &res))
+                {
+                    return nullptr;
+                }
+                break;
+            case u'*':
+                if(__builtin_mul_overflow(lnum, rnum, &res) || (res == 0 && (lnum < 0 || rnum < 0)))
+                {
+                    return nullptr;
+                }
+                break;
+            case u'/':
+                if(rnum == 0 || (lnum == INT32_MIN && rnum == -1) || lnum % rnum != 0 || (lnum == 0 && rnum < 0))
+                {
+                    return nullptr;
+                }
+                res = lnum / rnum;
+                break;
+            case u'%':
+                if(rnum == 0 || (lnum == INT32_MIN && rnum == -1))
+                {
+                    return nullptr;
+                }
+                res = lnum % rnum;
+                if(res == 0 && lnum < 0)
+                {
+                    return nullptr;
+                }
+                break;
+            default:
+                return nullptr;
+        }
+        return Number::FromInt32(res);
+    }
+
     // 11.5 Multiplicative Operators
     inline JSValue* EvalArithmeticOperator(Error* e, const std::string& op, JSValue* lval, JSValue* rval)
     {
+        if(lval->IsNumber() && rval->IsNumber())
+        {
+            Number* l = static_cast<Number*>(lval);
+            Number* r = static_cast<Number*>(rval);
+            if(l->IsInt32() && r->IsInt32())
+            {
+                Number* res = EvalInt32ArithmeticOperator(op[0], l->Int32Value(), r->Int32Value());
+                if(res != nullptr)
+                {
+                    return res;
+                }
+            }
+        }
         double lnum = ToNumber(e, lval);
         if(!e->IsOk())
         {
@@ -9781,6 +15342,19 @@ namespace es
     // 11.6 Additive Operators
     inline JSValue* EvalAddOperator(Error* e, JSValue* lval, JSValue* rval)
     {
+        if(lval->IsNumber() && rval->IsNumber())
+        {
+            Number* l = static_cast<Number*>(lval);
+            Number* r = static_cast<Number*>(rval);
+            if(l->IsInt32() && r->IsInt32())
+            {
+                Number* res = EvalInt32ArithmeticOperator(u'+', l->Int32Value(), r->Int32Value());
+                if(res != nullptr)
+                {
+                    return res;
+                }
+            }
+        }
         JSValue* lprim = ToPrimitive(e, lval, "");
         if(!e->IsOk())
         {
@@ -9794,17 +15368,17 @@ namespace es
 
         if(lprim->IsString() || rprim->IsString())
         {
-            std::string lstr = ToString(e, lprim);
+            String* lstr = lprim->IsString() ? static_cast<String*>(lprim) : new String(ToString(e, lprim));
             if(!e->IsOk())
             {
                 return nullptr;
             }
-            std::string rstr = ToString(e, rprim);
+            String* rstr = rprim->IsString() ? static_cast<String*>(rprim) : new String(ToString(e, rprim));
             if(!e->IsOk())
             {
                 return nullptr;
             }
-            return new String(lstr + rstr);
+            return String::Concat(lstr, rstr);
         }
 
         double lnum = ToNumber(e, lprim);
@@ -9836,16 +15410,15 @@ namespace es
         uint32_t shift_count = rnum & 0x1F;
         if(op == "<<")
         {
-            return new Number(lnum << shift_count);
+            return Number::FromInt32(int32_t(uint32_t(lnum) << shift_count));
         }
         else if(op == ">>")
         {
-            return new Number(lnum >> shift_count);
+            return Number::FromInt32(lnum >> shift_count);
         }
         else if(op == ">>>")
         {
-            uint32_t lnum = ToUint32(e, lval);
-            return new Number(lnum >> rnum);
+            return new Number(uint32_t(lnum) >> shift_count);
         }
         assert(false);
     }
@@ -9901,12 +15474,12 @@ namespace es
         {
             if(!rval->IsObject())
             {
-                *e = *Error::TypeError("Right-hand side of 'instanceof' is not an object");
+                *e = Error::TypeError("Right-hand side of 'instanceof' is not an object");
                 return nullptr;
             }
             if(!rval->IsCallable())
             {
-                *e = *Error::TypeError("Right-hand side of 'instanceof' is not callable");
+                *e = Error::TypeError("Right-hand side of 'instanceof' is not callable");
                 return nullptr;
             }
             JSObject* obj = static_cast<JSObject*>(rval);
@@ -9916,7 +15489,7 @@ namespace es
         {
             if(!rval->IsObject())
             {
-                *e = *Error::TypeError("in called on non-object");
+                *e = Error::TypeError("in called on non-object");
                 return nullptr;
             }
             JSObject* obj = static_cast<JSObject*>(rval);
@@ -9963,11 +15536,11 @@ namespace es
         switch(op[0])
         {
             case u'&':
-                return new Number(lnum & rnum);
+                return Number::FromInt32(lnum & rnum);
             case u'^':
-                return new Number(lnum ^ rnum);
+                return Number::FromInt32(lnum ^ rnum);
             case u'|':
-                return new Number(lnum | rnum);
+                return Number::FromInt32(lnum | rnum);
             default:
                 assert(false);
         }
@@ -9976,12 +15549,7 @@ namespace es
     // 11.11 Binary Logical Operators
     inline JSValue* EvalLogicalOperator(Error* e, const std::string& op, Parsing::AST* lhs, Parsing::AST* rhs)
     {
-        JSValue* lref = EvalExpression(e, lhs);
-        if(!e->IsOk())
-        {
-            return nullptr;
-        }
-        JSValue* lval = GetValue(e, lref);
+        JSValue* lval = EvalExpressionValue(e, lhs);
         if(!e->IsOk())
         {
             return nullptr;
@@ -9990,12 +15558,7 @@ namespace es
         {
             return lval;
         }
-        JSValue* rref = EvalExpression(e, rhs);
-        if(!e->IsOk())
-        {
-            return nullptr;
-        }
-        JSValue* rval = GetValue(e, rref);
+        JSValue* rval = EvalExpressionValue(e, rhs);
         if(!e->IsOk())
         {
             return nullptr;
@@ -10013,13 +15576,13 @@ namespace es
             // TODO(zhuzilin) not sure how to implement the type error part of the note.
             if(ref->IsStrictReference() && ref->IsUnresolvableReference())
             {
-                *e = *Error::ReferenceError(ref->GetReferencedName() + " is not defined");
+                *e = Error::ReferenceError(ref->GetReferencedName() + " is not defined");
                 return nullptr;
             }
             if(ref->IsStrictReference() && ref->GetBase()->type() == JSValue::JS_ENV_REC
                && (ref->GetReferencedName() == "eval" || ref->GetReferencedName() == "arguments"))
             {
-                *e = *Error::SyntaxError();
+                *e = Error::SyntaxError();
                 return nullptr;
             }
         }
@@ -10032,18 +15595,22 @@ namespace es
     }
 
     // 11.13.2 Compound Assignment ( op= )
-    inline JSValue* EvalCompoundAssignment(Error* e, const std::string& op, JSValue* lref, JSValue* rval)
+    inline JSValue* EvalCompoundAssignment(Error* e, Parsing::Binary* b, JSValue* lref, JSValue* rval)
     {
-        std::string calc_op = op.substr(0, op.size() - 1);
         JSValue* lval = GetValue(e, lref);
         if(!e->IsOk())
         {
             return nullptr;
         }
-        JSValue* r = EvalBinaryExpression(e, calc_op, lval, rval);
-        if(!e->IsOk())
+        JSValue* r = EvalQuickenedBinary(b, lval, rval);
+        if(r == nullptr)
         {
-            return nullptr;
+            const std::string& op = b->op();
+            r = EvalBinaryExpression(e, op.substr(0, op.size() - 1), lval, rval);
+            if(!e->IsOk())
+            {
+                return nullptr;
+            }
         }
         return EvalSimpleAssignment(e, lref, r);
     }
@@ -10053,12 +15620,7 @@ namespace es
     {
         assert(ast->type() == Parsing::AST::AST_EXPR_TRIPLE);
         Parsing::TripleCondition* t = static_cast<Parsing::TripleCondition*>(ast);
-        JSValue* lref = EvalExpression(e, t->cond());
-        if(!e->IsOk())
-        {
-            return nullptr;
-        }
-        JSValue* lval = GetValue(e, lref);
+        JSValue* lval = EvalExpressionValue(e, t->cond());
         if(!e->IsOk())
         {
             return nullptr;
@@ -10103,7 +15665,8 @@ namespace es
                 case Parsing::LHS::PostfixType::CALL:
                 {
                     auto args = lhs->args_list()[pair.first];
-                    auto arg_list = EvalArgumentsList(e, args);
+                    ArgumentsGuard arg_list;
+                    EvalArgumentsList(e, args, arg_list.values());
                     if(!e->IsOk())
                     {
                         return nullptr;
@@ -10117,11 +15680,11 @@ namespace es
                         }
                         if(!base->IsConstructor())
                         {
-                            *e = *Error::TypeError("base value is not a constructor");
+                            *e = Error::TypeError("base value is not a constructor");
                             return nullptr;
                         }
                         JSObject* constructor = static_cast<JSObject*>(base);
-                        base = constructor->Construct(e, arg_list);
+                        base = constructor->Construct(e, arg_list.values());
                         if(!e->IsOk())
                         {
                             return nullptr;
@@ -10130,7 +15693,7 @@ namespace es
                     }
                     else
                     {
-                        base = EvalCallExpression(e, base, arg_list);
+                        base = EvalCallExpression(e, base, arg_list.values());
                         if(!e->IsOk())
                         {
                             return nullptr;
@@ -10150,8 +15713,8 @@ namespace es
                 }
                 case Parsing::LHS::PostfixType::PROP:
                 {
-                    auto prop = lhs->prop_name_list()[pair.first];
-                    base = EvalIndexExpression(e, base, prop, guard);
+                    const std::string& prop = lhs->prop_name_list()[pair.first];
+                    base = EvalIndexExpression(e, base, prop, guard, lhs->prop_cache(pair.first));
                     if(!e->IsOk())
                     {
                         return nullptr;
@@ -10171,7 +15734,7 @@ namespace es
             }
             if(!base->IsConstructor())
             {
-                *e = *Error::TypeError("base value is not a constructor");
+                *e = Error::TypeError("base value is not a constructor");
                 return nullptr;
             }
             JSObject* constructor = static_cast<JSObject*>(base);
@@ -10185,24 +15748,17 @@ namespace es
         return base;
     }
 
-    inline std::vector<JSValue*> EvalArgumentsList(Error* e, Parsing::Arguments* ast)
+    inline void EvalArgumentsList(Error* e, Parsing::Arguments* ast, std::vector<JSValue*>& arg_list)
     {
-        std::vector<JSValue*> arg_list;
         for(Parsing::AST* ast : ast->args())
         {
-            JSValue* ref = EvalExpression(e, ast);
-            if(!e->IsOk())
-            {
-                return {};
-            }
-            JSValue* arg = GetValue(e, ref);
+            JSValue* arg = EvalExpressionValue(e, ast);
             if(!e->IsOk())
             {
-                return {};
+                return;
             }
             arg_list.emplace_back(arg);
         }
-        return arg_list;
     }
 
     // 11.2.3
@@ -10215,13 +15771,13 @@ namespace es
         }
         if(!val->IsObject())
         {// 4
-            *e = *Error::TypeError("is not a function");
+            *e = Error::TypeError("is not a function");
             return nullptr;
         }
         auto obj = static_cast<JSObject*>(val);
         if(!obj->IsCallable())
         {// 5
-            *e = *Error::TypeError("is not a function");
+            *e = Error::TypeError("is not a function");
             return nullptr;
         }
         JSValue* this_value;
@@ -10257,7 +15813,8 @@ namespace es
     }
 
     // 11.2.1 Property Accessors
-    inline JSValue* EvalIndexExpression(Error* e, JSValue* base_ref, const std::string& identifier_name, ValueGuard& guard)
+    inline JSValue* EvalIndexExpression(Error* e, JSValue* base_ref, const std::string& identifier_name, ValueGuard& guard,
+                                        Parsing::LHS::PropertyCache* cache)
     {
         JSValue* base_value = GetValue(e, base_ref);
         if(!e->IsOk())
@@ -10271,20 +15828,26 @@ namespace es
             return nullptr;
         }
         bool strict = RuntimeContext::TopContext()->strict();
-        return new Reference(base_value, identifier_name, strict);
+        Reference* ref = new Reference(base_value, identifier_name, strict);
+        ref->SetCache(cache);
+        return ref;
     }
 
     inline JSValue* EvalIndexExpression(Error* e, JSValue* base_ref, Parsing::AST* expr, ValueGuard& guard)
     {
-        JSValue* property_name_ref = EvalExpression(e, expr);
+        JSValue* property_name_value = EvalExpressionValue(e, expr);
         if(!e->IsOk())
         {
             return nullptr;
         }
-        JSValue* property_name_value = GetValue(e, property_name_ref);
-        if(!e->IsOk())
+        if(property_name_value->IsNumber())
         {
-            return nullptr;
+            double num = static_cast<Number*>(property_name_value)->data();
+            uint32_t index = num >= 0 && num < 4294967295.0 ? uint32_t(num) : 0;
+            if(index == num)
+            {
+                return EvalIndexExpression(e, base_ref, index, guard);
+            }
         }
         std::string property_name_str = ToString(e, property_name_value);
         if(!e->IsOk())
@@ -10294,6 +15857,29 @@ namespace es
         return EvalIndexExpression(e, base_ref, property_name_str, guard);
     }
 
+    // An array index stays a number, so that objects with indexed storage are
+    // accessed without building the property name.
+    inline JSValue* EvalIndexExpression(Error* e, JSValue* base_ref, uint32_t index, ValueGuard& guard)
+    {
+        JSValue* base_value = GetValue(e, base_ref);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        guard.AddValue(base_value);
+        base_value->CheckObjectCoercible(e);
+        if(!e->IsOk())
+        {
+            return nullptr;
+        }
+        bool strict = RuntimeContext::TopContext()->strict();
+        if(!base_value->IsObject())
+        {
+            return new Reference(base_value, NumberToString(index), strict);
+        }
+        return new Reference(base_value, index, strict);
+    }
+
     inline JSValue* EvalExpressionList(Error* e, Parsing::AST* ast)
     {
         assert(ast->type() == Parsing::AST::AST_EXPR);
@@ -3,6 +3,8 @@
 #include <string>
 #include <fstream>
 #include <vector>
+#include <new>
+#include <cstdlib>
 #if __has_include(<readline/readline.h>)
 #include <readline/readline.h>
 #include <readline/history.h>
@@ -12,6 +14,37 @@
 #include "es.h"
 #include "optionparser.h"
 
+// Counts heap allocations for --count-allocs. Replacing the global
+// allocation functions is the only way to see the allocations made inside
+// the standard containers, and it costs one increment per allocation.
+static size_t g_alloc_count = 0;
+static bool g_count_allocs = false;
+static bool g_code_cache_stats = false;
+static bool g_type_feedback = false;
+static bool g_jit_stats = false;
+
+void* operator new(size_t size)
+{
+    g_alloc_count++;
+    void* ptr = malloc(size == 0 ? 1 : size);
+    if(ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t size) noexcept
+{
+    (void)size;
+    free(ptr);
+}
+
 // NOTE(zhuzilin) There are some copy and paste from stackoverflow...
 std::string ReadFile(const std::string& filename)
 {
@@ -29,7 +62,8 @@ void print_result(const es::Completion& c)
 
 bool execute(const std::string& code, es::Completion& res)
 {
-    es::Error* e;
+    es::Error error;
+    es::Error* e = &error;
     es::Parsing::AST* ast;
     es::Parsing::Parser parser(code);
     ast = parser.ParseProgram();
@@ -38,14 +72,36 @@ bool execute(const std::string& code, es::Completion& res)
         std::cout << "ParserError: " << es::log::ToString(ast->source()) << std::endl;
         return false;
     }
-    e = es::Error::Ok();
     es::EnterGlobalCode(e, ast);
     if(!e->IsOk())
     {
         std::cout << "enter global failed" << std::endl;
         return false;
     }
+    size_t allocs_before = g_alloc_count;
     res = es::EvalProgram(ast);
+    es::RuntimeContext::Global()->PopContext();
+    if(g_count_allocs)
+    {
+        std::cerr << "allocations: " << (g_alloc_count - allocs_before) << std::endl;
+    }
+    if(g_code_cache_stats)
+    {
+        es::CodeCache* cache = es::CodeCache::Global();
+        std::cerr << "code cache: " << cache->hits() << " hits, " << cache->misses() << " misses, "
+                  << cache->evictions() << " evictions, " << cache->size() << " entries" << std::endl;
+    }
+    if(g_type_feedback)
+    {
+        es::DumpTypeFeedback(std::cerr);
+    }
+    if(g_jit_stats)
+    {
+        es::OptimizingTier* tier = es::OptimizingTier::Global();
+        std::cerr << "optimizing tier: " << tier->optimized() << " optimized, " << tier->replaced() << " loops replaced, "
+                  << tier->scalars() << " objects replaced by scalars, " << tier->constants() << " constants, "
+                  << tier->speculations() << " speculations, " << tier->deopts() << " deopts" << std::endl;
+    }
     switch(res.type)
     {
         case es::Completion::THROWING:
@@ -152,12 +208,20 @@ int main(int argc, char* argv[])
     bool alsoprint;
     bool forcerepl;
     bool havecodechunk;
+    size_t stackdepth;
+    size_t codecache;
+    size_t indexstrings;
+    uint32_t jitthreshold;
     std::string filename;
     std::string codechunk;
     es::Completion res;
     alsoprint = false;
     forcerepl = false;
     havecodechunk = false;
+    stackdepth = es::RuntimeContext::kDefaultMaxStackDepth;
+    codecache = es::CodeCache::kDefaultCapacity;
+    indexstrings = es::IndexStrings::kDefaultSize;
+    jitthreshold = es::OptimizingTier::kDefaultThreshold;
     OptionParser prs;
 
     prs.on({"-i", "--repl"}, "force run REPL", [&]
@@ -174,6 +238,42 @@ int main(int argc, char* argv[])
     {
         alsoprint = true;
     });
+    prs.on({"-s?", "--stack-depth=?"}, "maximum number of nested calls before a RangeError", [&](const auto& v)
+    {
+        stackdepth = v.template as<size_t>();
+    });
+    prs.on({"-a", "--count-allocs"}, "print the number of heap allocations made while running the script", [&]
+    {
+        g_count_allocs = true;
+    });
+    prs.on({"-c?", "--code-cache=?"}, "number of eval and Function sources kept parsed, 0 to disable", [&](const auto& v)
+    {
+        codecache = v.template as<size_t>();
+    });
+    prs.on({"-n?", "--index-strings=?"}, "number of integer strings kept interned for property names, 0 to disable", [&](const auto& v)
+    {
+        indexstrings = v.template as<size_t>();
+    });
+    prs.on({"--code-cache-stats"}, "print the hits and misses of the eval and Function code cache", [&]
+    {
+        g_code_cache_stats = true;
+    });
+    prs.on({"--type-feedback"}, "print the operand types seen by each binary operator and the handler it runs", [&]
+    {
+        g_type_feedback = true;
+    });
+    prs.on({"-j?", "--jit-threshold=?"}, "number of times code runs before it is optimized", [&](const auto& v)
+    {
+        jitthreshold = v.template as<uint32_t>();
+    });
+    prs.on({"--jit-stress"}, "optimize all code before it first runs, same as --jit-threshold=0", [&]
+    {
+        jitthreshold = 0;
+    });
+    prs.on({"--jit-stats"}, "print the work done by the optimizing tier", [&]
+    {
+        g_jit_stats = true;
+    });
     try
     {
         prs.parse(argc, argv);
@@ -183,7 +283,16 @@ int main(int argc, char* argv[])
         std::cerr << "failed to process options: " << e.what() << std::endl;
         return 1;
     }
+    if(stackdepth == 0)
+    {
+        std::cerr << "stack depth must be positive" << std::endl;
+        return 1;
+    }
     auto rest = prs.positional();
+    es::RuntimeContext::Global()->SetMaxStackDepth(stackdepth);
+    es::CodeCache::Global()->SetCapacity(codecache);
+    es::IndexStrings::Global()->SetSize(indexstrings);
+    es::OptimizingTier::Global()->SetThreshold(jitthreshold);
     es::Init();
     if(havecodechunk)
     {
@@ -197,7 +306,7 @@ int main(int argc, char* argv[])
     {
         if(rest.size() > 0)
         {
-            std::string filename(argv[1]);
+            std::string filename(rest[0]);
             auto content = ReadFile(filename);
             if(!execute(content, res))
             {
@@ -9,8 +9,174 @@ namespace es
 {
     namespace Parsing
     {
-        Parser::Parser(const std::string& source) : m_source(source), lexer_(source)
+        // 10.5 step 8 binds every variable declared in the code, outside of nested
+        // functions. The names are collected once here, in source order and
+        // without duplicates, so that entering the code never walks the AST.
+        static void CollectVarDecls(AST* stmt, std::vector<std::string>* names, std::set<std::string>* seen)
         {
+            auto add = [names, seen](VarDecl* decl)
+            {
+                if(seen->insert(decl->ident()).second)
+                {
+                    names->emplace_back(decl->ident());
+                }
+            };
+            if(stmt == nullptr)
+            {
+                return;
+            }
+            switch(stmt->type())
+            {
+                case AST::AST_STMT_VAR:
+                    for(VarDecl* decl : static_cast<VarStmt*>(stmt)->decls())
+                    {
+                        add(decl);
+                    }
+                    break;
+                case AST::AST_STMT_BLOCK:
+                    for(AST* child : static_cast<Block*>(stmt)->statements())
+                    {
+                        CollectVarDecls(child, names, seen);
+                    }
+                    break;
+                case AST::AST_STMT_IF:
+                {
+                    If* if_stmt = static_cast<If*>(stmt);
+                    CollectVarDecls(if_stmt->if_block(), names, seen);
+                    CollectVarDecls(if_stmt->else_block(), names, seen);
+                    break;
+                }
+                case AST::AST_STMT_WHILE:
+                case AST::AST_STMT_WITH:
+                    CollectVarDecls(static_cast<WhileOrWith*>(stmt)->stmt(), names, seen);
+                    break;
+                case AST::AST_STMT_DO_WHILE:
+                    CollectVarDecls(static_cast<DoWhile*>(stmt)->stmt(), names, seen);
+                    break;
+                case AST::AST_STMT_FOR:
+                {
+                    For* for_stmt = static_cast<For*>(stmt);
+                    for(AST* expr : for_stmt->expr0s())
+                    {
+                        if(expr->type() == AST::AST_STMT_VAR_DECL)
+                        {
+                            add(static_cast<VarDecl*>(expr));
+                        }
+                    }
+                    CollectVarDecls(for_stmt->statement(), names, seen);
+                    break;
+                }
+                case AST::AST_STMT_FOR_IN:
+                {
+                    ForIn* for_in_stmt = static_cast<ForIn*>(stmt);
+                    if(for_in_stmt->expr0()->type() == AST::AST_STMT_VAR_DECL)
+                    {
+                        add(static_cast<VarDecl*>(for_in_stmt->expr0()));
+                    }
+                    CollectVarDecls(for_in_stmt->statement(), names, seen);
+                    break;
+                }
+                case AST::AST_STMT_TRY:
+                {
+                    Try* try_stmt = static_cast<Try*>(stmt);
+                    CollectVarDecls(try_stmt->try_block(), names, seen);
+                    CollectVarDecls(try_stmt->catch_block(), names, seen);
+                    CollectVarDecls(try_stmt->finally_block(), names, seen);
+                    break;
+                }
+                case AST::AST_STMT_SWITCH:
+                {
+                    Switch* switch_stmt = static_cast<Switch*>(stmt);
+                    for(const auto& clause : switch_stmt->before_default_case_clauses())
+                    {
+                        for(AST* child : clause.stmts)
+                        {
+                            CollectVarDecls(child, names, seen);
+                        }
+                    }
+                    if(switch_stmt->has_default_clause())
+                    {
+                        for(AST* child : switch_stmt->default_clause().stmts)
+                        {
+                            CollectVarDecls(child, names, seen);
+                        }
+                    }
+                    for(const auto& clause : switch_stmt->after_default_case_clauses())
+                    {
+                        for(AST* child : clause.stmts)
+                        {
+                            CollectVarDecls(child, names, seen);
+                        }
+                    }
+                    break;
+                }
+                case AST::AST_STMT_LABEL:
+                    CollectVarDecls(static_cast<LabelledStmt*>(stmt)->statement(), names, seen);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        Parser::Parser(const std::string& source) : m_source(source), lexer_(source), current_body_(nullptr), capture_sites_(0),
+                                              jump_target_count_(0)
+        {
+        }
+
+        size_t Parser::BeginJumpTarget(bool iteration)
+        {
+            size_t target = jump_targets_.pending_label;
+            if(target == 0)
+            {
+                target = ++jump_target_count_;
+            }
+            jump_targets_.pending_label = 0;
+            jump_targets_.statements.emplace_back(target, iteration);
+            return target;
+        }
+
+        void Parser::EndJumpTarget()
+        {
+            jump_targets_.statements.pop_back();
+        }
+
+        // 12.7, 12.8 Returns the id of the statement a continue or break
+        // jumps to, or 0 if it is not nested in such a statement of the
+        // current body, which is a SyntaxError.
+        size_t Parser::ResolveJumpTarget(AST::Type type, const std::string& label)
+        {
+            const auto& statements = jump_targets_.statements;
+            if(label.empty())
+            {
+                for(auto it = statements.rbegin(); it != statements.rend(); it++)
+                {
+                    if(type == AST::AST_STMT_BREAK || it->second)
+                    {
+                        return it->first;
+                    }
+                }
+                return 0;
+            }
+            for(const auto& pair : jump_targets_.labels)
+            {
+                if(pair.first != label)
+                {
+                    continue;
+                }
+                if(type == AST::AST_STMT_BREAK)
+                {
+                    return pair.second;
+                }
+                for(const auto& stmt : statements)
+                {
+                    if(stmt.first == pair.second && stmt.second)
+                    {
+                        return stmt.first;
+                    }
+                }
+                return 0;
+            }
+            return 0;
         }
 
         AST* Parser::ParsePrimaryExpression()
@@ -27,6 +193,14 @@ namespace es
                     goto error;
                 case Token::TK_IDENT:
                     lexer_.Next();
+                    if(current_body_ != nullptr && (token.source() == "arguments" || token.source() == "eval"))
+                    {
+                        current_body_->SetUsesArguments();
+                    }
+                    if(token.source() == "eval")
+                    {
+                        capture_sites_++;
+                    }
                     return new AST(AST::AST_EXPR_IDENT, token.source());
                 case Token::TK_NULL:
                     lexer_.Next();
@@ -159,6 +333,11 @@ namespace es
                 goto error;
             }
 
+            if(current_body_ != nullptr)
+            {
+                current_body_->SetHasInnerFunctions();
+            }
+            capture_sites_++;
             if(name.type() == Token::TK_NOT_FOUND)
             {
                 func = new Function(params, body, SOURCE_PARSED);
@@ -275,6 +454,11 @@ namespace es
                             delete body;
                             goto error;
                         }
+                        if(current_body_ != nullptr)
+                        {
+                            current_body_->SetHasInnerFunctions();
+                        }
+                        capture_sites_++;
                         Function* value = new Function(params, body, SOURCE_PARSED);
                         obj->AddProperty(ObjectLiteral::Property(key, value, type));
                     }
@@ -651,6 +835,11 @@ namespace es
             }
 
             ProgramOrFunctionBody* prog = new ProgramOrFunctionBody(program_or_function, strict);
+            ProgramOrFunctionBody* outer_body = current_body_;
+            current_body_ = prog;
+            // break and continue cannot cross function boundaries.
+            JumpTargets outer_jump_targets = std::move(jump_targets_);
+            jump_targets_ = JumpTargets();
             AST* element;
 
             token = lexer_.NextAndRewind();
@@ -661,6 +850,8 @@ namespace es
                     element = ParseFunction(true);
                     if(element->IsIllegal())
                     {
+                        current_body_ = outer_body;
+                        jump_targets_ = std::move(outer_jump_targets);
                         delete prog;
                         return element;
                     }
@@ -671,6 +862,8 @@ namespace es
                     element = ParseStatement();
                     if(element->IsIllegal())
                     {
+                        current_body_ = outer_body;
+                        jump_targets_ = std::move(outer_jump_targets);
                         delete prog;
                         return element;
                     }
@@ -679,6 +872,15 @@ namespace es
                 token = lexer_.NextAndRewind();
             }
             assert(token.type() == ending_token_type);
+            current_body_ = outer_body;
+            jump_targets_ = std::move(outer_jump_targets);
+            std::vector<std::string> var_decls;
+            std::set<std::string> seen;
+            for(AST* stmt : prog->statements())
+            {
+                CollectVarDecls(stmt, &var_decls, &seen);
+            }
+            prog->SetVarDecls(std::move(var_decls));
             prog->SetSource(SOURCE_PARSED);
             return prog;
         }
@@ -687,6 +889,10 @@ namespace es
         {
             START_POS;
             Token token = lexer_.NextAndRewind();
+            // Only an iteration, switch or labelled statement
+            // shares the id of the labels in front of it.
+            size_t pending_label = jump_targets_.pending_label;
+            jump_targets_.pending_label = 0;
 
             switch(token.type())
             {
@@ -707,14 +913,17 @@ namespace es
                     }
                     else if(token.source() == "do")
                     {
+                        jump_targets_.pending_label = pending_label;
                         return ParseDoWhileStatement();
                     }
                     else if(token.source() == "while")
                     {
+                        jump_targets_.pending_label = pending_label;
                         return ParseWhileStatement();
                     }
                     else if(token.source() == "for")
                     {
+                        jump_targets_.pending_label = pending_label;
                         return ParseForStatement();
                     }
                     else if(token.source() == "continue")
@@ -735,6 +944,7 @@ namespace es
                     }
                     else if(token.source() == "switch")
                     {
+                        jump_targets_.pending_label = pending_label;
                         return ParseSwitchStatement();
                     }
                     else if(token.source() == "throw")
@@ -766,6 +976,7 @@ namespace es
                     lexer_.Rewind(old_pos, old_token);
                     if(colon.type() == Token::TK_COLON)
                     {
+                        jump_targets_.pending_label = pending_label;
                         return ParseLabelledStatement();
                     }
                 }
@@ -934,11 +1145,14 @@ namespace es
             assert(lexer_.Next().source() == "do");
             AST* cond;
             AST* loop_block;
+            DoWhile* do_while;
+            size_t target = BeginJumpTarget(true);
             loop_block = ParseStatement();
             if(loop_block->IsIllegal())
             {
                 return loop_block;
             }
+            EndJumpTarget();
             if(lexer_.Next().source() != "while")
             {// skip while
                 delete loop_block;
@@ -967,7 +1181,9 @@ namespace es
                 delete loop_block;
                 goto error;
             }
-            return new DoWhile(cond, loop_block, SOURCE_PARSED);
+            do_while = new DoWhile(cond, loop_block, SOURCE_PARSED);
+            do_while->SetTarget(target);
+            return do_while;
         error:
             return new AST(AST::AST_ILLEGAL, SOURCE_PARSED);
         }
@@ -988,6 +1204,8 @@ namespace es
             assert(lexer_.Next().source() == keyword);
             AST* expr;
             AST* stmt;
+            WhileOrWith* while_or_with;
+            size_t target = 0;
             if(lexer_.Next().type() != Token::TK_LPAREN)
             {// skip (
                 goto error;
@@ -1002,13 +1220,23 @@ namespace es
                 delete expr;
                 goto error;
             }
+            if(type == AST::AST_STMT_WHILE)
+            {
+                target = BeginJumpTarget(true);
+            }
             stmt = ParseStatement();
             if(stmt->IsIllegal())
             {
                 delete expr;
                 return stmt;
             }
-            return new WhileOrWith(type, expr, stmt, SOURCE_PARSED);
+            if(type == AST::AST_STMT_WHILE)
+            {
+                EndJumpTarget();
+            }
+            while_or_with = new WhileOrWith(type, expr, stmt, SOURCE_PARSED);
+            while_or_with->SetTarget(target);
+            return while_or_with;
         error:
             return new AST(AST::AST_ILLEGAL, SOURCE_PARSED);
         }
@@ -1112,6 +1340,8 @@ namespace es
             AST* expr1 = nullptr;
             AST* expr2 = nullptr;
             AST* stmt;
+            For* for_stmt;
+            size_t target;
             Token token = lexer_.NextAndRewind();
             if(!token.IsSemiColon())
             {
@@ -1155,6 +1385,7 @@ namespace es
                 goto error;
             }
 
+            target = BeginJumpTarget(true);
             stmt = ParseStatement();
             if(stmt->IsIllegal())
             {
@@ -1170,8 +1401,11 @@ namespace es
                 }
                 return stmt;
             }
+            EndJumpTarget();
 
-            return new For(expr0s, expr1, expr2, stmt, SOURCE_PARSED);
+            for_stmt = new For(expr0s, expr1, expr2, stmt, SOURCE_PARSED);
+            for_stmt->SetTarget(target);
+            return for_stmt;
         error:
             for(auto expr : expr0s)
             {
@@ -1191,6 +1425,8 @@ namespace es
             assert(lexer_.Next().source() == "in");
             AST* expr1 = ParseExpression(false);// for ( xxx in Expression
             AST* stmt;
+            ForIn* for_in;
+            size_t target;
             if(expr1->IsIllegal())
             {
                 delete expr0;
@@ -1203,6 +1439,7 @@ namespace es
                 goto error;
             }
 
+            target = BeginJumpTarget(true);
             stmt = ParseStatement();
             if(stmt->IsIllegal())
             {
@@ -1210,7 +1447,10 @@ namespace es
                 delete expr1;
                 return stmt;
             }
-            return new ForIn(expr0, expr1, stmt, SOURCE_PARSED);
+            EndJumpTarget();
+            for_in = new ForIn(expr0, expr1, stmt, SOURCE_PARSED);
+            for_in->SetTarget(target);
+            return for_in;
         error:
             delete expr0;
             delete expr1;
@@ -1231,6 +1471,7 @@ namespace es
         {
             START_POS;
             assert(lexer_.Next().source() == keyword);
+            ContinueOrBreak* stmt;
             if(!lexer_.TrySkipSemiColon())
             {
                 Token ident = lexer_.NextAndRewind();
@@ -1243,9 +1484,20 @@ namespace es
                     lexer_.Next();
                     return new AST(AST::AST_ILLEGAL, SOURCE_PARSED);
                 }
-                return new ContinueOrBreak(type, ident, SOURCE_PARSED);
+                stmt = new ContinueOrBreak(type, ident, SOURCE_PARSED);
+            }
+            else
+            {
+                stmt = new ContinueOrBreak(type, SOURCE_PARSED);
+            }
+            size_t target = ResolveJumpTarget(type, stmt->ident());
+            if(target == 0)
+            {
+                delete stmt;
+                return new AST(AST::AST_ILLEGAL, SOURCE_PARSED);
             }
-            return new ContinueOrBreak(type, SOURCE_PARSED);
+            stmt->SetTarget(target);
+            return stmt;
         }
 
         AST* Parser::ParseReturnStatement()
@@ -1319,6 +1571,7 @@ namespace es
             {// skip {
                 goto error;
             }
+            switch_stmt->SetTarget(BeginJumpTarget(false));
             // Loop for parsing CaseClause
             token = lexer_.NextAndRewind();
             while(token.type() != Token::TK_RBRACE)
@@ -1391,6 +1644,8 @@ namespace es
             }
             assert(token.type() == Token::TK_RBRACE);
             assert(lexer_.Next().type() == Token::TK_RBRACE);
+            EndJumpTarget();
+            switch_stmt->ChooseDispatch();
             switch_stmt->SetSource(SOURCE_PARSED);
             return switch_stmt;
         error:
@@ -1407,6 +1662,8 @@ namespace es
             Token catch_ident(Token::TK_NOT_FOUND, "");
             AST* catch_block = nullptr;
             AST* finally_block = nullptr;
+            Try* try_stmt;
+            size_t capture_sites = 0;
 
             try_block = ParseBlockStatement();
             if(try_block->IsIllegal())
@@ -1431,6 +1688,7 @@ namespace es
                     delete try_block;
                     goto error;
                 }
+                capture_sites = capture_sites_;
                 catch_block = ParseBlockStatement();
                 if(catch_block->IsIllegal())
                 {
@@ -1455,19 +1713,18 @@ namespace es
             {
                 goto error;
             }
-            else if(finally_block == nullptr)
-            {
-                assert(catch_block != nullptr && catch_ident.type() == Token::TK_IDENT);
-                return new Try(try_block, catch_ident, catch_block, SOURCE_PARSED);
-            }
             else if(catch_block == nullptr)
             {
                 assert(finally_block != nullptr);
                 return new Try(try_block, finally_block, SOURCE_PARSED);
             }
             assert(catch_block != nullptr && catch_ident.type() == Token::TK_IDENT);
-            assert(finally_block != nullptr);
-            return new Try(try_block, catch_ident, catch_block, finally_block, SOURCE_PARSED);
+            try_stmt = new Try(try_block, catch_ident, catch_block, finally_block, SOURCE_PARSED);
+            if(capture_sites_ != capture_sites)
+            {
+                try_stmt->SetCatchEnvCaptured();
+            }
+            return try_stmt;
         error:
             delete try_block;
             if(catch_block != nullptr)
@@ -1485,12 +1742,30 @@ namespace es
             START_POS;
             Token ident = lexer_.Next();// skip identifier
             assert(lexer_.Next().type() == Token::TK_COLON);// skip colon
+            auto& labels = jump_targets_.labels;
+            for(const auto& pair : labels)
+            {
+                if(pair.first == ident.source())
+                {// 12.12 the label set must not already contain Identifier.
+                    return new AST(AST::AST_ILLEGAL, SOURCE_PARSED);
+                }
+            }
+            size_t target = jump_targets_.pending_label;
+            if(target == 0)
+            {
+                target = ++jump_target_count_;
+            }
+            labels.emplace_back(ident.source(), target);
+            jump_targets_.pending_label = target;
             AST* stmt = ParseStatement();
+            labels.pop_back();
             if(stmt->IsIllegal())
             {
                 return stmt;
             }
-            return new LabelledStmt(ident, stmt, SOURCE_PARSED);
+            LabelledStmt* label_stmt = new LabelledStmt(ident, stmt, SOURCE_PARSED);
+            label_stmt->SetTarget(target);
+            return label_stmt;
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,74 @@
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+
+function test_mapped()
+{
+    function f(a, b) {
+        arguments[0] = 10;
+        b = 20;
+        return [a, arguments[1], arguments.length].join();
+    }
+    assert(f(1, 2), "10,20,2", "mapped");
+    assert(f(1), "10,,1", "unpassed parameter is not mapped");
+    function g(a) {
+        delete arguments[0];
+        arguments[0] = 5;
+        return a;
+    }
+    assert(g(1), 1, "delete unmaps");
+    function h(a, a) {
+        arguments[1] = 9;
+        return a;
+    }
+    assert(h(1, 2), 9, "duplicate parameter maps the last one");
+    function d(a) {
+        Object.defineProperty(arguments, "0", { value: 4, writable: false });
+        arguments[0] = 8;
+        a = 6;
+        return [a, arguments[0]].join();
+    }
+    assert(d(1), "6,4", "non-writable unmaps");
+}
+
+function test_lazy()
+{
+    function k(a) {
+        return eval("arguments[0]");
+    }
+    assert(k(7), 7, "eval sees arguments");
+    function m() {
+        var inner = function() {
+            return arguments.length;
+        };
+        return inner(1, 2, 3);
+    }
+    assert(m(1), 3, "nested arguments");
+    function n(a) {
+        "use strict";
+        arguments[0] = 3;
+        return a;
+    }
+    assert(n(1), 1, "strict arguments are not mapped");
+    function c() {
+        return arguments.callee;
+    }
+    assert(c() === c, true, "callee");
+}
+
+test_mapped();
+test_lazy();
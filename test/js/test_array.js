@@ -0,0 +1,214 @@
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+function test_push_pop()
+{
+    var a = [1, 2];
+    assert(a.push(3, 4), 4, "push");
+    assert(a.join(), "1,2,3,4", "push");
+    assert(a.pop(), 4, "pop");
+    assert(a.length, 3, "pop");
+    assert([].pop(), undefined, "pop empty");
+    a = [];
+    a[3] = 1;
+    assert(a.pop(), 1, "pop holey");
+    assert(a.length, 3, "pop holey");
+    assert(a.pop(), undefined, "pop hole");
+    assert(a.length, 2, "pop hole");
+}
+
+function test_join()
+{
+    assert([1, null, undefined, "x"].join("-"), "1---x", "join");
+    assert([1, 2, 3].join(""), "123", "join empty separator");
+    assert(new Array(3).join("a"), "aa", "join holes");
+    assert([].join(), "", "join empty");
+}
+
+function test_shift_unshift()
+{
+    var a = [1, 2, 3];
+    assert(a.shift(), 1, "shift");
+    assert(a.join(), "2,3", "shift");
+    assert(a.unshift(0, 1), 4, "unshift");
+    assert(a.join(), "0,1,2,3", "unshift");
+    a = [];
+    assert(a.shift(), undefined, "shift empty");
+    a = [1, , 3];
+    assert(a.shift(), 1, "shift holey");
+    assert(a.length, 2, "shift holey");
+    assert(0 in a, false, "shift holey");
+    assert(a[1], 3, "shift holey");
+}
+
+function test_slice_splice()
+{
+    var a = [1, 2, 3, 4, 5];
+    assert(a.slice(1, 3).join(), "2,3", "slice");
+    assert(a.slice(-2).join(), "4,5", "slice negative");
+    assert(a.slice(3, 1).length, 0, "slice empty");
+    assert(a.splice(1, 2).join(), "2,3", "splice delete");
+    assert(a.join(), "1,4,5", "splice delete");
+    assert(a.splice(1, 0, 2, 3).length, 0, "splice insert");
+    assert(a.join(), "1,2,3,4,5", "splice insert");
+    assert(a.splice(1, 3, "x").join(), "2,3,4", "splice replace");
+    assert(a.join(), "1,x,5", "splice replace");
+    assert(a.splice(1).join(), "x,5", "splice to end");
+    assert(a.join(), "1", "splice to end");
+
+    var b = [1, 2, 3, 4];
+    delete b[1];
+    assert(1 in b.slice(0, 2), false, "slice holey");
+    b[1] = 2;
+    assert(b.slice(0, 2).join(), "1,2", "slice refilled hole");
+    b.length = 6;
+    b[5] = 6;
+    b[4] = 5;
+    assert(b.splice(3, 2).join(), "4,5", "splice filled holes");
+    assert(b.join(), "1,2,3,6", "splice filled holes");
+    b[7] = 8;
+    b.length = 6;
+    assert(b.splice(0, 1).join(), "1", "splice holes left");
+    assert(b.length, 5, "splice holes left");
+    assert(3 in b, false, "splice holes left");
+    b.length = 3;
+    assert(b.splice(1, 1).join(), "3", "splice holes cut off");
+    assert(b.join(), "2,6", "splice holes cut off");
+}
+
+function test_reverse_concat()
+{
+    assert([1, 2, 3].reverse().join(), "3,2,1", "reverse");
+    var a = [1, , 3, , ];
+    a.reverse();
+    assert(a.length, 4, "reverse holey");
+    assert(0 in a, false, "reverse holey");
+    assert(a[1], 3, "reverse holey");
+    assert(a[3], 1, "reverse holey");
+    assert([1].concat([2, 3], 4, [[5]]).join(), "1,2,3,4,5", "concat");
+    assert([1].concat([2, 3], 4).length, 4, "concat");
+}
+
+function test_search()
+{
+    var a = [1, 2, 3, 2, 1];
+    assert(a.indexOf(2), 1, "indexOf");
+    assert(a.indexOf(2, 2), 3, "indexOf fromIndex");
+    assert(a.indexOf(2, -1), -1, "indexOf negative fromIndex");
+    assert(a.indexOf("2"), -1, "indexOf strict");
+    assert(a.lastIndexOf(2), 3, "lastIndexOf");
+    assert(a.lastIndexOf(2, 2), 1, "lastIndexOf fromIndex");
+    assert(a.lastIndexOf(1, -6), -1, "lastIndexOf negative fromIndex");
+    assert([].indexOf(undefined), -1, "indexOf empty");
+}
+
+function test_every_some()
+{
+    var a = [1, 2, 3];
+    assert(a.every(function(x) { return x > 0; }), true, "every");
+    assert(a.every(function(x) { return x > 1; }), false, "every");
+    assert(a.some(function(x) { return x > 2; }), true, "some");
+    assert(a.some(function(x) { return x > 3; }), false, "some");
+    var seen = 0;
+    [1, , 3].every(function() { seen++; return true; });
+    assert(seen, 2, "every skips holes");
+}
+
+function test_sort()
+{
+    var a = [3, 1, 10, 2];
+    a.sort();
+    assert(a.join(), "1,10,2,3", "sort default");
+    a.sort(function(x, y) { return x - y; });
+    assert(a.join(), "1,2,3,10", "sort comparefn");
+    a = [3, undefined, 1, , 2];
+    a.sort();
+    assert(a.length, 5, "sort holey");
+    assert(a.join(), "1,2,3,,", "sort holey");
+    assert(4 in a, false, "sort holey");
+    a = [[1, "b"], [0, "a"], [1, "a"], [0, "b"]];
+    a.sort(function(x, y) { return x[0] - y[0]; });
+    assert(a.join(), "0,a,0,b,1,b,1,a", "sort stable");
+}
+
+function insertion_sort(a, cmp)
+{
+    var b = a.slice(0), i, j, x;
+    for (i = 1; i < b.length; i++) {
+        x = b[i];
+        for (j = i - 1; j >= 0 && cmp(x, b[j]) < 0; j--)
+            b[j + 1] = b[j];
+        b[j + 1] = x;
+    }
+    return b;
+}
+
+function test_sort_large()
+{
+    var seed = 7, ints = [], doubles = [], strs = [], pairs = [], i;
+    function random() {
+        seed = (seed * 16807) % 2147483647;
+        return seed;
+    }
+    for (i = 0; i < 300; i++) {
+        ints.push(random() % 1000 - 500);
+        doubles.push((random() % 1000) / 8 - 60);
+        strs.push("s" + (random() % 100));
+        pairs.push([random() % 10, i]);
+    }
+    function asc(a, b) { return a - b; }
+    function desc(a, b) { return b - a; }
+    function by_string(a, b) { return a < b ? -1 : a > b ? 1 : 0; }
+    function by_key(a, b) { return a[0] - b[0]; }
+    assert(ints.slice(0).sort(asc).join(), insertion_sort(ints, asc).join(), "sort int32 ascending");
+    assert(ints.slice(0).sort(desc).join(), insertion_sort(ints, desc).join(), "sort int32 descending");
+    assert(doubles.slice(0).sort(asc).join(), insertion_sort(doubles, asc).join(), "sort double ascending");
+    assert(doubles.slice(0).sort(desc).join(), insertion_sort(doubles, desc).join(), "sort double descending");
+    assert(strs.slice(0).sort().join(), insertion_sort(strs, by_string).join(), "sort strings");
+    assert(ints.slice(0).sort().join(), insertion_sort(ints, function(a, b) {
+        return by_string(String(a), String(b));
+    }).join(), "sort numbers as strings");
+    assert(pairs.slice(0).sort(by_key).join(), insertion_sort(pairs, by_key).join(), "sort stable large");
+    assert(ints.slice(0).sort(function(a, b) { return a > b ? 1 : a < b ? -1 : 0; }).join(),
+           insertion_sort(ints, asc).join(), "sort generic comparator");
+}
+
+function test_sparse()
+{
+    var a = [1, 2, 3];
+    Object.defineProperty(a, "1", { value: 5, writable: false });
+    assert(a.join(), "1,5,3", "sparse");
+    a.push(4);
+    assert(a.join(), "1,5,3,4", "sparse push");
+    a.length = 2;
+    assert(a.join(), "1,5", "sparse truncate");
+    a = [];
+    a[100000] = 1;
+    assert(a.length, 100001, "far index");
+    assert(a.indexOf(1), 100000, "far index");
+}
+
+test_push_pop();
+test_join();
+test_shift_unshift();
+test_slice_splice();
+test_reverse_concat();
+test_search();
+test_every_some();
+test_sort();
+test_sort_large();
+test_sparse();
@@ -0,0 +1,76 @@
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+
+function test_stack_overflow()
+{
+    function f(n) {
+        return n == 0 ? 0 : f(n - 1) + 1;
+    }
+    var caught = false;
+    try {
+        f(1000000);
+    } catch (e) {
+        caught = e instanceof RangeError;
+    }
+    assert(caught, true, "deep recursion throws RangeError");
+    assert(f(1000), 1000, "stack is usable after overflow");
+}
+
+function test_reused_frames()
+{
+    function fib(n) {
+        var a = n - 1, b = n - 2;
+        return n < 2 ? n : fib(a) + fib(b);
+    }
+    assert(fib(15), 610, "recursion");
+    function make(x) {
+        var y = x * 2;
+        return function() { return x + y; };
+    }
+    var g = make(1), h = make(2);
+    fib(5);
+    assert(g(), 3, "captured environment survives later calls");
+    assert(h(), 6, "captured environment survives later calls");
+    function leaf(v) {
+        var w;
+        return w === undefined ? v : -1;
+    }
+    leaf(1);
+    assert(leaf(2), 2, "reused environment starts empty");
+}
+
+function test_many_bindings()
+{
+    var src = [];
+    for (var i = 0; i < 40; i++)
+        src.push("var v" + i + " = " + i + ";");
+    src.push("return v0 + v17 + v39;");
+    var f = new Function("a", src.join(""));
+    assert(f(), 56, "indexed bindings");
+    function g() {
+        eval("var added = 1;");
+        var before = typeof added;
+        delete added;
+        return before + "," + typeof added;
+    }
+    assert(g(), "number,undefined", "eval var can be deleted");
+}
+
+test_stack_overflow();
+test_reused_frames();
+test_many_bindings();
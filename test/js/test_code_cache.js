@@ -0,0 +1,97 @@
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+
+function test_eval()
+{
+    var results = [];
+    for (var i = 0; i < 3; i++)
+        results.push(eval("i * 2"));
+    assert(results.join(), "0,2,4", "same source, new scope values");
+
+    function scoped(v) {
+        return eval("v + 1");
+    }
+    assert(scoped(1), 2);
+    assert(scoped(10), 11, "same source from another call");
+
+    function counter() {
+        eval("var n = 0; function inc() { return ++n; }");
+        return inc;
+    }
+    var a = counter();
+    var b = counter();
+    a();
+    a();
+    assert(a(), 3);
+    assert(b(), 1, "functions declared by cached code keep their own state");
+
+    function sloppy() {
+        eval("var declared = 1;");
+        return typeof declared;
+    }
+    function strict() {
+        "use strict";
+        eval("var declared = 1;");
+        return typeof declared;
+    }
+    assert(sloppy(), "number");
+    assert(strict(), "undefined", "strictness of the caller applies to cached code");
+    assert(sloppy(), "number");
+}
+
+function test_syntax_errors()
+{
+    for (var i = 0; i < 2; i++) {
+        var ok = false;
+        try {
+            eval("var = ;");
+        } catch (e) {
+            ok = e instanceof SyntaxError;
+        }
+        assert(ok, true, "eval syntax error, attempt " + i);
+        ok = false;
+        try {
+            new Function("a", "return a +;");
+        } catch (e) {
+            ok = e instanceof SyntaxError;
+        }
+        assert(ok, true, "Function syntax error, attempt " + i);
+    }
+}
+
+function test_function_constructor()
+{
+    var fs = [];
+    for (var i = 0; i < 3; i++)
+        fs.push(new Function("a", "b", "return a * b + " + (i % 2) + ";"));
+    assert(fs[0](2, 3), 6);
+    assert(fs[1](2, 3), 7);
+    assert(fs[2](2, 3), 6, "same source as the first");
+    assert(fs[0] !== fs[2], true, "a new function object each time");
+    assert(new Function("a,b", "return a - b;")(5, 2), 3);
+    assert(new Function("a", "b, c", "return a + b + c;")(1, 2, 3), 6);
+    assert(new Function("", "return 4;")(), 4);
+    assert(new Function("return 5;")(), 5);
+    var f = Function("x", "this.x = x;");
+    var o = new f(7);
+    assert(o.x, 7);
+}
+
+test_eval();
+test_syntax_errors();
+test_function_constructor();
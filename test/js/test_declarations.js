@@ -0,0 +1,81 @@
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+
+function test_var_hoisting()
+{
+    function f(x) {
+        if (x) {
+            var a = 1;
+        } else {
+            for (var i = 0, j = 2; i < 1; i++) {
+                try { var b = 2; } catch (e) { var c = 3; }
+            }
+        }
+        return [typeof a, typeof b, typeof c, typeof i, typeof j].join();
+    }
+    assert(f(true), "number,undefined,undefined,undefined,undefined", "if branch");
+    assert(f(false), "undefined,number,undefined,number,number", "else branch");
+    function g() {
+        var r = [];
+        for (var k in { p: 1 }) r.push(k);
+        switch (1) {
+        case 1: var s = "one";
+        }
+        lbl: while (true) { var t = 1; break lbl; }
+        do { var u = 2; } while (false);
+        return [k, s, t, u].join();
+    }
+    assert(g(), "p,one,1,2", "nested statements");
+}
+
+function test_shadowing()
+{
+    function f(a, a) {
+        return a;
+    }
+    assert(f(1, 2), 2, "duplicate parameters");
+    function g(a) {
+        var a;
+        return a;
+    }
+    assert(g(3), 3, "var does not reset a parameter");
+    function h(a) {
+        function a() {}
+        var a;
+        return typeof a;
+    }
+    assert(h(1), "function", "function declaration overrides parameter");
+    function k() {
+        var arguments;
+        return typeof arguments;
+    }
+    assert(k(), "object", "var does not reset arguments");
+    function l(x) {
+        var arguments = 5;
+        return arguments;
+    }
+    assert(l(1), 5, "var can assign arguments");
+    function m() {
+        return typeof m2;
+        function m2() {}
+    }
+    assert(m(), "function", "function declarations are hoisted");
+}
+
+test_var_hoisting();
+test_shadowing();
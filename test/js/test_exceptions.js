@@ -0,0 +1,144 @@
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+
+function test_thrown_values()
+{
+    function thrower(v) {
+        throw v;
+    }
+    function call(v) {
+        return thrower(v);
+    }
+    var obj = { tag: 1 };
+    var err = new Error("boom");
+    var values = [1, "str", obj, err, null];
+    for (var i = 0; i < values.length; i++) {
+        var caught = undefined;
+        try {
+            call(values[i]);
+        } catch (e) {
+            caught = e;
+        }
+        assert(caught === values[i], true, "identity of thrown value " + i);
+    }
+    var seen;
+    try {
+        [1].forEach(function(v) { thrower(obj); });
+    } catch (e) {
+        seen = e;
+    }
+    assert(seen === obj, true, "through a builtin callback");
+    try {
+        eval("thrower(obj)");
+    } catch (e) {
+        seen = e;
+    }
+    assert(seen === obj, true, "through eval");
+}
+
+function test_error_types()
+{
+    function f() {
+        null.x;
+    }
+    function g() {
+        return f();
+    }
+    var ok = false;
+    try {
+        g();
+    } catch (e) {
+        ok = e instanceof TypeError;
+    }
+    assert(ok, true, "TypeError from callee");
+    try {
+        throw missing;
+    } catch (e) {
+        ok = e instanceof ReferenceError;
+    }
+    assert(ok, true, "error in throw operand");
+}
+
+// The error raised while evaluating a throw operand is thrown instead.
+function test_throw_operand()
+{
+    var caught;
+    try {
+        throw undefinedVar.x;
+    } catch (e) {
+        caught = e;
+    }
+    assert(caught instanceof ReferenceError, true, "undeclared base");
+    try {
+        throw null.x;
+    } catch (e) {
+        caught = e;
+    }
+    assert(caught instanceof TypeError, true, "null base");
+    var after = false;
+    function operand() {
+        throw new RangeError("inner");
+    }
+    try {
+        throw operand() + (after = true);
+    } catch (e) {
+        caught = e;
+    }
+    assert(caught instanceof RangeError && caught.message == "inner", true, "error from a call in the operand");
+    assert(after, false, "rest of the operand skipped");
+}
+
+function test_catch_scope()
+{
+    var e = "outer";
+    var fns = [];
+    for (var i = 0; i < 3; i++) {
+        try {
+            throw i;
+        } catch (e) {
+            fns.push(function() { return e; });
+        }
+    }
+    assert(fns[0]() + fns[1]() + fns[2](), 3, "captured catch bindings");
+    assert(e, "outer", "catch binding does not leak");
+    var sum = 0;
+    for (var j = 0; j < 3; j++) {
+        try {
+            throw j;
+        } catch (x) {
+            sum += x;
+        }
+    }
+    assert(sum, 3, "reused catch environment");
+    var order = [];
+    try {
+        try {
+            throw 1;
+        } finally {
+            order.push("finally");
+        }
+    } catch (x) {
+        order.push("catch " + x);
+    }
+    assert(order.join(), "finally,catch 1", "finally runs before outer catch");
+}
+
+test_thrown_values();
+test_error_types();
+test_throw_operand();
+test_catch_scope();
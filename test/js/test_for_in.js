@@ -0,0 +1,131 @@
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+
+function keys(o)
+{
+    var r = [];
+    for (var k in o)
+        r.push(k);
+    return r.join();
+}
+
+function test_same_keys()
+{
+    assert(keys({ a: 1, b: 2 }), "a,b");
+    assert(keys({ a: 3, b: 4 }), "a,b", "object with the same keys");
+    assert(keys({ a: 1, c: 2 }), "a,c", "same count, other keys");
+    assert(keys({ a: 1 }), "a");
+    assert(keys({}), "");
+    var o = { x: 1 };
+    assert(keys(o), "x");
+    o.y = 2;
+    assert(keys(o), "x,y", "property added between loops");
+    delete o.x;
+    assert(keys(o), "y", "property deleted between loops");
+}
+
+function test_prototypes()
+{
+    function F() {
+        this.own = 1;
+    }
+    F.prototype.inherited = 2;
+    var a = new F();
+    var b = new F();
+    assert(keys(a), "own,inherited", "own properties come first");
+    assert(keys(b), keys(a), "same constructor");
+    F.prototype.added = 3;
+    assert(keys(b).indexOf("added") >= 0, true, "property added to the prototype");
+    delete F.prototype.added;
+    assert(keys(b).indexOf("added"), -1, "property deleted from the prototype");
+
+    var p = { shared: 1 };
+    var c = Object.create(p);
+    c.shared = 2;
+    assert(keys(c), "shared", "shadowed inherited name listed once");
+    Object.defineProperty(c, "hidden", { value: 1, enumerable: false, configurable: true });
+    assert(keys(c), "shared", "non-enumerable own property");
+    Object.defineProperty(c, "hidden", { enumerable: true });
+    assert(keys(c), "hidden,shared", "property made enumerable");
+}
+
+function test_deleted_during_iteration()
+{
+    var o = { a: 1, b: 2, c: 3 };
+    var seen = [];
+    for (var k in o) {
+        seen.push(k);
+        if (k == "a")
+            delete o.b;
+    }
+    assert(seen.join(), "a,c", "deleted before it is visited");
+
+    var arr = [1, 2, 3];
+    seen = [];
+    for (var i in arr) {
+        seen.push(i);
+        if (i == "0")
+            delete arr[1];
+    }
+    assert(seen.join(), "0,2", "array element deleted before it is visited");
+}
+
+function test_recursion()
+{
+    function walk(o, depth) {
+        var r = [];
+        for (var k in o) {
+            r.push(k);
+            if (typeof o[k] == "object")
+                r.push("(" + walk(o[k], depth + 1) + ")");
+        }
+        return r.join();
+    }
+    assert(walk({ a: { x: 1, y: { z: 1 } }, b: 2 }), "a,(x,y,(z)),b");
+}
+
+function test_completion()
+{
+    var s = "";
+    var o = { a: 1, b: 2, c: 3, d: 4 };
+    for (var k in o) {
+        if (k == "b")
+            continue;
+        if (k == "d")
+            break;
+        s += k;
+    }
+    assert(s, "ac");
+    function find(o, v) {
+        for (var k in o)
+            if (o[k] == v)
+                return k;
+        return null;
+    }
+    assert(find(o, 3), "c");
+    assert(find(o, 5), null);
+    var target = {};
+    for (target.name in { p: 1 });
+    assert(target.name, "p", "left hand side expression");
+}
+
+test_same_keys();
+test_prototypes();
+test_deleted_during_iteration();
+test_recursion();
+test_completion();
@@ -0,0 +1,147 @@
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+function test_array()
+{
+    var a = [];
+    for (var i = 0; i < 5; i++)
+        a[i] = i * 2;
+    assert(a.length, 5);
+    assert(a[3], 6);
+    assert(a["3"], 6, "string key");
+    assert(a[-0], 0, "negative zero");
+    assert(a[5], undefined, "past the end");
+    a[1] += 10;
+    assert(a[1], 12, "compound assignment");
+    a[1.5] = "x";
+    assert(a["1.5"], "x", "fractional key");
+    assert(a.length, 5);
+    a[9] = 1;
+    assert(a.length, 10, "append with a hole");
+    assert(a[7], undefined, "hole");
+    assert(7 in a, false);
+    delete a[0];
+    assert(a[0], undefined, "deleted");
+    assert(0 in a, false);
+    a[4294967294] = "last";
+    assert(a.length, 4294967295);
+    a[4294967295] = "not an index";
+    assert(a.length, 4294967295, "2^32-1 is not an index");
+    assert(a["4294967295"], "not an index");
+}
+
+function test_prototype()
+{
+    Array.prototype[3] = "proto";
+    var a = [0, 1];
+    assert(a[3], "proto", "hole reads the prototype");
+    a[3] = "own";
+    assert(a[3], "own");
+    assert(Array.prototype[3], "proto");
+    delete Array.prototype[3];
+
+    var o = {};
+    for (var i = 0; i < 3; i++)
+        o[i] = i + 1;
+    assert(o[2], 3);
+    assert(o["2"], 3);
+    var keys = [];
+    for (var k in o)
+        keys.push(k);
+    assert(keys.join(), "0,1,2");
+
+    var p = Object.create(o);
+    p[0] = "p";
+    assert(p[0], "p");
+    assert(p[1], 2, "inherited element");
+    assert(o[0], 1);
+}
+
+function test_readonly()
+{
+    var a = [1, 2, 3];
+    Object.defineProperty(a, 1, { value: 5, writable: false, configurable: true });
+    a[1] = 6;
+    assert(a[1], 5, "read only element");
+    a[0] = 7;
+    assert(a[0], 7);
+    var threw = false;
+    (function() {
+        "use strict";
+        try {
+            a[1] = 8;
+        } catch (e) {
+            threw = e instanceof TypeError;
+        }
+    })();
+    assert(threw, true, "strict write to a read only element");
+}
+
+function test_primitive()
+{
+    var s = "abc";
+    assert(s[1], "b");
+    assert(s[3], undefined);
+    s[1] = "x";
+    assert(s, "abc");
+}
+
+function test_typed_array()
+{
+    var t = new Int8Array(4);
+    for (var i = 0; i < 4; i++)
+        t[i] = i + 126;
+    assert(t[0], 126);
+    assert(t[2], -128, "wraps around");
+    t[4] = 1;
+    assert(t[4], undefined, "out of range");
+    t[1] += 1;
+    assert(t[1], -128);
+}
+
+function test_arguments()
+{
+    function f(x, y) {
+        arguments[0] = 10;
+        assert(x, 10, "mapped argument");
+        assert(arguments[1], y);
+        assert(arguments[2], undefined);
+        return arguments.length;
+    }
+    assert(f(1, 2), 2);
+}
+
+function test_names()
+{
+    var a = [];
+    for (var i = 0; i < 1100; i++)
+        a.push(i);
+    assert(a.join("").length, 3290);
+    assert(Object.keys(a)[1099], "1099");
+    assert(String(1023), "1023");
+    assert(String(1024), "1024");
+    assert(String(-1), "-1");
+    assert("" + 7, "7");
+}
+
+test_array();
+test_prototype();
+test_readonly();
+test_primitive();
+test_typed_array();
+test_arguments();
+test_names();
@@ -0,0 +1,107 @@
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+
+function is_negative_zero(x)
+{
+    return x === 0 && 1 / x === -Infinity;
+}
+
+function test_arithmetic()
+{
+    var max = 2147483647, min = -2147483648;
+    assert(max + 1, 2147483648, "add overflow");
+    assert(min - 1, -2147483649, "sub overflow");
+    assert(max * 2, 4294967294, "mul overflow");
+    assert(65536 * 65536, 4294967296);
+    assert(is_negative_zero(0 * -5), true, "0 * -5");
+    assert(is_negative_zero(-5 * 0), true, "-5 * 0");
+    assert(7 / 2, 3.5);
+    assert(-6 / 3, -2);
+    assert(is_negative_zero(0 / -3), true, "0 / -3");
+    assert(1 / 0, Infinity);
+    assert(min / -1, 2147483648);
+    assert(7 % 3, 1);
+    assert(-7 % 3, -1);
+    assert(7 % -3, 1);
+    assert(is_negative_zero(-6 % 3), true, "-6 % 3");
+    assert(min % -1, 0);
+    assert(is_negative_zero(min % -1), true, "min % -1");
+    assert(5 % 0 !== 5 % 0, true, "x % 0 is NaN");
+    var i = max;
+    i++;
+    assert(i, 2147483648, "increment overflow");
+    var j = min;
+    j--;
+    assert(j, -2147483649, "decrement overflow");
+    var k = -1;
+    ++k;
+    assert(is_negative_zero(k), false, "-1 + 1 is +0");
+}
+
+function test_bitwise()
+{
+    assert(1 << 31, -2147483648);
+    assert(1 << 32, 1, "shift count is masked");
+    assert(-1 >> 28, -1);
+    assert(-1 >>> 28, 15);
+    assert(-1 >>> 0, 4294967295);
+    assert(1 >>> 33, 0);
+    assert(8 >>> 33, 4, ">>> masks the shift count");
+    assert(~0, -1);
+    assert(~(-1), 0);
+    assert(0xff & 0x0f, 15);
+    assert(0xf0 | 0x0f, 255);
+    assert(5 ^ 1, 4);
+    assert(4294967296 | 0, 0);
+    assert(4294967295 | 0, -1);
+    assert(2147483648 | 0, -2147483648);
+    assert(-2147483649 | 0, 2147483647);
+    assert(1.9 | 0, 1);
+    assert(-1.9 | 0, -1);
+    assert(2147483647.5 | 0, 2147483647);
+    assert(-2147483648.5 | 0, -2147483648);
+    assert(9007199254740993 | 0, 0);
+    assert(1e21 | 0, -559939584);
+    assert(-1e21 | 0, 559939584);
+    assert(Infinity | 0, 0);
+    assert((0 / 0) | 0, 0);
+    assert("12" | 0, 12);
+    assert(4294967297 >>> 0, 1);
+    assert(-4294967297 >> 0, -1);
+}
+
+function test_mixed()
+{
+    var x = 3, y = 0.5;
+    assert(x + y, 3.5);
+    assert(x * y, 1.5);
+    assert(x - y, 2.5);
+    assert(x + "1", "31");
+    var s = 0;
+    for (var i = 0; i < 100; i++)
+        s = (s + i * i) | 0;
+    assert(s, 328350);
+    var h = 0;
+    for (var i = 0; i < 1000; i++)
+        h = (h * 31 + i) | 0;
+    assert(h, 562641396);
+}
+
+test_arithmetic();
+test_bitwise();
+test_mixed();
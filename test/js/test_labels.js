@@ -0,0 +1,161 @@
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+function assert_syntax_error(source)
+{
+    var ok = false;
+    try {
+        eval(source);
+    } catch (e) {
+        ok = e instanceof SyntaxError;
+    }
+    assert(ok, true, source);
+}
+
+function test_nested_loops()
+{
+    var s = "";
+    outer: for (var i = 0; i < 3; i++) {
+        for (var j = 0; j < 3; j++) {
+            if (j == 1)
+                continue outer;
+            if (i == 2)
+                break outer;
+            s += i + "" + j + ",";
+        }
+    }
+    assert(s, "00,10,", "continue and break the outer loop");
+
+    s = "";
+    a: b: while (true) {
+        do {
+            s += "x";
+            if (s.length < 3)
+                continue b;
+            break a;
+        } while (false);
+    }
+    assert(s, "xxx", "two labels on one loop");
+
+    var n = 0;
+    for (var k = 0; k < 5; k++) {
+        inner: for (var m = 0; m < 5; m++) {
+            if (m == 2)
+                break;
+            n++;
+        }
+    }
+    assert(n, 10, "unlabelled break leaves the innermost loop");
+}
+
+function test_labelled_blocks()
+{
+    var s = "";
+    block: {
+        s += "a";
+        if (s.length)
+            break block;
+        s += "b";
+    }
+    assert(s, "a", "break out of a labelled block");
+
+    s = "";
+    loop: for (var i = 0; i < 3; i++) {
+        block: {
+            if (i == 1)
+                break block;
+            s += i;
+        }
+    }
+    assert(s, "02", "break a block inside a loop");
+
+    var v = eval("l: { 1; break l; 2; }");
+    assert(v, 1, "completion value of a labelled block");
+}
+
+function test_switch()
+{
+    var s = "";
+    for (var i = 0; i < 4; i++) {
+        switch (i % 2) {
+            case 0:
+                s += "e";
+                break;
+            default:
+                s += "o";
+                continue;
+        }
+        s += i;
+    }
+    assert(s, "e0oe2o", "break and continue inside a switch in a loop");
+
+    s = "";
+    loop: for (var j = 0; j < 3; j++) {
+        switch (1) {
+            case 1:
+                if (j == 1)
+                    break loop;
+                s += j;
+        }
+    }
+    assert(s, "0", "break a loop from a switch");
+
+    s = "";
+    switch (1) {
+        case 1:
+            s += "a";
+            break;
+        case 2:
+            s += "b";
+    }
+    assert(s, "a", "break at top level of a switch");
+}
+
+function test_function_boundaries()
+{
+    var s = "";
+    outer: for (var i = 0; i < 2; i++) {
+        var f = function () {
+            outer: for (var j = 0; j < 3; j++) {
+                if (j == 1)
+                    break outer;
+                s += j;
+            }
+        };
+        f();
+        s += "|";
+    }
+    assert(s, "0|0|", "labels are local to their function");
+}
+
+function test_syntax_errors()
+{
+    assert_syntax_error("break;");
+    assert_syntax_error("continue;");
+    assert_syntax_error("l: { continue l; }");
+    assert_syntax_error("l: while (true) { break m; }");
+    assert_syntax_error("l: l: while (true) break;");
+    assert_syntax_error("switch (1) { case 1: continue; }");
+    assert_syntax_error("l: while (true) { (function () { break l; })(); }");
+    assert_syntax_error("while (true) { (function () { continue; })(); }");
+}
+
+test_nested_loops();
+test_labelled_blocks();
+test_switch();
+test_function_boundaries();
+test_syntax_errors();
@@ -0,0 +1,88 @@
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+
+// NOTE: values are built with arithmetic so that the test does not depend on
+// the accuracy of number literals.
+function pow10(n)
+{
+    var r = 1;
+    for (var i = 0; i < n; i++)
+        r *= 10;
+    return r;
+}
+
+function test_integers()
+{
+    assert(String(0), "0");
+    assert(String(-0), "0", "negative zero");
+    assert(String(7), "7");
+    assert(String(-42), "-42");
+    assert(String(4294967295), "4294967295");
+    assert(String(9007199254740991), "9007199254740991");
+    assert(String(9007199254740992 * 2), "18014398509481984");
+    assert(String(pow10(20)), "100000000000000000000");
+    assert(String(pow10(21)), "1e+21", "21 digits switch to exponent form");
+    assert(String(-pow10(21) * 3), "-3e+21");
+    assert(String(pow10(22) + pow10(6) * 4194304), "1.0000000004194304e+22");
+    assert("" + 1024 + 1, "10241", "concatenation");
+}
+
+function test_fractions()
+{
+    assert(String(1 / 2), "0.5");
+    assert(String(1 / 10), "0.1");
+    assert(String(1 / 10 + 2 / 10), "0.30000000000000004", "shortest round trip");
+    assert(String(1 / 3), "0.3333333333333333");
+    assert(String(2 / 3), "0.6666666666666666");
+    assert(String(-1 / 8), "-0.125");
+    assert(String(123456 / 1000), "123.456");
+    assert(String(1 / pow10(6)), "0.000001");
+    assert(String(1 / pow10(7)), "1e-7", "below 1e-6 switch to exponent form");
+    assert(String(15 / pow10(8)), "1.5e-7");
+    assert(String(123 / pow10(20)), "1.23e-18");
+    assert(String(1 / pow10(22)), "1e-22");
+}
+
+function test_limits()
+{
+    assert(String(Number.MAX_VALUE), "1.7976931348623157e+308");
+    assert(String(Number.MIN_VALUE), "5e-324");
+    assert(String(-Number.MIN_VALUE), "-5e-324");
+    assert(String(1 / 0), "Infinity");
+    assert(String(-1 / 0), "-Infinity");
+    assert(String(0 / 0), "NaN");
+}
+
+function test_property_keys()
+{
+    var o = {};
+    o[1 / 10] = "a";
+    o[pow10(21)] = "b";
+    assert(o["0.1"], "a");
+    assert(o["1e+21"], "b");
+    var arr = [];
+    for (var i = 0; i < 12; i++)
+        arr.push(i);
+    assert(arr.join(), "0,1,2,3,4,5,6,7,8,9,10,11");
+    assert([1 / 4, -3, 1 / 3].join(" "), "0.25 -3 0.3333333333333333");
+}
+
+test_integers();
+test_fractions();
+test_limits();
+test_property_keys();
@@ -0,0 +1,131 @@
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+
+
+function is_negative_zero(x)
+{
+    return x === 0 && 1 / x === -Infinity;
+}
+
+// More calls than the default threshold, so each function below runs both
+// before and after it is optimized. Run with --jit-stress as well.
+var kCalls = 300;
+
+function test_constants()
+{
+    function f(x) {
+        return [1 + 2 * 3, -0, "a" + 1 + 2, 1 / 0, -(-1), !0, ~5, typeof "s", void 0, 7 >>> 1, "10" < "9", 1 == "1", null, true, x];
+    }
+    for (var i = 0; i < kCalls; i++) {
+        var r = f(i);
+        assert(r[0], 7);
+        assert(is_negative_zero(r[1]), true);
+        assert(r[2], "a12");
+        assert(r[3], Infinity);
+        assert(r[4], 1);
+        assert(r[5], true);
+        assert(r[6], -6);
+        assert(r[7], "string");
+        assert(r[8], undefined);
+        assert(r[9], 3);
+        assert(r[10], true);
+        assert(r[11], true);
+        assert(r[12], null);
+        assert(r[13], true);
+        assert(r[14], i);
+    }
+}
+
+function test_locals()
+{
+    function f(a, b) {
+        var c = a * b;
+        var d = c - a;
+        return d + b;
+    }
+    var s = 0;
+    for (var i = 0; i < kCalls; i++)
+        s = s + f(i, 2);
+    assert(s, 45450);
+
+    function outer(n) {
+        function inner() { return n + 1; }
+        return inner();
+    }
+    for (var i = 0; i < kCalls; i++)
+        assert(outer(i), i + 1);
+}
+
+// The innermost environment changes under an identifier, each time the
+// speculated slot must be found wrong and the identifier looked up again.
+function test_deopt()
+{
+    function shadow(x, i) {
+        var y = x + 1;
+        if (i % 2 == 0) {
+            try {
+                throw 5;
+            } catch (y) {
+                return x + y;
+            }
+        }
+        return x + y;
+    }
+    for (var i = 0; i < kCalls; i++)
+        assert(shadow(i, i), i % 2 == 0 ? i + 5 : i + i + 1);
+
+    function by_with(o, i) {
+        var p = 1;
+        with (o)
+            return p + i;
+    }
+    for (var i = 0; i < kCalls; i++)
+        assert(by_with(i % 3 == 0 ? { p: 10 } : {}, i), (i % 3 == 0 ? 10 : 1) + i);
+
+    function by_eval(i) {
+        var a = 1;
+        if (i % 5 == 0)
+            eval("var b = 2");
+        else
+            eval("var c = 3");
+        return a + (i % 5 == 0 ? eval("b") : c);
+    }
+    for (var i = 0; i < kCalls; i++)
+        assert(by_eval(i), i % 5 == 0 ? 3 : 4);
+
+    function moving_slot(i) {
+        if (i % 2 == 0)
+            eval("var a = 1");
+        eval("var z = " + i);
+        return z;
+    }
+    for (var i = 0; i < kCalls; i++)
+        assert(moving_slot(i), i);
+
+    function strict_local(i) {
+        "use strict";
+        var v = i;
+        return v;
+    }
+    for (var i = 0; i < kCalls; i++)
+        assert(strict_local(i), i);
+}
+
+test_constants();
+test_locals();
+test_deopt();
@@ -0,0 +1,100 @@
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+
+
+// More iterations than the default threshold, so each loop below is
+// optimized while it runs. The loops are at the top level on purpose,
+// where the variables are properties of the global object.
+var kIterations = 300;
+
+var sum = 0;
+for (var i = 0; i < kIterations; i++)
+    sum = sum + i * 2;
+assert(sum, 89700);
+
+// A global added in the loop changes the layout of the global object,
+// which invalidates the speculated global cells.
+var n = 0;
+var total = 0;
+while (n < kIterations) {
+    if (n % 50 == 0)
+        this["g" + n] = n;
+    total = total + n;
+    n++;
+}
+assert(total, 44850);
+assert(g250, 250);
+
+// A global read by the loop is deleted and comes back.
+var k = 0;
+var seen = 0;
+do {
+    if (k == 150) {
+        delete this.extra;
+        assert(typeof extra, "undefined");
+        this.extra = 2;
+    }
+    if (k == 0)
+        this.extra = 1;
+    seen = seen + extra;
+    k++;
+} while (k < kIterations);
+assert(seen, 150 + 150 * 2);
+
+// Labels, break and continue keep working across the replacement.
+var count = 0;
+outer: for (var a = 0; a < 30; a++) {
+    for (var b = 0; b < 30; b++) {
+        if (b == a)
+            continue outer;
+        if (a == 29)
+            break outer;
+        count = count + 1;
+    }
+}
+assert(count, 406);
+
+var keys = {};
+for (var j = 0; j < kIterations; j++)
+    keys["k" + j] = j;
+var key_sum = 0;
+for (var p in keys)
+    key_sum = key_sum + keys[p];
+assert(key_sum, 44850);
+
+// A loop inside a function that is called once.
+function run_once() {
+    var acc = 0;
+    for (var x = 0; x < kIterations; x++)
+        acc = (acc + x * x) | 0;
+    return acc;
+}
+assert(run_once(), 8955050);
+
+// The loop variable is shadowed by a catch parameter part of the time.
+var caught = 0;
+for (var c = 0; c < kIterations; c++) {
+    try {
+        if (c % 3 == 0)
+            throw 1;
+        caught = caught + c;
+    } catch (c) {
+        caught = caught + c;
+    }
+}
+assert(caught, 30000 + 100);
@@ -0,0 +1,114 @@
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+
+function describe(o, p)
+{
+    var d = Object.getOwnPropertyDescriptor(o, p);
+    if (d === undefined)
+        return "undefined";
+    var s = "";
+    if ("value" in d)
+        s += "v:" + d.value + " w:" + d.writable;
+    else
+        s += "g:" + typeof d.get + " s:" + typeof d.set;
+    return s + " e:" + d.enumerable + " c:" + d.configurable;
+}
+
+function test_descriptors()
+{
+    var o = { a: 1 };
+    assert(describe(o, "a"), "v:1 w:true e:true c:true", "literal");
+    assert(describe(o, "b"), "undefined", "absent");
+    assert(describe([5, 6], "1"), "v:6 w:true e:true c:true", "element");
+    assert(describe([5, 6], "length"), "v:2 w:true e:false c:false", "array length");
+    assert(describe(new String("xy"), "length"), "v:2 w:false e:false c:false", "string length");
+    var d = Object.getOwnPropertyDescriptor(o, "a");
+    d.value = 2;
+    assert(o.a, 1, "descriptor is a copy");
+    Object.defineProperty(o, "c", { value: 3 });
+    assert(describe(o, "c"), "v:3 w:false e:false c:false", "defaults");
+}
+
+function test_attributes()
+{
+    var o = {};
+    Object.defineProperty(o, "ro", { value: 1, writable: false, enumerable: true, configurable: false });
+    o.ro = 2;
+    assert(o.ro, 1, "not writable");
+    assert(delete o.ro, false, "not configurable");
+    var threw = false;
+    try {
+        Object.defineProperty(o, "ro", { value: 2 });
+    } catch (e) {
+        threw = true;
+    }
+    assert(threw, true, "redefine non writable");
+    Object.defineProperty(o, "hidden", { value: 1, writable: true, enumerable: false, configurable: true });
+    o.visible = 2;
+    var names = [];
+    for (var k in o)
+        names.push(k);
+    assert(names.join(), "ro,visible", "for-in skips non enumerable");
+    assert(Object.keys(o).join(), "ro,visible", "keys");
+    o.hidden = 5;
+    assert(describe(o, "hidden"), "v:5 w:true e:false c:true", "put keeps attributes");
+}
+
+function test_accessors()
+{
+    var log = [];
+    var o = {
+        get x() { return 1; },
+        get y() { return this.v; },
+        set y(v) { log.push(v); this.v = v; }
+    };
+    assert(o.x, 1, "getter only");
+    o.x = 5;
+    assert(o.x, 1, "getter only ignores put");
+    o.y = 7;
+    assert(o.y, 7, "getter and setter");
+    assert(log.join(), "7", "setter called");
+    assert(describe(o, "y"), "g:function s:function e:true c:true", "accessor");
+    assert(describe(o, "x"), "g:function s:undefined e:true c:true", "accessor without setter");
+
+    var p = { z: 1 };
+    Object.defineProperty(p, "z", { get: function() { return 2; } });
+    assert(p.z, 2, "data to accessor");
+    assert(describe(p, "z"), "g:function s:undefined e:true c:true", "converted");
+    Object.defineProperty(p, "z", { value: 3 });
+    assert(p.z, 3, "accessor to data");
+    assert(describe(p, "z"), "v:3 w:false e:true c:true", "converted back");
+
+    var child = Object.create(o);
+    child.y = 9;
+    assert(log.join(), "7,9", "inherited setter");
+}
+
+function test_arguments()
+{
+    function f(a) {
+        arguments[0] = 2;
+        return a + ":" + describe(arguments, "0");
+    }
+    assert(f(1), "2:v:2 w:true e:true c:true", "mapped argument");
+}
+
+test_descriptors();
+test_attributes();
+test_accessors();
+test_arguments();
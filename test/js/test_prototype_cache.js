@@ -0,0 +1,124 @@
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+
+function read_x(o)
+{
+    return o.x;
+}
+
+function test_shadowing()
+{
+    function F() {}
+    F.prototype.x = 1;
+    var a = new F(), b = new F();
+    assert(read_x(a), 1, "from prototype");
+    assert(read_x(b), 1, "cached");
+    b.x = 2;
+    assert(read_x(b), 2, "own property shadows");
+    assert(read_x(a), 1, "other receiver");
+    F.prototype.x = 3;
+    assert(read_x(a), 3, "value changed on prototype");
+    delete F.prototype.x;
+    assert(read_x(a), undefined, "deleted from prototype");
+    Object.prototype.x = 4;
+    assert(read_x(a), 4, "added deeper on the chain");
+    delete Object.prototype.x;
+    assert(read_x(a), undefined, "deleted deeper on the chain");
+}
+
+function test_chains()
+{
+    var base = { x: "base" };
+    var mid = Object.create(base);
+    var o = Object.create(mid);
+    assert(read_x(o), "base", "two levels up");
+    mid.x = "mid";
+    assert(read_x(o), "mid", "added in between");
+    var other = { x: "other" };
+    Object.setPrototypeOf(mid, other);
+    delete mid.x;
+    assert(read_x(o), "other", "prototype of prototype changed");
+    Object.setPrototypeOf(o, base);
+    assert(read_x(o), "base", "prototype of receiver changed");
+    assert(read_x(Object.create(null)), undefined, "no prototype");
+}
+
+function test_accessors()
+{
+    var proto = {};
+    Object.defineProperty(proto, "x", { get: function() { return this.v * 2; }, configurable: true });
+    var a = Object.create(proto), b = Object.create(proto);
+    a.v = 1;
+    b.v = 5;
+    assert(read_x(a), 2, "getter");
+    assert(read_x(b), 10, "getter called on the receiver");
+    Object.defineProperty(proto, "x", { value: 7 });
+    assert(read_x(a), 7, "accessor turned data");
+}
+
+function test_primitives()
+{
+    function first(s) {
+        return s.charAt(0);
+    }
+    function len(s) {
+        return s.length;
+    }
+    assert(first("ab"), "a", "string method");
+    assert(first("cd"), "c", "string method cached");
+    assert(len("abc"), 3, "string length");
+    function tag(v) {
+        return v.tag;
+    }
+    assert(tag("ab"), undefined, "missing on string");
+    String.prototype.tag = 1;
+    assert(tag("ab"), 1, "added to String.prototype");
+    String.prototype.tag = 2;
+    assert(tag("cd"), 2, "changed on String.prototype");
+    assert(tag(3), undefined, "number after string");
+    Number.prototype.tag = 3;
+    assert(tag(4), 3, "added to Number.prototype");
+    Object.prototype.tag = 4;
+    assert(tag(true), 4, "boolean from Object.prototype");
+    delete Object.prototype.tag;
+    assert(tag(false), undefined, "deleted from Object.prototype");
+}
+
+function test_builtins()
+{
+    function push(a, v) {
+        a.push(v);
+        return a.length;
+    }
+    var a = [];
+    for (var i = 0; i < 10; i++)
+        push(a, i);
+    assert(a.join(), "0,1,2,3,4,5,6,7,8,9", "array push");
+    var b = [];
+    var pushed = [];
+    Object.defineProperty(b, "push", { value: function(v) { pushed[pushed.length] = v; } });
+    push(b, 10);
+    assert(pushed.join(), "10", "own push shadows");
+    assert(push(a, 10), 11, "prototype push again");
+}
+
+test_shadowing();
+test_chains();
+test_accessors();
+test_primitives();
+test_builtins();
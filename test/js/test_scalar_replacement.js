@@ -0,0 +1,177 @@
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+
+
+// More calls than the default threshold, so each function below runs both
+// before and after it is optimized. Run with --jit-stress as well.
+var kCalls = 300;
+
+function test_replaced()
+{
+    function dist2(ax, ay, bx, by) {
+        var d = { x: ax - bx, y: ay - by };
+        d.x = d.x * d.x;
+        d.y *= d.y;
+        return d.x + d.y;
+    }
+    for (var i = 0; i < kCalls; i++)
+        assert(dist2(i, 1, 0, 1 - i), 2 * i * i);
+
+    function in_loop(n) {
+        var s = 0;
+        for (var i = 0; i < n; i++) {
+            var p = { a: i, "b": i + 1, if: 2 };
+            p.a++;
+            s += p.a * p.b * p.if / 2;
+        }
+        return s;
+    }
+    for (var i = 0; i < kCalls; i++)
+        assert(in_loop(3), 1 * 1 + 2 * 2 + 3 * 3);
+
+    // A throwing property leaves the previous values in place.
+    function partial(i) {
+        var r = 0;
+        try {
+            var q = { v: i, w: (i % 2 ? null.x : 1) };
+            r = q.v + q.w;
+        } catch (e) {
+            r = -1;
+        }
+        return r;
+    }
+    for (var i = 0; i < kCalls; i++)
+        assert(partial(i), i % 2 ? -1 : i + 1);
+
+    // Properties missing from the literal read undefined from the prototype chain.
+    function missing(i) {
+        var o = { k: i };
+        return typeof o.missing + o.k;
+    }
+    for (var i = 0; i < kCalls; i++)
+        assert(missing(i), "undefined" + i);
+}
+
+// Each object below escapes, and must stay an object.
+function test_escaping()
+{
+    var saved = [];
+    function stored(i) {
+        var p = { x: i };
+        saved[i % 2] = p;
+        return p.x;
+    }
+    function returned(i) {
+        var p = { x: i };
+        return p;
+    }
+    function method(i) {
+        var p = { x: i, toString: null };
+        return p.hasOwnProperty === undefined ? 0 : String(p.x);
+    }
+    function deleted(i) {
+        var p = { x: i };
+        delete p.x;
+        return p.x;
+    }
+    function before(i) {
+        if (i % 2 == 0) {
+            var p = { x: i };
+        }
+        return i % 2 == 0 ? p.x : typeof p;
+    }
+    function self(i) {
+        var p = { x: i };
+        var q = { x: 1 };
+        q = { x: p.x + q.x };
+        return q.x;
+    }
+    function captured(i) {
+        var p = { x: i };
+        function get() { return p.x; }
+        return get();
+    }
+    function with_scope(i) {
+        var p = { x: i };
+        with ({ y: 1 })
+            return p.x + y;
+    }
+    function uses_eval(i) {
+        var p = { x: i };
+        return eval("p.x");
+    }
+    function compared(i) {
+        var p = { x: i };
+        var q = p;
+        return p === q && q.x == i;
+    }
+    function in_operator(i) {
+        var p = { x: i };
+        return "x" in p;
+    }
+    for (var i = 0; i < kCalls; i++) {
+        assert(stored(i), i);
+        assert(saved[i % 2].x, i);
+        assert(returned(i).x, i);
+        assert(method(i), String(i));
+        assert(deleted(i), undefined);
+        assert(before(i), i % 2 == 0 ? i : "undefined");
+        assert(self(i), i + 1);
+        assert(captured(i), i);
+        assert(with_scope(i), i + 1);
+        assert(uses_eval(i), i);
+        assert(compared(i), true);
+        assert(in_operator(i), true);
+    }
+}
+
+// The function is optimized while outer runs of it are still active,
+// which hold the object.
+function test_reentered()
+{
+    function recursive(n) {
+        var p = { x: n, y: 1 };
+        if (n > 0)
+            recursive(n - 1);
+        return p.x + p.y;
+    }
+    assert(recursive(kCalls), kCalls + 1);
+
+    function declared_after(n) {
+        if (n > 0)
+            declared_after(n - 1);
+        var p = { x: n, y: 1 };
+        return p.x + p.y;
+    }
+    assert(declared_after(kCalls), kCalls + 1);
+
+    function callback(cb) {
+        var p = { x: 1, y: 2 };
+        if (cb)
+            cb();
+        return p.x + p.y;
+    }
+    assert(callback(function() {
+        for (var i = 0; i < kCalls; i++)
+            assert(callback(null), 3);
+    }), 3);
+}
+
+test_replaced();
+test_escaping();
+test_reentered();
@@ -0,0 +1,128 @@
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+
+function test_index_of()
+{
+    var s = "hello world, hello moon";
+    assert(s.indexOf("hello"), 0, "indexOf");
+    assert(s.indexOf("hello", 1), 13, "indexOf from");
+    assert(s.indexOf("moon"), 19, "indexOf tail");
+    assert(s.indexOf("mooon"), -1, "indexOf missing");
+    assert(s.indexOf(""), 0, "indexOf empty");
+    assert(s.indexOf("", 100), s.length, "indexOf empty clamped");
+    assert(s.indexOf("o", -5), 4, "indexOf negative");
+    assert(s.lastIndexOf("hello"), 13, "lastIndexOf");
+    assert(s.lastIndexOf("hello", 12), 0, "lastIndexOf from");
+    assert(s.lastIndexOf("o"), 21, "lastIndexOf char");
+    assert(s.lastIndexOf("x"), -1, "lastIndexOf missing");
+    assert(s.lastIndexOf(""), s.length, "lastIndexOf empty");
+    assert("aaa".lastIndexOf("a", 0), 0, "lastIndexOf zero");
+}
+
+function naive_index_of(s, t, from)
+{
+    for (var i = from; i + t.length <= s.length; i++) {
+        if (s.substring(i, i + t.length) == t)
+            return i;
+    }
+    return -1;
+}
+
+function naive_last_index_of(s, t)
+{
+    for (var i = s.length - t.length; i >= 0; i--) {
+        if (s.substring(i, i + t.length) == t)
+            return i;
+    }
+    return -1;
+}
+
+function test_index_of_long()
+{
+    /* periodic and aperiodic needles around the vector and Two-Way cutoffs */
+    var seed = 7, s = "", i, j, t, len;
+    for (i = 0; i < 400; i++) {
+        seed = (seed * 1103515245 + 12345) % 2147483648;
+        s += "ab"[seed % 2];
+    }
+    for (i = 0; i < 60; i++) {
+        len = 1 + (i * 7) % 45;
+        j = (i * 37) % (s.length - len);
+        t = s.substring(j, j + len);
+        assert(s.indexOf(t), naive_index_of(s, t, 0), "indexOf " + t);
+        assert(s.indexOf(t, j + 1), naive_index_of(s, t, j + 1), "indexOf from " + t);
+        assert(s.lastIndexOf(t), naive_last_index_of(s, t), "lastIndexOf " + t);
+        t = t + "c";
+        assert(s.indexOf(t), -1, "indexOf missing " + t);
+    }
+    t = "";
+    for (i = 0; i < 40; i++)
+        t += "a";
+    assert((t + t + "b").indexOf(t + "b"), 40, "indexOf periodic");
+}
+
+function test_split()
+{
+    assert("a,b,,c".split(",").length, 4, "split");
+    assert("a,b,,c".split(",").join("|"), "a|b||c", "split");
+    assert("a,b,c".split(",", 2).join("|"), "a|b", "split limit");
+    assert("a,b,c".split(",", 0).length, 0, "split limit 0");
+    assert("abc".split().length, 1, "split undefined");
+    assert("abc".split()[0], "abc", "split undefined");
+    assert("abc".split("").join("|"), "a|b|c", "split empty");
+    assert("".split(",").length, 1, "split empty string");
+    assert("".split("").length, 0, "split empty string empty separator");
+    assert("--a--b--".split("--").join("|"), "|a|b|", "split edges");
+    assert("abc".split("abcd").join("|"), "abc", "split long separator");
+}
+
+function test_replace()
+{
+    assert("aXbXc".replace("X", "-"), "a-bXc", "replace first");
+    assert("abc".replace("x", "-"), "abc", "replace missing");
+    assert("abc".replace("b", "[$&]"), "a[b]c", "replace $&");
+    assert("abc".replace("b", "[$`]"), "a[a]c", "replace $`");
+    assert("abc".replace("b", "[$']"), "a[c]c", "replace $'");
+    assert("abc".replace("b", "$$"), "a$c", "replace $$");
+    assert("abc".replace("b", "$1$"), "a$1$c", "replace literal $");
+    assert("abc".replace("", "-"), "-abc", "replace empty");
+    assert("abc".replace("b", function(m, pos, s) { return m + pos + s; }), "ab1abcc", "replace function");
+}
+
+function test_concat()
+{
+    var s = "", t = "", i;
+    for (i = 0; i < 1000; i++) {
+        s += "ab";
+        t = i % 10 + t;
+    }
+    assert(s.length, 2000, "+= length");
+    assert(s.substring(1000, 1004), "abab", "+= content");
+    assert(s.indexOf("ba"), 1, "+= search");
+    assert(t.substring(0, 10), "9876543210", "prepend content");
+    assert(s == ("ab".concat(s)).substring(2), true, "+= equality");
+    assert(s + 1 + null, s + "1null", "+ conversion");
+    assert("a".concat(1, null, undefined, "b"), "a1nullundefinedb", "concat");
+    assert("a".concat(), "a", "concat none");
+}
+
+test_index_of();
+test_index_of_long();
+test_split();
+test_replace();
+test_concat();
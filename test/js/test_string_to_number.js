@@ -0,0 +1,104 @@
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+
+function is_nan(x)
+{
+    return x !== x;
+}
+
+function test_literals()
+{
+    assert(1e21, 1000000000000000000000);
+    assert(2E-3, 0.002);
+    assert(1.5e+2, 150);
+    assert(.5e1, 5);
+    assert(0x1F, 31);
+    assert(0XfF, 255);
+    assert(0.1 + 0.2, 0.30000000000000004);
+    assert(9007199254740993, 9007199254740992, "ties to even");
+    assert(3.141592653589793238462643383279, 3.141592653589793, "long mantissa");
+    assert(1.7976931348623157e308, Number.MAX_VALUE);
+    assert(5e-324, Number.MIN_VALUE);
+    assert(1e400, Infinity);
+    assert(1e-400, 0);
+    assert(String(123456789012345678901234567890), "1.2345678901234568e+29");
+    assert(String(0.000001), "0.000001");
+}
+
+function test_to_number()
+{
+    assert(Number(""), 0);
+    assert(Number("  \n\t "), 0);
+    assert(Number("  12  "), 12);
+    assert(Number("-12.5"), -12.5);
+    assert(Number("+.5"), 0.5);
+    assert(Number("5."), 5);
+    assert(Number("1.234e-7"), 1.234e-7, "negative exponent");
+    assert(Number("12345678.12345678"), 12345678.12345678, "eight digits at a time");
+    assert(Number("0x1F"), 31);
+    assert(is_nan(Number("-0x10")), true, "signed hex");
+    assert(Number("-Infinity"), -Infinity);
+    assert(is_nan(Number("infinity")), true);
+    assert(is_nan(Number("1e")), true);
+    assert(is_nan(Number(".")), true);
+    assert(is_nan(Number("1 2")), true);
+    assert(is_nan(Number("12px")), true);
+    assert(1 / Number("-0"), -Infinity);
+    assert(Number("-1e400"), -Infinity);
+    assert("10" * "2.5", 25);
+}
+
+function test_parse_int()
+{
+    assert(parseInt("  42px"), 42);
+    assert(parseInt("-0x1A"), -26);
+    assert(parseInt("0x1A", 16), 26);
+    assert(parseInt("0x1A", 10), 0);
+    assert(parseInt("101", 2), 5);
+    assert(parseInt("zZ", 36), 1295);
+    assert(parseInt("08"), 8);
+    assert(parseInt("3.9"), 3);
+    assert(parseInt("12345678901234567890"), 12345678901234567000);
+    assert(parseInt("ffffffffffffffff", 16), 18446744073709552000);
+    assert(is_nan(parseInt("12", 1)), true);
+    assert(is_nan(parseInt("12", 37)), true);
+    assert(is_nan(parseInt("")), true);
+    assert(is_nan(parseInt("-")), true);
+    assert(is_nan(parseInt("x1")), true);
+    assert(parseInt(15.99, 10), 15);
+}
+
+function test_parse_float()
+{
+    assert(parseFloat("3.14abc"), 3.14);
+    assert(parseFloat("  -2.5e3x"), -2500);
+    assert(parseFloat("1e"), 1);
+    assert(parseFloat("1e+"), 1);
+    assert(parseFloat(".5."), 0.5);
+    assert(parseFloat("Infinityx"), Infinity);
+    assert(parseFloat("-Infinity"), -Infinity);
+    assert(1 / parseFloat("-0"), -Infinity);
+    assert(is_nan(parseFloat(".e1")), true);
+    assert(is_nan(parseFloat("abc")), true);
+    assert(parseFloat("0.1e-5"), 0.000001);
+}
+
+test_literals();
+test_to_number();
+test_parse_int();
+test_parse_float();
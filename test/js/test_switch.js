@@ -0,0 +1,133 @@
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+
+function test_dense_int()
+{
+    function f(x) {
+        switch (x) {
+            case 0: return "zero";
+            case 1: return "one";
+            case 2: return "two";
+            case 4: return "four";
+            case 1: return "dup";
+        }
+        return "none";
+    }
+    assert(f(0), "zero");
+    assert(f(1), "one", "first of duplicated labels");
+    assert(f(2), "two");
+    assert(f(3), "none", "hole in the table");
+    assert(f(4), "four");
+    assert(f(5), "none");
+    assert(f(-1), "none");
+    assert(f(1.5), "none");
+    assert(f("1"), "none", "no conversion of the input");
+    assert(f(NaN), "none");
+    assert(f(-0), "zero", "-0 is strictly equal to 0");
+
+    function g(x) {
+        switch (x) {
+            case -0: return "zero";
+            case 1: return "one";
+        }
+        return "none";
+    }
+    assert(g(0), "zero", "-0 label");
+    assert(g(-0), "zero");
+    assert(g(1), "one");
+}
+
+function test_sparse_int()
+{
+    function f(x) {
+        var s = "";
+        switch (x) {
+            case 100000: s += "a";
+            case 7: s += "b"; break;
+            case 42: s += "c";
+            default: s += "d";
+            case 2000000000: s += "e";
+        }
+        return s;
+    }
+    assert(f(100000), "ab");
+    assert(f(7), "b");
+    assert(f(42), "cde", "fall through the default clause");
+    assert(f(2000000000), "e", "label after the default clause");
+    assert(f(0), "de");
+    assert(f(4294967296), "de");
+}
+
+function test_strings()
+{
+    function f(x) {
+        switch (x) {
+            case "start": return 1;
+            case "run": return 2;
+            case "": return 3;
+            default: return 0;
+            case "stop": return 4;
+        }
+    }
+    assert(f("start"), 1);
+    assert(f("ru" + "n"), 2, "input built at runtime");
+    assert(f(""), 3);
+    assert(f("stop"), 4);
+    assert(f("pause"), 0);
+    assert(f(1), 0);
+}
+
+function test_general()
+{
+    function f(x) {
+        switch (x) {
+            case 0.5: return "half";
+            case 1: return "one";
+        }
+        return "none";
+    }
+    assert(f(0.5), "half", "number label that is not an int32");
+    assert(f(1), "one");
+
+    var order = [];
+    function sel(v) {
+        order.push(v);
+        return v;
+    }
+    var s = "";
+    switch (3) {
+        case sel(1): s += "1";
+        default: s += "d";
+        case sel(3): s += "3";
+        case sel(4): s += "4";
+    }
+    assert(s, "34", "fall through after a match past the default clause");
+    assert(order.join(), "1,3", "selectors evaluated in order until a match");
+
+    var t = "x";
+    switch (t) {
+        case "x": s = "matched"; break;
+        case 1: s = "number";
+    }
+    assert(s, "matched", "mixed labels");
+}
+
+test_dense_int();
+test_sparse_int();
+test_strings();
+test_general();
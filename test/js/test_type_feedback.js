@@ -0,0 +1,116 @@
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+
+function is_negative_zero(x)
+{
+    return x === 0 && 1 / x === -Infinity;
+}
+
+// Each function below is one set of sites, which sees int32 operands
+// first and then widens to doubles, strings and objects.
+function test_widening()
+{
+    function add(a, b) { return a + b; }
+    function lt(a, b) { return a < b; }
+    function eq(a, b) { return a == b; }
+    function seq(a, b) { return a === b; }
+    function shr(a, b) { return a >> b; }
+
+    for (var i = 0; i < 10; i++) {
+        assert(add(i, 1), i + 1);
+        assert(lt(i, 5), i < 5);
+        assert(eq(i, 3), i === 3);
+        assert(shr(-i, 1), Math_floor_half(-i));
+    }
+    assert(add(2147483647, 1), 2147483648, "int32 site overflows into a double");
+    assert(add(0.5, 0.25), 0.75);
+    assert(is_negative_zero(add(-0, -0)), true);
+    assert(add("a", "b"), "ab");
+    assert(add("a", 1), "a1");
+    assert(add(1, "a"), "1a");
+    assert(add(true, 1), 2);
+    assert(add({ valueOf: function() { return 40; } }, 2), 42);
+    assert(add(undefined, 1) !== add(undefined, 1), true, "NaN");
+
+    assert(lt(0.5, 1), true);
+    assert(lt(1, 0 / 0), false);
+    assert(lt(0 / 0, 1), false);
+    assert(lt("a", "b"), true);
+    assert(lt("b", "a"), false);
+    assert(lt("10", "9"), true, "strings compare as strings");
+    assert(lt("10", 9), false, "mixed compares as numbers");
+    assert(lt(null, 1), true);
+
+    assert(eq(0, -0), true);
+    assert(eq(0 / 0, 0 / 0), false);
+    assert(eq("1", 1), true);
+    assert(eq("a", "a"), true);
+    assert(eq(null, undefined), true);
+    assert(seq("1", 1), false);
+    assert(seq(0.5, 0.5), true);
+    assert(seq("a", "a"), true);
+    var o = {};
+    assert(seq(o, o), true);
+    assert(seq(o, {}), false);
+
+    assert(shr(-7.5, 1), -4);
+    assert(shr(4294967295, 0), -1);
+    assert(shr("16", 2), 4);
+}
+
+function Math_floor_half(x)
+{
+    var r = x / 2;
+    return r === (r | 0) ? r : (x - 1) / 2;
+}
+
+function test_compound()
+{
+    var s = 0;
+    for (var i = 0; i < 10; i++)
+        s += i;
+    assert(s, 45);
+    s += 0.5;
+    assert(s, 45.5);
+    s += "!";
+    assert(s, "45.5!");
+    var t = "";
+    for (var i = 0; i < 3; i++)
+        t += "ab";
+    assert(t, "ababab");
+    var b = 1;
+    for (var i = 0; i < 3; i++)
+        b <<= 1;
+    b <<= 33;
+    assert(b, 16, "shift count wraps");
+    var u = -1;
+    u >>>= 28;
+    assert(u, 15);
+    var m = 7;
+    m %= -3;
+    assert(m, 1);
+    var z = -6;
+    z %= 3;
+    assert(is_negative_zero(z), true);
+    var d = 1;
+    d /= 4;
+    assert(d, 0.25);
+}
+
+test_widening();
+test_compound();
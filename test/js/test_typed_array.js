@@ -0,0 +1,121 @@
+function assert(actual, expected, message) {
+    if (arguments.length == 1)
+        expected = true;
+
+    if (actual === expected)
+        return;
+
+    if (actual !== null && expected !== null
+    &&  typeof actual == 'object' && typeof expected == 'object'
+    &&  actual.toString() === expected.toString())
+        return;
+
+    throw Error("assertion failed: got |" + actual + "|" +
+                ", expected |" + expected + "|" +
+                (message ? " (" + message + ")" : ""));
+}
+
+
+function test_conversions()
+{
+    var a = new Float64Array(4);
+    a[0] = 1.5;
+    a[3] = "2";
+    a[4] = 9;
+    assert(a.length, 4, "length");
+    assert(a.byteLength, 32, "byteLength");
+    assert(a[0], 1.5, "float64");
+    assert(a[3], 2, "float64 from string");
+    assert(a[4], undefined, "out of range");
+    var u = new Uint8Array([1, 256, -1, 3.7]);
+    assert(u[1], 0, "uint8 wraps");
+    assert(u[2], 255, "uint8 wraps negative");
+    assert(u[3], 3, "uint8 truncates");
+    var c = new Uint8ClampedArray([300, -5, 1.5, 2.5]);
+    assert(c[0], 255, "clamped high");
+    assert(c[1], 0, "clamped low");
+    assert(c[2], 2, "clamped rounds to even");
+    assert(c[3], 2, "clamped rounds to even");
+    var i = new Int16Array([32768, -32769]);
+    assert(i[0], -32768, "int16 wraps");
+    assert(i[1], 32767, "int16 wraps");
+    assert(new Uint32Array([-1])[0], 4294967295, "uint32");
+    assert(new Float32Array([0.5])[0], 0.5, "float32");
+    assert(Int32Array.BYTES_PER_ELEMENT, 4, "BYTES_PER_ELEMENT");
+}
+
+function test_views()
+{
+    var buf = new ArrayBuffer(16);
+    assert(buf.byteLength, 16, "buffer length");
+    var i32 = new Int32Array(buf), u8 = new Uint8Array(buf, 4, 4);
+    assert(i32.length, 4, "view length");
+    assert(u8.byteOffset, 4, "view offset");
+    i32[1] = -1;
+    assert(u8[0], 255, "shared buffer");
+    assert(u8[3], 255, "shared buffer");
+    var s = i32.subarray(1, 3);
+    assert(s.length, 2, "subarray length");
+    assert(s.byteOffset, 4, "subarray offset");
+    assert(s.buffer === buf, true, "subarray shares buffer");
+    s[1] = 42;
+    assert(i32[2], 42, "subarray writes through");
+    assert(i32.subarray(-1)[0], 0, "subarray negative");
+    var copy = new Int32Array(i32);
+    copy[2] = 0;
+    assert(i32[2], 42, "copy does not share");
+    assert(buf.slice(4, 8).byteLength, 4, "buffer slice");
+    assert(ArrayBuffer.isView(s), true, "isView");
+    assert(ArrayBuffer.isView(buf), false, "isView");
+}
+
+function test_set_fill()
+{
+    var a = new Int32Array(4);
+    a.set([7, 8], 2);
+    assert(a[2], 7, "set array");
+    assert(a[3], 8, "set array");
+    a.set(a.subarray(2, 4), 1);
+    assert(a[1], 7, "set overlapping");
+    assert(a[2], 8, "set overlapping");
+    var f = new Float64Array(a);
+    assert(f[2], 8, "from typed array");
+    a.fill(5, 1, 3);
+    assert(a[0], 0, "fill");
+    assert(a[1], 5, "fill");
+    assert(a[3], 8, "fill");
+    var keys = [];
+    for (var k in new Uint8Array(2))
+        keys.push(k);
+    assert(keys.join(), "0,1", "for-in");
+}
+
+function test_errors()
+{
+    var threw = false;
+    try {
+        Float64Array(2);
+    } catch (e) {
+        threw = true;
+    }
+    assert(threw, true, "call without new");
+    threw = false;
+    try {
+        new Int32Array(new ArrayBuffer(8), 3);
+    } catch (e) {
+        threw = true;
+    }
+    assert(threw, true, "unaligned offset");
+    threw = false;
+    try {
+        new Int32Array(new ArrayBuffer(8), 4, 2);
+    } catch (e) {
+        threw = true;
+    }
+    assert(threw, true, "length out of range");
+}
+
+test_conversions();
+test_views();
+test_set_fill();
+test_errors();
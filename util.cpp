@@ -3,187 +3,157 @@
 
 namespace es
 {
-    std::string NumberToString(double m)
+    // 9.8.1 ToString Applied to the Number Type
+    size_t NumberToString(double m, char* buf)
     {
-        int k;
-        int n;
-        int frac_digit;
-        size_t i;
-        double s;
-        double tmp;
-        std::string res;
-        std::string sign;
-        // TODO(zhuzilin) Figure out how to solve the large number error.
-        if(m == 0)
+        char* p = buf;
+        if(isnan(m))
         {
-            return String::Zero()->data();
+            memcpy(p, "NaN", 3);
+            return 3;
+        }
+        if(m == 0)
+        {// 2
+            *p = '0';
+            return 1;
         }
         if(m < 0)
-        {
+        {// 3
+            *p++ = '-';
             m = -m;
-            sign = "-";
-        }
-        // the fraction digits, e.g. 1.23's frac_digit = 2, 4200's = -2
-        frac_digit = 0;
-        // the total digits, e.g. 1.23's k = 3, 4200's k = 2
-        k = 0;
-        // n - k = -frac_digit
-        n = 0;
-        while(modf(m, &tmp) != 0)
-        {
-            frac_digit++;
-            m *= 10;
-        }
-        while(fmod(m, 10) < 1e-6)
-        {
-            frac_digit--;
-            m /= 10;
-        }
-        s = m;
-        while(m > 0.5)
-        {
-            k++;
-            m /= 10;
-            modf(m, &tmp);
-            m = tmp;
         }
-        n = k - frac_digit;
-        if(k <= n && n <= 21)
-        {
-            while(s > 0.5)
+        if(isinf(m))
+        {// 4
+            memcpy(p, "Infinity", 8);
+            return p + 8 - buf;
+        }
+        if(m < 9007199254740992.0 && m == floor(m))
+        {// Integers below 2^53 are exact, so their digits are
+         // the shortest ones.
+            char digits[16];
+            char* d = digits + sizeof(digits);
+            uint64_t v = static_cast<uint64_t>(m);
+            do
             {
-                res += u'0' + int(fmod(s, 10));
-                s /= 10;
-                modf(s, &tmp);
-                s = tmp;
-            }
-            reverse(res.begin(), res.end());
-            res += std::string(n - k, u'0');
-            return sign + res;
-        }
-        if(0 < n && n <= 21)
-        {
-            for(i = 0; i < size_t(k); i++)
+                *--d = '0' + v % 10;
+                v /= 10;
+            } while(v != 0);
+            size_t len = digits + sizeof(digits) - d;
+            memcpy(p, d, len);
+            return p + len - buf;
+        }
+        // 5. std::to_chars gives the shortest digits s, k of them, such that
+        // s * 10^(n-k) reads back as m, in the form d.ddde[+-]x.
+        char sci[32];
+        char* end = std::to_chars(sci, sci + sizeof(sci), m, std::chars_format::scientific).ptr;
+        char s[20];
+        int k = 0;
+        char* q = sci;
+        for(; q < end && *q != 'e'; q++)
+        {
+            if(*q != '.')
             {
-                res += u'0' + int(fmod(s, 10));
-                if(int(int(i) + 1) == int(int(k) - int(n)))
-                {
-                    res += u'.';
-                }
-                s /= 10;
-                modf(s, &tmp);
-                s = tmp;
+                s[k++] = *q;
             }
-            reverse(res.begin(), res.end());
-            return sign + res;
         }
-        if(-6 < n && n <= 0)
+        int exponent = 0;
+        bool negative = q + 1 < end && q[1] == '-';
+        for(q += 2; q < end; q++)
         {
-            for(i = 0; i < size_t(k); i++)
-            {
-                res += u'0' + int(fmod(s, 10));
-                s /= 10;
-                modf(s, &tmp);
-                s = tmp;
-            }
-            reverse(res.begin(), res.end());
-            res = "0." + std::string(-n, u'0') + res;
-            return sign + res;
+            exponent = exponent * 10 + (*q - '0');
         }
-        if(k == 1)
-        {
-            res += u'0' + int(s);
-            res += "e";
-            if(n - 1 > 0)
+        int n = (negative ? -exponent : exponent) + 1;
+        if(k <= n && n <= 21)
+        {// 6
+            memcpy(p, s, k);
+            p += k;
+            memset(p, '0', n - k);
+            p += n - k;
+        }
+        else if(0 < n && n <= 21)
+        {// 7
+            memcpy(p, s, n);
+            p += n;
+            *p++ = '.';
+            memcpy(p, s + n, k - n);
+            p += k - n;
+        }
+        else if(-6 < n && n <= 0)
+        {// 8
+            *p++ = '0';
+            *p++ = '.';
+            memset(p, '0', -n);
+            p += -n;
+            memcpy(p, s, k);
+            p += k;
+        }
+        else
+        {// 9, 10
+            *p++ = s[0];
+            if(k > 1)
             {
-                res += "+" + NumberToString(n - 1);
+                *p++ = '.';
+                memcpy(p, s + 1, k - 1);
+                p += k - 1;
             }
-            else
+            *p++ = 'e';
+            *p++ = n - 1 > 0 ? '+' : '-';
+            exponent = n - 1 > 0 ? n - 1 : 1 - n;
+            if(exponent >= 100)
             {
-                res += "-" + NumberToString(1 - n);
+                *p++ = '0' + exponent / 100;
             }
-            return sign + res;
-        }
-        for(i = 0; i < size_t(k); i++)
-        {
-            res += u'0' + int(fmod(s, 10));
-            if(int(int(i) + 1) == int(int(k) - 1))
+            if(exponent >= 10)
             {
-                res += u'.';
+                *p++ = '0' + exponent / 10 % 10;
             }
-            s /= 10;
-            modf(s, &tmp);
-            s = tmp;
+            *p++ = '0' + exponent % 10;
         }
-        res += "e";
-        if(n - 1 > 0)
-        {
-            res += "+" + NumberToString(n - 1);
-        }
-        else
+        return p - buf;
+    }
+
+    std::string NumberToString(double m)
+    {
+        String* interned = IndexStrings::Global()->Find(m);
+        if(interned != nullptr)
         {
-            res += "-" + NumberToString(1 - n);
+            return interned->data();
         }
-        return sign + res;
+        char buf[kNumberToStringSize];
+        return std::string(buf, NumberToString(m, buf));
     }
 
     std::string NumberToString(Number* num)
     {
-        if(num->IsNaN())
-        {
-            return String::NaN()->data();
-        }
-        if(num->IsInfinity())
-        {
-            return String::Infinity()->data();
-        }
         return NumberToString(num->data());
     }
 
     double ToInt32(Error* e, JSValue* input)
     {
+        if(input->IsNumber() && static_cast<Number*>(input)->IsInt32())
+        {
+            return static_cast<Number*>(input)->Int32Value();
+        }
         double num = ToNumber(e, input);
         if(!e->IsOk())
         {
             return 0;
         }
-        if(isnan(num) || isinf(num) || num == 0)
-        {
-            return 0.0;
-        }
-        double pos_int = num > 0 ? floor(abs(num)) : -(floor(abs(-num)));
-        double int32_bit = fmod(pos_int, pow(2, 32));
-        if(int32_bit < 0)
-        {
-            int32_bit += pow(2, 32);
-        }
-
-        if(int32_bit > pow(2, 31))
-        {
-            return int32_bit - pow(2, 32);
-        }
-        else
-        {
-            return int32_bit;
-        }
+        return DoubleToInt32(num);
     }
 
     double ToUint(Error* e, JSValue* input, char bits)
     {
+        assert(bits > 0 && bits <= 32);
         double num = ToNumber(e, input);
         if(!e->IsOk())
         {
             return 0.0;
         }
-        if(isnan(num) || isinf(num) || num == 0)
-        {
-            return 0.0;
-        }
-        double pos_int = num > 0 ? floor(abs(num)) : -(floor(abs(-num)));
-        double int_bit = fmod(pos_int, pow(2, bits));
-        if(int_bit < 0)
+        uint32_t int_bit = DoubleToUint32(num);
+        if(bits < 32)
         {
-            int_bit += pow(2, bits);
+            int_bit &= (1u << bits) - 1;
         }
         return int_bit;
     }
@@ -250,147 +220,319 @@ namespace es
         return num > 0 ? floor(abs(num)) : -(floor(abs(-num)));
     }
 
-    double StringToNumber(const std::string& source)
+    // Eight digits are validated and converted at once with
+    // SWAR arithmetic on a 64-bit word, as in fast_float.
+    static inline bool ParseEightDigits(const char* p, uint64_t* value)
     {
-        size_t start = 0;
-        size_t end = source.size();
-        bool positive = true;
-        double val = 0;
-        while(start < end)
-        {
-            char c = source[start];
-            if(!character::IsWhiteSpace(c) && !character::IsLineTerminator(c))
-            {
-                break;
-            }
-            start++;
-        }
-        while(start < end)
+        uint64_t v;
+        memcpy(&v, p, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        v = __builtin_bswap64(v);
+#endif
+        if(((v & 0xF0F0F0F0F0F0F0F0) | (((v + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) != 0x3333333333333333)
+        {
+            return false;
+        }
+        const uint64_t mask = 0x000000FF000000FF;
+        const uint64_t mul1 = 100 + (1000000ull << 32);
+        const uint64_t mul2 = 1 + (10000ull << 32);
+        v -= 0x3030303030303030;
+        v = (v * 10) + (v >> 8);
+        v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+        *value = uint32_t(v);
+        return true;
+    }
+
+    // Appends the decimal digits at p to *mantissa and returns their end.
+    // The mantissa wraps around past 19 digits, callers check the count.
+    static inline const char* AccumulateDigits(const char* p, const char* end, uint64_t* mantissa)
+    {
+        uint64_t m = *mantissa;
+        uint64_t eight;
+        while(end - p >= 8 && ParseEightDigits(p, &eight))
         {
-            char c = source[end - 1];
-            if(!character::IsWhiteSpace(c) && !character::IsLineTerminator(c))
-            {
-                break;
-            }
-            end--;
+            m = m * 100000000 + eight;
+            p += 8;
         }
-        if(start == end)
+        while(p < end && character::IsDecimalDigit(*p))
         {
-            goto error;
+            m = m * 10 + (*p - u'0');
+            p++;
         }
-        else if(source[start] == u'-')
+        *mantissa = m;
+        return p;
+    }
+
+    static inline int DigitValue(char c)
+    {
+        if(c >= u'0' && c <= u'9')
         {
-            positive = false;
-            start++;
+            return c - u'0';
         }
-        else if(source[start] == u'+')
+        if(c >= u'a' && c <= u'z')
         {
-            start++;
+            return c - u'a' + 10;
         }
-        else if(end - start > 2 && source[start] == u'0' && (source[start + 1] == u'x' || source[start + 1] == u'X'))
+        if(c >= u'A' && c <= u'Z')
         {
-            // 0xABCD...
-            start += 2;
-            while(start < end)
-            {
-                char c = source[start];
-                if(!character::IsHexDigit(c))
-                {
-                    goto error;
-                }
-                val = val * 16 + character::Digit(c);
-                start++;
-            }
-            return val;
+            return c - u'A' + 10;
         }
+        return 36;
+    }
 
-        if(start == end)
+    static inline const char* SkipStrWhiteSpace(const char* p, const char* end)
+    {
+        while(p < end && (character::IsWhiteSpace(*p) || character::IsLineTerminator(*p)))
         {
-            goto error;
+            p++;
         }
+        return p;
+    }
 
-        if(source.substr(start, end - start) == "Infinity")
+    // Parses "Infinity" at p, and returns its end or p.
+    static inline const char* ParseInfinity(const char* p, const char* end)
+    {
+        static constexpr std::string_view kInfinity = "Infinity";
+        if(size_t(end - p) >= kInfinity.size() && std::string_view(p, kInfinity.size()) == kInfinity)
         {
-            return positive ? Number::PositiveInfinity()->data() : Number::NegativeInfinity()->data();
+            return p + kInfinity.size();
         }
+        return p;
+    }
 
-        while(start < end)
+    const char* ParseDecimal(const char* begin, const char* end, double* result)
+    {
+        // Exactly representable powers of ten, for the fast path.
+        static constexpr double kPowersOfTen[] = {
+            1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+        };
+        uint64_t mantissa = 0;
+        const char* p = AccumulateDigits(begin, end, &mantissa);
+        size_t int_digits = p - begin;
+        size_t frac_digits = 0;
+        if(p < end && *p == u'.')
         {
-            char c = source[start];
-            if(!character::IsDecimalDigit(c))
-            {
-                break;
-            }
-            val = val * 10 + character::Digit(c);
-            start++;
+            const char* frac = p + 1;
+            p = AccumulateDigits(frac, end, &mantissa);
+            frac_digits = p - frac;
         }
-        if(start == end)
+        if(int_digits + frac_digits == 0)
         {
-            return positive ? val : -val;
+            return begin;
         }
-
-        if(source[start] == u'.')
+        int64_t exponent = 0;
+        if(p < end && (*p == u'e' || *p == u'E'))
         {
-            start++;
-            double frac = 0.1;
-            while(start < end)
+            const char* q = p + 1;
+            bool exp_positive = true;
+            if(q < end && (*q == u'+' || *q == u'-'))
+            {
+                exp_positive = *q == u'+';
+                q++;
+            }
+            if(q < end && character::IsDecimalDigit(*q))
             {
-                char c = source[start];
-                if(!character::IsDecimalDigit(c))
+                while(q < end && character::IsDecimalDigit(*q))
+                {
+                    if(exponent < 100000)
+                    {
+                        exponent = exponent * 10 + (*q - u'0');
+                    }
+                    q++;
+                }
+                if(!exp_positive)
                 {
-                    break;
+                    exponent = -exponent;
                 }
-                val += frac * character::Digit(c);
-                frac /= 10;
-                start++;
+                p = q;
             }
-            if(start == end)
+        }
+        int64_t exp10 = exponent - int64_t(frac_digits);
+        if(int_digits + frac_digits <= 19)
+        {
+            // Clinger's fast path: both operands are exact, so a single
+            // rounding gives the correctly rounded result.
+            if(mantissa == 0 || exp10 == 0)
             {
-                return positive ? val : -val;
+                *result = double(mantissa);
+                return p;
+            }
+            if(mantissa <= (1ull << 53) && exp10 >= -22 && exp10 <= 22)
+            {
+                *result = exp10 > 0 ? double(mantissa) * kPowersOfTen[exp10] : double(mantissa) / kPowersOfTen[-exp10];
+                return p;
             }
         }
+        // Everything else goes through the Eisel-Lemire parser of from_chars.
+        auto res = std::from_chars(begin, p, *result);
+        if(res.ec == std::errc::result_out_of_range)
+        {
+            const char* first = begin;
+            while(first < begin + int_digits && *first == u'0')
+            {
+                first++;
+            }
+            int64_t magnitude = exponent + (begin + int_digits - first);
+            *result = magnitude > 0 ? Number::PositiveInfinity()->data() : 0.0;
+        }
+        return p;
+    }
 
-        if(source[start] == u'e' || source[start] == u'E')
+    const char* ParseDigits(const char* begin, const char* end, int radix, double* result)
+    {
+        assert(radix >= 2 && radix <= 36);
+        if(radix == 10)
         {
-            start++;
-            double exp = 0;
-            bool exp_positive = true;
-            if(start == end)
+            uint64_t mantissa = 0;
+            const char* p = AccumulateDigits(begin, end, &mantissa);
+            if(p != begin)
             {
-                goto error;
+                ParseDecimal(begin, p, result);
             }
-            if(source[start] == u'-')
+            return p;
+        }
+        // Digits are gathered in an integer while they fit, so that up to 64
+        // bits worth of digits convert with a single rounding.
+        const uint64_t limit = (UINT64_MAX - 35) / radix;
+        uint64_t mantissa = 0;
+        double val = 0;
+        bool wide = false;
+        const char* p = begin;
+        for(; p < end; p++)
+        {
+            int digit = DigitValue(*p);
+            if(digit >= radix)
             {
-                exp_positive = false;
-                start++;
+                break;
             }
-            else if(source[start] == u'-')
+            if(!wide && mantissa > limit)
             {
-                start++;
+                val = double(mantissa);
+                wide = true;
             }
-            if(start == end)
+            if(wide)
             {
-                goto error;
+                val = val * radix + digit;
             }
+            else
+            {
+                mantissa = mantissa * radix + digit;
+            }
+        }
+        *result = wide ? val : double(mantissa);
+        return p;
+    }
 
-            while(start < end)
+    // 9.3.1 ToNumber Applied to the String Type
+    double StringToNumber(const std::string& source)
+    {
+        const char* p = source.data();
+        const char* end = p + source.size();
+        p = SkipStrWhiteSpace(p, end);
+        while(p < end && (character::IsWhiteSpace(end[-1]) || character::IsLineTerminator(end[-1])))
+        {
+            end--;
+        }
+        if(p == end)
+        {// StrWhiteSpace
+            return 0.0;
+        }
+        if(end - p > 2 && p[0] == u'0' && (p[1] == u'x' || p[1] == u'X'))
+        {// HexIntegerLiteral
+            double val;
+            if(ParseDigits(p + 2, end, 16, &val) != end)
             {
-                char c = source[start];
-                if(!character::IsDecimalDigit(c))
-                {
-                    break;
-                }
-                exp = exp * 10 + character::Digit(c);
-                start++;
+                return nan("");
+            }
+            return val;
+        }
+        bool positive = true;
+        if(*p == u'-' || *p == u'+')
+        {
+            positive = *p == u'+';
+            p++;
+        }
+        double val;
+        const char* q = ParseInfinity(p, end);
+        if(q != p)
+        {
+            val = Number::PositiveInfinity()->data();
+        }
+        else
+        {
+            q = ParseDecimal(p, end, &val);
+        }
+        if(q == p || q != end)
+        {
+            return nan("");
+        }
+        return positive ? val : -val;
+    }
+
+    // 15.1.2.2 parseInt (string , radix) 2-15
+    double ParseInt(const std::string& source, int radix)
+    {
+        const char* p = source.data();
+        const char* end = p + source.size();
+        p = SkipStrWhiteSpace(p, end);// 2
+        bool positive = true;
+        if(p < end && (*p == u'-' || *p == u'+'))
+        {// 3-5
+            positive = *p == u'+';
+            p++;
+        }
+        bool strip_prefix = true;// 7
+        if(radix != 0)
+        {// 8
+            if(radix < 2 || radix > 36)
+            {
+                return nan("");
             }
-            if(start == end)
+            if(radix != 16)
             {
-                val = val * pow(10, exp);
-                return positive ? val : -val;
+                strip_prefix = false;
             }
         }
-    error:
-        return nan("");
+        else
+        {// 9
+            radix = 10;
+        }
+        if(strip_prefix && end - p >= 2 && p[0] == u'0' && (p[1] == u'x' || p[1] == u'X'))
+        {// 10
+            p += 2;
+            radix = 16;
+        }
+        double val;
+        if(ParseDigits(p, end, radix, &val) == p)
+        {// 11, 12
+            return nan("");
+        }
+        return positive ? val : -val;// 13-15
+    }
+
+    // 15.1.2.3 parseFloat (string) 2-5
+    double ParseFloat(const std::string& source)
+    {
+        const char* p = source.data();
+        const char* end = p + source.size();
+        p = SkipStrWhiteSpace(p, end);// 2
+        bool positive = true;
+        if(p < end && (*p == u'-' || *p == u'+'))
+        {
+            positive = *p == u'+';
+            p++;
+        }
+        double val;
+        if(ParseInfinity(p, end) != p)
+        {
+            val = Number::PositiveInfinity()->data();
+        }
+        else if(ParseDecimal(p, end, &val) == p)
+        {// 3
+            return nan("");
+        }
+        return positive ? val : -val;// 5
     }
 
     bool ToBoolean(JSValue* input)
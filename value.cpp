@@ -11,7 +11,7 @@ namespace es
         {
             case JSValue::JS_UNDEFINED:
             case JSValue::JS_NULL:
-                *e = *Error::TypeError("Cannot convert undefined or null to object");
+                *e = Error::TypeError("Cannot convert undefined or null to object");
                 return nullptr;
             case JSValue::JS_BOOL:
                 return new BoolObject(input);
@@ -24,7 +24,21 @@ namespace es
             default:
                 assert(false);
         }
+    }
 
+    JSObject* PrimitivePrototype(JSValue* input)
+    {
+        switch(input->type())
+        {
+            case JSValue::JS_BOOL:
+                return BoolProto::Instance();
+            case JSValue::JS_NUMBER:
+                return NumberProto::Instance();
+            case JSValue::JS_STRING:
+                return StringProto::Instance();
+            default:
+                assert(false);
+        }
     }// namespace es
 
     // 11.8.5 The Abstract Relational Comparison Algorithm
@@ -141,7 +155,7 @@ namespace es
             {
                 String* sx = static_cast<String*>(x);
                 String* sy = static_cast<String*>(y);
-                return sx->data() == sy->data();
+                return sx->Equals(sy);
             }
             return x == y;
         }
@@ -241,7 +255,7 @@ namespace es
             {
                 String* str_x = static_cast<String*>(x);
                 String* str_y = static_cast<String*>(y);
-                return str_x->data() == str_y->data();
+                return str_x->Equals(str_y);
             }
             case JSValue::JS_BOOL:
             {